@@ -0,0 +1,43 @@
+// Calls into the binding with small Buffers, where getting at the Buffer's
+// memory is a large part of the cost of each call.
+'use strict';
+
+var common = require('../common.js');
+
+var bench = common.createBenchmark(main, {
+  op: ['compare', 'fill', 'write'],
+  size: [8, 64, 512],
+  n: [1e6]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var size = +conf.size;
+  var a = Buffer.alloc(size, 'a');
+  var b = Buffer.alloc(size, 'a');
+  var str = 'b'.repeat(size);
+  var i;
+
+  switch (conf.op) {
+    case 'compare':
+      bench.start();
+      for (i = 0; i < n; i++)
+        Buffer.compare(a, b);
+      bench.end(n);
+      break;
+    case 'fill':
+      bench.start();
+      for (i = 0; i < n; i++)
+        a.fill('xy');
+      bench.end(n);
+      break;
+    case 'write':
+      bench.start();
+      for (i = 0; i < n; i++)
+        a.write(str, 0, 'utf8');
+      bench.end(n);
+      break;
+    default:
+      throw new Error('unknown op ' + conf.op);
+  }
+}
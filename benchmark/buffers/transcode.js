@@ -0,0 +1,46 @@
+// Throughput of buffer.transcode() between the encodings that have fast
+// paths, for short records and for larger blocks.  `stream` feeds the same
+// data through the binding's streaming Transcoder in 1 KB chunks instead.
+'use strict';
+
+var common = require('../common.js');
+var buffer = require('buffer');
+
+var bench = common.createBenchmark(main, {
+  pair: ['latin1-utf8', 'utf8-ucs2', 'ucs2-latin1', 'utf8-latin1'],
+  content: ['ascii', 'latin1'],
+  len: [16, 65536],
+  mode: ['oneshot', 'stream'],
+  n: [1e5]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var len = +conf.len;
+  var encodings = conf.pair.split('-');
+  var from = encodings[0];
+  var to = encodings[1];
+  var chars = conf.content === 'ascii' ? 'hello world ' : 'héllo wörld ';
+  var source = Buffer.from(chars.repeat(Math.ceil(len / chars.length))
+                                .slice(0, len), from);
+  var i;
+
+  if (conf.mode === 'oneshot') {
+    bench.start();
+    for (i = 0; i < n; i++)
+      buffer.transcode(source, from, to);
+    bench.end(n * source.length / 1024 / 1024);
+    return;
+  }
+
+  var Transcoder = process.binding('icu').Transcoder;
+  var transcoder = new Transcoder(from, to);
+  var chunk = 1024;
+  bench.start();
+  for (i = 0; i < n; i++) {
+    for (var offset = 0; offset < source.length; offset += chunk)
+      transcoder.transcode(source.slice(offset, offset + chunk), false);
+    transcoder.transcode(Buffer.alloc(0), true);
+  }
+  bench.end(n * source.length / 1024 / 1024);
+}
@@ -0,0 +1,39 @@
+// Latency of child_process.spawn() as the parent grows.  `rss` MB of
+// touched memory are held while `n` short-lived children are started one
+// after the other; with fork() every spawn pays for copying the page tables
+// of all of it.  The rate reported is spawns per second.
+'use strict';
+
+var common = require('../common.js');
+var spawn = require('child_process').spawn;
+
+var bench = common.createBenchmark(main, {
+  rss: [0, 512, 2048],
+  n: [200]
+});
+
+var ballast = [];
+
+function main(conf) {
+  var n = +conf.n;
+  var rss = +conf.rss;
+
+  // Allocate in 64MB pieces and write to every page so that they are
+  // actually mapped.
+  for (var mb = 0; mb < rss; mb += 64)
+    ballast.push(Buffer.alloc(64 * 1024 * 1024, 1));
+
+  var done = 0;
+  bench.start();
+  go();
+
+  function go() {
+    var child = spawn('true');
+    child.on('exit', function() {
+      if (++done < n)
+        return go();
+      bench.end(done);
+      ballast = [];
+    });
+  }
+}
@@ -0,0 +1,34 @@
+// spawnSync() of a child that writes `mb` MB to stdout.  The output is read
+// into a single block that becomes the result Buffer without being copied
+// again, so both the time and the peak RSS (printed to stderr) should grow
+// with the output size only once.
+'use strict';
+
+var common = require('../common.js');
+var spawnSync = require('child_process').spawnSync;
+
+var bench = common.createBenchmark(main, {
+  mb: [1, 64, 256],
+  n: [10]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var bytes = +conf.mb * 1024 * 1024;
+  var peak = 0;
+
+  bench.start();
+  for (var i = 0; i < n; i++) {
+    var result = spawnSync('head', ['-c', String(bytes), '/dev/zero'], {
+      maxBuffer: bytes + 1
+    });
+    if (result.error)
+      throw result.error;
+    if (result.stdout.length !== bytes)
+      throw new Error('short output: ' + result.stdout.length);
+    peak = Math.max(peak, process.memoryUsage().rss);
+  }
+  bench.end(n);
+
+  process.stderr.write('peak rss: ' + Math.round(peak / 1048576) + ' MB\n');
+}
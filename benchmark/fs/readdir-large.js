@@ -0,0 +1,54 @@
+// Measures fs.readdir()/fs.readdirSync() on a directory holding a large
+// number of entries, which stresses building the result array.
+'use strict';
+
+var common = require('../common.js');
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+
+var bench = common.createBenchmark(main, {
+  type: ['sync', 'async'],
+  entries: [50000],
+  n: [20]
+});
+
+function populate(dir, entries) {
+  fs.mkdirSync(dir);
+  for (var i = 0; i < entries; i++)
+    fs.closeSync(fs.openSync(path.join(dir, 'entry-' + i), 'w'));
+}
+
+function cleanup(dir) {
+  fs.readdirSync(dir).forEach(function(name) {
+    fs.unlinkSync(path.join(dir, name));
+  });
+  fs.rmdirSync(dir);
+}
+
+function main(conf) {
+  var n = +conf.n;
+  var entries = +conf.entries;
+  var dir = path.join(os.tmpdir(), 'readdir-bench-' + process.pid);
+  populate(dir, entries);
+
+  bench.start();
+  if (conf.type === 'sync') {
+    for (var i = 0; i < n; i++)
+      fs.readdirSync(dir);
+    bench.end(n);
+    cleanup(dir);
+  } else {
+    (function next(remaining) {
+      if (remaining === 0) {
+        bench.end(n);
+        return cleanup(dir);
+      }
+      fs.readdir(dir, function(err) {
+        if (err)
+          throw err;
+        next(remaining - 1);
+      });
+    })(n);
+  }
+}
@@ -0,0 +1,94 @@
+// Throughput of small HTTP responses that are written in several pieces
+// (head, a few body chunks, end).  With `cork` set the server corks the
+// socket handle until setImmediate(), so libuv sends what http flushed in
+// the meantime with one writev() instead of one syscall per piece.  The
+// client pipelines `pipeline` requests on a single keep-alive connection;
+// the rate is responses/sec.
+'use strict';
+
+var common = require('../common.js');
+var http = require('http');
+var net = require('net');
+
+var bench = common.createBenchmark(main, {
+  cork: [0, 1],
+  chunks: [1, 4, 16],
+  pipeline: [1, 16],
+  n: [1e5]
+});
+
+var PORT = common.PORT;
+
+function main(conf) {
+  var n = +conf.n;
+  var cork = +conf.cork === 1;
+  var chunks = +conf.chunks;
+  var pipeline = +conf.pipeline;
+
+  // Every response ends in a single '#', which never shows up in the
+  // headers, so the client can count responses without parsing them.
+  var chunk = 'x'.repeat(32);
+  var last = chunk.slice(1) + '#';
+  var length = chunk.length * chunks;
+
+  // http corks the JS socket itself and only writes to the handle from a
+  // nextTick, so uncorking right after the handler would hold nothing back.
+  // Requests handled in the same tick share one uncork.
+  function corkUntilImmediate(handle) {
+    if (handle.benchCorked)
+      return;
+    handle.benchCorked = true;
+    handle.cork();
+    setImmediate(function() {
+      handle.benchCorked = false;
+      handle.uncork();
+    });
+  }
+
+  var server = http.createServer(function(req, res) {
+    if (cork)
+      corkUntilImmediate(req.socket._handle);
+    res.writeHead(200, {
+      'Content-Type': 'text/plain',
+      'Content-Length': length
+    });
+    for (var i = 1; i < chunks; i++)
+      res.write(chunk);
+    res.end(last);
+  });
+
+  var request = 'GET / HTTP/1.1\r\nHost: localhost\r\n\r\n';
+  var batch = request.repeat(pipeline);
+
+  server.listen(PORT, function() {
+    var socket = net.connect(PORT);
+    var sent = 0;
+    var received = 0;
+    var pending = 0;
+
+    function send() {
+      sent += pipeline;
+      pending = pipeline;
+      socket.write(batch);
+    }
+
+    socket.setEncoding('latin1');
+    socket.on('connect', function() {
+      bench.start();
+      send();
+    });
+    socket.on('data', function(data) {
+      for (var i = data.indexOf('#'); i !== -1; i = data.indexOf('#', i + 1)) {
+        received++;
+        pending--;
+      }
+      if (pending > 0)
+        return;
+      if (sent < n)
+        return send();
+      bench.end(received);
+      socket.destroy();
+      server.close();
+    });
+  });
+}
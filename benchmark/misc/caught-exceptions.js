@@ -0,0 +1,46 @@
+// Measures the cost of exceptions that are thrown and caught again, as in
+// code that uses try/catch for control flow.  Each exception passes through
+// the embedder's TryCatch on its way back to JS: `compile` throws a
+// SyntaxError out of the vm.Script constructor, `script` throws out of a
+// running vm.Script.
+'use strict';
+
+var common = require('../common.js');
+var vm = require('vm');
+
+var bench = common.createBenchmark(main, {
+  type: ['compile', 'script'],
+  n: [1e6]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var caught = 0;
+  var i;
+
+  if (conf.type === 'compile') {
+    bench.start();
+    for (i = 0; i < n; i++) {
+      try {
+        new vm.Script('{"truncated":');
+      } catch (e) {
+        caught++;
+      }
+    }
+    bench.end(n);
+  } else {
+    var script = new vm.Script("JSON.parse('{\"truncated\":')");
+    bench.start();
+    for (i = 0; i < n; i++) {
+      try {
+        script.runInThisContext();
+      } catch (e) {
+        caught++;
+      }
+    }
+    bench.end(n);
+  }
+
+  if (caught !== n)
+    throw new Error('expected ' + n + ' exceptions, caught ' + caught);
+}
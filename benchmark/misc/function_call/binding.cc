@@ -9,9 +9,24 @@ void Hello(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(c++);
 }
 
+// Checks and unboxes its arguments the way most bindings do.
+void HelloArgs(const FunctionCallbackInfo<Value>& args) {
+  uint32_t sum = c++;
+  for (int i = 0; i < args.Length(); i++) {
+    if (args[i]->IsNumber())
+      sum += args[i]->Uint32Value();
+  }
+  args.GetReturnValue().Set(sum);
+}
+
 extern "C" void init (Local<Object> target) {
   HandleScope scope(Isolate::GetCurrent());
   NODE_SET_METHOD(target, "hello", Hello);
+  NODE_SET_METHOD(target, "helloArgs", HelloArgs);
+  Isolate* isolate = Isolate::GetCurrent();
+  Local<Context> context = isolate->GetCurrentContext();
+  target->Set(String::NewFromUtf8(isolate, "helloFunction"),
+              Function::New(context, Hello).ToLocalChecked());
 }
 
 NODE_MODULE(binding, init);
@@ -18,6 +18,8 @@ try {
   process.exit(0);
 }
 var cxx = binding.hello;
+var cxxFunction = binding.helloFunction;
+var cxxArgs = binding.helloArgs;
 
 var c = 0;
 function js() {
@@ -25,18 +27,32 @@ function js() {
 }
 
 assert(js() === cxx());
+assert(cxx() === cxxFunction() - 1);
 
 var bench = common.createBenchmark(main, {
-  type: ['js', 'cxx'],
+  type: ['js', 'cxx', 'cxx-function', 'cxx-args'],
   millions: [1, 10, 50]
 });
 
 function main(conf) {
   var n = +conf.millions * 1e6;
 
-  var fn = conf.type === 'cxx' ? cxx : js;
+  var fn = js;
+  var i;
+  if (conf.type === 'cxx-args') {
+    bench.start();
+    for (i = 0; i < n; i++) {
+      cxxArgs(i, 1, 2);
+    }
+    bench.end(+conf.millions);
+    return;
+  }
+  if (conf.type === 'cxx')
+    fn = cxx;
+  else if (conf.type === 'cxx-function')
+    fn = cxxFunction;
   bench.start();
-  for (var i = 0; i < n; i++) {
+  for (i = 0; i < n; i++) {
     fn();
   }
   bench.end(+conf.millions);
@@ -0,0 +1,51 @@
+// Measures JIT warm-up: how long a fresh process takes to run a workload
+// whose hot functions only get fast once they have been compiled by
+// SpiderMonkey's optimizing JIT on a helper thread.  Each configuration runs
+// the workload in child processes with the helper thread pool sized by
+// --v8-pool-size, so the effect of fewer or more helper threads on JIT
+// latency shows up directly.  Reports workload runs per second.
+'use strict';
+
+var common = require('../common.js');
+var spawnSync = require('child_process').spawnSync;
+
+var bench = common.createBenchmark(main, {
+  pool: [1, 2, 4, 16],
+  n: [10]
+});
+
+var workload = [
+  "'use strict';",
+  'function Point(x, y) { this.x = x; this.y = y; }',
+  'Point.prototype.add = function(p) {',
+  '  return new Point(this.x + p.x, this.y + p.y);',
+  '};',
+  'function kernel(i) {',
+  '  var p = new Point(i, i * 2);',
+  '  for (var j = 0; j < 100; j++)',
+  '    p = p.add(new Point(j & 7, j >> 3));',
+  '  return p.x ^ p.y;',
+  '}',
+  // Several distinct hot functions, so that there is more than one Ion
+  // compilation in flight at a time.
+  'var kernels = [];',
+  'for (var k = 0; k < 16; k++)',
+  "  kernels.push(new Function('kernel', 'i', 'return kernel(i) + ' + k));",
+  'var sum = 0;',
+  'for (var i = 0; i < 20000; i++)',
+  '  sum += kernels[i & 15](kernel, i);',
+  'if (sum === 0.5) console.log(sum);'
+].join('\n');
+
+function main(conf) {
+  var n = +conf.n;
+  var args = ['--v8-pool-size=' + conf.pool, '-e', workload];
+
+  bench.start();
+  for (var i = 0; i < n; i++) {
+    var child = spawnSync(process.execPath, args, { stdio: 'inherit' });
+    if (child.status !== 0)
+      throw new Error('workload exited with ' + child.status);
+  }
+  bench.end(n);
+}
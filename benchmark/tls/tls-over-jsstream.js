@@ -0,0 +1,91 @@
+// TLS throughput when the client's TLS socket sits on a JS duplex stream
+// rather than directly on a TCP handle, as for TLS tunnelled through
+// another TLS connection.  Everything the TLS layer writes then goes
+// through JSStream.  With `batch` set, the JSStream hands all writes of a
+// tick to JS in one `onwritebatch()` call instead of one `onwrite()` each.
+'use strict';
+
+var common = require('../common.js');
+var fs = require('fs');
+var net = require('net');
+var path = require('path');
+var stream = require('stream');
+var tls = require('tls');
+
+var bench = common.createBenchmark(main, {
+  batch: [0, 1],
+  size: [64, 1024, 16384],
+  dur: [5]
+});
+
+var UV_EPIPE = -32;
+
+function main(conf) {
+  var dur = +conf.dur;
+  var size = +conf.size;
+  var batch = +conf.batch === 1;
+  var chunk = Buffer.alloc(size, 'b');
+
+  var keys = path.resolve(__dirname, '../../test/fixtures/keys');
+  var options = {
+    key: fs.readFileSync(path.join(keys, 'agent2-key.pem')),
+    cert: fs.readFileSync(path.join(keys, 'agent2-cert.pem')),
+    ciphers: 'AES256-GCM-SHA384'
+  };
+
+  var received = 0;
+  var server = tls.createServer(options, function(socket) {
+    socket.on('data', function(data) {
+      received += data.length;
+    });
+  });
+
+  server.listen(common.PORT, function() {
+    var tcp = net.connect(common.PORT);
+
+    // A plain JS duplex in front of the TCP socket, so that tls has to
+    // wrap it in a JSStream.
+    var duplex = new stream.Duplex({
+      write: function(data, encoding, callback) {
+        tcp.write(data, callback);
+      },
+      read: function() {}
+    });
+    tcp.on('data', function(data) { duplex.push(data); });
+    tcp.on('end', function() { duplex.push(null); });
+
+    var client = tls.connect({
+      socket: duplex,
+      rejectUnauthorized: false
+    }, function() {
+      bench.start();
+      setTimeout(done, dur * 1000);
+      write();
+    });
+
+    if (batch) {
+      var wrap = client._handle._parentWrap;
+      var handle = wrap._handle;
+      handle.onwritebatch = function(reqs, data) {
+        wrap.stream.write(data, function(err) {
+          handle.finishWriteBatch(reqs, err ? UV_EPIPE : 0);
+        });
+        return 0;
+      };
+      handle.setBatching(true);
+    }
+
+    function write() {
+      while (client.write(chunk));
+    }
+    client.on('drain', write);
+
+    function done() {
+      var gbits = (received * 8) / (1024 * 1024 * 1024);
+      bench.end(gbits);
+      client.destroy();
+      tcp.destroy();
+      server.close();
+    }
+  });
+}
@@ -0,0 +1,62 @@
+// Measures how much compiling a large script blocks the event loop.  A
+// setImmediate() heartbeat runs while the script is compiled, and the rate
+// reported is heartbeats per second: the more the loop is blocked, the lower
+// it is.  The async variant compiles on one of SpiderMonkey's helper threads.
+'use strict';
+
+var common = require('../common.js');
+var binding = process.binding('contextify');
+
+var bench = common.createBenchmark(main, {
+  type: ['sync', 'async'],
+  size: [5, 20],
+  n: [5]
+});
+
+function generate(megabytes) {
+  var chunks = [];
+  var length = 0;
+  for (var i = 0; length < megabytes * 1024 * 1024; i++) {
+    var chunk = 'function f' + i + '(a, b) { return a * ' + i + ' + b; }\n';
+    chunks.push(chunk);
+    length += chunk.length;
+  }
+  return chunks.join('');
+}
+
+function compile(type, code, cb) {
+  if (type === 'sync' || !binding.compileScriptAsync) {
+    new binding.ContextifyScript(code, { filename: 'bench.js' });
+    return setImmediate(cb);
+  }
+  binding.compileScriptAsync(code, { filename: 'bench.js' }, function(err) {
+    if (err)
+      throw err;
+    cb();
+  });
+}
+
+function main(conf) {
+  var n = +conf.n;
+  var code = generate(+conf.size);
+  var heartbeats = 0;
+  var done = false;
+
+  function heartbeat() {
+    heartbeats++;
+    if (!done)
+      setImmediate(heartbeat);
+  }
+
+  bench.start();
+  setImmediate(heartbeat);
+  (function next(remaining) {
+    if (remaining === 0) {
+      done = true;
+      return bench.end(heartbeats);
+    }
+    compile(conf.type, code, function() {
+      next(remaining - 1);
+    });
+  })(n);
+}
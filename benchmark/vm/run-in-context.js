@@ -0,0 +1,29 @@
+// Runs a small script over and over in a long-lived context whose sandbox has
+// many properties, the way a template engine would.
+'use strict';
+
+var common = require('../common.js');
+var vm = require('vm');
+
+var bench = common.createBenchmark(main, {
+  props: [0, 200],
+  n: [1e5]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var sandbox = {};
+  for (var i = 0; i < +conf.props; i++)
+    sandbox['p' + i] = i;
+  sandbox.count = 0;
+  vm.createContext(sandbox);
+
+  var script = new vm.Script('count += 1; var last = count;');
+  bench.start();
+  for (i = 0; i < n; i++)
+    script.runInContext(sandbox);
+  bench.end(n);
+
+  if (sandbox.count !== n || sandbox.last !== n)
+    throw new Error('sandbox was not updated');
+}
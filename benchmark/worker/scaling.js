@@ -0,0 +1,66 @@
+// Measures how CPU-bound work scales across worker threads.  The same total
+// amount of work is split between `workers` threads; the rate reported is
+// jobs per second, so perfect scaling doubles it with every doubling of
+// workers (up to the number of cores).
+'use strict';
+
+var common = require('../common.js');
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+var binding = process.binding('worker');
+
+var bench = common.createBenchmark(main, {
+  workers: [1, 2, 4, 8],
+  n: [64]
+});
+
+var script = [
+  "'use strict';",
+  "var binding = process.binding('worker');",
+  'function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }',
+  'binding.onmessage = function(job) {',
+  '  if (job === null)',
+  '    return binding.close();',
+  '  binding.postMessage(fib(job));',
+  '};'
+].join('\n');
+
+function main(conf) {
+  var n = +conf.n;
+  var count = +conf.workers;
+  var filename = path.join(os.tmpdir(),
+                           'worker-scaling-' + process.pid + '.js');
+  fs.writeFileSync(filename, script);
+
+  var sent = 0;
+  var received = 0;
+  var exited = 0;
+  var workers = [];
+
+  function dispatch(worker) {
+    if (sent < n) {
+      sent++;
+      worker.postMessage(25);
+    } else {
+      worker.postMessage(null);
+    }
+  }
+
+  bench.start();
+  for (var i = 0; i < count; i++) {
+    var worker = new binding.Worker(filename);
+    worker.onmessage = function() {
+      received++;
+      dispatch(this);
+    };
+    worker.onexit = function() {
+      if (++exited === count) {
+        bench.end(received);
+        fs.unlinkSync(filename);
+      }
+    };
+    workers.push(worker);
+    dispatch(worker);
+  }
+}
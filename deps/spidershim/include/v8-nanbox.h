@@ -0,0 +1,129 @@
+// Copyright Mozilla Foundation. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+// Internal to v8.h: just enough of the layout of SpiderMonkey's JS::Value to
+// do type checks and unbox primitives without calling into the shim.  The
+// embedder never sees jsapi.h, so the constants are duplicated here from
+// js/public/Value.h, and v8value.cc static_asserts that they still match.
+//
+// Only the 64-bit ("punboxing") layout is decoded.  Elsewhere
+// SPIDERSHIM_INLINE_VALUES is 0 and v8.h calls the out-of-line versions.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "v8config.h"
+
+#if UINTPTR_MAX == UINT64_MAX
+#define SPIDERSHIM_INLINE_VALUES 1
+#else
+#define SPIDERSHIM_INLINE_VALUES 0
+#endif
+
+namespace v8 {
+namespace internal {
+namespace nanbox {
+
+#if SPIDERSHIM_INLINE_VALUES
+
+const int kTagShift = 47;
+
+const uint32_t kTagMaxDouble = 0x1FFF0;
+const uint32_t kTagInt32 = kTagMaxDouble | 0x01;
+const uint32_t kTagUndefined = kTagMaxDouble | 0x02;
+const uint32_t kTagNull = kTagMaxDouble | 0x03;
+const uint32_t kTagBoolean = kTagMaxDouble | 0x04;
+const uint32_t kTagString = kTagMaxDouble | 0x06;
+const uint32_t kTagSymbol = kTagMaxDouble | 0x07;
+const uint32_t kTagObject = kTagMaxDouble | 0x0c;
+
+const uint64_t kShiftedTagMaxDouble =
+    (static_cast<uint64_t>(kTagMaxDouble) << kTagShift) | 0xFFFFFFFF;
+const uint64_t kShiftedTagUndefined =
+    static_cast<uint64_t>(kTagUndefined) << kTagShift;
+const uint64_t kShiftedTagNull = static_cast<uint64_t>(kTagNull) << kTagShift;
+const uint64_t kShiftedTagBoolean =
+    static_cast<uint64_t>(kTagBoolean) << kTagShift;
+const uint64_t kShiftedTagObject =
+    static_cast<uint64_t>(kTagObject) << kTagShift;
+
+const uint64_t kSignBit = 0x8000000000000000ull;
+
+V8_INLINE uint64_t Bits(const void* value) {
+  uint64_t bits;
+  memcpy(&bits, value, sizeof(bits));
+  return bits;
+}
+
+V8_INLINE uint32_t Tag(uint64_t bits) {
+  return static_cast<uint32_t>(bits >> kTagShift);
+}
+
+V8_INLINE bool IsUndefined(uint64_t bits) {
+  return bits == kShiftedTagUndefined;
+}
+
+V8_INLINE bool IsNull(uint64_t bits) { return bits == kShiftedTagNull; }
+
+V8_INLINE bool IsBoolean(uint64_t bits) { return Tag(bits) == kTagBoolean; }
+
+V8_INLINE bool IsTrue(uint64_t bits) {
+  return bits == (kShiftedTagBoolean | 1);
+}
+
+V8_INLINE bool IsFalse(uint64_t bits) { return bits == kShiftedTagBoolean; }
+
+V8_INLINE bool IsInt32(uint64_t bits) { return Tag(bits) == kTagInt32; }
+
+V8_INLINE bool IsDouble(uint64_t bits) {
+  return (bits | kSignBit) <= kShiftedTagMaxDouble;
+}
+
+V8_INLINE bool IsNumber(uint64_t bits) { return bits < kShiftedTagUndefined; }
+
+V8_INLINE bool IsString(uint64_t bits) { return Tag(bits) == kTagString; }
+
+V8_INLINE bool IsSymbol(uint64_t bits) { return Tag(bits) == kTagSymbol; }
+
+V8_INLINE bool IsObject(uint64_t bits) { return bits >= kShiftedTagObject; }
+
+V8_INLINE int32_t ToInt32(uint64_t bits) {
+  return static_cast<int32_t>(static_cast<uint32_t>(bits));
+}
+
+V8_INLINE bool ToBoolean(uint64_t bits) { return (bits & 1) != 0; }
+
+V8_INLINE double ToDouble(uint64_t bits) {
+  double d;
+  memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+
+V8_INLINE double ToNumber(uint64_t bits) {
+  return IsInt32(bits) ? ToInt32(bits) : ToDouble(bits);
+}
+
+#endif  // SPIDERSHIM_INLINE_VALUES
+
+}  // namespace nanbox
+}  // namespace internal
+}  // namespace v8
@@ -33,6 +33,7 @@
 #endif
 
 #include <assert.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <memory>
@@ -40,6 +41,7 @@
 
 #include "v8-version.h"
 #include "v8config.h"
+#include "v8-nanbox.h"
 
 // TODO: Do the dllexport/import dance on Windows.
 #define V8_EXPORT
@@ -59,8 +61,10 @@ struct JSRuntime;
 struct JSContext;
 class JSObject;
 class JSScript;
+class JSString;
 class V8Engine;
 struct JSClass;
+struct jsid;
 
 namespace JS {
 class Symbol;
@@ -86,6 +90,7 @@ class HeapSpaceStatistics;
 class HeapObjectStatistics;
 class HeapCodeStatistics;
 class HeapStatistics;
+class HelperThreadStatistics;
 class Int32;
 class Integer;
 class Isolate;
@@ -280,6 +285,12 @@ typedef void (*GenericNamedPropertyDeleterCallback)(
     Local<Name> property, const PropertyCallbackInfo<Boolean>& info);
 typedef void (*GenericNamedPropertyEnumeratorCallback)(
     const PropertyCallbackInfo<Array>& info);
+// Intercepts defineProperty, including the definitions that var and function
+// declarations make on a global.  Setting a return value marks the request as
+// handled; otherwise the property is defined on the object as usual.
+typedef void (*GenericNamedPropertyDefinerCallback)(
+    Local<Name> property, const PropertyDescriptor& desc,
+    const PropertyCallbackInfo<Value>& info);
 
 typedef void (*IndexedPropertyGetterCallback)(
     uint32_t index, const PropertyCallbackInfo<Value>& info);
@@ -971,6 +982,8 @@ class V8_EXPORT ScriptCompiler {
     friend class UnboundScript;
     Local<String> source_string;
     Handle<Value> resource_name;
+    Handle<Integer> resource_line_offset;
+    Handle<Integer> resource_column_offset;
   };
 
   enum CompileOptions {
@@ -998,6 +1011,42 @@ class V8_EXPORT ScriptCompiler {
       CompileOptions options = kNoCompileOptions);
 
   static uint32_t CachedDataVersionTag() { return 0; }
+
+  /**
+   * SpiderShim extension: compiles a script on one of SpiderMonkey's helper
+   * threads.  V8's streaming API expects the embedder to run the parser on
+   * a thread of its own, which SpiderMonkey doesn't support, so we expose
+   * its own off-thread compilation instead.
+   */
+  class OffThreadCompileTask;
+  typedef void (*OffThreadCompileCallback)(OffThreadCompileTask* task,
+                                           void* data);
+
+  /**
+   * Starts compiling source in the background and returns a task for it, or
+   * nullptr on failure.  Sources that are too small to be worth compiling
+   * off-thread are compiled by FinishOffThreadCompile() instead.
+   *
+   * callback is invoked exactly once when the task is ready to be finished.
+   * It may run on a helper thread, or synchronously from inside this call,
+   * and must not use the isolate.  After that the embedder must call either
+   * FinishOffThreadCompile() or CancelOffThreadCompile() on the isolate's
+   * thread, before disposing of the isolate.
+   */
+  static OffThreadCompileTask* StartOffThreadCompile(
+      Isolate* isolate, Source* source, OffThreadCompileCallback callback,
+      void* data);
+  /**
+   * Returns the script compiled by task and deletes the task.  Compilation
+   * errors are reported like those of CompileUnboundScript().
+   */
+  static V8_WARN_UNUSED_RESULT MaybeLocal<UnboundScript>
+  FinishOffThreadCompile(Isolate* isolate, OffThreadCompileTask* task);
+  /**
+   * Throws away the result of task and deletes the task.
+   */
+  static void CancelOffThreadCompile(Isolate* isolate,
+                                     OffThreadCompileTask* task);
 };
 
 class V8_EXPORT UnboundScript {
@@ -1006,6 +1055,8 @@ class V8_EXPORT UnboundScript {
 
  private:
   UnboundScript(Isolate* isolate, ScriptCompiler::Source* source);
+  UnboundScript(Isolate* isolate, ScriptCompiler::Source* source,
+                JSScript* script);
   ~UnboundScript();
 
   friend class Isolate;
@@ -1353,19 +1404,21 @@ class V8_EXPORT ValueDeserializer {
 // practice all compilers do, and is mandated in C++17 so it's future proof.
 class V8_EXPORT Value : public Data {
  public:
-  bool IsUndefined() const;
-  bool IsNull() const;
-  bool IsTrue() const;
-  bool IsFalse() const;
-  bool IsString() const;
-  bool IsSymbol() const;
+  // The checks that only look at the type tag, and the unboxing of int32s,
+  // doubles and booleans below, are decoded inline; see v8-nanbox.h.
+  V8_INLINE bool IsUndefined() const;
+  V8_INLINE bool IsNull() const;
+  V8_INLINE bool IsTrue() const;
+  V8_INLINE bool IsFalse() const;
+  V8_INLINE bool IsString() const;
+  V8_INLINE bool IsSymbol() const;
   bool IsFunction() const;
   bool IsArray() const;
-  bool IsObject() const;
-  bool IsBoolean() const;
-  bool IsNumber() const;
-  bool IsInt32() const;
-  bool IsUint32() const;
+  V8_INLINE bool IsObject() const;
+  V8_INLINE bool IsBoolean() const;
+  V8_INLINE bool IsNumber() const;
+  V8_INLINE bool IsInt32() const;
+  V8_INLINE bool IsUint32() const;
   bool IsDate() const;
   bool IsBooleanObject() const;
   bool IsNumberObject() const;
@@ -1424,19 +1477,24 @@ class V8_EXPORT Value : public Data {
   V8_WARN_UNUSED_RESULT MaybeLocal<Uint32> ToArrayIndex(
       Local<Context> context) const;
 
-  V8_WARN_UNUSED_RESULT Maybe<bool> BooleanValue(Local<Context> context) const;
-  V8_WARN_UNUSED_RESULT Maybe<double> NumberValue(Local<Context> context) const;
-  V8_WARN_UNUSED_RESULT Maybe<int64_t> IntegerValue(
+  V8_WARN_UNUSED_RESULT V8_INLINE Maybe<bool> BooleanValue(
+      Local<Context> context) const;
+  V8_WARN_UNUSED_RESULT V8_INLINE Maybe<double> NumberValue(
       Local<Context> context) const;
-  V8_WARN_UNUSED_RESULT Maybe<uint32_t> Uint32Value(
+  V8_WARN_UNUSED_RESULT V8_INLINE Maybe<int64_t> IntegerValue(
+      Local<Context> context) const;
+  V8_WARN_UNUSED_RESULT V8_INLINE Maybe<uint32_t> Uint32Value(
+      Local<Context> context) const;
+  V8_WARN_UNUSED_RESULT V8_INLINE Maybe<int32_t> Int32Value(
       Local<Context> context) const;
-  V8_WARN_UNUSED_RESULT Maybe<int32_t> Int32Value(Local<Context> context) const;
 
-  V8_DEPRECATE_SOON("Use maybe version", bool BooleanValue()) const;
-  V8_DEPRECATE_SOON("Use maybe version", double NumberValue()) const;
-  V8_DEPRECATE_SOON("Use maybe version", int64_t IntegerValue()) const;
-  V8_DEPRECATE_SOON("Use maybe version", uint32_t Uint32Value()) const;
-  V8_DEPRECATE_SOON("Use maybe version", int32_t Int32Value()) const;
+  V8_DEPRECATE_SOON("Use maybe version", V8_INLINE bool BooleanValue()) const;
+  V8_DEPRECATE_SOON("Use maybe version", V8_INLINE double NumberValue()) const;
+  V8_DEPRECATE_SOON("Use maybe version",
+                    V8_INLINE int64_t IntegerValue()) const;
+  V8_DEPRECATE_SOON("Use maybe version",
+                    V8_INLINE uint32_t Uint32Value()) const;
+  V8_DEPRECATE_SOON("Use maybe version", V8_INLINE int32_t Int32Value()) const;
 
   V8_DEPRECATE_SOON("Use maybe version", bool Equals(Handle<Value> that)) const;
   V8_WARN_UNUSED_RESULT Maybe<bool> Equals(Local<Context> context,
@@ -1453,6 +1511,31 @@ class V8_EXPORT Value : public Data {
   Local<String> TypeOf(v8::Isolate*);
 
  private:
+  // Out-of-line versions of the inline functions above, for values that
+  // need converting and for builds that don't decode JS::Value inline.
+  bool FullIsUndefined() const;
+  bool FullIsNull() const;
+  bool FullIsTrue() const;
+  bool FullIsFalse() const;
+  bool FullIsString() const;
+  bool FullIsSymbol() const;
+  bool FullIsObject() const;
+  bool FullIsBoolean() const;
+  bool FullIsNumber() const;
+  bool FullIsInt32() const;
+  bool FullIsUint32() const;
+  Maybe<bool> FullBooleanValue(Local<Context> context) const;
+  Maybe<double> FullNumberValue(Local<Context> context) const;
+  Maybe<int64_t> FullIntegerValue(Local<Context> context) const;
+  Maybe<uint32_t> FullUint32Value(Local<Context> context) const;
+  Maybe<int32_t> FullInt32Value(Local<Context> context) const;
+  // Return false if the value has to be converted by the Full versions.
+  V8_INLINE bool QuickBooleanValue(bool* value) const;
+  V8_INLINE bool QuickNumberValue(double* value) const;
+  V8_INLINE bool QuickIntegerValue(int64_t* value) const;
+  V8_INLINE bool QuickUint32Value(uint32_t* value) const;
+  V8_INLINE bool QuickInt32Value(int32_t* value) const;
+
   char spidershim_padding[8];  // see the comment for Value.
 
  protected:
@@ -2007,6 +2090,16 @@ class V8_EXPORT Object : public Value {
 
   Isolate* GetIsolate();
   static Local<Object> New(Isolate* isolate = nullptr);
+  /**
+   * Creates a JavaScript object with the given properties, and the given
+   * prototype_or_null (which must be an object or null, and if it's null,
+   * the newly created object won't have a prototype at all).  The properties
+   * are defined as enumerable data properties in order, so later duplicates
+   * of a name win.
+   */
+  static Local<Object> New(Isolate* isolate, Local<Value> prototype_or_null,
+                           Local<Name>* names, Local<Value>* values,
+                           size_t length);
   static Object* Cast(Value* obj);
 
  private:
@@ -2044,6 +2137,12 @@ class V8_EXPORT Array : public Object {
 #endif
 
   static Local<Array> New(Isolate* isolate = nullptr, int length = 0);
+  /**
+   * Creates a JavaScript array out of a Local<Value> array with a known
+   * length.
+   */
+  static Local<Array> New(Isolate* isolate, Local<Value>* elements,
+                          size_t length);
   static Array* Cast(Value* obj);
 };
 
@@ -2266,12 +2365,18 @@ class V8_EXPORT Function : public Object {
 
 class V8_EXPORT Promise : public Object {
  public:
+  enum PromiseState { kPending, kFulfilled, kRejected };
+
   class V8_EXPORT Resolver : public Object {
    public:
     static Local<Resolver> New(Isolate* isolate);
+    static V8_WARN_UNUSED_RESULT MaybeLocal<Resolver> New(
+        Local<Context> context);
     Local<Promise> GetPromise();
     void Resolve(Handle<Value> value);
+    Maybe<bool> Resolve(Local<Context> context, Local<Value> value);
     void Reject(Handle<Value> value);
+    Maybe<bool> Reject(Local<Context> context, Local<Value> value);
     static Resolver* Cast(Value* obj);
 
    private:
@@ -2280,9 +2385,15 @@ class V8_EXPORT Promise : public Object {
   };
 
   Local<Promise> Catch(Handle<Function> handler);
+  V8_WARN_UNUSED_RESULT MaybeLocal<Promise> Catch(Local<Context> context,
+                                                  Local<Function> handler);
   Local<Promise> Then(Handle<Function> handler);
+  V8_WARN_UNUSED_RESULT MaybeLocal<Promise> Then(Local<Context> context,
+                                                 Local<Function> handler);
 
   bool HasHandler();
+  Local<Value> Result();
+  PromiseState State();
   static Promise* Cast(Value* obj);
 
  private:
@@ -2440,6 +2551,16 @@ class V8_EXPORT ArrayBufferView : public Object {
   size_t CopyContents(void* dest, size_t byte_length);
   bool HasBuffer() const;
 
+  /**
+   * SpiderShim extension: returns a pointer to the first byte of the view
+   * and stores its length in byte_length.  Unlike going through Buffer(),
+   * this creates no handles, and for views that already have an
+   * ArrayBuffer it doesn't allocate at all.  Small typed arrays that keep
+   * their data inline get a buffer first, so that the pointer stays valid
+   * across GCs.
+   */
+  void* GetData(size_t* byte_length);
+
   static ArrayBufferView* Cast(Value* obj);
 
   static const int kInternalFieldCount = V8_ARRAY_BUFFER_INTERNAL_FIELD_COUNT;
@@ -2779,6 +2900,7 @@ struct NamedPropertyHandlerConfiguration {
   GenericNamedPropertyQueryCallback query;
   GenericNamedPropertyDeleterCallback deleter;
   GenericNamedPropertyEnumeratorCallback enumerator;
+  GenericNamedPropertyDefinerCallback definer;
   Handle<Value> data;
   PropertyHandlerFlags flags;
 };
@@ -3283,14 +3405,22 @@ class V8_EXPORT Isolate {
   void AddUnboundScript(UnboundScript* script);
   friend class ::AutoJSAPI;
   friend class Context;
+  friend class Debug;
+  friend class Locker;
   friend class MicrotasksScope;
   friend class StackFrame;
   friend class StackTrace;
   friend class SuppressMicrotaskExecutionScope;
   friend class TryCatch;
   friend class UnboundScript;
+  friend class Unlocker;
   friend class ::V8Engine;
   friend JSContext* JSContextFromIsolate(Isolate* isolate);
+  friend void AddInternalizedStringId(Isolate* isolate, JSString* str,
+                                      const jsid& id);
+  friend bool GetInternalizedStringId(Isolate* isolate, JSString* str,
+                                      jsid* id);
+  friend Value* GetImmortalValue(Isolate* isolate, uint32_t index);
   template <class T>
   friend class PersistentBase;
   template <class T>
@@ -3381,6 +3511,14 @@ class V8_EXPORT V8 {
                                       bool remove_flags);
   static const char* GetVersion();
   static bool Initialize();
+  /**
+   * SpiderMonkey-specific: size the engine's helper thread pool (off-thread
+   * Ion compilation, parsing, source compression and parallel GC) for
+   * |count| CPUs instead of the number the system reports.  Must be called
+   * before Initialize().  Also settable with --helper-thread-cpus=N.
+   */
+  static void SetHelperThreadCPUCount(int count);
+  static void GetHelperThreadStatistics(HelperThreadStatistics* statistics);
   static void SetEntropySource(EntropySource source);
   static void TerminateExecution(Isolate* isolate);
   static bool IsExeuctionDisabled(Isolate* isolate = nullptr);
@@ -3577,6 +3715,39 @@ class V8_EXPORT HeapCodeStatistics {
   friend class Isolate;
 };
 
+/**
+ * SpiderMonkey-specific: a snapshot of the engine's helper thread pool, see
+ * V8::GetHelperThreadStatistics().
+ */
+class V8_EXPORT HelperThreadStatistics {
+ public:
+  HelperThreadStatistics();
+  size_t cpu_count() { return cpu_count_; }
+  size_t thread_count() { return thread_count_; }
+  size_t ion_pending() { return ion_pending_; }
+  size_t ion_finished() { return ion_finished_; }
+  size_t wasm_pending() { return wasm_pending_; }
+  size_t parse_pending() { return parse_pending_; }
+  size_t parse_finished() { return parse_finished_; }
+  size_t compression_pending() { return compression_pending_; }
+  size_t gc_pending() { return gc_pending_; }
+  size_t promise_tasks_pending() { return promise_tasks_pending_; }
+
+ private:
+  size_t cpu_count_;
+  size_t thread_count_;
+  size_t ion_pending_;
+  size_t ion_finished_;
+  size_t wasm_pending_;
+  size_t parse_pending_;
+  size_t parse_finished_;
+  size_t compression_pending_;
+  size_t gc_pending_;
+  size_t promise_tasks_pending_;
+
+  friend class V8;
+};
+
 class V8_EXPORT JitCodeEvent {
  public:
   enum EventType {
@@ -3767,10 +3938,52 @@ class V8_EXPORT Context {
   Impl* pimpl_;
 };
 
+class V8_EXPORT Unlocker {
+ public:
+  /**
+   * Releases the lock the current thread holds on the isolate, however
+   * deeply its Lockers are nested, until the Unlocker is destroyed.
+   */
+  V8_INLINE explicit Unlocker(Isolate* isolate) { Initialize(isolate); }
+  ~Unlocker();
+
+ private:
+  void Initialize(Isolate* isolate);
+
+  Isolate* isolate_;
+};
+
 class V8_EXPORT Locker {
-  // Don't need to implement this for Chakra
  public:
-  explicit Locker(Isolate* isolate) {}
+  /**
+   * Gives the current thread exclusive access to the isolate until the Locker
+   * is destroyed.  Lockers can be nested on the same thread.
+   *
+   * Unlike in V8, an isolate can only run JS on the thread that created it,
+   * since SpiderMonkey ties a JSContext to its thread.  Embedders that want
+   * to run JS on several threads need to create one isolate per thread.
+   */
+  V8_INLINE explicit Locker(Isolate* isolate) { Initialize(isolate); }
+  ~Locker();
+
+  /**
+   * Returns whether or not the isolate is locked by the current thread.
+   */
+  static bool IsLocked(Isolate* isolate);
+
+  /**
+   * Returns whether any Locker has ever been used.
+   */
+  static bool IsActive();
+
+ private:
+  void Initialize(Isolate* isolate);
+
+  Locker(const Locker&) = delete;
+  void operator=(const Locker&) = delete;
+
+  bool has_lock_;
+  Isolate* isolate_;
 };
 
 //
@@ -4054,7 +4267,10 @@ V8_INLINE Script::Script(Local<Context> context, JSScript* script)
 V8_INLINE ScriptCompiler::Source::Source(Local<String> source_string,
                                          const ScriptOrigin& origin,
                                          CachedData* cached_data)
-    : source_string(source_string), resource_name(origin.ResourceName()) {}
+    : source_string(source_string),
+      resource_name(origin.ResourceName()),
+      resource_line_offset(origin.ResourceLineOffset()),
+      resource_column_offset(origin.ResourceColumnOffset()) {}
 
 V8_INLINE ScriptCompiler::Source::Source(Local<String> source_string,
                                          CachedData* cached_data)
@@ -4080,6 +4296,7 @@ V8_INLINE NamedPropertyHandlerConfiguration::NamedPropertyHandlerConfiguration(
       query(query),
       deleter(deleter),
       enumerator(enumerator),
+      definer(0),
       data(data),
       flags(flags) {}
 
@@ -4108,4 +4325,139 @@ V8_INLINE PromiseRejectMessage::PromiseRejectMessage(
 V8_INLINE Context::Scope::Scope(Local<Context> context) : context_(context) {
   context_->Enter();
 }
+
+#if SPIDERSHIM_INLINE_VALUES
+
+#define SPIDERSHIM_INLINE_PREDICATE(Name)                                     \
+  V8_INLINE bool Value::Is##Name() const {                                    \
+    return internal::nanbox::Is##Name(internal::nanbox::Bits(this));          \
+  }
+SPIDERSHIM_INLINE_PREDICATE(Undefined)
+SPIDERSHIM_INLINE_PREDICATE(Null)
+SPIDERSHIM_INLINE_PREDICATE(True)
+SPIDERSHIM_INLINE_PREDICATE(False)
+SPIDERSHIM_INLINE_PREDICATE(String)
+SPIDERSHIM_INLINE_PREDICATE(Symbol)
+SPIDERSHIM_INLINE_PREDICATE(Object)
+SPIDERSHIM_INLINE_PREDICATE(Boolean)
+SPIDERSHIM_INLINE_PREDICATE(Number)
+SPIDERSHIM_INLINE_PREDICATE(Int32)
+#undef SPIDERSHIM_INLINE_PREDICATE
+
+V8_INLINE bool Value::IsUint32() const {
+  uint64_t bits = internal::nanbox::Bits(this);
+  if (internal::nanbox::IsInt32(bits)) {
+    return internal::nanbox::ToInt32(bits) >= 0;
+  }
+  return internal::nanbox::IsDouble(bits) && FullIsUint32();
+}
+
+V8_INLINE bool Value::QuickBooleanValue(bool* value) const {
+  uint64_t bits = internal::nanbox::Bits(this);
+  if (internal::nanbox::IsBoolean(bits)) {
+    *value = internal::nanbox::ToBoolean(bits);
+    return true;
+  }
+  if (internal::nanbox::IsInt32(bits)) {
+    *value = internal::nanbox::ToInt32(bits) != 0;
+    return true;
+  }
+  if (internal::nanbox::IsUndefined(bits) || internal::nanbox::IsNull(bits)) {
+    *value = false;
+    return true;
+  }
+  return false;
+}
+
+V8_INLINE bool Value::QuickNumberValue(double* value) const {
+  uint64_t bits = internal::nanbox::Bits(this);
+  if (!internal::nanbox::IsNumber(bits)) {
+    return false;
+  }
+  // NaN is left to FullNumberValue(), which reports it as Nothing.
+  *value = internal::nanbox::ToNumber(bits);
+  return *value == *value;
+}
+
+V8_INLINE bool Value::QuickIntegerValue(int64_t* value) const {
+  uint64_t bits = internal::nanbox::Bits(this);
+  if (!internal::nanbox::IsInt32(bits)) {
+    return false;
+  }
+  *value = internal::nanbox::ToInt32(bits);
+  return true;
+}
+
+V8_INLINE bool Value::QuickUint32Value(uint32_t* value) const {
+  uint64_t bits = internal::nanbox::Bits(this);
+  if (!internal::nanbox::IsInt32(bits)) {
+    return false;
+  }
+  *value = static_cast<uint32_t>(internal::nanbox::ToInt32(bits));
+  return true;
+}
+
+V8_INLINE bool Value::QuickInt32Value(int32_t* value) const {
+  uint64_t bits = internal::nanbox::Bits(this);
+  if (!internal::nanbox::IsInt32(bits)) {
+    return false;
+  }
+  *value = internal::nanbox::ToInt32(bits);
+  return true;
+}
+
+#else  // SPIDERSHIM_INLINE_VALUES
+
+#define SPIDERSHIM_INLINE_PREDICATE(Name)                                     \
+  V8_INLINE bool Value::Is##Name() const { return FullIs##Name(); }
+SPIDERSHIM_INLINE_PREDICATE(Undefined)
+SPIDERSHIM_INLINE_PREDICATE(Null)
+SPIDERSHIM_INLINE_PREDICATE(True)
+SPIDERSHIM_INLINE_PREDICATE(False)
+SPIDERSHIM_INLINE_PREDICATE(String)
+SPIDERSHIM_INLINE_PREDICATE(Symbol)
+SPIDERSHIM_INLINE_PREDICATE(Object)
+SPIDERSHIM_INLINE_PREDICATE(Boolean)
+SPIDERSHIM_INLINE_PREDICATE(Number)
+SPIDERSHIM_INLINE_PREDICATE(Int32)
+SPIDERSHIM_INLINE_PREDICATE(Uint32)
+#undef SPIDERSHIM_INLINE_PREDICATE
+
+V8_INLINE bool Value::QuickBooleanValue(bool* value) const { return false; }
+V8_INLINE bool Value::QuickNumberValue(double* value) const { return false; }
+V8_INLINE bool Value::QuickIntegerValue(int64_t* value) const {
+  return false;
+}
+V8_INLINE bool Value::QuickUint32Value(uint32_t* value) const {
+  return false;
+}
+V8_INLINE bool Value::QuickInt32Value(int32_t* value) const { return false; }
+
+#endif  // SPIDERSHIM_INLINE_VALUES
+
+// The deprecated versions only look up the current context when they have
+// to convert.
+#define SPIDERSHIM_VALUE_ACCESSORS(Type, Name, Default)                       \
+  V8_INLINE Maybe<Type> Value::Name(Local<Context> context) const {           \
+    Type value;                                                               \
+    if (Quick##Name(&value)) {                                                \
+      return Just(value);                                                     \
+    }                                                                         \
+    return Full##Name(context);                                               \
+  }                                                                           \
+  V8_INLINE Type Value::Name() const {                                        \
+    Type value;                                                               \
+    if (Quick##Name(&value)) {                                                \
+      return value;                                                           \
+    }                                                                         \
+    return Full##Name(Isolate::GetCurrent()->GetCurrentContext())             \
+        .FromMaybe(Default);                                                  \
+  }
+SPIDERSHIM_VALUE_ACCESSORS(bool, BooleanValue, false)
+SPIDERSHIM_VALUE_ACCESSORS(double, NumberValue, NAN)
+SPIDERSHIM_VALUE_ACCESSORS(int64_t, IntegerValue, 0)
+SPIDERSHIM_VALUE_ACCESSORS(uint32_t, Uint32Value, 0)
+SPIDERSHIM_VALUE_ACCESSORS(int32_t, Int32Value, 0)
+#undef SPIDERSHIM_VALUE_ACCESSORS
+
 }  // namespace v8
@@ -1939,6 +1939,13 @@ JS_DEFINE_DATA_AND_LENGTH_ACCESSOR(Float64, double)
 extern JS_FRIEND_API(void)
 GetArrayBufferViewLengthAndData(JSObject* obj, uint32_t* length, bool* isSharedMemory, uint8_t** data);
 
+// Like GetArrayBufferViewLengthAndData, but returns false without touching
+// the out params if the view is a typed array whose data is still stored
+// inline, and could therefore move during GC.
+extern JS_FRIEND_API(bool)
+GetArrayBufferViewLengthAndDataIfHasBuffer(JSObject* obj, uint32_t* length, bool* isSharedMemory,
+                                           uint8_t** data);
+
 // This one isn't inlined because there are a bunch of different ArrayBuffer
 // classes that would have to be individually handled here.
 //
@@ -3059,6 +3066,39 @@ SetCooperativeYieldCallback(JSContext* cx, YieldCallback callback);
 extern JS_FRIEND_API(bool)
 SystemZoneAvailable(JSContext* cx);
 
+// Size the helper thread pool, which runs off-thread Ion compilation, parsing,
+// source compression and parallel GC tasks, as if the machine had |cpuCount|
+// CPUs rather than the number the system reports. The threads are started
+// when the first JSContext is created; after that this returns false and
+// has no effect.
+extern JS_FRIEND_API(bool)
+SetHelperThreadCPUCount(size_t cpuCount);
+
+struct HelperThreadStats
+{
+    size_t cpuCount;
+    size_t threadCount;
+
+    // Number of tasks waiting for a helper thread, per kind.
+    size_t ionWorklist;
+    size_t wasmWorklist;
+    size_t parseWorklist;
+    size_t compressionWorklist;
+    size_t gcHelperWorklist;
+    size_t gcParallelWorklist;
+    size_t promiseTasks;
+
+    // Number of tasks finished on a helper thread but not yet picked up by
+    // their owning thread.
+    size_t ionFinished;
+    size_t parseFinished;
+};
+
+// Take a snapshot of the helper thread pool. All counts are zero if the
+// threads haven't been started yet.
+extern JS_FRIEND_API(void)
+GetHelperThreadStats(HelperThreadStats* stats);
+
 } /* namespace js */
 
 #endif /* jsfriendapi_h */
@@ -1917,6 +1917,19 @@ js::GetArrayBufferViewLengthAndData(JSObject* obj, uint32_t* length, bool* isSha
     }
 }
 
+JS_FRIEND_API(bool)
+js::GetArrayBufferViewLengthAndDataIfHasBuffer(JSObject* obj, uint32_t* length,
+                                               bool* isSharedMemory, uint8_t** data)
+{
+    MOZ_ASSERT(obj->is<ArrayBufferViewObject>());
+
+    if (obj->is<TypedArrayObject>() && !obj->as<TypedArrayObject>().hasBuffer())
+        return false;
+
+    GetArrayBufferViewLengthAndData(obj, length, isSharedMemory, data);
+    return true;
+}
+
 JS_FRIEND_API(JSObject*)
 JS_GetObjectAsArrayBuffer(JSObject* obj, uint32_t* length, uint8_t** data)
 {
@@ -10,6 +10,7 @@
 #include "mozilla/Maybe.h"
 #include "mozilla/Unused.h"
 
+#include "jsfriendapi.h"
 #include "jsnativestack.h"
 
 #include "builtin/Promise.h"
@@ -88,6 +89,44 @@ js::SetFakeCPUCount(size_t count)
     HelperThreadState().threadCount = ThreadCountForCPUCount(count);
 }
 
+JS_FRIEND_API(bool)
+js::SetHelperThreadCPUCount(size_t cpuCount)
+{
+    MOZ_ASSERT(cpuCount > 0);
+
+    AutoLockHelperThreadState lock;
+    if (HelperThreadState().threads)
+        return false;
+
+    HelperThreadState().cpuCount = cpuCount;
+    HelperThreadState().threadCount = ThreadCountForCPUCount(cpuCount);
+    return true;
+}
+
+JS_FRIEND_API(void)
+js::GetHelperThreadStats(HelperThreadStats* stats)
+{
+    *stats = HelperThreadStats();
+
+    AutoLockHelperThreadState lock;
+    GlobalHelperThreadState& state = HelperThreadState();
+    stats->cpuCount = state.cpuCount;
+    if (!state.threads)
+        return;
+
+    stats->threadCount = state.threads->length();
+    stats->ionWorklist = state.ionWorklist(lock).length();
+    stats->wasmWorklist = state.wasmWorklist(lock).length();
+    stats->parseWorklist = state.parseWorklist(lock).length();
+    stats->compressionWorklist = state.compressionPendingList(lock).length() +
+                                 state.compressionWorklist(lock).length();
+    stats->gcHelperWorklist = state.gcHelperWorklist(lock).length();
+    stats->gcParallelWorklist = state.gcParallelWorklist(lock).length();
+    stats->promiseTasks = state.promiseTasks(lock).length();
+    stats->ionFinished = state.ionFinishedList(lock).length();
+    stats->parseFinished = state.parseFinishedList(lock).length();
+}
+
 bool
 js::StartOffThreadWasmCompile(wasm::CompileTask* task)
 {
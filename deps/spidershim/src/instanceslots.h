@@ -59,6 +59,8 @@ enum class InstanceSlots {
   GenericDeleterCallbackSlot2,
   GenericEnumeratorCallbackSlot1, // Stores our generic prop enumerator callback.
   GenericEnumeratorCallbackSlot2,
+  GenericDefinerCallbackSlot1,    // Stores our generic prop definer callback.
+  GenericDefinerCallbackSlot2,
   GenericCallbackDataSlot,        // Stores our generic prop callback data
   ContextSlot,                    // Stores our v8::Context pointer.  Only used on global objects.
   NumSlots
@@ -40,6 +40,33 @@ Local<Array> Array::New(Isolate* isolate, int length) {
   return internal::Local<Array>::New(isolate, retVal);
 }
 
+Local<Array> Array::New(Isolate* isolate, Local<Value>* elements,
+                        size_t length) {
+  if (!isolate) {
+    isolate = Isolate::GetCurrent();
+  }
+  JSContext* cx = JSContextFromIsolate(isolate);
+  AutoJSAPI jsAPI(cx, isolate);
+  JS::AutoValueVector values(cx);
+  if (!values.reserve(length)) {
+    return Local<Array>();
+  }
+  for (size_t i = 0; i < length; ++i) {
+    JS::RootedValue value(cx, *GetValue(elements[i]));
+    if (!JS_WrapValue(cx, &value)) {
+      return Local<Array>();
+    }
+    values.infallibleAppend(value);
+  }
+  JSObject* array = JS_NewArrayObject(cx, values);
+  if (!array) {
+    return Local<Array>();
+  }
+  JS::Value retVal;
+  retVal.setObject(*array);
+  return internal::Local<Array>::New(isolate, retVal);
+}
+
 Array* Array::Cast(Value* obj) {
   bool isArray = false;
   JSContext* cx = JSContextFromIsolate(Isolate::GetCurrent());
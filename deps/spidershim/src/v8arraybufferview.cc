@@ -62,6 +62,37 @@ size_t ArrayBufferView::ByteLength() {
   return JS_GetDataViewByteLength(view);
 }
 
+bool ArrayBufferView::HasBuffer() const {
+  AutoJSAPI jsAPI(this);
+  JSObject* view = js::UnwrapArrayBufferView(GetObject(this));
+  uint32_t length;
+  bool shared;
+  uint8_t* data;
+  return view &&
+         js::GetArrayBufferViewLengthAndDataIfHasBuffer(view, &length,
+                                                        &shared, &data);
+}
+
+void* ArrayBufferView::GetData(size_t* byte_length) {
+  AutoJSAPI jsAPI(this);
+  JSObject* view = js::UnwrapArrayBufferView(GetObject(this));
+  assert(view);
+  uint32_t length;
+  bool shared;
+  uint8_t* data;
+  if (!js::GetArrayBufferViewLengthAndDataIfHasBuffer(view, &length,
+                                                      &shared, &data)) {
+    // Moves the data out of line; this only happens once per view.
+    if (Buffer().IsEmpty()) {
+      *byte_length = 0;
+      return nullptr;
+    }
+    js::GetArrayBufferViewLengthAndData(view, &length, &shared, &data);
+  }
+  *byte_length = length;
+  return data;
+}
+
 ArrayBufferView* ArrayBufferView::Cast(Value* val) {
   assert(val->IsArrayBufferView());
   return static_cast<ArrayBufferView*>(val);
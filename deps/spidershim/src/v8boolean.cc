@@ -33,9 +33,7 @@ bool Boolean::Value() const {
 }
 
 Local<Boolean> Boolean::New(Isolate* isolate, bool value) {
-  JS::Value boolVal;
-  boolVal.setBoolean(value);
-  return internal::Local<Boolean>::New(isolate, boolVal);
+  return value ? True(isolate) : False(isolate);
 }
 
 Local<Boolean> Boolean::From(bool value) {
@@ -22,6 +22,7 @@
 #include "v8-debug.h"
 #include "jsapi.h"
 #include "v8local.h"
+#include "v8isolate.h"
 
 namespace {
 
@@ -53,6 +54,14 @@ void MakeMirror(const FunctionCallbackInfo<Value>& info) {
 namespace v8 {
 
 Local<Context> Debug::GetDebugContext(Isolate* isolate) {
+  // The debug context is created once and then kept alive until the isolate
+  // is disposed, since creating a context is expensive and callers such as
+  // vm.runInDebugContext() ask for it over and over.
+  auto isolateImpl = reinterpret_cast<Isolate::Impl*>(isolate->pimpl_);
+  if (!isolateImpl->debugContext.IsEmpty()) {
+    return Local<Context>::New(isolate, isolateImpl->debugContext);
+  }
+
   Local<Context> dbgContext = Context::New(isolate);
   if (dbgContext.IsEmpty()) {
     return dbgContext;
@@ -76,6 +85,7 @@ Local<Context> Debug::GetDebugContext(Isolate* isolate) {
   Debug->Set(String::NewFromUtf8(isolate, "setBreakpoint"), setBreakpoint);
   Debug->Set(String::NewFromUtf8(isolate, "makeMirror"), makeMirror);
   dbgContext->Global()->Set(String::NewFromUtf8(isolate, "Debug"), handleScope.Escape(Debug));
+  isolateImpl->debugContext.Reset(isolate, dbgContext);
   return dbgContext;
 }
 }
@@ -27,6 +27,7 @@
 #include "jsfriendapi.h"
 #include "js/Conversions.h"
 #include "accessor.h"
+#include "instanceslots.h"
 
 namespace {
 
@@ -107,6 +108,46 @@ bool SetHiddenCallback(JSContext* cx, JS::HandleObject self,
   return JS_SetPropertyById(cx, self, id1, val1) &&
          JS_SetPropertyById(cx, self, id2, val2);
 }
+
+// The extended slots of the functions we create.
+enum FunctionNativeReservedSlots {
+  TemplateSlot,            // Stores our FunctionTemplate, if any.
+  CreationContextSlot      // Stores our creation v8::Context pointer, once known.
+};
+
+// Returns the v8::Context whose global is the current global of cx, or nullptr
+// if the current global doesn't belong to a Context (e.g. the hidden global).
+Context* ContextForCurrentGlobal(JSContext* cx) {
+  JSObject* global = JS::CurrentGlobalOrNull(cx);
+  if (!global) {
+    return nullptr;
+  }
+  auto slot = GetInstanceSlot(global, uint32_t(InstanceSlots::ContextSlot));
+  if (slot.isUndefined()) {
+    return nullptr;
+  }
+  return static_cast<Context*>(slot.toPrivate());
+}
+
+// A function's creation context never changes, so we cache it in a reserved
+// slot instead of going through Object::CreationContext() on every call.
+// Functions created before their global had a Context attached (for example,
+// while instantiating the global template) fill the cache lazily here.
+Context* GetCreationContext(JS::HandleObject callee,
+                            Local<Function> calleeFunction) {
+  const JS::Value& cached =
+    js::GetFunctionNativeReserved(callee, CreationContextSlot);
+  if (!cached.isUndefined()) {
+    return static_cast<Context*>(cached.toPrivate());
+  }
+  Local<Context> context = calleeFunction->CreationContext();
+  if (context.IsEmpty()) {
+    return nullptr;
+  }
+  js::SetFunctionNativeReserved(callee, CreationContextSlot,
+                                JS::PrivateValue(*context));
+  return *context;
+}
 }
 
 namespace v8 {
@@ -124,7 +165,9 @@ class FunctionCallback {
     v8::Local<Function> calleeFunction =
       internal::Local<Function>::New(isolate, calleeVal);
     v8::Local<Value> data = GetHiddenCalleeData(cx, callee);
-    JS::RootedValue templateVal(cx, js::GetFunctionNativeReserved(callee, 0));
+    JS::RootedValue templateVal(cx,
+                                js::GetFunctionNativeReserved(callee,
+                                                              TemplateSlot));
     v8::Local<FunctionTemplate> templ;
     if (!templateVal.isUndefined()) {
       templ = internal::Local<FunctionTemplate>::NewTemplate(isolate,
@@ -176,11 +219,14 @@ class FunctionCallback {
                                        args.isConstructing(),
                                        data, calleeFunction);
       {
-        // Enter the context of the callee if one is available.
-        v8::Local<Context> context = calleeFunction->CreationContext();
+        // Enter the context of the callee if one is available, unless the
+        // caller is already running inside of it.
+        Context* context = GetCreationContext(callee, calleeFunction);
         mozilla::Maybe<Context::Scope> scope;
-        if (!context.IsEmpty()) {
-          scope.emplace(context);
+        if (context &&
+            (*isolate->GetCurrentContext() != context ||
+             ContextForCurrentGlobal(cx) != context)) {
+          scope.emplace(internal::Local<Context>::New(isolate, context));
         }
         callback(info);
       }
@@ -360,10 +406,17 @@ MaybeLocal<Function> Function::New(Local<Context> context,
     if (!JS_WrapValue(cx, &templVal)) {
       return MaybeLocal<Function>();
     }
-    js::SetFunctionNativeReserved(funobj, 0, templVal);
+    js::SetFunctionNativeReserved(funobj, TemplateSlot, templVal);
   } else {
-    js::SetFunctionNativeReserved(funobj, 0, JS::UndefinedValue());
+    js::SetFunctionNativeReserved(funobj, TemplateSlot, JS::UndefinedValue());
   }
+  // The function is created in the compartment of the current global, so
+  // that's its creation context.
+  Context* creationContext = ContextForCurrentGlobal(cx);
+  js::SetFunctionNativeReserved(funobj, CreationContextSlot,
+                                creationContext ?
+                                  JS::PrivateValue(creationContext) :
+                                  JS::UndefinedValue());
   JS::Value retVal;
   retVal.setObject(*funobj);
   return internal::Local<Function>::New(context->GetIsolate(), retVal);
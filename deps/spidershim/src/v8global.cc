@@ -20,24 +20,29 @@
 
 #include "v8.h"
 #include "autojsapi.h"
+#include "v8isolate.h"
 #include "v8local.h"
 
 namespace v8 {
 
 Local<Primitive> Undefined(Isolate* isolate) {
-  return internal::Local<Primitive>::New(isolate, JS::UndefinedValue());
+  return internal::Local<Primitive>::NewImmortal(
+      GetImmortalValue(isolate, internal::kImmortalUndefined));
 }
 
 Local<Primitive> Null(Isolate* isolate) {
-  return internal::Local<Primitive>::New(isolate, JS::NullValue());
+  return internal::Local<Primitive>::NewImmortal(
+      GetImmortalValue(isolate, internal::kImmortalNull));
 }
 
 Local<Boolean> True(Isolate* isolate) {
-  return internal::Local<Boolean>::New(isolate, JS::TrueValue());
+  return internal::Local<Boolean>::NewImmortal(
+      GetImmortalValue(isolate, internal::kImmortalTrue));
 }
 
 Local<Boolean> False(Isolate* isolate) {
-  return internal::Local<Boolean>::New(isolate, JS::FalseValue());
+  return internal::Local<Boolean>::NewImmortal(
+      GetImmortalValue(isolate, internal::kImmortalFalse));
 }
 
 bool SetResourceConstraints(ResourceConstraints* constraints) {
@@ -23,6 +23,7 @@
 #include "v8.h"
 #include "autojsapi.h"
 #include "conversions.h"
+#include "v8isolate.h"
 #include "v8local.h"
 
 namespace v8 {
@@ -33,6 +34,10 @@ int64_t Integer::Value() const {
 }
 
 Local<Integer> Integer::New(Isolate* isolate, int32_t value) {
+  if (internal::IsImmortalInteger(value)) {
+    return internal::Local<Integer>::NewImmortal(
+        GetImmortalValue(isolate, internal::ImmortalIntegerIndex(value)));
+  }
   JS::Value intVal;
   intVal.setInt32(value);
   return internal::Local<Integer>::New(isolate, intVal);
@@ -43,6 +48,9 @@ Local<Integer> Integer::From(int32_t value) {
 }
 
 Local<Integer> Integer::NewFromUnsigned(Isolate* isolate, uint32_t value) {
+  if (internal::IsImmortalInteger(value)) {
+    return New(isolate, static_cast<int32_t>(value));
+  }
   JS::Value intVal;
   intVal.setNumber(value);
   return internal::Local<Integer>::New(isolate, intVal);
@@ -99,10 +99,9 @@ void Isolate::Impl::OnGC(JSContext* cx, JSGCStatus status, void* data) {
 bool Isolate::Impl::OnInterrupt(JSContext* cx) {
   auto isolateImpl = Isolate::GetCurrent()->pimpl_;
   // Prevent re-entering while handler is running.
-  if (!isolateImpl->serviceInterrupt) {
+  if (!isolateImpl->serviceInterrupt.exchange(false)) {
     return true;
   }
-  isolateImpl->serviceInterrupt = false;
 
   if (isolateImpl->terminatingExecution) {
     return false;
@@ -117,6 +116,29 @@ bool Isolate::Impl::EnqueuePromiseJobCallback(JSContext* cx, JS::HandleObject jo
   return context->pimpl_->jobQueue.append(job);
 }
 
+void Isolate::Impl::PromiseRejectionTrackerCallback(JSContext* cx,
+                                                     JS::HandleObject promise,
+                                                     PromiseRejectionHandlingState state,
+                                                     void* data) {
+  Isolate* isolate = static_cast<Isolate*>(data);
+  PromiseRejectCallback callback = isolate->pimpl_->promiseRejectCallback;
+  if (!callback) {
+    return;
+  }
+  HandleScope handleScope(isolate);
+  Local<Promise> promiseVal =
+    internal::Local<Promise>::New(isolate, JS::ObjectValue(*promise));
+  if (state == PromiseRejectionHandlingState::Unhandled) {
+    Local<Value> reason =
+      internal::Local<Value>::New(isolate, JS::GetPromiseResult(promise));
+    callback(PromiseRejectMessage(promiseVal, kPromiseRejectWithNoHandler,
+                                  reason, Local<StackTrace>()));
+  } else {
+    callback(PromiseRejectMessage(promiseVal, kPromiseHandlerAddedAfterReject,
+                                  Local<Value>(), Local<StackTrace>()));
+  }
+}
+
 static JSObject* GetIncumbentGlobalCallback(JSContext* cx) {
   return JS::CurrentGlobalOrNull(cx);
 }
@@ -155,6 +177,18 @@ Isolate::Isolate() : pimpl_(new Impl()) {
 
   pimpl_->EnsurePersistents(this);
   pimpl_->EnsureEternals(this);
+
+  JS::Value* immortals = pimpl_->immortals;
+  immortals[internal::kImmortalUndefined] = JS::UndefinedValue();
+  immortals[internal::kImmortalNull] = JS::NullValue();
+  immortals[internal::kImmortalTrue] = JS::TrueValue();
+  immortals[internal::kImmortalFalse] = JS::FalseValue();
+  immortals[internal::kImmortalEmptyString] =
+      JS_GetEmptyStringValue(pimpl_->cx);
+  for (int32_t i = internal::kMinImmortalInteger;
+       i <= internal::kMaxImmortalInteger; i++) {
+    immortals[internal::ImmortalIntegerIndex(i)] = JS::Int32Value(i);
+  }
 }
 
 Isolate::~Isolate() {
@@ -228,6 +262,7 @@ void Isolate::Dispose() {
   for (auto script : pimpl_->unboundScripts) {
     delete script;
   }
+  pimpl_->debugContext.Reset();
   for (auto context : pimpl_->contexts) {
     context->Dispose();
   }
@@ -267,6 +302,31 @@ JSContext* JSContextFromIsolate(v8::Isolate* isolate) {
   return isolate->pimpl_->cx;
 }
 
+void AddInternalizedStringId(Isolate* isolate, JSString* str, const jsid& id) {
+  assert(isolate);
+  assert(isolate->pimpl_);
+  isolate->pimpl_->internalizedStringIds.emplace(str, id);
+}
+
+bool GetInternalizedStringId(Isolate* isolate, JSString* str, jsid* id) {
+  assert(isolate);
+  assert(isolate->pimpl_);
+  const auto& ids = isolate->pimpl_->internalizedStringIds;
+  auto iter = ids.find(str);
+  if (iter == ids.end()) {
+    return false;
+  }
+  *id = iter->second;
+  return true;
+}
+
+Value* GetImmortalValue(Isolate* isolate, uint32_t index) {
+  assert(isolate);
+  assert(isolate->pimpl_);
+  assert(index < internal::kNumImmortalValues);
+  return GetV8Value(&isolate->pimpl_->immortals[index]);
+}
+
 void Isolate::AddUnboundScript(UnboundScript* script) {
   assert(pimpl_);
   pimpl_->unboundScripts.push_back(script);
@@ -502,7 +562,11 @@ void Isolate::SetData(uint32_t slot, void* data) {
 }
 
 void Isolate::SetPromiseRejectCallback(PromiseRejectCallback callback) {
-  // TODO: https://github.com/mozilla/spidernode/issues/127
+  pimpl_->promiseRejectCallback = callback;
+  JS::SetPromiseRejectionTrackerCallback(pimpl_->cx,
+                                         callback ? Impl::PromiseRejectionTrackerCallback
+                                                  : nullptr,
+                                         this);
 }
 
 void* Isolate::GetData(uint32_t slot) {
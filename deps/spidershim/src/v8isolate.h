@@ -20,8 +20,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <stack>
 #include <set>
+#include <thread>
+#include <unordered_map>
 
 #include "v8.h"
 #include "v8context.h"
@@ -34,6 +38,31 @@ namespace internal {
 // Node only has 4 slots
 static const uint32_t kNumIsolateDataSlots = 4;
 
+// Locals for these values point straight into Isolate::Impl::immortals
+// instead of at a new HandleScope entry.  None of them can be collected or
+// moved: the oddballs and the integers aren't GC things at all, and the
+// empty string is one of the runtime's permanent atoms.
+enum ImmortalValue {
+  kImmortalUndefined,
+  kImmortalNull,
+  kImmortalTrue,
+  kImmortalFalse,
+  kImmortalEmptyString,
+  kFirstImmortalInteger
+};
+static const int32_t kMinImmortalInteger = -128;
+static const int32_t kMaxImmortalInteger = 1023;
+static const uint32_t kNumImmortalValues =
+    kFirstImmortalInteger + kMaxImmortalInteger - kMinImmortalInteger + 1;
+
+inline bool IsImmortalInteger(int64_t value) {
+  return value >= kMinImmortalInteger && value <= kMaxImmortalInteger;
+}
+
+inline uint32_t ImmortalIntegerIndex(int32_t value) {
+  return kFirstImmortalInteger + (value - kMinImmortalInteger);
+}
+
 bool InitializeIsolate();
 }
 
@@ -41,6 +70,8 @@ struct Isolate::Impl {
   Impl()
       : cx(nullptr),
         topTryCatch(nullptr),
+        promiseRejectCallback(nullptr),
+        lockOwner(std::thread::id()),
         serviceInterrupt(false),
         terminatingExecution(false),
         runningMicrotasks(false),
@@ -68,11 +99,23 @@ struct Isolate::Impl {
   mozilla::Maybe<internal::RootStore> eternals;
   std::vector<MessageCallback> messageListeners;
   std::set<MicrotasksCompletedCallback> microtaskCompletionCallbacks;
+  PromiseRejectCallback promiseRejectCallback;
+  // Maps the pinned atoms created for internalized strings to their jsids.
+  // Pinned atoms live as long as the runtime and are never moved by the GC.
+  std::unordered_map<JSString*, jsid> internalizedStringIds;
   void* embeddedData[internal::kNumIsolateDataSlots];
+  // Held by Locker, and owned by lockOwner while it is.
+  std::mutex lock;
+  std::atomic<std::thread::id> lockOwner;
   Persistent<Object> hiddenGlobal;
+  // Created by the first Debug::GetDebugContext() call.
+  Persistent<Context> debugContext;
+  // Indexed by internal::ImmortalValue, set up once the context exists.
+  JS::Value immortals[internal::kNumImmortalValues];
 
-  bool serviceInterrupt;
-  bool terminatingExecution;
+  // Set by TerminateExecution(), which may be called from another thread.
+  std::atomic<bool> serviceInterrupt;
+  std::atomic<bool> terminatingExecution;
   bool runningMicrotasks;
   int64_t amountOfExternallyAllocatedMemory;
   int callDepth;
@@ -104,8 +147,20 @@ struct Isolate::Impl {
   static bool EnqueuePromiseJobCallback(JSContext* cx, JS::HandleObject job,
                                         JS::HandleObject allocationSite,
                                         JS::HandleObject incumbentGlobal, void* data);
+  static void PromiseRejectionTrackerCallback(JSContext* cx,
+                                              JS::HandleObject promise,
+                                              PromiseRejectionHandlingState state,
+                                              void* data);
 
 };
 
 JSContext* JSContextFromIsolate(v8::Isolate* isolate);
+
+// Remembers the jsid of an internalized string so that property accesses
+// using it as a key don't need to wrap and atomize it again.
+void AddInternalizedStringId(Isolate* isolate, JSString* str, const jsid& id);
+// Looks up the jsid of str if it's a string we have internalized.
+bool GetInternalizedStringId(Isolate* isolate, JSString* str, jsid* id);
+// Returns the slot for one of the values in internal::ImmortalValue.
+Value* GetImmortalValue(Isolate* isolate, uint32_t index);
 }
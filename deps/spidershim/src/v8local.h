@@ -36,6 +36,14 @@ class Local {
   static v8::Local<T> New(Isolate* isolate, JS::Symbol* symbol) {
     return v8::Local<T>::New(isolate, symbol);
   }
+  static v8::Local<T> New(Isolate* isolate, T* that) {
+    return v8::Local<T>::New(isolate, that);
+  }
+  // For slots that are rooted for the lifetime of the isolate, see
+  // GetImmortalValue().  Nothing is added to the current HandleScope.
+  static v8::Local<T> NewImmortal(Value* slot) {
+    return v8::Local<T>(static_cast<T*>(slot));
+  }
   static v8::Local<T> NewTemplate(Isolate* isolate, JS::Value val) {
     return v8::Local<T>::New(isolate, GetV8Template(&val));
   }
@@ -0,0 +1,73 @@
+// Copyright Mozilla Foundation. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include <assert.h>
+#include <atomic>
+
+#include "v8.h"
+#include "v8isolate.h"
+
+namespace v8 {
+
+static std::atomic<bool> sLockerActive(false);
+
+void Locker::Initialize(Isolate* isolate) {
+  isolate_ = isolate;
+  sLockerActive = true;
+  auto pimpl = isolate->pimpl_;
+  // Nested Lockers on the thread that holds the lock are no-ops.
+  has_lock_ = pimpl->lockOwner.load() != std::this_thread::get_id();
+  if (has_lock_) {
+    pimpl->lock.lock();
+    pimpl->lockOwner = std::this_thread::get_id();
+  }
+}
+
+Locker::~Locker() {
+  if (has_lock_) {
+    auto pimpl = isolate_->pimpl_;
+    assert(pimpl->lockOwner.load() == std::this_thread::get_id());
+    pimpl->lockOwner = std::thread::id();
+    pimpl->lock.unlock();
+  }
+}
+
+bool Locker::IsLocked(Isolate* isolate) {
+  return isolate->pimpl_->lockOwner.load() == std::this_thread::get_id();
+}
+
+bool Locker::IsActive() {
+  return sLockerActive;
+}
+
+void Unlocker::Initialize(Isolate* isolate) {
+  isolate_ = isolate;
+  auto pimpl = isolate->pimpl_;
+  assert(pimpl->lockOwner.load() == std::this_thread::get_id());
+  pimpl->lockOwner = std::thread::id();
+  pimpl->lock.unlock();
+}
+
+Unlocker::~Unlocker() {
+  auto pimpl = isolate_->pimpl_;
+  pimpl->lock.lock();
+  pimpl->lockOwner = std::this_thread::get_id();
+}
+}
@@ -25,65 +25,115 @@
 #include "v8local.h"
 #include "autojsapi.h"
 #include "jsfriendapi.h"
+#include "mozilla/Maybe.h"
 #include <string>
 
 namespace v8 {
 
+// Messages are created for every exception that reaches a TryCatch with
+// message listeners, and most of them are never looked at.  So only the
+// exception itself is kept around, and the error report and the message
+// string are computed the first time somebody asks for them.  The exception
+// is rooted for as long as the message lives; unlike a Persistent, the root
+// is dropped without searching the isolate's root store.
 struct Message::Impl {
-  Impl(Value* exception) : lineNumber_(0), columnNumber_(0) {
-    Isolate* isolate = Isolate::GetCurrent();
-    JSContext* cx = JSContextFromIsolate(isolate);
+  Impl(Local<Value> exception)
+    : isolate_(Isolate::GetCurrent()),
+      exception_(JSContextFromIsolate(isolate_), *GetValue(exception)),
+      reportInitialized_(false),
+      hasFilename_(false),
+      lineNumber_(0),
+      columnNumber_(0) {}
+
+  void EnsureReport() {
+    if (reportInitialized_) {
+      return;
+    }
+    reportInitialized_ = true;
+    HandleScope handle_scope(isolate_);
+    JSContext* cx = JSContextFromIsolate(isolate_);
     AutoJSAPI jsAPI(cx);
-    JS::RootedValue exc(cx, *GetValue(exception));
+    JS::RootedValue exc(cx, exception_);
+    // The message may be read from another context than the one that threw,
+    // so look at the exception from inside its own compartment.
+    mozilla::Maybe<JSAutoCompartment> maybeAC;
+    if (exc.isObject()) {
+      maybeAC.emplace(cx, &exc.toObject());
+    }
     js::ErrorReport errorReport(cx);
-    if (errorReport.init(cx, exc, js::ErrorReport::WithSideEffects)) {
-      JSErrorReport* report = errorReport.report();
-      assert(report);
-
-      if (report->linebuf() && report->linebufLength()) {
-        sourceLine_ = String::NewFromTwoByte(
-            isolate, reinterpret_cast<const uint16_t*>(report->linebuf()),
-            NewStringType::kNormal, report->linebufLength());
-      }
-      resourceName_ = String::NewFromOneByte(
-          isolate, reinterpret_cast<const uint8_t*>(report->filename));
-      lineNumber_ = report->lineno;
-      columnNumber_ = report->column;
+    if (!errorReport.init(cx, exc, js::ErrorReport::WithSideEffects)) {
+      return;
     }
-    if (exc.isObject()) {
-      JS::RootedObject obj(cx, &exc.toObject());
-      stackTrace_ = StackTrace::ExceptionStackTrace(isolate, obj);
+    JSErrorReport* report = errorReport.report();
+    assert(report);
+
+    if (report->linebuf() && report->linebufLength()) {
+      sourceLine_.assign(report->linebuf(),
+                         report->linebuf() + report->linebufLength());
     }
-    Local<String> message = exception->ToString();
-    std::string str = "Uncaught ";
+    if (report->filename) {
+      hasFilename_ = true;
+      filename_ = report->filename;
+    }
+    lineNumber_ = report->lineno;
+    columnNumber_ = report->column;
+  }
+
+  const std::string& StringMessage() {
+    if (!stringMessage_.empty()) {
+      return stringMessage_;
+    }
+    HandleScope handle_scope(isolate_);
+    Local<String> message =
+      internal::Local<Value>::New(isolate_, exception_)->ToString();
+    stringMessage_ = "Uncaught ";
     if (message.IsEmpty()) {
-      str += "exception";
+      stringMessage_ += "exception";
     } else {
       String::Utf8Value utf8(message);
       if (!strcmp(*utf8, "InternalError: too much recursion")) {
-        str += "RangeError: Maximum call stack size exceeded";
+        stringMessage_ += "RangeError: Maximum call stack size exceeded";
       } else {
-        str += *utf8;
+        stringMessage_ += *utf8;
       }
     }
-    stringMessage_ = String::NewFromUtf8(isolate, str.c_str());
+    return stringMessage_;
   }
 
-  MaybeLocal<String> sourceLine_;
-  Local<Value> resourceName_;
-  Local<StackTrace> stackTrace_;
+  Local<Value> ResourceName() {
+    EnsureReport();
+    if (!hasFilename_) {
+      return Local<Value>();
+    }
+    return String::NewFromOneByte(
+        isolate_, reinterpret_cast<const uint8_t*>(filename_.c_str()));
+  }
+
+  Isolate* isolate_;
+  JS::PersistentRooted<JS::Value> exception_;
+  bool reportInitialized_;
+  bool hasFilename_;
+  std::u16string sourceLine_;
+  std::string filename_;
   int lineNumber_;
   int columnNumber_;
-  Local<String> stringMessage_;
+  std::string stringMessage_;
 };
 
 Message::Message(Local<Value> exception)
-    : pimpl_(new Impl(*exception)) {}
+    : pimpl_(new Impl(exception)) {}
 
 Message::~Message() { delete pimpl_; }
 
 MaybeLocal<String> Message::GetSourceLine(Local<Context> context) const {
-  return pimpl_->sourceLine_;
+  pimpl_->EnsureReport();
+  if (pimpl_->sourceLine_.empty()) {
+    return MaybeLocal<String>();
+  }
+  return String::NewFromTwoByte(
+      pimpl_->isolate_,
+      reinterpret_cast<const uint16_t*>(pimpl_->sourceLine_.data()),
+      NewStringType::kNormal, pimpl_->sourceLine_.length());
 }
 
 Local<String> Message::GetSourceLine() const {
@@ -92,10 +142,11 @@ Local<String> Message::GetSourceLine() const {
 }
 
 Handle<Value> Message::GetScriptResourceName() const {
-  return pimpl_->resourceName_;
+  return pimpl_->ResourceName();
 }
 
 Maybe<int> Message::GetLineNumber(Local<Context> context) const {
+  pimpl_->EnsureReport();
   return Just(pimpl_->lineNumber_);
 }
 
@@ -104,6 +155,7 @@ int Message::GetLineNumber() const {
 }
 
 Maybe<int> Message::GetStartColumn(Local<Context> context) const {
+  pimpl_->EnsureReport();
   return Just(pimpl_->columnNumber_);
 }
 
@@ -125,16 +177,26 @@ int Message::GetEndColumn() const {
 }
 
 Local<StackTrace> Message::GetStackTrace() const {
-  return pimpl_->stackTrace_;
+  Isolate* isolate = pimpl_->isolate_;
+  JSContext* cx = JSContextFromIsolate(isolate);
+  AutoJSAPI jsAPI(cx);
+  JS::RootedValue exc(cx, pimpl_->exception_);
+  if (!exc.isObject()) {
+    return Local<StackTrace>();
+  }
+  JS::RootedObject obj(cx, &exc.toObject());
+  return StackTrace::ExceptionStackTrace(isolate, obj);
 }
 
 Local<String> Message::Get() const {
-  return pimpl_->stringMessage_;
+  return String::NewFromUtf8(pimpl_->isolate_,
+                             pimpl_->StringMessage().c_str());
 }
 
 ScriptOrigin Message::GetScriptOrigin() const {
-  Isolate* isolate = Isolate::GetCurrent();
-  return ScriptOrigin(pimpl_->resourceName_,
+  Isolate* isolate = pimpl_->isolate_;
+  Local<Value> resourceName = pimpl_->ResourceName();
+  return ScriptOrigin(resourceName,
                       Integer::New(isolate, pimpl_->lineNumber_),
                       Integer::New(isolate, pimpl_->columnNumber_));
 }
@@ -25,6 +25,7 @@
 #include "jsfriendapi.h"
 #include "js/Proxy.h"
 #include "v8context.h"
+#include "v8isolate.h"
 #include "conversions.h"
 #include "v8local.h"
 #include "v8string.h"
@@ -48,6 +49,22 @@ JS::Symbol* GetHiddenValuesTableSymbol(JSContext* cx) {
   return JS::GetSymbolFor(cx, name);
 }
 
+// Converts a property key into a jsid usable in the current compartment of cx.
+// Internalized strings are pinned atoms which are shared by all compartments,
+// so for them we can use the jsid cached when they were created instead of
+// wrapping and atomizing the key on every access.
+bool KeyToId(JSContext* cx, Isolate* isolate, Local<Value> key,
+             JS::MutableHandleId id) {
+  const JS::Value* keyVal = GetValue(key);
+  if (keyVal->isString() &&
+      GetInternalizedStringId(isolate, keyVal->toString(), id.address())) {
+    return true;
+  }
+  JS::RootedValue wrappedKey(cx, *keyVal);
+  return JS_WrapValue(cx, &wrappedKey) &&
+         JS_ValueToId(cx, wrappedKey, id);
+}
+
 // These classes have twice the number of required internal slots in order to
 // keep the internal slot structure compatible with objects created through
 // ObjectTemplate.
@@ -141,9 +158,7 @@ Maybe<bool> Object::Set(Local<Context> context, Local<Value> key,
   JSContext* cx = JSContextFromContext(*context);
   AutoJSAPI jsAPI(cx, this);
   JS::Rooted<jsid> id(cx);
-  JS::RootedValue keyVal(cx, *GetValue(key));
-  if (!JS_WrapValue(cx, &keyVal) ||
-      !JS_ValueToId(cx, keyVal, &id)) {
+  if (!KeyToId(cx, context->GetIsolate(), key, &id)) {
     return Nothing<bool>();
   }
   JSObject* thisObj = GetObject(this);
@@ -195,17 +210,66 @@ Maybe<bool> Object::DefineOwnProperty(Local<Context> context, Local<Name> key,
 
 Maybe<bool> Object::DefineProperty(Local<Context> context, Local<Name> key,
                                    PropertyDescriptor& descriptor) {
-  uint32_t attributes = None;
-  if (!descriptor.writable()) {
-    attributes |= ReadOnly;
+  JSContext* cx = JSContextFromContext(*context);
+  AutoJSAPI jsAPI(cx, this);
+  JS::Rooted<jsid> id(cx);
+  if (!KeyToId(cx, context->GetIsolate(), key, &id)) {
+    return Nothing<bool>();
   }
-  if (!descriptor.enumerable()) {
-    attributes |= DontEnum;
+  JSObject* thisObj = GetObject(this);
+  JSAutoCompartment ac(cx, thisObj);
+  JS::RootedObject thisVal(cx, thisObj);
+
+  // Start out with a generic descriptor and only fill in the fields that are
+  // present, so that a partial descriptor leaves the others alone.
+  JS::Rooted<JS::PropertyDescriptor> desc(cx);
+  desc.setAttributes(JSPROP_IGNORE_ENUMERATE | JSPROP_IGNORE_PERMANENT |
+                     JSPROP_IGNORE_READONLY | JSPROP_IGNORE_VALUE);
+  if (descriptor.has_get() || descriptor.has_set()) {
+    if (descriptor.has_get()) {
+      JS::RootedObject getter(cx);
+      if (descriptor.get()->IsFunction()) {
+        getter = &GetValue(descriptor.get())->toObject();
+        if (!JS_WrapObject(cx, &getter)) {
+          return Nothing<bool>();
+        }
+      }
+      desc.setGetterObject(getter);
+    }
+    if (descriptor.has_set()) {
+      JS::RootedObject setter(cx);
+      if (descriptor.set()->IsFunction()) {
+        setter = &GetValue(descriptor.set())->toObject();
+        if (!JS_WrapObject(cx, &setter)) {
+          return Nothing<bool>();
+        }
+      }
+      desc.setSetterObject(setter);
+    }
+  } else {
+    if (descriptor.has_value()) {
+      JS::RootedValue valueVal(cx, *GetValue(descriptor.value()));
+      if (!JS_WrapValue(cx, &valueVal)) {
+        return Nothing<bool>();
+      }
+      desc.setValue(valueVal);
+    }
+    if (descriptor.has_writable()) {
+      desc.setWritable(descriptor.writable());
+    }
   }
-  if (!descriptor.configurable()) {
-    attributes |= DontDelete;
+  if (descriptor.has_enumerable()) {
+    desc.setEnumerable(descriptor.enumerable());
+  }
+  if (descriptor.has_configurable()) {
+    desc.setConfigurable(descriptor.configurable());
+  }
+
+  JS::ObjectOpResult result;
+  if (!JS_DefinePropertyById(cx, thisVal, id, desc, result)) {
+    return Nothing<bool>();
   }
-  return Set(context, key, descriptor.value(), static_cast<PropertyAttribute>(attributes), /* force = */ true);
+  return Just(result.ok());
 }
 
 Maybe<bool> Object::ForceSet(Local<Context> context, Local<Value> key,
@@ -224,9 +288,7 @@ MaybeLocal<Value> Object::Get(Local<Context> context, Local<Value> key) {
   JSContext* cx = JSContextFromContext(*context);
   AutoJSAPI jsAPI(cx, this);
   JS::Rooted<jsid> id(cx);
-  JS::RootedValue keyVal(cx, *GetValue(key));
-  if (!JS_WrapValue(cx, &keyVal) ||
-      !JS_ValueToId(cx, keyVal, &id)) {
+  if (!KeyToId(cx, context->GetIsolate(), key, &id)) {
     return MaybeLocal<Value>();
   }
   JSObject* thisObj = GetObject(this);
@@ -267,9 +329,7 @@ Maybe<PropertyAttribute> Object::GetPropertyAttributes(Local<Context> context,
   JSContext* cx = JSContextFromContext(*context);
   AutoJSAPI jsAPI(cx, this);
   JS::Rooted<jsid> id(cx);
-  JS::RootedValue keyVal(cx, *GetValue(key));
-  if (!JS_WrapValue(cx, &keyVal) ||
-      !JS_ValueToId(cx, keyVal, &id)) {
+  if (!KeyToId(cx, context->GetIsolate(), key, &id)) {
     return Nothing<PropertyAttribute>();
   }
   JS::RootedObject thisVal(cx, GetObject(this));
@@ -323,9 +383,7 @@ Maybe<bool> Object::Has(Local<Context> context, Local<Value> key) {
   JSContext* cx = JSContextFromContext(*context);
   AutoJSAPI jsAPI(cx, this);
   JS::Rooted<jsid> id(cx);
-  JS::RootedValue keyVal(cx, *GetValue(key));
-  if (!JS_WrapValue(cx, &keyVal) ||
-      !JS_ValueToId(cx, keyVal, &id)) {
+  if (!KeyToId(cx, context->GetIsolate(), key, &id)) {
     return Nothing<bool>();
   }
   JS::RootedObject thisVal(cx, GetObject(this));
@@ -360,9 +418,7 @@ Maybe<bool> Object::Delete(Local<Context> context, Local<Value> key) {
   JSContext* cx = JSContextFromContext(*context);
   AutoJSAPI jsAPI(cx, this);
   JS::Rooted<jsid> id(cx);
-  JS::RootedValue keyVal(cx, *GetValue(key));
-  if (!JS_WrapValue(cx, &keyVal) ||
-      !JS_ValueToId(cx, keyVal, &id)) {
+  if (!KeyToId(cx, context->GetIsolate(), key, &id)) {
     return Nothing<bool>();
   }
   JS::RootedObject thisVal(cx, GetObject(this));
@@ -416,6 +472,39 @@ Local<Object> Object::New(Isolate* isolate) {
   return internal::Local<Object>::New(isolate, objVal);
 }
 
+Local<Object> Object::New(Isolate* isolate, Local<Value> prototype_or_null,
+                          Local<Name>* names, Local<Value>* values,
+                          size_t length) {
+  if (!isolate) {
+    isolate = Isolate::GetCurrent();
+  }
+  JSContext* cx = JSContextFromIsolate(isolate);
+  AutoJSAPI jsAPI(cx);
+  JS::RootedValue protoVal(cx, *GetValue(prototype_or_null));
+  if (!JS_WrapValue(cx, &protoVal)) {
+    return Local<Object>();
+  }
+  assert(protoVal.isObjectOrNull());
+  JS::RootedObject proto(cx, protoVal.toObjectOrNull());
+  JS::RootedObject obj(cx, JS_NewObjectWithGivenProto(cx, nullptr, proto));
+  if (!obj) {
+    return Local<Object>();
+  }
+  JS::Rooted<jsid> id(cx);
+  JS::RootedValue value(cx);
+  for (size_t i = 0; i < length; ++i) {
+    value = *GetValue(values[i]);
+    if (!KeyToId(cx, isolate, names[i], &id) ||
+        !JS_WrapValue(cx, &value) ||
+        !JS_DefinePropertyById(cx, obj, id, value, JSPROP_ENUMERATE)) {
+      return Local<Object>();
+    }
+  }
+  JS::Value objVal;
+  objVal.setObject(*obj);
+  return internal::Local<Object>::New(isolate, objVal);
+}
+
 Object* Object::Cast(Value* obj) {
   assert(GetValue(obj)->isObject());
   return static_cast<Object*>(obj);
@@ -129,6 +129,8 @@ enum class TemplateSlots {
   GenericDeleterCallbackSlot2,
   GenericEnumeratorCallbackSlot1, // Stores our generic prop enumerator callback.
   GenericEnumeratorCallbackSlot2,
+  GenericDefinerCallbackSlot1,    // Stores our generic prop definer callback.
+  GenericDefinerCallbackSlot2,
   GenericCallbackDataSlot,        // Stores our generic prop callback data
   NumSlots
 };
@@ -929,6 +931,119 @@ static bool EnumeratorOp(JSContext* cx, JS::HandleObject obj,
 
 #undef PREPARE_CALLBACK
 
+static bool DefinePropertyOp(JSContext* cx, JS::HandleObject obj,
+                             JS::HandleId id,
+                             JS::Handle<JS::PropertyDescriptor> desc,
+                             JS::ObjectOpResult& result);
+struct AutoResetDefinePropHook {
+  AutoResetDefinePropHook(JS::HandleObject obj)
+    : clasp_(ObjectTemplate::InstanceClass::FromObject(obj)) {
+    clasp_->AddRef();
+    clasp_->ModifyObjectOps().defineProperty = nullptr;
+  }
+  ~AutoResetDefinePropHook() {
+    clasp_->ModifyObjectOps().defineProperty = DefinePropertyOp;
+    clasp_->Release();
+  }
+ private:
+  ObjectTemplate::InstanceClass* clasp_;
+};
+
+// Defines the property on the object itself, as if there were no definer.
+static bool DefineOrdinaryProperty(JSContext* cx, JS::HandleObject obj,
+                                   JS::HandleId id,
+                                   JS::Handle<JS::PropertyDescriptor> desc,
+                                   JS::ObjectOpResult& result) {
+  AutoResetDefinePropHook ignoreHook(obj);
+  return JS_DefinePropertyById(cx, obj, id, desc, result);
+}
+
+// This hook is used when a V8 definer is being used.  SpiderMonkey sends all
+// definitions through it, not only Object.defineProperty(): var and function
+// declarations on a global and assignments that create a new property too.
+static bool DefinePropertyOp(JSContext* cx, JS::HandleObject obj,
+                             JS::HandleId id,
+                             JS::Handle<JS::PropertyDescriptor> desc,
+                             JS::ObjectOpResult& result) {
+  // Properties defined by the resolve hook are mirrors of what the getter
+  // returned, and they're not something the definer should see.
+  if (!JSID_IS_STRING(id) || (desc.attributes() & JSPROP_RESOLVING)) {
+    return DefineOrdinaryProperty(cx, obj, id, desc, result);
+  }
+
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope handleScope(isolate);
+  JS::RootedValue callback1(cx,
+    GetInstanceSlot(obj, size_t(InstanceSlots::GenericDefinerCallbackSlot1)));
+  JS::RootedValue callback2(cx,
+    GetInstanceSlot(obj, size_t(InstanceSlots::GenericDefinerCallbackSlot2)));
+  if (callback1.isUndefined() || callback2.isUndefined()) {
+    return DefineOrdinaryProperty(cx, obj, id, desc, result);
+  }
+  auto callback =
+    ValuesToCallback<GenericNamedPropertyDefinerCallback>(callback1, callback2);
+  JS::RootedValue dataVal(cx,
+    GetInstanceSlot(obj, size_t(InstanceSlots::GenericCallbackDataSlot)));
+  Local<Value> data = internal::Local<Value>::New(isolate, dataVal);
+  Local<Object> thisObj =
+    internal::Local<Object>::New(isolate, JS::ObjectValue(*obj));
+  Local<Name> name =
+    internal::Local<String>::New(isolate, JS::StringValue(JSID_TO_STRING(id)));
+
+  // Only the fields present in |desc| are passed on, so that the definer can
+  // tell a partial redefinition from a complete one.
+  mozilla::Maybe<PropertyDescriptor> v8desc;
+  if (desc.isAccessorDescriptor()) {
+    Local<Value> get;
+    Local<Value> set;
+    if (desc.hasGetterObject()) {
+      get = desc.getterObject() ?
+        internal::Local<Value>::New(isolate,
+                                    JS::ObjectValue(*desc.getterObject())) :
+        Undefined(isolate).As<Value>();
+    }
+    if (desc.hasSetterObject()) {
+      set = desc.setterObject() ?
+        internal::Local<Value>::New(isolate,
+                                    JS::ObjectValue(*desc.setterObject())) :
+        Undefined(isolate).As<Value>();
+    }
+    v8desc.emplace(get, set);
+  } else if (desc.hasValue()) {
+    Local<Value> value = internal::Local<Value>::New(isolate, desc.value());
+    if (desc.hasWritable()) {
+      v8desc.emplace(value, desc.writable());
+    } else {
+      v8desc.emplace(value);
+    }
+  } else {
+    v8desc.emplace();
+  }
+  if (desc.hasEnumerable()) {
+    v8desc->set_enumerable(desc.enumerable());
+  }
+  if (desc.hasConfigurable()) {
+    v8desc->set_configurable(desc.configurable());
+  }
+
+  PropertyCallbackInfo<Value> info(data, thisObj, thisObj);
+  callback(name, v8desc.ref(), info);
+
+  if (isolate->IsExecutionTerminating() || JS_IsExceptionPending(cx)) {
+    return false;
+  }
+  if (info.GetReturnValue().Get()) {
+    // An assignment that adds a property calls the class setter on the new
+    // property right after defining it, so one has to exist.  It carries the
+    // class hooks, just like the ones the resolve hook leaves behind.
+    if (!desc.isAccessorDescriptor() && desc.setter()) {
+      return DefineOrdinaryProperty(cx, obj, id, desc, result);
+    }
+    return result.succeed();
+  }
+  return DefineOrdinaryProperty(cx, obj, id, desc, result);
+}
+
 static bool CallOp(JSContext* cx, unsigned argc, JS::Value* vp) {
   Isolate* isolate = Isolate::GetCurrent();
   JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
@@ -1117,6 +1232,19 @@ Local<Object> ObjectTemplate::NewInstance(Local<Object> prototype,
   CopyTemplateCallbackPropsOnInstance<Name>(cx, obj, instanceObj);
   CopyTemplateCallbackPropsOnInstance<uint32_t>(cx, obj, instanceObj);
 
+  JS::Value definer1 = js::GetReservedSlot(obj,
+    size_t(TemplateSlots::GenericDefinerCallbackSlot1));
+  JS::Value definer2 = js::GetReservedSlot(obj,
+    size_t(TemplateSlots::GenericDefinerCallbackSlot2));
+  if (!definer1.isUndefined() && !definer2.isUndefined()) {
+    SetInstanceSlot(instanceObj,
+                    size_t(InstanceSlots::GenericDefinerCallbackSlot1),
+                    definer1);
+    SetInstanceSlot(instanceObj,
+                    size_t(InstanceSlots::GenericDefinerCallbackSlot2),
+                    definer2);
+  }
+
   // Ensure that we keep our instance class, if any, alive as long as the
   // instance is alive.
   instanceClass->AddRef();
@@ -1245,6 +1373,12 @@ ObjectTemplate::InstanceClass* ObjectTemplate::GetInstanceClass(ObjectType objec
     instanceClass->ModifyObjectOps().enumerate = EnumeratorOp;
   }
 
+  JS::Value definer =
+    js::GetReservedSlot(obj, size_t(TemplateSlots::GenericDefinerCallbackSlot1));
+  if (!definer.isUndefined()) {
+    instanceClass->ModifyObjectOps().defineProperty = DefinePropertyOp;
+  }
+
   JS::Value callAsFunctionHandler =
     js::GetReservedSlot(obj, size_t(TemplateSlots::CallCallbackSlot));
   if (!callAsFunctionHandler.isUndefined()) {
@@ -1375,6 +1509,16 @@ void ObjectTemplate::SetHandler(const NamedPropertyHandlerConfiguration& config)
 
   ::SetHandler<Name>(cx, obj, config.getter, config.setter, config.query,
                      config.deleter, config.enumerator, config.data);
+
+  if (config.definer) {
+    JS::RootedValue callback1(cx);
+    JS::RootedValue callback2(cx);
+    CallbackToValues(config.definer, &callback1, &callback2);
+    js::SetReservedSlot(obj, size_t(TemplateSlots::GenericDefinerCallbackSlot1),
+                        callback1);
+    js::SetReservedSlot(obj, size_t(TemplateSlots::GenericDefinerCallbackSlot2),
+                        callback2);
+  }
 }
 
 void ObjectTemplate::SetIndexedPropertyHandler(IndexedPropertyGetterCallback getter,
@@ -0,0 +1,183 @@
+// Copyright Mozilla Foundation. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include <assert.h>
+
+#include "v8.h"
+#include "autojsapi.h"
+#include "conversions.h"
+#include "v8local.h"
+
+namespace {
+
+bool ResolveOrReject(v8::Local<v8::Context> context, v8::Value* promise,
+                     v8::Local<v8::Value> value, bool reject) {
+  JSContext* cx = JSContextFromContext(*context);
+  AutoJSAPI jsAPI(cx, promise);
+  JS::RootedObject promiseObj(cx, v8::GetObject(promise));
+  JS::RootedValue val(cx, *GetValue(value));
+  if (!JS_WrapValue(cx, &val)) {
+    return false;
+  }
+  // Settling a promise that's no longer pending is a no-op.
+  return reject ? JS::RejectPromise(cx, promiseObj, val)
+                : JS::ResolvePromise(cx, promiseObj, val);
+}
+
+v8::MaybeLocal<v8::Promise> CallThen(v8::Local<v8::Context> context,
+                                     v8::Value* promise,
+                                     v8::Local<v8::Function> onResolve,
+                                     v8::Local<v8::Function> onReject) {
+  JSContext* cx = JSContextFromContext(*context);
+  AutoJSAPI jsAPI(cx, promise);
+  JS::RootedObject promiseObj(cx, v8::GetObject(promise));
+  JS::RootedObject onResolveObj(cx);
+  JS::RootedObject onRejectObj(cx);
+  if (!onResolve.IsEmpty()) {
+    onResolveObj = v8::GetObject(onResolve);
+    if (!JS_WrapObject(cx, &onResolveObj)) {
+      return v8::MaybeLocal<v8::Promise>();
+    }
+  }
+  if (!onReject.IsEmpty()) {
+    onRejectObj = v8::GetObject(onReject);
+    if (!JS_WrapObject(cx, &onRejectObj)) {
+      return v8::MaybeLocal<v8::Promise>();
+    }
+  }
+  JSObject* result =
+    JS::CallOriginalPromiseThen(cx, promiseObj, onResolveObj, onRejectObj);
+  if (!result) {
+    return v8::MaybeLocal<v8::Promise>();
+  }
+  JS::Value retVal;
+  retVal.setObject(*result);
+  return v8::internal::Local<v8::Promise>::New(context->GetIsolate(), retVal);
+}
+}
+
+namespace v8 {
+
+// A Resolver is simply the promise it resolves.  Promises created by
+// JS::NewPromiseObject without an executor can be settled directly through
+// JS::ResolvePromise and JS::RejectPromise, so we don't need to allocate and
+// hold on to a pair of resolving functions.
+MaybeLocal<Promise::Resolver> Promise::Resolver::New(Local<Context> context) {
+  JSContext* cx = JSContextFromContext(*context);
+  AutoJSAPI jsAPI(cx);
+  JSObject* promise = JS::NewPromiseObject(cx, nullptr);
+  if (!promise) {
+    return MaybeLocal<Resolver>();
+  }
+  JS::Value retVal;
+  retVal.setObject(*promise);
+  return internal::Local<Resolver>::New(context->GetIsolate(), retVal);
+}
+
+Local<Promise::Resolver> Promise::Resolver::New(Isolate* isolate) {
+  return New(isolate->GetCurrentContext()).FromMaybe(Local<Resolver>());
+}
+
+Local<Promise> Promise::Resolver::GetPromise() {
+  return internal::Local<Promise>::New(Isolate::GetCurrent(), *GetValue(this));
+}
+
+Maybe<bool> Promise::Resolver::Resolve(Local<Context> context,
+                                       Local<Value> value) {
+  if (!ResolveOrReject(context, this, value, false)) {
+    return Nothing<bool>();
+  }
+  return Just(true);
+}
+
+void Promise::Resolver::Resolve(Handle<Value> value) {
+  Resolve(Isolate::GetCurrent()->GetCurrentContext(), value);
+}
+
+Maybe<bool> Promise::Resolver::Reject(Local<Context> context,
+                                      Local<Value> value) {
+  if (!ResolveOrReject(context, this, value, true)) {
+    return Nothing<bool>();
+  }
+  return Just(true);
+}
+
+void Promise::Resolver::Reject(Handle<Value> value) {
+  Reject(Isolate::GetCurrent()->GetCurrentContext(), value);
+}
+
+Promise::Resolver* Promise::Resolver::Cast(Value* obj) {
+  CheckCast(obj);
+  return static_cast<Resolver*>(obj);
+}
+
+void Promise::Resolver::CheckCast(Value* obj) {
+  assert(obj->IsPromise());
+}
+
+MaybeLocal<Promise> Promise::Catch(Local<Context> context,
+                                   Local<Function> handler) {
+  return CallThen(context, this, Local<Function>(), handler);
+}
+
+Local<Promise> Promise::Catch(Handle<Function> handler) {
+  return Catch(Isolate::GetCurrent()->GetCurrentContext(), handler).
+           FromMaybe(Local<Promise>());
+}
+
+MaybeLocal<Promise> Promise::Then(Local<Context> context,
+                                  Local<Function> handler) {
+  return CallThen(context, this, handler, Local<Function>());
+}
+
+Local<Promise> Promise::Then(Handle<Function> handler) {
+  return Then(Isolate::GetCurrent()->GetCurrentContext(), handler).
+           FromMaybe(Local<Promise>());
+}
+
+Local<Value> Promise::Result() {
+  Isolate* isolate = Isolate::GetCurrent();
+  JSContext* cx = JSContextFromIsolate(isolate);
+  AutoJSAPI jsAPI(cx, this);
+  JS::RootedObject promise(cx, GetObject(this));
+  assert(JS::GetPromiseState(promise) != JS::PromiseState::Pending);
+  return internal::Local<Value>::New(isolate, JS::GetPromiseResult(promise));
+}
+
+Promise::PromiseState Promise::State() {
+  JSContext* cx = JSContextFromIsolate(Isolate::GetCurrent());
+  AutoJSAPI jsAPI(cx, this);
+  JS::RootedObject promise(cx, GetObject(this));
+  switch (JS::GetPromiseState(promise)) {
+    case JS::PromiseState::Pending:
+      return kPending;
+    case JS::PromiseState::Fulfilled:
+      return kFulfilled;
+    case JS::PromiseState::Rejected:
+      return kRejected;
+  }
+  MOZ_CRASH("Unknown promise state");
+}
+
+Promise* Promise::Cast(Value* obj) {
+  assert(obj->IsPromise());
+  return static_cast<Promise*>(obj);
+}
+}
@@ -21,6 +21,9 @@
 #include "v8.h"
 #include "autojsapi.h"
 #include "v8local.h"
+#include "v8string.h"
+#include "mozilla/Atomics.h"
+#include "mozilla/UniquePtr.h"
 
 namespace v8 {
 
@@ -52,4 +55,127 @@ Local<UnboundScript> ScriptCompiler::CompileUnbound(Isolate* isolate,
   return CompileUnboundScript(isolate, source, options).
            FromMaybe(Local<UnboundScript>());
 }
+
+class ScriptCompiler::OffThreadCompileTask {
+ public:
+  OffThreadCompileTask(Isolate* isolate, Source* source,
+                       OffThreadCompileCallback callback, void* data)
+    : source(isolate, source->source_string),
+      resourceName(isolate, source->resource_name),
+      lineOffset(isolate, source->resource_line_offset),
+      columnOffset(isolate, source->resource_column_offset),
+      length(0),
+      token(nullptr),
+      callback(callback),
+      data(data) {}
+
+  // Called by SpiderMonkey on the helper thread once parsing is done.
+  static void OnParsed(void* token, void* closure) {
+    auto task = static_cast<OffThreadCompileTask*>(closure);
+    task->token = token;
+    task->callback(task, task->data);
+  }
+
+  Persistent<String> source;
+  Persistent<Value> resourceName;
+  Persistent<Integer> lineOffset;
+  Persistent<Integer> columnOffset;
+  // The characters being parsed, which need to outlive the parse.
+  JS::UniqueTwoByteChars chars;
+  size_t length;
+  // The parse token handed to us by SpiderMonkey, or nullptr if the source
+  // is compiled on the main thread when the task is finished.
+  mozilla::Atomic<void*> token;
+  OffThreadCompileCallback callback;
+  void* data;
+};
+
+ScriptCompiler::OffThreadCompileTask* ScriptCompiler::StartOffThreadCompile(
+  Isolate* isolate, Source* source, OffThreadCompileCallback callback,
+  void* data) {
+  JSContext* cx = JSContextFromIsolate(isolate);
+  AutoJSAPI jsAPI(cx);
+  mozilla::UniquePtr<OffThreadCompileTask> task =
+    mozilla::MakeUnique<OffThreadCompileTask>(isolate, source, callback, data);
+  {
+    // The source string may belong to the zone of another global, see
+    // Script::Compile().
+    JS::RootedValue sourceVal(cx, *GetValue(source->source_string));
+    if (!JS_WrapValue(cx, &sourceVal)) {
+      return nullptr;
+    }
+    Local<String> src = internal::Local<String>::New(isolate, sourceVal);
+    task->chars = internal::GetFlatString(cx, src, &task->length);
+  }
+  if (!task->chars) {
+    return nullptr;
+  }
+  JS::CompileOptions options(cx);
+  mozilla::UniquePtr<String::Utf8Value> utf8;
+  options.setVersion(JSVERSION_DEFAULT)
+      .setNoScriptRval(false)
+      .setUTF8(true)
+      .setSourceIsLazy(false)
+      .setLine(1)
+      .setColumn(0, 0);
+  if (!source->resource_line_offset.IsEmpty()) {
+    options.setLine(source->resource_line_offset->Value() + 1);
+  }
+  if (!source->resource_column_offset.IsEmpty()) {
+    options.setColumn(source->resource_column_offset->Value(), 0);
+  }
+  if (!source->resource_name.IsEmpty()) {
+    JS::RootedValue nameVal(cx, *GetValue(source->resource_name));
+    if (!JS_WrapValue(cx, &nameVal)) {
+      return nullptr;
+    }
+    MaybeLocal<String> resourceName =
+        GetV8Value(&nameVal)->ToString(isolate->GetCurrentContext());
+    if (!resourceName.IsEmpty()) {
+      utf8 =
+          mozilla::MakeUnique<String::Utf8Value>(resourceName.ToLocalChecked());
+      options.setFile(**utf8);
+    }
+  }
+  if (!JS::CanCompileOffThread(cx, options, task->length)) {
+    // Not worth it; FinishOffThreadCompile() will compile it synchronously.
+    task->callback(task.get(), task->data);
+    return task.release();
+  }
+  if (!JS::CompileOffThread(cx, options, task->chars.get(), task->length,
+                            OffThreadCompileTask::OnParsed, task.get())) {
+    return nullptr;
+  }
+  return task.release();
+}
+
+MaybeLocal<UnboundScript> ScriptCompiler::FinishOffThreadCompile(
+  Isolate* isolate, OffThreadCompileTask* task) {
+  mozilla::UniquePtr<OffThreadCompileTask> owner(task);
+  ScriptOrigin origin(task->resourceName, task->lineOffset,
+                      task->columnOffset);
+  Source source(Local<String>::New(isolate, task->source), origin);
+  if (!task->token) {
+    return CompileUnboundScript(isolate, &source);
+  }
+  JSContext* cx = JSContextFromIsolate(isolate);
+  AutoJSAPI jsAPI(cx);
+  // This merges the script into the compartment we're currently in.
+  JS::RootedScript script(cx, JS::FinishOffThreadScript(cx, task->token));
+  if (!script) {
+    return MaybeLocal<UnboundScript>();
+  }
+  return Local<UnboundScript>::New(isolate,
+                                   new UnboundScript(isolate, &source, script));
+}
+
+void ScriptCompiler::CancelOffThreadCompile(Isolate* isolate,
+                                            OffThreadCompileTask* task) {
+  mozilla::UniquePtr<OffThreadCompileTask> owner(task);
+  if (task->token) {
+    JSContext* cx = JSContextFromIsolate(isolate);
+    AutoJSAPI jsAPI(cx);
+    JS::CancelOffThreadScript(cx, task->token);
+  }
+}
 }
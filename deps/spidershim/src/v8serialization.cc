@@ -18,68 +18,286 @@
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 // IN THE SOFTWARE.
 
+#include <stdlib.h>
+
 #include "v8.h"
 #include "v8conversions.h"
 #include "conversions.h"
 #include "v8local.h"
 #include "autojsapi.h"
 #include "jsfriendapi.h"
-#include "js/Conversions.h"
-#include "js/Proxy.h"
+#include "js/StructuredClone.h"
+
+// ValueSerializer and ValueDeserializer are implemented on top of
+// SpiderMonkey's structured clone algorithm, so the wire format is
+// SpiderMonkey's and not V8's.  Transferred ArrayBuffers have their contents
+// moved into the serialized data by WriteValue() and are recreated by
+// ReadValue(), so ValueDeserializer::TransferArrayBuffer() is a no-op.  Until
+// ReadValue() has done that, the ValueDeserializer owns those contents, and
+// destroying it without reading the value frees them.  The serialized data
+// may be read on another thread of the same process, but not in another
+// process.  Host objects and the raw Read/Write methods used to implement
+// them aren't supported.
+
+namespace {
+
+const JS::StructuredCloneScope kScope =
+  JS::StructuredCloneScope::SameProcessDifferentThread;
+
+// SharedArrayBuffers would need their references to be held on to while the
+// data is in flight, which the flat buffer handed out by Release() can't do.
+JS::CloneDataPolicy ClonePolicy() {
+  JS::CloneDataPolicy policy;
+  policy.denySharedArrayBuffer();
+  return policy;
+}
+
+void ReportUnsupported(const char* what) {
+  fprintf(stderr, "ValueSerializer: %s is not supported\n", what);
+}
+}
 
 namespace v8 {
 
-Maybe<uint32_t>
-ValueSerializer::Delegate::GetSharedArrayBufferId(Isolate*, Local<SharedArrayBuffer>)
-  {
+Maybe<bool> ValueSerializer::Delegate::WriteHostObject(Isolate* isolate,
+                                                       Local<Object> object) {
+  ThrowDataCloneError(
+    String::NewFromUtf8(isolate, "Host objects cannot be cloned",
+                        NewStringType::kNormal).ToLocalChecked());
+  return Nothing<bool>();
+}
+
+Maybe<uint32_t> ValueSerializer::Delegate::GetSharedArrayBufferId(
+    Isolate* isolate, Local<SharedArrayBuffer> shared_array_buffer) {
+  ThrowDataCloneError(
+    String::NewFromUtf8(isolate, "SharedArrayBuffers cannot be cloned",
+                        NewStringType::kNormal).ToLocalChecked());
+  return Nothing<uint32_t>();
+}
+
+void* ValueSerializer::Delegate::ReallocateBufferMemory(void* old_buffer,
+                                                        size_t size,
+                                                        size_t* actual_size) {
+  *actual_size = size;
+  return realloc(old_buffer, size);
+}
+
+void ValueSerializer::Delegate::FreeBufferMemory(void* buffer) {
+  free(buffer);
+}
+
+struct ValueSerializer::PrivateData {
+  PrivateData(Isolate* isolate, Delegate* delegate)
+    : isolate(isolate),
+      delegate(delegate),
+      buffer(kScope, nullptr, nullptr) {}
+
+  Isolate* isolate;
+  Delegate* delegate;
+  JSAutoStructuredCloneBuffer buffer;
+  // The ArrayBuffers passed to TransferArrayBuffer(), if any.
+  Persistent<Array> transferables;
+};
+
+ValueSerializer::ValueSerializer(Isolate* isolate)
+  : ValueSerializer(isolate, nullptr) {}
+
+ValueSerializer::ValueSerializer(Isolate* isolate, Delegate* delegate)
+  : private_(new PrivateData(isolate, delegate)) {}
+
+ValueSerializer::~ValueSerializer() {
+  delete private_;
+}
+
+void ValueSerializer::WriteHeader() {
+  // The structured clone data carries its own header.
+}
+
+Maybe<bool> ValueSerializer::WriteValue(Local<Context> context,
+                                        Local<Value> value) {
+  JSContext* cx = JSContextFromContext(*context);
+  AutoJSAPI jsAPI(cx);
+  JS::RootedValue val(cx, *GetValue(value));
+  JS::RootedValue transferables(cx);
+  if (!private_->transferables.IsEmpty()) {
+    transferables = *GetValue(Local<Array>::New(private_->isolate,
+                                                private_->transferables));
+  }
+  if (!JS_WrapValue(cx, &val) || !JS_WrapValue(cx, &transferables)) {
+    return Nothing<bool>();
+  }
+  if (!private_->buffer.write(cx, val, transferables, ClonePolicy())) {
+    return Nothing<bool>();
+  }
+  return Just(true);
+}
+
+std::vector<uint8_t> ValueSerializer::ReleaseBuffer() {
+  std::pair<uint8_t*, size_t> data = Release();
+  std::vector<uint8_t> result(data.first, data.first + data.second);
+  if (private_->delegate) {
+    private_->delegate->FreeBufferMemory(data.first);
+  } else {
+    free(data.first);
+  }
+  return result;
+}
+
+std::pair<uint8_t*, size_t> ValueSerializer::Release() {
+  JSStructuredCloneData& data = private_->buffer.data();
+  size_t size = data.Size();
+  size_t actual_size = 0;
+  void* result =
+    private_->delegate ?
+      private_->delegate->ReallocateBufferMemory(nullptr, size, &actual_size) :
+      malloc(size);
+  if (!result) {
+    return std::make_pair(nullptr, 0);
+  }
+  auto iter = data.Iter();
+  data.ReadBytes(iter, static_cast<char*>(result), size);
+  // The copy now owns the contents of any transferred ArrayBuffers.
+  private_->buffer.abandon();
+  private_->buffer.clear();
+  return std::make_pair(static_cast<uint8_t*>(result), size);
+}
+
+void ValueSerializer::TransferArrayBuffer(uint32_t transfer_id,
+                                          Local<ArrayBuffer> array_buffer) {
+  Isolate* isolate = private_->isolate;
+  Local<Context> context = isolate->GetCurrentContext();
+  Local<Array> transferables;
+  if (private_->transferables.IsEmpty()) {
+    transferables = Array::New(isolate);
+    private_->transferables.Reset(isolate, transferables);
+  } else {
+    transferables = Local<Array>::New(isolate, private_->transferables);
+  }
+  // The ids are only meaningful to V8, since the contents travel in-band.
+  transferables->Set(context, transferables->Length(), array_buffer)
+    .FromJust();
+}
+
+void ValueSerializer::TransferSharedArrayBuffer(
+    uint32_t transfer_id, Local<SharedArrayBuffer> shared_array_buffer) {
+  ReportUnsupported("TransferSharedArrayBuffer");
+}
+
+void ValueSerializer::SetTreatArrayBufferViewsAsHostObjects(bool mode) {
+  if (mode) {
+    ReportUnsupported("SetTreatArrayBufferViewsAsHostObjects");
+  }
+}
+
+void ValueSerializer::WriteUint32(uint32_t value) {
+  ReportUnsupported("WriteUint32");
+}
+
+void ValueSerializer::WriteUint64(uint64_t value) {
+  ReportUnsupported("WriteUint64");
+}
+
+void ValueSerializer::WriteDouble(double value) {
+  ReportUnsupported("WriteDouble");
+}
+
+void ValueSerializer::WriteRawBytes(const void* source, size_t length) {
+  ReportUnsupported("WriteRawBytes");
+}
+
+MaybeLocal<Object> ValueDeserializer::Delegate::ReadHostObject(
+    Isolate* isolate) {
+  isolate->ThrowException(Exception::Error(
+    String::NewFromUtf8(isolate, "Host objects cannot be deserialized",
+                        NewStringType::kNormal).ToLocalChecked()));
+  return MaybeLocal<Object>();
+}
+
+struct ValueDeserializer::PrivateData {
+  PrivateData(Isolate* isolate, Delegate* delegate)
+    : isolate(isolate),
+      delegate(delegate),
+      buffer(kScope, nullptr, nullptr),
+      valid(true) {}
+
+  Isolate* isolate;
+  Delegate* delegate;
+  JSAutoStructuredCloneBuffer buffer;
+  bool valid;
+};
+
+ValueDeserializer::ValueDeserializer(Isolate* isolate, const uint8_t* data,
+                                     size_t size)
+  : ValueDeserializer(isolate, data, size, nullptr) {}
+
+ValueDeserializer::ValueDeserializer(Isolate* isolate, const uint8_t* data,
+                                     size_t size, Delegate* delegate)
+  : private_(new PrivateData(isolate, delegate)) {
+  JSStructuredCloneData copy;
+  private_->valid =
+    copy.WriteBytes(reinterpret_cast<const char*>(data), size);
+  if (private_->valid) {
+    // Take over the contents of any transferred ArrayBuffers.
+    private_->buffer.adopt(std::move(copy));
   }
+}
+
+ValueDeserializer::~ValueDeserializer() {
+  delete private_;
+}
 
-void
-  ValueSerializer::Delegate::FreeBufferMemory(void*)
-  {
+Maybe<bool> ValueDeserializer::ReadHeader(Local<Context> context) {
+  if (!private_->valid) {
+    return Nothing<bool>();
   }
+  return Just(true);
+}
 
-Maybe<bool> ValueSerializer::Delegate::WriteHostObject(Isolate*, Local<Object>) {}
-void *ValueSerializer::Delegate::ReallocateBufferMemory(void*, size_t, size_t*) {}
+MaybeLocal<Value> ValueDeserializer::ReadValue(Local<Context> context) {
+  JSContext* cx = JSContextFromContext(*context);
+  AutoJSAPI jsAPI(cx);
+  JS::RootedValue result(cx);
+  if (!private_->valid || !private_->buffer.read(cx, &result)) {
+    return MaybeLocal<Value>();
+  }
+  return internal::Local<Value>::New(private_->isolate, result);
+}
 
-ValueSerializer::ValueSerializer(Isolate*, Delegate*)
-{
-  printf("serialization is not supported\n");
+void ValueDeserializer::TransferArrayBuffer(uint32_t transfer_id,
+                                            Local<ArrayBuffer> array_buffer) {
+  // ReadValue() recreates transferred ArrayBuffers by itself.
 }
 
-ValueSerializer::ValueSerializer(Isolate*)
-{
-  printf("serialization is not supported\n");
+void ValueDeserializer::TransferSharedArrayBuffer(
+    uint32_t id, Local<SharedArrayBuffer> shared_array_buffer) {
+  ReportUnsupported("TransferSharedArrayBuffer");
 }
 
-ValueSerializer::~ValueSerializer() {}
+void ValueDeserializer::SetSupportsLegacyWireFormat(
+    bool supports_legacy_wire_format) {
+}
 
-void ValueSerializer::WriteHeader() {}
-void ValueSerializer::WriteDouble(double) {}
-void ValueSerializer::WriteUint32(uint32_t) {}
-void ValueSerializer::WriteUint64(uint64_t) {}
-Maybe<bool> ValueSerializer::WriteValue(Local<Context>, Local<Value>) {}
-void ValueSerializer::TransferArrayBuffer(uint32_t, Local<ArrayBuffer>) {}
-void ValueSerializer::SetTreatArrayBufferViewsAsHostObjects(bool) {}
-std::pair<uint8_t*, size_t> ValueSerializer::Release() {}
-void ValueSerializer::WriteRawBytes(const void *, size_t) {}
+uint32_t ValueDeserializer::GetWireFormatVersion() const {
+  return JS_STRUCTURED_CLONE_VERSION;
+}
 
-MaybeLocal<Object> ValueDeserializer::Delegate::ReadHostObject(Isolate *) {}
+bool ValueDeserializer::ReadUint32(uint32_t* value) {
+  ReportUnsupported("ReadUint32");
+  return false;
+}
 
-ValueDeserializer::ValueDeserializer(Isolate*, const uint8_t *, size_t, Delegate*)
-{
-  printf("serialization is not supported\n");
+bool ValueDeserializer::ReadUint64(uint64_t* value) {
+  ReportUnsupported("ReadUint64");
+  return false;
 }
 
-ValueDeserializer::~ValueDeserializer() {}
+bool ValueDeserializer::ReadDouble(double* value) {
+  ReportUnsupported("ReadDouble");
+  return false;
+}
 
-void ValueDeserializer::TransferArrayBuffer(uint32_t, Local<ArrayBuffer>) {}
-bool ValueDeserializer::ReadRawBytes(size_t, const void **) {}
-Maybe<bool> ValueDeserializer::ReadHeader(Local<Context>) {}
-bool ValueDeserializer::ReadUint64(uint64_t *) {}
-bool ValueDeserializer::ReadUint32(uint32_t*) {}
-bool ValueDeserializer::ReadDouble(double*) {}
-MaybeLocal<Value> ValueDeserializer::ReadValue(Local<Context>) {}
-void ValueDeserializer::TransferSharedArrayBuffer(uint32_t, Local<SharedArrayBuffer>) {}
-uint32_t ValueDeserializer::GetWireFormatVersion() const {}
+bool ValueDeserializer::ReadRawBytes(size_t length, const void** data) {
+  ReportUnsupported("ReadRawBytes");
+  return false;
+}
 }
@@ -113,6 +113,10 @@ MaybeLocal<String> String::NewFromUtf8(Isolate* isolate, const char* data,
     return MaybeLocal<String>();
   }
 
+  if (type == v8::NewStringType::kInternalized) {
+    AddInternalizedStringId(isolate, str, INTERNED_STRING_TO_JSID(cx, str));
+  }
+
   // If creating the non-internalized string was successful, relinquish ownership.
   if (type != v8::NewStringType::kInternalized) {
     mozilla::Unused << twoByteChars.release();
@@ -149,6 +153,10 @@ MaybeLocal<String> String::NewFromOneByte(Isolate* isolate, const uint8_t* data,
     return MaybeLocal<String>();
   }
 
+  if (type == v8::NewStringType::kInternalized) {
+    AddInternalizedStringId(isolate, str, INTERNED_STRING_TO_JSID(cx, str));
+  }
+
   JS::Value strVal;
   strVal.setString(str);
   return internal::Local<String>::New(isolate, strVal);
@@ -190,6 +198,10 @@ MaybeLocal<String> String::NewFromTwoByte(Isolate* isolate,
     return MaybeLocal<String>();
   }
 
+  if (type == v8::NewStringType::kInternalized) {
+    AddInternalizedStringId(isolate, str, INTERNED_STRING_TO_JSID(cx, str));
+  }
+
   JS::Value strVal;
   strVal.setString(str);
   return internal::Local<String>::New(isolate, strVal);
@@ -224,6 +236,7 @@ MaybeLocal<String> String::NewExternalTwoByte(
   if (!str) {
     return MaybeLocal<String>();
   }
+
   JS::Value strVal;
   strVal.setString(str);
   return internal::Local<String>::New(isolate, strVal);
@@ -304,7 +317,8 @@ int String::Utf8Length() const {
 }
 
 Local<String> String::Empty(Isolate* isolate) {
-  return NewFromUtf8(isolate, "");
+  return internal::Local<String>::NewImmortal(
+      GetImmortalValue(isolate, internal::kImmortalEmptyString));
 }
 
 Local<String> String::Concat(Handle<String> left, Handle<String> right) {
@@ -68,7 +68,12 @@ struct TryCatch::Impl {
   void SetException(JS::HandleValue exception) const {
     assert(!hasExceptionSet_ || !HasException());
     hasExceptionSet_ = true;
-    exception_ = exception.get();
+    // Most TryCatches never see an exception, so only root one when needed.
+    if (exception_.initialized()) {
+      exception_ = exception.get();
+    } else {
+      exception_.init(JSContextFromIsolate(isolate_), exception.get());
+    }
   }
   void ReThrow() {
     if (rethrow_) {
@@ -80,7 +85,7 @@ struct TryCatch::Impl {
     }
     JSContext* cx = JSContextFromIsolate(isolate_);
     assert(hasExceptionSet_ && HasException() && !HasExceptionPending(cx));
-    JS::RootedValue exc(cx, *exception_.unsafeGet());
+    JS::RootedValue exc(cx, exception_.get());
     if (!JS_WrapValue(cx, &exc)) {
       // TODO: signal the failure somehow.
       return;
@@ -90,7 +95,7 @@ struct TryCatch::Impl {
   }
   JS::Value* Exception() {
     assert(hasExceptionSet_ && HasException());
-    return exception_.unsafeGet();
+    return exception_.address();
   }
   void SetVerbose(bool verbose) { verbose_ = verbose; }
   bool IsVerbose() const { return verbose_; }
@@ -113,7 +118,9 @@ struct TryCatch::Impl {
     hasException_ = false;
     hasExceptionSet_ = false;
     rethrow_ = false;
-    exception_ = JS::UndefinedValue();
+    if (exception_.initialized()) {
+      exception_ = JS::UndefinedValue();
+    }
   }
   bool GetAndClearExceptionIfNeeded() const {
     if (HasExceptionSet()) {
@@ -143,7 +150,7 @@ struct TryCatch::Impl {
  private:
   class Isolate* isolate_;
   class TryCatch* prev_;
-  mutable JS::Heap<JS::Value> exception_;
+  mutable JS::PersistentRooted<JS::Value> exception_;
   mutable bool hasException_;
   mutable bool hasExceptionSet_;
   mutable bool rethrow_;
@@ -201,9 +208,15 @@ void TryCatch::CheckReportExternalException() {
     auto exceptionHolder = pimpl_->Previous() ? nonInternal : this;
     auto isolateImpl =
         reinterpret_cast<Isolate::Impl*>(pimpl_->Isolate()->pimpl_);
-    auto messageListeners = isolateImpl->messageListeners;
-    for (auto i : messageListeners) {
-      (*i)(exceptionHolder->Message(), exceptionHolder->Exception());
+    if (!isolateImpl->messageListeners.empty()) {
+      // Listeners may add or remove listeners, so iterate over a copy.
+      auto messageListeners = isolateImpl->messageListeners;
+      // The message is cheap to create, its contents are computed on demand.
+      Local<class Message> message = exceptionHolder->Message();
+      Local<Value> exception = exceptionHolder->Exception();
+      for (auto i : messageListeners) {
+        (*i)(message, exception);
+      }
     }
   } else {
     pimpl_->IgnoreException();
@@ -26,26 +26,45 @@
 namespace v8 {
 
 struct UnboundScript::Impl {
-  Impl(Isolate* isolate, Local<String> src, Local<Value> name)
-    : source(isolate, src),
-      resourceName(isolate, name) {}
+  Impl(Isolate* isolate, ScriptCompiler::Source* src)
+    : source(isolate, src->source_string),
+      resourceName(isolate, src->resource_name),
+      lineOffset(isolate, src->resource_line_offset),
+      columnOffset(isolate, src->resource_column_offset) {}
 
   Persistent<String> source;
   Persistent<Value> resourceName;
+  Persistent<Integer> lineOffset;
+  Persistent<Integer> columnOffset;
+  // The compiled script, if we have one.  It's cloned into the compartment
+  // of whichever context ends up running it.
+  JS::PersistentRooted<JSScript*> script;
 };
 
 UnboundScript::UnboundScript(Isolate* isolate, ScriptCompiler::Source* source)
-  : pimpl_(new Impl(isolate, source->source_string, source->resource_name)) {
+  : pimpl_(new Impl(isolate, source)) {
   isolate->AddUnboundScript(this);
 }
 
+UnboundScript::UnboundScript(Isolate* isolate, ScriptCompiler::Source* source,
+                             JSScript* script)
+  : UnboundScript(isolate, source) {
+  pimpl_->script.init(JSContextFromIsolate(isolate), script);
+}
+
 UnboundScript::~UnboundScript() {
   delete pimpl_;
 }
 
 Local<Script> UnboundScript::BindToCurrentContext() {
-  ScriptOrigin origin(pimpl_->resourceName);
-  return Script::Compile(Isolate::GetCurrent()->GetCurrentContext(), 
+  Isolate* isolate = Isolate::GetCurrent();
+  if (pimpl_->script.initialized()) {
+    return internal::Local<Script>::New(isolate, pimpl_->script,
+                                        isolate->GetCurrentContext());
+  }
+  ScriptOrigin origin(pimpl_->resourceName, pimpl_->lineOffset,
+                      pimpl_->columnOffset);
+  return Script::Compile(isolate->GetCurrentContext(),
                          pimpl_->source, &origin).
            FromMaybe(Local<Script>());
 }
@@ -24,6 +24,7 @@
 #include "v8handlescope.h"
 #include "v8isolate.h"
 #include "autojsapi.h"
+#include "jsfriendapi.h"
 #include "js/Initialization.h"
 
 namespace v8 {
@@ -31,6 +32,7 @@ namespace v8 {
 namespace internal {
 bool gJSInitNeeded = false;
 bool gDisposed = false;
+int gHelperThreadCPUCount = 0;
 }
 
 bool V8::Initialize() {
@@ -39,6 +41,14 @@ bool V8::Initialize() {
   if (internal::gJSInitNeeded && !JS_Init()) {
     return false;
   }
+  // The helper threads are started along with the first JSContext, so this
+  // only works if nobody has created one yet.
+  if (internal::gHelperThreadCPUCount > 0 &&
+      !js::SetHelperThreadCPUCount(internal::gHelperThreadCPUCount)) {
+    fprintf(stderr, "Helper threads are already running, ignoring the "
+                    "requested CPU count of %d\n",
+            internal::gHelperThreadCPUCount);
+  }
   return v8::internal::InitializeIsolate() &&
          v8::internal::InitializeHandleScope();
 }
@@ -52,6 +62,38 @@ bool V8::Dispose() {
   return true;
 }
 
+void V8::SetHelperThreadCPUCount(int count) {
+  assert(count >= 0);
+  internal::gHelperThreadCPUCount = count;
+}
+
+HelperThreadStatistics::HelperThreadStatistics()
+  : cpu_count_(0),
+    thread_count_(0),
+    ion_pending_(0),
+    ion_finished_(0),
+    wasm_pending_(0),
+    parse_pending_(0),
+    parse_finished_(0),
+    compression_pending_(0),
+    gc_pending_(0),
+    promise_tasks_pending_(0) {}
+
+void V8::GetHelperThreadStatistics(HelperThreadStatistics* statistics) {
+  js::HelperThreadStats stats;
+  js::GetHelperThreadStats(&stats);
+  statistics->cpu_count_ = stats.cpuCount;
+  statistics->thread_count_ = stats.threadCount;
+  statistics->ion_pending_ = stats.ionWorklist;
+  statistics->ion_finished_ = stats.ionFinished;
+  statistics->wasm_pending_ = stats.wasmWorklist;
+  statistics->parse_pending_ = stats.parseWorklist;
+  statistics->parse_finished_ = stats.parseFinished;
+  statistics->compression_pending_ = stats.compressionWorklist;
+  statistics->gc_pending_ = stats.gcHelperWorklist + stats.gcParallelWorklist;
+  statistics->promise_tasks_pending_ = stats.promiseTasks;
+}
+
 void V8::FromJustIsNothing() {
   MOZ_CRASH("Maybe value in FromJust() is nothing");
 }
@@ -72,7 +114,22 @@ void V8::SetFlagsFromCommandLine(int *argc, char **argv, bool remove_flags) {
   // TODO: command line arguments should be added on an as-needed basis
   for (int i = 1; i < *argc; i++) {
     const char kStackSize[] = "--stack-size=";
-    if (!strncmp(argv[i], kStackSize, sizeof(kStackSize) - 1)) {
+    const char kHelperThreadCPUs[] = "--helper-thread-cpus=";
+    if (!strncmp(argv[i], kHelperThreadCPUs, sizeof(kHelperThreadCPUs) - 1)) {
+      const char* count = argv[i] + sizeof(kHelperThreadCPUs) - 1;
+      int cpus = strtol(count, nullptr, 0);
+      if (cpus <= 0) {
+        fprintf(stderr, "--helper-thread-cpus requires a positive count\n");
+        continue;
+      }
+
+      internal::gHelperThreadCPUCount = cpus;
+      if (remove_flags) {
+        memmove(argv + i, argv + i + 1, sizeof(char*) * (*argc - i));
+        (*argc)--;
+        i--;
+      }
+    } else if (!strncmp(argv[i], kStackSize, sizeof(kStackSize) - 1)) {
       const char* size = argv[i] + sizeof(kStackSize) - 1;
       uintptr_t kbytes = strtol(size, nullptr, 0);
       if (!kbytes) {
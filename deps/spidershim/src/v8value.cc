@@ -30,10 +30,26 @@
 static_assert(sizeof(v8::Value) == sizeof(JS::Value),
               "v8::Value and JS::Value must be binary compatible");
 
+#if SPIDERSHIM_INLINE_VALUES
+namespace nanbox = v8::internal::nanbox;
+static_assert(nanbox::kTagShift == JSVAL_TAG_SHIFT &&
+              nanbox::kTagInt32 == JSVAL_TAG_INT32 &&
+              nanbox::kTagUndefined == JSVAL_TAG_UNDEFINED &&
+              nanbox::kTagNull == JSVAL_TAG_NULL &&
+              nanbox::kTagBoolean == JSVAL_TAG_BOOLEAN &&
+              nanbox::kTagString == JSVAL_TAG_STRING &&
+              nanbox::kTagSymbol == JSVAL_TAG_SYMBOL &&
+              nanbox::kTagObject == JSVAL_TAG_OBJECT &&
+              nanbox::kShiftedTagMaxDouble == JSVAL_SHIFTED_TAG_MAX_DOUBLE &&
+              nanbox::kShiftedTagUndefined == JSVAL_SHIFTED_TAG_UNDEFINED &&
+              nanbox::kShiftedTagObject == JSVAL_SHIFTED_TAG_OBJECT,
+              "v8-nanbox.h is out of sync with js/public/Value.h");
+#endif
+
 namespace v8 {
 
 #define SIMPLE_VALUE(V8_VAL, SM_VAL) \
-  bool Value::Is##V8_VAL() const { return GetValue(this)->is##SM_VAL(); }
+  bool Value::FullIs##V8_VAL() const { return GetValue(this)->is##SM_VAL(); }
 #define COMMON_VALUE(NAME) SIMPLE_VALUE(NAME, NAME)
 // Needed to get around clang preprocessor issue with pasting next to :: token.
 #define CONCATENATE(X) ESClass:: X
@@ -63,7 +79,7 @@ namespace v8 {
 #undef ES_BUILTIN
 #undef TYPED_ARRAY
 
-bool Value::IsUint32() const {
+bool Value::FullIsUint32() const {
   if (!IsNumber()) {
     return false;
   }
@@ -117,7 +133,7 @@ Local<Boolean> Value::ToBoolean(Isolate* isolate) const {
   return ToBoolean(isolate->GetCurrentContext()).ToLocalChecked();
 }
 
-Maybe<bool> Value::BooleanValue(Local<Context> context) const {
+Maybe<bool> Value::FullBooleanValue(Local<Context> context) const {
   MaybeLocal<Boolean> maybeBool = ToBoolean(context);
   if (maybeBool.IsEmpty()) {
     return Nothing<bool>();
@@ -125,10 +141,6 @@ Maybe<bool> Value::BooleanValue(Local<Context> context) const {
   return Just(maybeBool.ToLocalChecked()->Value());
 }
 
-bool Value::BooleanValue() const {
-  return BooleanValue(Isolate::GetCurrent()->GetCurrentContext())
-      .FromMaybe(false);
-}
 
 MaybeLocal<Number> Value::ToNumber(Local<Context> context) const {
   JSContext* cx = JSContextFromContext(*context);
@@ -150,7 +162,7 @@ Local<Number> Value::ToNumber(Isolate* isolate) const {
   return ToNumber(isolate->GetCurrentContext()).FromMaybe(Local<Number>());
 }
 
-Maybe<double> Value::NumberValue(Local<Context> context) const {
+Maybe<double> Value::FullNumberValue(Local<Context> context) const {
   MaybeLocal<Number> maybeNum = ToNumber(context);
   if (maybeNum.IsEmpty()) {
     return Nothing<double>();
@@ -158,9 +170,6 @@ Maybe<double> Value::NumberValue(Local<Context> context) const {
   return Just(maybeNum.ToLocalChecked()->Value());
 }
 
-double Value::NumberValue() const {
-  return NumberValue(Isolate::GetCurrent()->GetCurrentContext()).FromMaybe(NAN);
-}
 
 MaybeLocal<Integer> Value::ToInteger(Local<Context> context) const {
   JSContext* cx = JSContextFromContext(*context);
@@ -182,7 +191,7 @@ Local<Integer> Value::ToInteger(Isolate* isolate) const {
   return ToInteger(isolate->GetCurrentContext()).FromMaybe(Local<Integer>());
 }
 
-Maybe<int64_t> Value::IntegerValue(Local<Context> context) const {
+Maybe<int64_t> Value::FullIntegerValue(Local<Context> context) const {
   MaybeLocal<Integer> maybeInt = ToInteger(context);
   if (maybeInt.IsEmpty()) {
     return Nothing<int64_t>();
@@ -190,9 +199,6 @@ Maybe<int64_t> Value::IntegerValue(Local<Context> context) const {
   return Just(maybeInt.ToLocalChecked()->Value());
 }
 
-int64_t Value::IntegerValue() const {
-  return IntegerValue(Isolate::GetCurrent()->GetCurrentContext()).FromMaybe(0);
-}
 
 MaybeLocal<Int32> Value::ToInt32(Local<Context> context) const {
   JSContext* cx = JSContextFromContext(*context);
@@ -214,7 +220,7 @@ Local<Int32> Value::ToInt32(Isolate* isolate) const {
   return ToInt32(isolate->GetCurrentContext()).FromMaybe(Local<Int32>());
 }
 
-Maybe<int32_t> Value::Int32Value(Local<Context> context) const {
+Maybe<int32_t> Value::FullInt32Value(Local<Context> context) const {
   MaybeLocal<Int32> maybeInt = ToInt32(context);
   if (maybeInt.IsEmpty()) {
     return Nothing<int32_t>();
@@ -222,9 +228,6 @@ Maybe<int32_t> Value::Int32Value(Local<Context> context) const {
   return Just(maybeInt.ToLocalChecked()->Value());
 }
 
-int32_t Value::Int32Value() const {
-  return Int32Value(Isolate::GetCurrent()->GetCurrentContext()).FromMaybe(0);
-}
 
 MaybeLocal<Uint32> Value::ToUint32(Local<Context> context) const {
   JSContext* cx = JSContextFromContext(*context);
@@ -246,7 +249,7 @@ Local<Uint32> Value::ToUint32(Isolate* isolate) const {
   return ToUint32(isolate->GetCurrentContext()).FromMaybe(Local<Uint32>());
 }
 
-Maybe<uint32_t> Value::Uint32Value(Local<Context> context) const {
+Maybe<uint32_t> Value::FullUint32Value(Local<Context> context) const {
   MaybeLocal<Uint32> maybeInt = ToUint32(context);
   if (maybeInt.IsEmpty()) {
     return Nothing<uint32_t>();
@@ -254,9 +257,6 @@ Maybe<uint32_t> Value::Uint32Value(Local<Context> context) const {
   return Just(maybeInt.ToLocalChecked()->Value());
 }
 
-uint32_t Value::Uint32Value() const {
-  return Uint32Value(Isolate::GetCurrent()->GetCurrentContext()).FromMaybe(0);
-}
 
 MaybeLocal<String> Value::ToString(Local<Context> context) const {
   JSContext* cx = JSContextFromContext(*context);
@@ -379,8 +379,59 @@ Value::IsSharedArrayBuffer() const
 }
 
 bool
-Value::IsSymbol() const
+Value::FullIsSymbol() const
 {
   return GetValue(this)->isSymbol();
 }
+
+// The predicates and unboxing accessors are inline in v8.h, but they used to
+// be exported from the shim and addons built against older headers still
+// link against them.  Keep exporting them under their old mangled names with
+// plain functions that call the inline versions.
+#if defined(__GNUC__)
+#define SPIDERSHIM_STRINGIFY_(x) #x
+#define SPIDERSHIM_STRINGIFY(x) SPIDERSHIM_STRINGIFY_(x)
+#define SPIDERSHIM_LEGACY_NAME(Mangled) \
+  SPIDERSHIM_STRINGIFY(__USER_LABEL_PREFIX__) "_ZNK2v85Value" Mangled
+namespace legacy {
+
+#define LEGACY_PREDICATE(Length, Name)                                \
+  V8_EXPORT bool Is##Name(const Value* self)                          \
+      __asm__(SPIDERSHIM_LEGACY_NAME(#Length "Is" #Name "Ev"));       \
+  bool Is##Name(const Value* self) { return self->Is##Name(); }
+LEGACY_PREDICATE(11, Undefined)
+LEGACY_PREDICATE(6, Null)
+LEGACY_PREDICATE(6, True)
+LEGACY_PREDICATE(7, False)
+LEGACY_PREDICATE(8, String)
+LEGACY_PREDICATE(8, Symbol)
+LEGACY_PREDICATE(8, Object)
+LEGACY_PREDICATE(9, Boolean)
+LEGACY_PREDICATE(8, Number)
+LEGACY_PREDICATE(7, Int32)
+LEGACY_PREDICATE(8, Uint32)
+#undef LEGACY_PREDICATE
+
+#define LEGACY_ACCESSORS(Type, Length, Name)                                 \
+  V8_EXPORT Maybe<Type> Name(const Value* self, Local<Context> context)      \
+      __asm__(SPIDERSHIM_LEGACY_NAME(                                        \
+          #Length #Name "ENS_5LocalINS_7ContextEEE"));                       \
+  Maybe<Type> Name(const Value* self, Local<Context> context) {              \
+    return self->Name(context);                                              \
+  }                                                                          \
+  V8_EXPORT Type Name(const Value* self)                                     \
+      __asm__(SPIDERSHIM_LEGACY_NAME(#Length #Name "Ev"));                   \
+  Type Name(const Value* self) { return self->Name(); }
+LEGACY_ACCESSORS(bool, 12, BooleanValue)
+LEGACY_ACCESSORS(double, 11, NumberValue)
+LEGACY_ACCESSORS(int64_t, 12, IntegerValue)
+LEGACY_ACCESSORS(uint32_t, 11, Uint32Value)
+LEGACY_ACCESSORS(int32_t, 10, Int32Value)
+#undef LEGACY_ACCESSORS
+
+}  // namespace legacy
+#undef SPIDERSHIM_LEGACY_NAME
+#undef SPIDERSHIM_STRINGIFY
+#undef SPIDERSHIM_STRINGIFY_
+#endif  // defined(__GNUC__)
 }
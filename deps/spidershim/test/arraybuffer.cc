@@ -302,3 +302,42 @@ TEST(SpiderShim, ArrayBuffer_NeuteringScript) {
   CheckDataViewIsNeutered(dv);
 #endif
 }
+
+TEST(SpiderShim, ArrayBufferView_GetData) {
+  V8Engine engine;
+
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+  Local<Context> context = Context::New(engine.isolate());
+  Context::Scope context_scope(context);
+
+  // A view on an existing buffer points into it at its offset.
+  Local<Uint8Array> view = Local<Uint8Array>::Cast(CompileRun(
+      "var ab = new ArrayBuffer(16);"
+      "new Uint8Array(ab).fill(7, 4, 12);"
+      "new Uint8Array(ab, 4, 8)"));
+  EXPECT_TRUE(view->HasBuffer());
+  size_t length = 0;
+  uint8_t* data = static_cast<uint8_t*>(view->GetData(&length));
+  EXPECT_EQ(8u, length);
+  EXPECT_EQ(static_cast<uint8_t*>(view->Buffer()->GetContents().Data()) + 4,
+            data);
+  for (size_t i = 0; i < length; i++) {
+    EXPECT_EQ(7, data[i]);
+  }
+
+  // A small typed array starts out with its data inline; GetData() gives it
+  // a buffer so that the pointer stays put.
+  Local<Uint8Array> small = Local<Uint8Array>::Cast(CompileRun(
+      "var small = new Uint8Array([1, 2, 3]); small"));
+  EXPECT_FALSE(small->HasBuffer());
+  data = static_cast<uint8_t*>(small->GetData(&length));
+  EXPECT_TRUE(small->HasBuffer());
+  EXPECT_EQ(3u, length);
+  EXPECT_EQ(1, data[0]);
+  EXPECT_EQ(3, data[2]);
+  data[1] = 42;
+  EXPECT_EQ(42, CompileRun("small[1]")->Int32Value(context).FromJust());
+  EXPECT_EQ(data, small->GetData(&length));
+}
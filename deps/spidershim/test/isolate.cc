@@ -7,7 +7,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <thread>
+
 #include "v8engine.h"
+#include "v8-debug.h"
 
 #include "gtest/gtest.h"
 #include "jsapi.h"
@@ -324,6 +327,92 @@ TEST(SpiderShim, Microtask) {
   EXPECT_FALSE(on_fulfilled_called);
 }
 
+int promise_handler_value;
+
+static void PromiseHandler(const FunctionCallbackInfo<Value>& info) {
+  promise_handler_value = info[0]->Int32Value();
+}
+
+TEST(SpiderShim, PromiseResolver) {
+  promise_handler_value = 0;
+  V8Engine engine;
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+  Local<Context> context = Context::New(engine.isolate());
+  Context::Scope context_scope(context);
+  engine.isolate()->SetAutorunMicrotasks(false);
+
+  Local<Function> handler =
+    Function::New(context, PromiseHandler).ToLocalChecked();
+
+  Local<Promise::Resolver> resolver =
+    Promise::Resolver::New(context).ToLocalChecked();
+  Local<Promise> promise = resolver->GetPromise();
+  EXPECT_TRUE(promise->IsPromise());
+  EXPECT_EQ(Promise::kPending, promise->State());
+  Local<Promise> derived = promise->Then(context, handler).ToLocalChecked();
+  EXPECT_TRUE(derived->IsPromise());
+  EXPECT_TRUE(resolver->Resolve(context, v8_num(42)).FromJust());
+  EXPECT_EQ(Promise::kFulfilled, promise->State());
+  EXPECT_EQ(42, promise->Result()->Int32Value(context).FromJust());
+  // Settling a promise twice is ignored.
+  EXPECT_TRUE(resolver->Reject(context, v8_num(43)).FromJust());
+  EXPECT_EQ(Promise::kFulfilled, promise->State());
+  EXPECT_EQ(0, promise_handler_value);
+  engine.isolate()->RunMicrotasks();
+  EXPECT_EQ(42, promise_handler_value);
+
+  resolver = Promise::Resolver::New(context).ToLocalChecked();
+  promise = resolver->GetPromise();
+  EXPECT_FALSE(promise->Catch(context, handler).IsEmpty());
+  EXPECT_TRUE(resolver->Reject(context, v8_num(44)).FromJust());
+  EXPECT_EQ(Promise::kRejected, promise->State());
+  EXPECT_EQ(44, promise->Result()->Int32Value(context).FromJust());
+  engine.isolate()->RunMicrotasks();
+  EXPECT_EQ(44, promise_handler_value);
+}
+
+int promise_reject_count;
+PromiseRejectEvent promise_reject_event;
+
+static void OnPromiseReject(PromiseRejectMessage message) {
+  promise_reject_count++;
+  promise_reject_event = message.GetEvent();
+  if (message.GetEvent() == kPromiseRejectWithNoHandler) {
+    EXPECT_EQ(45, message.GetValue()->Int32Value());
+  }
+  EXPECT_EQ(Promise::kRejected, message.GetPromise()->State());
+}
+
+TEST(SpiderShim, PromiseRejectCallback) {
+  promise_reject_count = 0;
+  V8Engine engine;
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+  Local<Context> context = Context::New(engine.isolate());
+  Context::Scope context_scope(context);
+  engine.isolate()->SetPromiseRejectCallback(OnPromiseReject);
+
+  Local<Promise::Resolver> resolver =
+    Promise::Resolver::New(context).ToLocalChecked();
+  EXPECT_TRUE(resolver->Reject(context, v8_num(45)).FromJust());
+  EXPECT_EQ(1, promise_reject_count);
+  EXPECT_EQ(kPromiseRejectWithNoHandler, promise_reject_event);
+
+  Local<Function> handler =
+    Function::New(context, PromiseHandler).ToLocalChecked();
+  EXPECT_FALSE(resolver->GetPromise()->Catch(context, handler).IsEmpty());
+  EXPECT_EQ(2, promise_reject_count);
+  EXPECT_EQ(kPromiseHandlerAddedAfterReject, promise_reject_event);
+
+  engine.isolate()->SetPromiseRejectCallback(nullptr);
+  resolver = Promise::Resolver::New(context).ToLocalChecked();
+  EXPECT_TRUE(resolver->Reject(context, v8_num(45)).FromJust());
+  EXPECT_EQ(2, promise_reject_count);
+}
+
 TEST(SpiderShim, GetHeapStatistics) {
   // This test is based on V8's GetHeapStatistics.
   V8Engine engine;
@@ -351,6 +440,22 @@ TEST(SpiderShim, GetHeapStatistics) {
   }
 }
 
+TEST(SpiderShim, GetHelperThreadStatistics) {
+  V8Engine engine;
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+  Local<Context> context = Context::New(engine.isolate());
+  Context::Scope context_scope(context);
+
+  HelperThreadStatistics statistics;
+  EXPECT_EQ(0u, statistics.thread_count());
+  V8::GetHelperThreadStatistics(&statistics);
+  EXPECT_NE(0u, statistics.cpu_count());
+  // SpiderMonkey starts a few threads on top of one per CPU.
+  EXPECT_GT(statistics.thread_count(), statistics.cpu_count());
+}
+
 void ThrowValue(const FunctionCallbackInfo<Value>& args) {
   EXPECT_EQ(1, args.Length());
   args.GetIsolate()->ThrowException(args[0]);
@@ -857,3 +962,83 @@ TEST(SpiderShim, IsolateMultipleEnter) {
   Isolate::Scope isolate_scope_3(isolate);
   Isolate::Scope isolate_scope_4(isolate);
 }
+
+TEST(SpiderShim, DebugContext) {
+  V8Engine engine;
+  Isolate* isolate = engine.isolate();
+  Isolate::Scope isolate_scope(isolate);
+
+  HandleScope handle_scope(isolate);
+  Local<Context> debug_context = Debug::GetDebugContext(isolate);
+  ASSERT_FALSE(debug_context.IsEmpty());
+  {
+    Context::Scope context_scope(debug_context);
+    engine.CompileRun(debug_context, "var marker = 42;");
+  }
+
+  // Later calls hand out the same context.
+  {
+    HandleScope inner(isolate);
+    Local<Context> again = Debug::GetDebugContext(isolate);
+    EXPECT_TRUE(again->Global()->StrictEquals(debug_context->Global()));
+    Context::Scope context_scope(again);
+    EXPECT_EQ(42, engine.CompileRun(again, "marker")
+                      ->Int32Value(again).FromJust());
+    EXPECT_TRUE(engine.CompileRun(again, "typeof Debug.makeMirror")
+                    ->StrictEquals(v8_str("function")));
+  }
+}
+
+static void RunIsolateOnThread(int* result) {
+  V8Engine engine;
+  Locker locker(engine.isolate());
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+  Local<Context> context = Context::New(engine.isolate());
+  Context::Scope context_scope(context);
+  *result = engine.CompileRun(context,
+                              "var sum = 0;"
+                              "for (var i = 0; i < 100000; ++i) sum += i % 7;"
+                              "sum")->Int32Value(context).FromJust();
+}
+
+TEST(SpiderShim, Locker) {
+  V8Engine engine;
+  Isolate* isolate = engine.isolate();
+
+  EXPECT_FALSE(Locker::IsLocked(isolate));
+  {
+    Locker locker(isolate);
+    EXPECT_TRUE(Locker::IsLocked(isolate));
+    EXPECT_TRUE(Locker::IsActive());
+    {
+      Locker nested(isolate);
+      EXPECT_TRUE(Locker::IsLocked(isolate));
+      {
+        Unlocker unlocker(isolate);
+        EXPECT_FALSE(Locker::IsLocked(isolate));
+        std::thread other([isolate]() {
+          Locker locker(isolate);
+          EXPECT_TRUE(Locker::IsLocked(isolate));
+        });
+        other.join();
+      }
+      EXPECT_TRUE(Locker::IsLocked(isolate));
+    }
+    EXPECT_TRUE(Locker::IsLocked(isolate));
+  }
+  EXPECT_FALSE(Locker::IsLocked(isolate));
+
+  // Each thread runs JS in an isolate of its own.
+  const int kThreads = 4;
+  int results[kThreads] = {};
+  std::thread threads[kThreads];
+  for (int i = 0; i < kThreads; ++i) {
+    threads[i] = std::thread(RunIsolateOnThread, &results[i]);
+  }
+  for (int i = 0; i < kThreads; ++i) {
+    threads[i].join();
+    EXPECT_EQ(299995, results[i]);
+  }
+}
@@ -372,3 +372,48 @@ TEST(SpiderShim, CallAsFunction) {
     EXPECT_TRUE(a10->StrictEquals(True(isolate)));
   }
 }
+
+TEST(SpiderShim, InternalizedPropertyKeys) {
+  V8Engine engine;
+  Isolate* isolate = engine.isolate();
+  Isolate::Scope isolate_scope(isolate);
+
+  HandleScope handle_scope(isolate);
+  Local<Context> context = Context::New(isolate);
+  Local<Context> context2 = Context::New(isolate);
+  Context::Scope context_scope(context);
+
+  Eternal<String> eternal_key(isolate,
+      String::NewFromOneByte(isolate,
+                             reinterpret_cast<const uint8_t*>("oncomplete"),
+                             NewStringType::kInternalized).ToLocalChecked());
+  Local<String> key = eternal_key.Get(isolate);
+  Local<String> index_key =
+      String::NewFromUtf8(isolate, "7", NewStringType::kInternalized)
+          .ToLocalChecked();
+
+  Local<Object> obj = Object::New(isolate);
+  EXPECT_TRUE(obj->Set(context, key, v8_num(42)).FromJust());
+  EXPECT_TRUE(obj->Set(context, index_key, v8_num(7)).FromJust());
+  EXPECT_TRUE(obj->Has(context, key).FromJust());
+  EXPECT_EQ(42, obj->Get(context, key).ToLocalChecked()
+                    ->Int32Value(context).FromJust());
+  // The cached key must agree with non-internalized strings and indices.
+  EXPECT_EQ(42, obj->Get(context, v8_str("oncomplete")).ToLocalChecked()
+                    ->Int32Value(context).FromJust());
+  EXPECT_EQ(7, obj->Get(context, 7).ToLocalChecked()
+                   ->Int32Value(context).FromJust());
+
+  // Internalized keys can be used with objects from other compartments.
+  Local<Object> obj2;
+  {
+    Context::Scope context_scope2(context2);
+    obj2 = Object::New(isolate);
+  }
+  EXPECT_TRUE(obj2->Set(context, key, v8_num(23)).FromJust());
+  EXPECT_EQ(23, obj2->Get(context, key).ToLocalChecked()
+                    ->Int32Value(context).FromJust());
+  EXPECT_TRUE(obj2->Delete(context, key).FromJust());
+  EXPECT_FALSE(obj2->Has(context, key).FromJust());
+  EXPECT_TRUE(obj->Has(context, key).FromJust());
+}
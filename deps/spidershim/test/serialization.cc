@@ -0,0 +1,112 @@
+// Copyright Mozilla Foundation. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "v8engine.h"
+
+#include "gtest/gtest.h"
+
+TEST(SpiderShim, ValueSerializer) {
+  V8Engine engine;
+
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+  Local<Context> context = Context::New(engine.isolate());
+  Context::Scope context_scope(context);
+
+  Local<Value> value =
+    engine.CompileRun(context, "({ a: 1, b: [2, 'three'], c: { d: null } })");
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(engine.isolate(), 8);
+  memset(buffer->GetContents().Data(), 42, 8);
+  Local<Array> array = Array::New(engine.isolate(), 2);
+  EXPECT_TRUE(array->Set(context, 0, value).FromJust());
+  EXPECT_TRUE(array->Set(context, 1, buffer).FromJust());
+
+  ValueSerializer serializer(engine.isolate());
+  serializer.WriteHeader();
+  serializer.TransferArrayBuffer(0, buffer);
+  EXPECT_TRUE(serializer.WriteValue(context, array).FromJust());
+  // Transferring detaches the original ArrayBuffer.
+  EXPECT_EQ(0u, buffer->ByteLength());
+  std::pair<uint8_t*, size_t> data = serializer.Release();
+  EXPECT_TRUE(data.first != nullptr);
+
+  Local<Context> context2 = Context::New(engine.isolate());
+  Context::Scope context_scope2(context2);
+  ValueDeserializer deserializer(engine.isolate(), data.first, data.second);
+  EXPECT_TRUE(deserializer.ReadHeader(context2).FromJust());
+  Local<Value> result = deserializer.ReadValue(context2).ToLocalChecked();
+  free(data.first);
+
+  EXPECT_TRUE(context2->Global()->Set(context2, v8_str("result"), result)
+                  .FromJust());
+  EXPECT_TRUE(engine.CompileRun(context2,
+                                "result[0].a === 1 &&"
+                                "result[0].b[1] === 'three' &&"
+                                "result[0].c.d === null &&"
+                                "new Uint8Array(result[1])[7] === 42")
+                  ->BooleanValue(context2).FromJust());
+}
+
+TEST(SpiderShim, ValueSerializerError) {
+  V8Engine engine;
+
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+  Local<Context> context = Context::New(engine.isolate());
+  Context::Scope context_scope(context);
+
+  TryCatch try_catch(engine.isolate());
+  ValueSerializer serializer(engine.isolate());
+  Local<Value> function = engine.CompileRun(context, "(function() {})");
+  EXPECT_TRUE(serializer.WriteValue(context, function).IsNothing());
+  EXPECT_TRUE(try_catch.HasCaught());
+}
+
+TEST(SpiderShim, ValueDeserializerUnread) {
+  V8Engine engine;
+
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+  Local<Context> context = Context::New(engine.isolate());
+  Context::Scope context_scope(context);
+
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(engine.isolate(), 1 << 20);
+  ValueSerializer serializer(engine.isolate());
+  serializer.WriteHeader();
+  serializer.TransferArrayBuffer(0, buffer);
+  EXPECT_TRUE(serializer.WriteValue(context, buffer).FromJust());
+  EXPECT_EQ(0u, buffer->ByteLength());
+  std::pair<uint8_t*, size_t> data = serializer.Release();
+  EXPECT_TRUE(data.first != nullptr);
+
+  // A deserializer that is destroyed without reading the value frees the
+  // contents of the transferred ArrayBuffer, which would otherwise leak.
+  {
+    ValueDeserializer deserializer(engine.isolate(), data.first, data.second);
+    EXPECT_TRUE(deserializer.ReadHeader(context).FromJust());
+  }
+  free(data.first);
+}
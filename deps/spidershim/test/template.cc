@@ -1501,6 +1501,63 @@ TEST(SpiderShim, PropertyHandlers) {
   EXPECT_EQ(41, Int32::Cast(*val)->Value());
 }
 
+static std::string definer_log;
+
+static void LoggingDefiner(Local<Name> property,
+                           const PropertyDescriptor& desc,
+                           const PropertyCallbackInfo<Value>& info) {
+  EXPECT_EQ(5, Int32::Cast(*info.Data())->Value());
+  String::Utf8Value name(property);
+  definer_log += *name;
+  if (desc.has_get()) {
+    definer_log += ":get";
+  }
+  if (desc.has_value() && desc.value()->IsInt32()) {
+    definer_log += ":" + std::to_string(Int32::Cast(*desc.value())->Value());
+  }
+  definer_log += " ";
+  // Swallow the names that start with an underscore.
+  if ((*name)[0] == '_') {
+    info.GetReturnValue().Set(true);
+  }
+}
+
+TEST(SpiderShim, PropertyDefiner) {
+  V8Engine engine;
+  Isolate* isolate = engine.isolate();
+  Isolate::Scope isolate_scope(isolate);
+
+  HandleScope handle_scope(isolate);
+  Local<ObjectTemplate> global_templ = ObjectTemplate::New(isolate);
+  NamedPropertyHandlerConfiguration config;
+  config.definer = LoggingDefiner;
+  config.data = Int32::New(isolate, 5);
+  global_templ->SetHandler(config);
+  Local<Context> context = Context::New(isolate, nullptr, global_templ);
+  Context::Scope context_scope(context);
+
+  definer_log.clear();
+  Local<Value> val = CompileRun("var a = 1; a;");
+  EXPECT_EQ(1, Int32::Cast(*val)->Value());
+  val = CompileRun("function b() { return 2; } b();");
+  EXPECT_EQ(2, Int32::Cast(*val)->Value());
+  CompileRun("Object.defineProperty(this, 'c', {get() { return 3; }});");
+  val = CompileRun("d = 4; d;");
+  EXPECT_EQ(4, Int32::Cast(*val)->Value());
+  EXPECT_EQ("a b c:get d:4 ", definer_log);
+
+  // Existing properties are assigned to, not redefined.
+  definer_log.clear();
+  CompileRun("a = 5; d = 6;");
+  EXPECT_EQ("", definer_log);
+
+  // Intercepted definitions never reach the global.
+  val = CompileRun("_e = 7; Object.defineProperty(this, '_f', {value: 8});"
+                   "this.hasOwnProperty('_e') || this.hasOwnProperty('_f');");
+  EXPECT_TRUE(val->IsFalse());
+  EXPECT_EQ("_e:7 _f:8 ", definer_log);
+}
+
 static void ShadowFunctionCallback(
     const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(v8_num(42));
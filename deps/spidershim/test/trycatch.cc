@@ -324,6 +324,43 @@ TEST(SpiderShim, TryCatchSourceInfoForEOSError) {
   EXPECT_EQ(0, message->GetStartColumn(context).FromJust());
 }
 
+TEST(SpiderShim, TryCatchLazyMessage) {
+  V8Engine engine;
+
+  Isolate* isolate = engine.isolate();
+  Isolate::Scope isolate_scope(isolate);
+
+  HandleScope handle_scope(isolate);
+  Local<Context> context = Context::New(isolate);
+  Context::Scope context_scope(context);
+
+  TryCatch try_catch(isolate);
+  CompileRun("function f() {\n"
+             "  throw new Error('lazy');\n"
+             "}\n"
+             "f();\n");
+  EXPECT_TRUE(try_catch.HasCaught());
+  Local<Message> message = try_catch.Message();
+
+  // Nothing has been read from the message yet, so it only holds on to the
+  // exception.  It must survive a GC and handle scopes closing around the
+  // first accesses.
+  isolate->RequestGarbageCollectionForTesting(kFullGarbageCollection);
+  {
+    HandleScope inner(isolate);
+    String::Utf8Value text(message->Get());
+    EXPECT_STREQ("Uncaught Error: lazy", *text);
+    EXPECT_EQ(2, message->GetLineNumber(context).FromJust());
+  }
+  isolate->RequestGarbageCollectionForTesting(kFullGarbageCollection);
+  String::Utf8Value text(message->Get());
+  EXPECT_STREQ("Uncaught Error: lazy", *text);
+  EXPECT_EQ(2, message->GetLineNumber(context).FromJust());
+  String::Utf8Value line(message->GetSourceLine(context).ToLocalChecked());
+  EXPECT_STREQ("  throw new Error('lazy');", *line);
+  EXPECT_EQ(2, message->GetStackTrace()->GetFrameCount());
+}
+
 TEST(SpiderShim, TryCatchStackTrace) {
   V8Engine engine;
 
@@ -6,6 +6,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <string>
+#include <thread>
+
 #include "v8engine.h"
 
 #include "gtest/gtest.h"
@@ -118,3 +122,77 @@ TEST(SpiderShim, InvalidSyntax) {
                                                  &script_source).IsEmpty());
   EXPECT_TRUE(try_catch.HasCaught());
 }
+
+namespace {
+void OnOffThreadCompileReady(ScriptCompiler::OffThreadCompileTask* task,
+                             void* data) {
+  static_cast<std::atomic<bool>*>(data)->store(true);
+}
+
+MaybeLocal<UnboundScript> CompileOffThread(Isolate* isolate,
+                                           const std::string& source) {
+  std::atomic<bool> ready(false);
+  ScriptCompiler::Source script_source(v8_str(source.c_str()),
+                                       ScriptOrigin(v8_str("off-thread")));
+  ScriptCompiler::OffThreadCompileTask* task =
+    ScriptCompiler::StartOffThreadCompile(isolate, &script_source,
+                                          OnOffThreadCompileReady, &ready);
+  EXPECT_TRUE(task != nullptr);
+  while (!ready.load()) {
+    std::this_thread::yield();
+  }
+  return ScriptCompiler::FinishOffThreadCompile(isolate, task);
+}
+}
+
+TEST(SpiderShim, OffThreadCompile) {
+  V8Engine engine;
+
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+
+  // Large enough for SpiderMonkey to compile it on a helper thread.
+  std::string large;
+  for (int i = 0; i < 2000; ++i) {
+    large += "foo += 1;\n";
+  }
+  const char* small = "foo * 2";
+
+  Local<Context> c1 = Context::New(engine.isolate());
+  Context::Scope context_scope(c1);
+  c1->Global()->Set(c1, v8_str("foo"), Integer::New(engine.isolate(), 100))
+      .FromJust();
+
+  Local<UnboundScript> large_script =
+    CompileOffThread(engine.isolate(), large).ToLocalChecked();
+  Local<UnboundScript> small_script =
+    CompileOffThread(engine.isolate(), small).ToLocalChecked();
+  EXPECT_EQ(2100, large_script->BindToCurrentContext()
+                      ->Run(c1)
+                      .ToLocalChecked()
+                      ->Int32Value(c1)
+                      .FromJust());
+  EXPECT_EQ(4200, small_script->BindToCurrentContext()
+                      ->Run(c1)
+                      .ToLocalChecked()
+                      ->Int32Value(c1)
+                      .FromJust());
+
+  {
+    Local<Context> c2 = Context::New(engine.isolate());
+    Context::Scope context_scope(c2);
+    c2->Global()->Set(c2, v8_str("foo"), Integer::New(engine.isolate(), 1))
+        .FromJust();
+    EXPECT_EQ(2001, large_script->BindToCurrentContext()
+                        ->Run(c2)
+                        .ToLocalChecked()
+                        ->Int32Value(c2)
+                        .FromJust());
+  }
+
+  TryCatch try_catch(engine.isolate());
+  EXPECT_TRUE(CompileOffThread(engine.isolate(), large + "function foo() {")
+                  .IsEmpty());
+  EXPECT_TRUE(try_catch.HasCaught());
+}
@@ -262,6 +262,110 @@ TEST(SpiderShim, Integer) {
   TestInteger(engine.isolate(), UINT32_MAX);
 }
 
+TEST(SpiderShim, ImmortalHandles) {
+  V8Engine engine;
+
+  Isolate* isolate = engine.isolate();
+  Isolate::Scope isolate_scope(isolate);
+
+  HandleScope handle_scope(isolate);
+  Local<Context> context = Context::New(isolate);
+  Context::Scope context_scope(context);
+
+  int handles = HandleScope::NumberOfHandles(isolate);
+  EXPECT_TRUE(Undefined(isolate)->IsUndefined());
+  EXPECT_TRUE(Null(isolate)->IsNull());
+  EXPECT_TRUE(True(isolate)->IsTrue());
+  EXPECT_TRUE(False(isolate)->IsFalse());
+  EXPECT_TRUE(Boolean::New(isolate, true)->IsTrue());
+  EXPECT_EQ(0, String::Empty(isolate)->Length());
+  EXPECT_EQ(-128, Integer::New(isolate, -128)->Value());
+  EXPECT_EQ(0, Integer::New(isolate, 0)->Value());
+  EXPECT_EQ(1023, Integer::New(isolate, 1023)->Value());
+  EXPECT_EQ(7, Integer::NewFromUnsigned(isolate, 7)->Value());
+  EXPECT_EQ(handles, HandleScope::NumberOfHandles(isolate));
+
+  // The same slot is handed out every time.
+  EXPECT_EQ(*Integer::New(isolate, 42), *Integer::New(isolate, 42));
+  EXPECT_EQ(*Undefined(isolate), *Undefined(isolate));
+
+  EXPECT_EQ(1024, Integer::New(isolate, 1024)->Value());
+  EXPECT_EQ(-129, Integer::New(isolate, -129)->Value());
+  EXPECT_EQ(handles + 2, HandleScope::NumberOfHandles(isolate));
+
+  // They behave like any other Local.
+  EXPECT_TRUE(String::Empty(isolate)->StrictEquals(
+      engine.CompileRun(context, "''")));
+  Local<Object> global = context->Global();
+  EXPECT_TRUE(global->Set(context, v8_str("n"), Integer::New(isolate, 5))
+                  .FromJust());
+  EXPECT_EQ(10, engine.CompileRun(context, "n * 2")->Int32Value(context)
+                    .FromJust());
+  Persistent<Value> persistent(isolate, Integer::New(isolate, 3));
+  EXPECT_EQ(3, Local<Value>::New(isolate, persistent)->Int32Value(context)
+                   .FromJust());
+  persistent.Reset();
+}
+
+TEST(SpiderShim, InlineValueChecks) {
+  V8Engine engine;
+
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+  Local<Context> context = Context::New(engine.isolate());
+  Context::Scope context_scope(context);
+
+  Local<Value> minus = engine.CompileRun(context, "-7");
+  EXPECT_TRUE(minus->IsInt32());
+  EXPECT_TRUE(minus->IsNumber());
+  EXPECT_FALSE(minus->IsUint32());
+  EXPECT_EQ(-7, minus->Int32Value(context).FromJust());
+  EXPECT_EQ(static_cast<uint32_t>(-7), minus->Uint32Value(context).FromJust());
+  EXPECT_EQ(-7, minus->IntegerValue(context).FromJust());
+  EXPECT_EQ(-7.0, minus->NumberValue(context).FromJust());
+  EXPECT_TRUE(minus->BooleanValue(context).FromJust());
+
+  // Doubles that happen to be integers are still unsigned 32-bit ints.
+  Local<Value> big = engine.CompileRun(context, "4294967295");
+  EXPECT_FALSE(big->IsInt32());
+  EXPECT_TRUE(big->IsUint32());
+  EXPECT_EQ(4294967295u, big->Uint32Value(context).FromJust());
+  EXPECT_EQ(-1, big->Int32Value(context).FromJust());
+  EXPECT_FALSE(engine.CompileRun(context, "-0")->IsUint32());
+  EXPECT_FALSE(engine.CompileRun(context, "1.5")->IsUint32());
+  EXPECT_TRUE(engine.CompileRun(context, "NaN")->NumberValue(context)
+                  .IsNothing());
+
+  Local<Value> t = engine.CompileRun(context, "true");
+  EXPECT_TRUE(t->IsBoolean());
+  EXPECT_TRUE(t->IsTrue());
+  EXPECT_FALSE(t->IsFalse());
+  EXPECT_FALSE(t->IsNumber());
+  EXPECT_EQ(1, t->Int32Value(context).FromJust());
+
+  Local<Value> undef = engine.CompileRun(context, "undefined");
+  EXPECT_TRUE(undef->IsUndefined());
+  EXPECT_FALSE(undef->IsNull());
+  EXPECT_FALSE(undef->IsObject());
+  EXPECT_FALSE(undef->BooleanValue(context).FromJust());
+  EXPECT_TRUE(engine.CompileRun(context, "null")->IsNull());
+
+  // Conversions that run JS still go through the out-of-line path.
+  EXPECT_EQ(12, engine.CompileRun(context, "'12'")->Int32Value(context)
+                    .FromJust());
+  EXPECT_EQ(3, engine.CompileRun(context, "({ valueOf() { return 3; } })")
+                   ->Uint32Value(context).FromJust());
+  EXPECT_FALSE(engine.CompileRun(context, "''")->BooleanValue(context)
+                   .FromJust());
+
+  EXPECT_TRUE(engine.CompileRun(context, "'x'")->IsString());
+  EXPECT_TRUE(engine.CompileRun(context, "Symbol()")->IsSymbol());
+  EXPECT_TRUE(engine.CompileRun(context, "({})")->IsObject());
+  EXPECT_TRUE(engine.CompileRun(context, "(function() {})")->IsObject());
+  EXPECT_FALSE(engine.CompileRun(context, "'x'")->IsObject());
+}
+
 TEST(SpiderShim, Object) {
   V8Engine engine;
 
@@ -2703,6 +2807,53 @@ TEST(SpiderShim, FunctionNew) {
   CHECK(result4->IsUndefined());
 }
 
+static Local<Context> function_creation_context_expected;
+
+static void FunctionCreationContextCallback(
+    const v8::FunctionCallbackInfo<Value>& info) {
+  Local<Context> current = info.GetIsolate()->GetCurrentContext();
+  CHECK(*current == *function_creation_context_expected);
+  CHECK(*info.Callee()->CreationContext() == *current);
+  info.GetReturnValue().Set(info.Length());
+}
+
+TEST(SpiderShim, FunctionCreationContext) {
+  V8Engine engine;
+
+  Isolate::Scope isolate_scope(engine.isolate());
+
+  HandleScope handle_scope(engine.isolate());
+  Isolate* isolate = engine.isolate();
+  Local<Context> context1 = Context::New(isolate);
+  Local<Context> context2 = Context::New(isolate);
+  function_creation_context_expected = context1;
+
+  Local<Function> func;
+  Local<Function> templFunc;
+  {
+    Context::Scope context_scope(context1);
+    func = Function::New(context1, FunctionCreationContextCallback)
+             .ToLocalChecked();
+    templFunc = FunctionTemplate::New(isolate, FunctionCreationContextCallback)
+                  ->GetFunction(context1).ToLocalChecked();
+    CHECK(context1->Global()->Set(context1, v8_str("f"), func).FromJust());
+    CHECK(context1->Global()->Set(context1, v8_str("g"), templFunc).FromJust());
+    // Calls from within the creation context repeatedly hit the cached context.
+    Local<Value> result = engine.CompileRun(context1, "f(1) + g(1, 2) + f()");
+    CHECK(v8::Integer::New(isolate, 3)->Equals(context1, result).FromJust());
+  }
+  {
+    // Calls from another context still run the callback in the creation one.
+    Context::Scope context_scope(context2);
+    CHECK(context2->Global()->Set(context2, v8_str("f"), func).FromJust());
+    CHECK(context2->Global()->Set(context2, v8_str("g"), templFunc).FromJust());
+    Local<Value> result = engine.CompileRun(context2, "f(1, 2) + g(1)");
+    CHECK(v8::Integer::New(isolate, 3)->Equals(context2, result).FromJust());
+    CHECK(*isolate->GetCurrentContext() == *context2);
+  }
+  function_creation_context_expected.Clear();
+}
+
 static void CallbackReturnNewHandle(const v8::FunctionCallbackInfo<Value>& info) {
   Isolate* isolate = Isolate::GetCurrent();
   HandleScope scope(isolate);
@@ -3782,3 +3933,48 @@ TEST(SpiderShim, PropertyDescriptor) {
     EXPECT_TRUE(!desc.has_writable());
   }
 }
+
+TEST(SpiderShim, ArrayNewWithElements) {
+  V8Engine engine;
+  Isolate* isolate = engine.isolate();
+  Isolate::Scope isolate_scope(isolate);
+
+  HandleScope handle_scope(isolate);
+  Local<Context> context = Context::New(isolate);
+  Context::Scope context_scope(context);
+
+  Local<Array> empty = Array::New(isolate, nullptr, 0);
+  EXPECT_EQ(0u, empty->Length());
+
+  Local<Value> elements[] = { v8_num(1), v8_str("two"), v8::Null(isolate) };
+  Local<Array> array = Array::New(isolate, elements, 3);
+  EXPECT_EQ(3u, array->Length());
+  EXPECT_TRUE(array->IsArray());
+  CHECK(context->Global()->Set(context, v8_str("a"), array).FromJust());
+  EXPECT_TRUE(engine.CompileRun(context,
+      "a[0] === 1 && a[1] === 'two' && a[2] === null && "
+      "Object.getPrototypeOf(a) === Array.prototype")->BooleanValue());
+}
+
+TEST(SpiderShim, ObjectNewWithProperties) {
+  V8Engine engine;
+  Isolate* isolate = engine.isolate();
+  Isolate::Scope isolate_scope(isolate);
+
+  HandleScope handle_scope(isolate);
+  Local<Context> context = Context::New(isolate);
+  Context::Scope context_scope(context);
+
+  Local<Name> names[] = { v8_str("x"), v8_str("y"), v8_str("x") };
+  Local<Value> values[] = { v8_num(1), v8_str("why"), v8_num(3) };
+  Local<Object> obj = Object::New(isolate, v8::Null(isolate), names, values, 3);
+  CHECK(context->Global()->Set(context, v8_str("o"), obj).FromJust());
+  EXPECT_TRUE(engine.CompileRun(context,
+      "Object.getPrototypeOf(o) === null && o.x === 3 && o.y === 'why' && "
+      "Object.keys(o).join() === 'x,y'")->BooleanValue());
+
+  Local<Object> proto = Object::New(isolate);
+  Local<Object> obj2 = Object::New(isolate, proto, nullptr, nullptr, 0);
+  EXPECT_TRUE(obj2->GetPrototype()->StrictEquals(proto));
+  EXPECT_EQ(0u, obj2->GetOwnPropertyNames()->Length());
+}
@@ -30,5 +30,6 @@
 #define UV_PLATFORM_FS_EVENT_FIELDS                                           \
   void* watchers[2];                                                          \
   int wd;                                                                     \
+  void* tree;                                                                 \
 
 #endif /* UV_LINUX_H */
@@ -228,6 +228,7 @@ typedef struct {
   uv_signal_t child_watcher;                                                  \
   int emfile_fd;                                                              \
   UV_PLATFORM_LOOP_FIELDS                                                     \
+  void* internal_fields;                                                      \
 
 #define UV_REQ_TYPE_PRIVATE /* empty */
 
@@ -364,7 +365,9 @@ typedef struct {
     struct uv_signal_s* rbe_parent;                                           \
     int rbe_color;                                                            \
   } tree_entry;                                                               \
-  /* Use two counters here so we don have to fiddle with atomics. */          \
+  /* Value of the process-wide delivery counter for signum that has been      \
+   * dispatched to this handle, and the number of callbacks made so far.      \
+   */                                                                         \
   unsigned int caught_signals;                                                \
   unsigned int dispatched_signals;
 
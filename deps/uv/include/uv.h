@@ -232,8 +232,26 @@ typedef struct uv_interface_address_s uv_interface_address_t;
 typedef struct uv_dirent_s uv_dirent_t;
 typedef struct uv_passwd_s uv_passwd_t;
 
+typedef struct uv_loop_metrics_s uv_loop_metrics_t;
+
 typedef enum {
-  UV_LOOP_BLOCK_SIGNAL
+  UV_LOOP_BLOCK_SIGNAL,
+  /* Linux only: register TCP and non-IPC pipe streams with EPOLLET. */
+  UV_LOOP_EDGE_TRIGGERED,
+  /* Linux only: spin for up to N microseconds (unsigned int argument) with
+   * non-blocking polls before sleeping. 0 turns it off again.
+   */
+  UV_LOOP_BUSY_POLL,
+  /* Keep loop metrics and time each phase of uv_run(), see
+   * uv_loop_metrics_t.
+   */
+  UV_LOOP_MEASURE_TIME,
+  /* Keep timers on a hierarchical timing wheel instead of a binary heap,
+   * making start, stop and again O(1). The unsigned int argument is the
+   * tick in milliseconds; timers fire on the first tick at or after their
+   * timeout. Only while the loop has no active timers.
+   */
+  UV_LOOP_TIMER_WHEEL
 } uv_loop_option;
 
 typedef enum {
@@ -275,6 +293,45 @@ UV_EXTERN size_t uv_loop_size(void);
 UV_EXTERN int uv_loop_alive(const uv_loop_t* loop);
 UV_EXTERN int uv_loop_configure(uv_loop_t* loop, uv_loop_option option, ...);
 
+/*
+ * Lag histogram buckets, in microseconds. Buckets 0-3 count 0-3us exactly.
+ * After that every power of two is split in four: bucket 4 * (e - 1) + s
+ * covers [2^e + s * 2^(e-2), 2^e + (s + 1) * 2^(e-2)). The last bucket
+ * also takes everything above ~16.7s.
+ */
+#define UV_LOOP_LAG_BUCKETS 96
+
+/*
+ * Loop statistics, kept once the loop is configured with
+ * UV_LOOP_MEASURE_TIME; uv_loop_metrics() returns UV_EINVAL before that.
+ * The poller counters are only maintained by the Linux (epoll) backend. The
+ * timings are cumulative nanoseconds; poll_block_time is only measured on
+ * Linux, elsewhere it is part of poll_time. Windows returns UV_ENOSYS.
+ */
+struct uv_loop_metrics_s {
+  uint64_t poll_count;        /* epoll_wait() calls, busy polls included. */
+  uint64_t poll_wakeups;      /* Calls that returned at least one event. */
+  uint64_t events;            /* Events handed to watchers. */
+  uint64_t ctl_count;         /* epoll_ctl() calls. */
+  uint64_t ctl_deferred;      /* Watcher updates that needed no epoll_ctl(). */
+  uint64_t iterations;        /* Timed loop iterations. */
+  uint64_t timers_time;
+  uint64_t pending_time;
+  uint64_t idle_prepare_time;
+  uint64_t poll_block_time;   /* Asleep in the poller, i.e. idle. */
+  uint64_t poll_time;         /* Poll phase minus poll_block_time. */
+  uint64_t check_close_time;
+  /* Per iteration: time not spent asleep in the poller, which is how long
+   * an event may have waited before the loop got around to it. Points at
+   * the loop's own UV_LOOP_LAG_BUCKETS counters, which keep counting; valid
+   * until uv_loop_close().
+   */
+  const uint64_t* lag_histogram;
+};
+
+UV_EXTERN int uv_loop_metrics(const uv_loop_t* loop,
+                              uv_loop_metrics_t* metrics);
+
 UV_EXTERN int uv_run(uv_loop_t*, uv_run_mode mode);
 UV_EXTERN void uv_stop(uv_loop_t*);
 
@@ -500,6 +557,16 @@ UV_EXTERN int uv_is_writable(const uv_stream_t* handle);
 
 UV_EXTERN int uv_stream_set_blocking(uv_stream_t* handle, int blocking);
 
+/*
+ * While a stream is corked, uv_write() only queues the data; nothing is
+ * written until uv_stream_uncork(), which sends everything queued so far
+ * with as few writev() calls as possible. Writes that were already waiting
+ * for the fd to become writable are not held back. On Windows both calls
+ * are no-ops.
+ */
+UV_EXTERN int uv_stream_cork(uv_stream_t* handle);
+UV_EXTERN int uv_stream_uncork(uv_stream_t* handle);
+
 UV_EXTERN int uv_is_closing(const uv_handle_t* handle);
 
 
@@ -1294,7 +1361,9 @@ struct uv_fs_event_s {
 
 
 /*
- * uv_fs_stat() based polling file watcher.
+ * uv_fs_stat() based polling file watcher. On Linux the file is only stat'ed
+ * after inotify reports activity on it or its directory, unless the path is
+ * on a network or pseudo file system.
  */
 struct uv_fs_poll_s {
   UV_HANDLE_FIELDS
@@ -1355,6 +1424,15 @@ enum uv_fs_event_flags {
    * By default, event watcher, when watching directory, is not registering
    * (is ignoring) changes in it's subdirectories.
    * This flag will override this behaviour on platforms that support it.
+   * On Linux, file names are relative to the watched directory and new
+   * subdirectories are picked up as they appear. Every directory in the
+   * tree is read, on the loop thread, when the watch starts and again each
+   * time the kernel drops events, so a large tree blocks the loop for a
+   * while. When the kernel drops events, the callback gets status
+   * UV_ENOBUFS and a NULL file name, and should rescan whatever it keeps
+   * track of.  Watchers started without this
+   * flag get a UV_RENAME | UV_CHANGE event with status 0 and a NULL file name
+   * instead, as a hint that they may have missed something.
    */
   UV_FS_EVENT_RECURSIVE = 4
 };
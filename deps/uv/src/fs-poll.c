@@ -26,6 +26,18 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__linux__)
+# include <sys/vfs.h>
+#endif
+
+/* On Linux the path and its directory are watched with inotify and the
+ * file is only stat'ed after an event, at the next point in time where the
+ * poller would have stat'ed it.  Changes are reported exactly like they
+ * would have been when polling, minus the stat() calls that find nothing.
+ * Paths on file systems where inotify doesn't see every change, like NFS,
+ * or that can't be watched at all, are polled.  The file system is checked
+ * on the threadpool, a hung mount must not block the loop.
+ */
 struct poll_ctx {
   uv_fs_poll_t* parent_handle; /* NULL if parent has been stopped or closed */
   int busy_polling;
@@ -36,13 +48,42 @@ struct poll_ctx {
   uv_timer_t timer_handle;
   uv_fs_t fs_req; /* TODO(bnoordhuis) mark fs_req internal */
   uv_stat_t statbuf;
+  int stat_active;
+  int closing_handles;
+#if defined(__linux__)
+  int watching;
+  int changed;  /* Seen an event while a stat() was in progress. */
+  int rewatch;  /* UV__WATCH_FILE and/or UV__WATCH_DIR. */
+  int probe_active;
+  int probe_supported;  /* Result of the last watch_probe(). */
+  uv_work_t probe_req;
+  uv_fs_event_t file_watcher;
+  uv_fs_event_t dir_watcher;
+  const char* basename;
+  char* dirname;
+#endif
   char path[1]; /* variable length */
 };
 
 static int statbuf_eq(const uv_stat_t* a, const uv_stat_t* b);
+static int poll_stat(struct poll_ctx* ctx);
 static void poll_cb(uv_fs_t* req);
 static void timer_cb(uv_timer_t* timer);
-static void timer_close_cb(uv_handle_t* handle);
+static int poll_ctx_busy(const struct poll_ctx* ctx);
+static void poll_ctx_close(struct poll_ctx* ctx);
+static void poll_ctx_close_cb(uv_handle_t* handle);
+
+#if defined(__linux__)
+enum {
+  UV__WATCH_FILE = 1,
+  UV__WATCH_DIR = 2
+};
+
+static void watch_init(struct poll_ctx* ctx);
+static int watch_probe(struct poll_ctx* ctx);
+static int watch_start(struct poll_ctx* ctx, int which);
+static void watch_rearm(struct poll_ctx* ctx);
+#endif
 
 static uv_stat_t zero_statbuf;
 
@@ -67,7 +108,8 @@ int uv_fs_poll_start(uv_fs_poll_t* handle,
 
   loop = handle->loop;
   len = strlen(path);
-  ctx = uv__calloc(1, sizeof(*ctx) + len);
+  /* Room for the directory name too, which is "." if path has no slash. */
+  ctx = uv__calloc(1, sizeof(*ctx) + 2 * len + 2);
 
   if (ctx == NULL)
     return UV_ENOMEM;
@@ -80,13 +122,28 @@ int uv_fs_poll_start(uv_fs_poll_t* handle,
   memcpy(ctx->path, path, len + 1);
 
   err = uv_timer_init(loop, &ctx->timer_handle);
-  if (err < 0)
-    goto error;
+  if (err < 0) {
+    uv__free(ctx);
+    return err;
+  }
 
   ctx->timer_handle.flags |= UV__HANDLE_INTERNAL;
+  ctx->timer_handle.data = ctx;
   uv__handle_unref(&ctx->timer_handle);
 
-  err = uv_fs_stat(loop, &ctx->fs_req, ctx->path, poll_cb);
+#if defined(__linux__)
+  /* Watch before the first stat() so no change can slip in between.  That
+   * stat() is made once watch_probe() has looked at the file system.
+   */
+  watch_init(ctx);
+  ctx->rewatch = UV__WATCH_DIR | UV__WATCH_FILE;
+  ctx->watching = watch_probe(ctx) == 0;
+  err = 0;
+  if (!ctx->watching)
+    err = poll_stat(ctx);
+#else
+  err = poll_stat(ctx);
+#endif
   if (err < 0)
     goto error;
 
@@ -96,7 +153,8 @@ int uv_fs_poll_start(uv_fs_poll_t* handle,
   return 0;
 
 error:
-  uv__free(ctx);
+  ctx->parent_handle = NULL;
+  poll_ctx_close(ctx);
   return err;
 }
 
@@ -113,11 +171,11 @@ int uv_fs_poll_stop(uv_fs_poll_t* handle) {
   ctx->parent_handle = NULL;
   handle->poll_ctx = NULL;
 
-  /* Close the timer if it's active. If it's inactive, there's a stat request
-   * in progress and poll_cb will take care of the cleanup.
+  /* If there's a stat request in progress, poll_cb will take care of the
+   * cleanup.
    */
-  if (uv__is_active(&ctx->timer_handle))
-    uv_close((uv_handle_t*)&ctx->timer_handle, timer_close_cb);
+  if (!poll_ctx_busy(ctx))
+    poll_ctx_close(ctx);
 
   uv__handle_stop(handle);
 
@@ -156,15 +214,50 @@ void uv__fs_poll_close(uv_fs_poll_t* handle) {
 }
 
 
+/* Whether a request on the threadpool still refers to the context. */
+static int poll_ctx_busy(const struct poll_ctx* ctx) {
+#if defined(__linux__)
+  if (ctx->probe_active)
+    return 1;
+#endif
+  return ctx->stat_active;
+}
+
+
+static int poll_stat(struct poll_ctx* ctx) {
+  int err;
+
+  ctx->start_time = uv_now(ctx->loop);
+  err = uv_fs_stat(ctx->loop, &ctx->fs_req, ctx->path, poll_cb);
+  if (err == 0)
+    ctx->stat_active = 1;
+
+  return err;
+}
+
+
+/* Arms the timer for the next time the path is due to be stat'ed, making
+ * up for the time the last stat() took.
+ */
+static void poll_schedule(struct poll_ctx* ctx) {
+  uint64_t interval;
+
+  interval = ctx->interval;
+  interval -= (uv_now(ctx->loop) - ctx->start_time) % interval;
+
+  if (uv_timer_start(&ctx->timer_handle, timer_cb, interval, 0))
+    abort();
+}
+
+
 static void timer_cb(uv_timer_t* timer) {
   struct poll_ctx* ctx;
 
   ctx = container_of(timer, struct poll_ctx, timer_handle);
   assert(ctx->parent_handle != NULL);
   assert(ctx->parent_handle->poll_ctx == ctx);
-  ctx->start_time = uv_now(ctx->loop);
 
-  if (uv_fs_stat(ctx->loop, &ctx->fs_req, ctx->path, poll_cb))
+  if (poll_stat(ctx))
     abort();
 }
 
@@ -172,12 +265,13 @@ static void timer_cb(uv_timer_t* timer) {
 static void poll_cb(uv_fs_t* req) {
   uv_stat_t* statbuf;
   struct poll_ctx* ctx;
-  uint64_t interval;
 
   ctx = container_of(req, struct poll_ctx, fs_req);
 
   if (ctx->parent_handle == NULL) { /* handle has been stopped or closed */
-    uv_close((uv_handle_t*)&ctx->timer_handle, timer_close_cb);
+    ctx->stat_active = 0;
+    if (!poll_ctx_busy(ctx))
+      poll_ctx_close(ctx);
     uv_fs_req_cleanup(req);
     return;
   }
@@ -195,6 +289,18 @@ static void poll_cb(uv_fs_t* req) {
 
   statbuf = &req->statbuf;
 
+#if defined(__linux__)
+  /* A different file now lives at the path, the file watch has to follow.
+   * The first stat() finds the file that was there when the watch started.
+   */
+  if (ctx->busy_polling < 0 ||
+      (ctx->busy_polling > 0 &&
+       (ctx->statbuf.st_ino != statbuf->st_ino ||
+        ctx->statbuf.st_dev != statbuf->st_dev))) {
+    ctx->rewatch |= UV__WATCH_FILE;
+  }
+#endif
+
   if (ctx->busy_polling != 0)
     if (ctx->busy_polling < 0 || !statbuf_eq(&ctx->statbuf, statbuf))
       ctx->poll_cb(ctx->parent_handle, 0, &ctx->statbuf, statbuf);
@@ -204,26 +310,326 @@ static void poll_cb(uv_fs_t* req) {
 
 out:
   uv_fs_req_cleanup(req);
+  ctx->stat_active = 0;
 
   if (ctx->parent_handle == NULL) { /* handle has been stopped by callback */
-    uv_close((uv_handle_t*)&ctx->timer_handle, timer_close_cb);
+    if (!poll_ctx_busy(ctx))
+      poll_ctx_close(ctx);
     return;
   }
 
-  /* Reschedule timer, subtract the delay from doing the stat(). */
-  interval = ctx->interval;
-  interval -= (uv_now(ctx->loop) - ctx->start_time) % interval;
+#if defined(__linux__)
+  if (ctx->watching) {
+    /* Sleep until inotify reports the next change. */
+    watch_rearm(ctx);
+    if (ctx->watching)
+      return;
+  }
+#endif
 
-  if (uv_timer_start(&ctx->timer_handle, timer_cb, interval, 0))
-    abort();
+  poll_schedule(ctx);
+}
+
+
+static void poll_ctx_close(struct poll_ctx* ctx) {
+  ctx->closing_handles = 1;
+  uv_close((uv_handle_t*)&ctx->timer_handle, poll_ctx_close_cb);
+#if defined(__linux__)
+  ctx->closing_handles += 2;
+  uv_close((uv_handle_t*)&ctx->file_watcher, poll_ctx_close_cb);
+  uv_close((uv_handle_t*)&ctx->dir_watcher, poll_ctx_close_cb);
+#endif
+}
+
+
+static void poll_ctx_close_cb(uv_handle_t* handle) {
+  struct poll_ctx* ctx;
+
+  ctx = handle->data;
+  if (--ctx->closing_handles == 0)
+    uv__free(ctx);
+}
+
+
+#if defined(__linux__)
+
+/* File systems that accept inotify watches but don't report all changes,
+ * typically because they can happen on another machine.
+ */
+static int watch_supported(const char* path) {
+  struct statfs s;
+
+  if (statfs(path, &s))
+    return 0;
+
+  switch ((unsigned int) s.f_type) {
+  case 0x00C36400:  /* CEPH_SUPER_MAGIC */
+  case 0x01021997:  /* V9FS_MAGIC */
+  case 0x0BD00BD0:  /* LL_SUPER_MAGIC (Lustre) */
+  case 0x01161970:  /* GFS2_MAGIC */
+  case 0x517B:      /* SMB_SUPER_MAGIC */
+  case 0x5346414F:  /* AFS_SUPER_MAGIC */
+  case 0x6969:      /* NFS_SUPER_MAGIC */
+  case 0x65735546:  /* FUSE_SUPER_MAGIC */
+  case 0x73757245:  /* CODA_SUPER_MAGIC */
+  case 0x7461636F:  /* OCFS2_SUPER_MAGIC */
+  case 0x9FA0:      /* PROC_SUPER_MAGIC */
+  case 0x62656572:  /* SYSFS_MAGIC */
+  case 0xFE534D42:  /* SMB2_MAGIC_NUMBER */
+  case 0xFF534D42:  /* CIFS_MAGIC_NUMBER */
+    return 0;
+  }
+
+  return 1;
+}
+
+
+/* Called for every event on the file or its directory.  Only remembers that
+ * the file needs to be stat'ed when the poller would have done so next.
+ */
+static void watch_changed(struct poll_ctx* ctx) {
+  if (ctx->parent_handle == NULL)
+    return;
+
+  /* poll_cb arms the timer when the stat() in progress is done. */
+  if (ctx->stat_active) {
+    ctx->changed = 1;
+    return;
+  }
+
+  if (!uv__is_active(&ctx->timer_handle))
+    poll_schedule(ctx);
+}
+
+
+static void file_watcher_cb(uv_fs_event_t* handle,
+                            const char* filename,
+                            int events,
+                            int status) {
+  watch_changed(handle->data);
+}
+
+
+static void dir_watcher_cb(uv_fs_event_t* handle,
+                           const char* filename,
+                           int events,
+                           int status) {
+  struct poll_ctx* ctx;
+  const char* self;
+
+  ctx = handle->data;
+
+  /* The kernel dropped events, any of them could have been for the file or
+   * the directory itself.
+   */
+  if (filename == NULL) {
+    ctx->rewatch |= UV__WATCH_DIR;
+    watch_changed(ctx);
+    return;
+  }
+
+  /* Events on the directory itself come with its own name.  When it's
+   * renamed or deleted, the path may resolve to a different directory.
+   */
+  self = strrchr(handle->path, '/');
+  self = self ? self + 1 : handle->path;
+  if (strcmp(filename, self) == 0) {
+    ctx->rewatch |= UV__WATCH_DIR;
+    watch_changed(ctx);
+    return;
+  }
+
+  if (strcmp(filename, ctx->basename) == 0)
+    watch_changed(ctx);
+}
+
+
+static void watch_init(struct poll_ctx* ctx) {
+  char* slash;
+
+  uv_fs_event_init(ctx->loop, &ctx->file_watcher);
+  uv_fs_event_init(ctx->loop, &ctx->dir_watcher);
+  ctx->file_watcher.flags |= UV__HANDLE_INTERNAL;
+  ctx->dir_watcher.flags |= UV__HANDLE_INTERNAL;
+  ctx->file_watcher.data = ctx;
+  ctx->dir_watcher.data = ctx;
+
+  ctx->dirname = ctx->path + strlen(ctx->path) + 1;
+  slash = strrchr(ctx->path, '/');
+  if (slash == NULL) {
+    strcpy(ctx->dirname, ".");
+    ctx->basename = ctx->path;
+  } else if (slash == ctx->path) {
+    strcpy(ctx->dirname, "/");
+    ctx->basename = slash + 1;
+  } else {
+    memcpy(ctx->dirname, ctx->path, slash - ctx->path);
+    ctx->dirname[slash - ctx->path] = '\0';
+    ctx->basename = slash + 1;
+  }
+}
+
+
+static void watch_probe_work(uv_work_t* req) {
+  struct poll_ctx* ctx;
+
+  ctx = container_of(req, struct poll_ctx, probe_req);
+  ctx->probe_supported = watch_supported(ctx->dirname);
 }
 
 
-static void timer_close_cb(uv_handle_t* handle) {
-  uv__free(container_of(handle, struct poll_ctx, timer_handle));
+/* Starts the watches that watch_probe() was queued for and takes over from
+ * there: makes the first stat(), or schedules the next one.
+ */
+static void watch_probe_done(uv_work_t* req, int status) {
+  struct poll_ctx* ctx;
+  int which;
+
+  ctx = container_of(req, struct poll_ctx, probe_req);
+  ctx->probe_active = 0;
+
+  if (ctx->parent_handle == NULL) { /* handle has been stopped or closed */
+    if (!poll_ctx_busy(ctx))
+      poll_ctx_close(ctx);
+    return;
+  }
+
+  which = ctx->rewatch;
+  ctx->rewatch = 0;
+  if (status != 0)
+    ctx->probe_supported = 0;
+
+  if (watch_start(ctx, which) != 0) {
+    uv_fs_event_stop(&ctx->file_watcher);
+    uv_fs_event_stop(&ctx->dir_watcher);
+    ctx->watching = 0;
+  }
+
+  /* poll_cb takes it from here, with another look to be safe. */
+  if (ctx->stat_active) {
+    ctx->changed = 1;
+    return;
+  }
+
+  if (ctx->busy_polling == 0) {
+    if (poll_stat(ctx))
+      abort();
+    return;
+  }
+
+  /* Look again once more, the file may have changed before it was watched.
+   * That is also the first stat() when falling back to polling.
+   */
+  ctx->changed = 0;
+  poll_schedule(ctx);
 }
 
 
+/* Checks on the threadpool whether the directory's file system can be
+ * watched; watch_probe_done() continues with ctx->rewatch.
+ */
+static int watch_probe(struct poll_ctx* ctx) {
+  int err;
+
+  err = uv_queue_work(ctx->loop,
+                      &ctx->probe_req,
+                      watch_probe_work,
+                      watch_probe_done);
+  if (err == 0)
+    ctx->probe_active = 1;
+
+  return err;
+}
+
+
+/* (Re)starts the directory and/or file watch.  Stopping a watch drops the
+ * events that are still queued for it, so only the ones that point at the
+ * wrong inode are restarted.
+ */
+static int watch_start(struct poll_ctx* ctx, int which) {
+  int err;
+
+  if (which & UV__WATCH_DIR) {
+    uv_fs_event_stop(&ctx->dir_watcher);
+
+    if (*ctx->basename == '\0' || !ctx->probe_supported)
+      return UV_ENOTSUP;
+
+    /* The directory watch sees the file being created, deleted or replaced.
+     * Without it there is no way to tell when to look at the path again.
+     */
+    err = uv_fs_event_start(&ctx->dir_watcher,
+                            dir_watcher_cb,
+                            ctx->dirname,
+                            0);
+    if (err)
+      return err;
+    uv__handle_unref(&ctx->dir_watcher);
+  }
+
+  /* Also watch the file, changes made through a hard link elsewhere don't
+   * show up in this directory.  Fine if it doesn't exist (yet).
+   */
+  if (which & UV__WATCH_FILE) {
+    uv_fs_event_stop(&ctx->file_watcher);
+    if (uv_fs_event_start(&ctx->file_watcher,
+                          file_watcher_cb,
+                          ctx->path,
+                          0) == 0) {
+      uv__handle_unref(&ctx->file_watcher);
+    }
+  }
+
+  return 0;
+}
+
+
+/* Called after each stat() while watching.  Points the watches at whatever
+ * the path resolves to now and schedules another stat() if something
+ * changed in the meantime.  Falls back to polling when the path can't be
+ * watched anymore.
+ */
+static void watch_rearm(struct poll_ctx* ctx) {
+  int which;
+
+  /* watch_probe_done() picks up ctx->rewatch. */
+  if (ctx->probe_active)
+    return;
+
+  /* The directory may be on another file system now, check it first. */
+  if (ctx->rewatch & UV__WATCH_DIR) {
+    if (watch_probe(ctx) == 0)
+      return;
+    ctx->rewatch = 0;
+    uv_fs_event_stop(&ctx->file_watcher);
+    uv_fs_event_stop(&ctx->dir_watcher);
+    ctx->watching = 0;
+    return;
+  }
+
+  which = ctx->rewatch;
+  ctx->rewatch = 0;
+
+  if (which != 0 && watch_start(ctx, which) != 0) {
+    uv_fs_event_stop(&ctx->file_watcher);
+    uv_fs_event_stop(&ctx->dir_watcher);
+    ctx->watching = 0;
+    return;
+  }
+
+  /* Look again once more, the file may have changed before it was watched. */
+  if (which != 0)
+    ctx->changed = 1;
+
+  if (ctx->changed) {
+    ctx->changed = 0;
+    poll_schedule(ctx);
+  }
+}
+
+#endif  /* defined(__linux__) */
+
+
 static int statbuf_eq(const uv_stat_t* a, const uv_stat_t* b) {
   return a->st_ctim.tv_nsec == b->st_ctim.tv_nsec
       && a->st_mtim.tv_nsec == b->st_mtim.tv_nsec
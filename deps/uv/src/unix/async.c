@@ -36,7 +36,6 @@
 static void uv__async_event(uv_loop_t* loop,
                             struct uv__async* w,
                             unsigned int nevents);
-static int uv__async_eventfd(void);
 
 
 int uv_async_init(uv_loop_t* loop, uv_async_t* handle, uv_async_cb async_cb) {
@@ -247,7 +246,7 @@ void uv__async_stop(uv_loop_t* loop, struct uv__async* wa) {
 }
 
 
-static int uv__async_eventfd() {
+int uv__async_eventfd(void) {
 #if defined(__linux__)
   static int no_eventfd2;
   static int no_eventfd;
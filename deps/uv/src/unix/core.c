@@ -158,9 +158,7 @@ void uv_close(uv_handle_t* handle, uv_close_cb close_cb) {
 
   case UV_SIGNAL:
     uv__signal_close((uv_signal_t*) handle);
-    /* Signal handles may not be closed immediately. The signal code will */
-    /* itself close uv__make_close_pending whenever appropriate. */
-    return;
+    break;
 
   default:
     assert(0);
@@ -329,29 +327,91 @@ int uv_loop_alive(const uv_loop_t* loop) {
 }
 
 
+/* See the comment for UV_LOOP_LAG_BUCKETS in uv.h. */
+static unsigned int uv__lag_bucket(uint64_t usec) {
+  unsigned int bucket;
+  unsigned int e;
+
+  if (usec < 4)
+    return usec;
+
+  for (e = 2; e < 63 && (usec >> (e + 1)) != 0; e++);
+
+  bucket = 4 * (e - 1) + ((usec >> (e - 2)) & 3);
+  if (bucket >= UV_LOOP_LAG_BUCKETS)
+    bucket = UV_LOOP_LAG_BUCKETS - 1;
+
+  return bucket;
+}
+
+
+/* Charges the time since |*stamp| to |*counter| and moves |*stamp| on. */
+static void uv__metrics_phase(uint64_t* stamp, uint64_t* counter) {
+  uint64_t now;
+
+  now = uv__hrtime(UV_CLOCK_PRECISE);
+  *counter += now - *stamp;
+  *stamp = now;
+}
+
+
 int uv_run(uv_loop_t* loop, uv_run_mode mode) {
+  uv_loop_metrics_t* metrics;
+  uint64_t iteration_start;
+  uint64_t blocked;
+  uint64_t stamp;
   int timeout;
+  int timed;
   int r;
   int ran_pending;
 
+  metrics = NULL;
+  iteration_start = 0;
+  blocked = 0;
+  stamp = 0;
   r = uv__loop_alive(loop);
   if (!r)
     uv__update_time(loop);
 
   while (r != 0 && loop->stop_flag == 0) {
+    timed = loop->flags & UV_LOOP_TIMED;
+    if (timed) {
+      metrics = &uv__get_internal_fields(loop)->metrics;
+      stamp = uv__hrtime(UV_CLOCK_PRECISE);
+      iteration_start = stamp;
+    }
+
     uv__update_time(loop);
     uv__run_timers(loop);
+    if (timed)
+      uv__metrics_phase(&stamp, &metrics->timers_time);
+
     ran_pending = uv__run_pending(loop);
+    if (timed)
+      uv__metrics_phase(&stamp, &metrics->pending_time);
+
     uv__run_idle(loop);
     uv__run_prepare(loop);
+    if (timed)
+      uv__metrics_phase(&stamp, &metrics->idle_prepare_time);
 
     timeout = 0;
     if ((mode == UV_RUN_ONCE && !ran_pending) || mode == UV_RUN_DEFAULT)
       timeout = uv_backend_timeout(loop);
 
+    if (timed)
+      blocked = metrics->poll_block_time;
     uv__io_poll(loop, timeout);
+    if (timed) {
+      blocked = metrics->poll_block_time - blocked;
+      uv__metrics_phase(&stamp, &metrics->poll_time);
+      metrics->poll_time -= blocked;
+    }
+
     uv__run_check(loop);
     uv__run_closing_handles(loop);
+    if (timed)
+      uv__metrics_phase(&stamp, &metrics->check_close_time);
 
     if (mode == UV_RUN_ONCE) {
       /* UV_RUN_ONCE implies forward progress: at least one callback must have
@@ -364,6 +424,14 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
        */
       uv__update_time(loop);
       uv__run_timers(loop);
+      if (timed)
+        uv__metrics_phase(&stamp, &metrics->timers_time);
+    }
+
+    if (timed) {
+      metrics->iterations++;
+      uv__get_internal_fields(loop)->lag_histogram[
+          uv__lag_bucket((stamp - iteration_start - blocked) / 1000)]++;
     }
 
     r = uv__loop_alive(loop);
@@ -899,6 +967,16 @@ void uv__io_close(uv_loop_t* loop, uv__io_t* w) {
 }
 
 
+/* Make the backend look at the watcher again on the next poll even though
+ * its event mask did not change.  Edge-triggered watchers need this when
+ * they stop consuming input before the kernel said EAGAIN.
+ */
+void uv__io_rearm(uv_loop_t* loop, uv__io_t* w) {
+  if (w->pevents != 0 && QUEUE_EMPTY(&w->watcher_queue))
+    QUEUE_INSERT_TAIL(&loop->watcher_queue, &w->watcher_queue);
+}
+
+
 void uv__io_feed(uv_loop_t* loop, uv__io_t* w) {
   if (QUEUE_EMPTY(&w->pending_queue))
     QUEUE_INSERT_TAIL(&loop->pending_queue, &w->pending_queue);
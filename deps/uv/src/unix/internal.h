@@ -137,14 +137,41 @@ enum {
   UV_TCP_SINGLE_ACCEPT    = 0x1000, /* Only accept() when idle. */
   UV_HANDLE_IPV6          = 0x10000, /* Handle is bound to a IPv6 socket. */
   UV_UDP_PROCESSING       = 0x20000, /* Handle is running the send callback queue. */
-  UV_HANDLE_BOUND         = 0x40000  /* Handle is bound to an address and port */
+  UV_HANDLE_BOUND         = 0x40000, /* Handle is bound to an address and port */
+  UV_STREAM_CORKED        = 0x80000  /* uv_stream_cork() called. */
 };
 
 /* loop flags */
 enum {
-  UV_LOOP_BLOCK_SIGPROF = 1
+  UV_LOOP_BLOCK_SIGPROF = 1,
+  UV_LOOP_EPOLLET = 2,
+  UV_LOOP_TIMED = 4
 };
 
+/* Loop state that only some loops need. Allocated by uv_loop_configure() so
+ * that it doesn't take up room in every uv_loop_t.
+ */
+typedef struct uv__loop_internal_fields_s uv__loop_internal_fields_t;
+
+struct uv__loop_internal_fields_s {
+  uint64_t busy_poll_timeout;  /* Nanoseconds, 0 when off. */
+  struct uv__timer_wheel* timer_wheel;  /* See timer.c, NULL for the heap. */
+  uv_loop_metrics_t metrics;   /* Kept while UV_LOOP_TIMED is set. */
+  uint64_t lag_histogram[UV_LOOP_LAG_BUCKETS];
+};
+
+#define uv__get_internal_fields(loop)                                         \
+  ((uv__loop_internal_fields_t*) (loop)->internal_fields)
+
+uv__loop_internal_fields_t* uv__loop_alloc_internal_fields(uv_loop_t* loop);
+
+#define uv__metrics_add(loop, field, n)                                       \
+  do {                                                                        \
+    if ((loop)->flags & UV_LOOP_TIMED)                                        \
+      uv__get_internal_fields(loop)->metrics.field += (n);                    \
+  }                                                                           \
+  while (0)
+
 typedef enum {
   UV_CLOCK_PRECISE = 0,  /* Use the highest resolution clock available. */
   UV_CLOCK_FAST = 1      /* Use the fastest clock with <= 1ms granularity. */
@@ -188,6 +215,7 @@ void uv__io_start(uv_loop_t* loop, uv__io_t* w, unsigned int events);
 void uv__io_stop(uv_loop_t* loop, uv__io_t* w, unsigned int events);
 void uv__io_close(uv_loop_t* loop, uv__io_t* w);
 void uv__io_feed(uv_loop_t* loop, uv__io_t* w);
+void uv__io_rearm(uv_loop_t* loop, uv__io_t* w);
 int uv__io_active(const uv__io_t* w, unsigned int events);
 int uv__io_check_fd(uv_loop_t* loop, int fd);
 void uv__io_poll(uv_loop_t* loop, int timeout); /* in milliseconds or -1 */
@@ -197,6 +225,7 @@ void uv__async_send(struct uv__async* wa);
 void uv__async_init(struct uv__async* wa);
 int uv__async_start(uv_loop_t* loop, struct uv__async* wa, uv__async_cb cb);
 void uv__async_stop(uv_loop_t* loop, struct uv__async* wa);
+int uv__async_eventfd(void);
 
 /* loop */
 void uv__run_idle(uv_loop_t* loop);
@@ -208,6 +237,7 @@ void uv__stream_init(uv_loop_t* loop, uv_stream_t* stream,
     uv_handle_type type);
 int uv__stream_open(uv_stream_t*, int fd, int flags);
 void uv__stream_destroy(uv_stream_t* stream);
+int uv__stream_edge_triggered(uv__io_t* w);
 #if defined(__APPLE__)
 int uv__stream_try_select(uv_stream_t* stream, int* fd);
 #endif /* defined(__APPLE__) */
@@ -227,6 +257,8 @@ int uv_pipe_listen(uv_pipe_t* handle, int backlog, uv_connection_cb cb);
 /* timer */
 void uv__run_timers(uv_loop_t* loop);
 int uv__next_timeout(const uv_loop_t* loop);
+int uv__timer_wheel_init(uv_loop_t* loop, unsigned int granularity);
+void uv__timer_wheel_free(uv_loop_t* loop);
 
 /* signal */
 void uv__signal_close(uv_signal_t* handle);
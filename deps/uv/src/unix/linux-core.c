@@ -138,6 +138,7 @@ void uv__platform_invalidate_fd(uv_loop_t* loop, int fd) {
    * We pass in a dummy epoll_event, to work around a bug in old kernels.
    */
   if (loop->backend_fd >= 0) {
+    uv__metrics_add(loop, ctl_count, 1);
     /* Work around a bug in kernels 3.10 to 3.19 where passing a struct that
      * has the EPOLLWAKEUP flag set generates spurious audit syslog warnings.
      */
@@ -182,6 +183,10 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   struct uv__epoll_event events[1024];
   struct uv__epoll_event* pe;
   struct uv__epoll_event e;
+  uv__loop_internal_fields_t* fields;
+  uint64_t busy_until;
+  uint64_t wait_start;
+  int poll_timeout;
   int real_timeout;
   QUEUE* q;
   uv__io_t* w;
@@ -214,14 +219,30 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     e.events = w->pevents;
     e.data = w->fd;
 
+    if (uv__stream_edge_triggered(w)) {
+      /* Always go through epoll_ctl(): the MOD is what rearms the watcher
+       * after uv__read() stopped short of EAGAIN.
+       */
+      e.events |= UV__EPOLLET;
+    } else if (w->events != 0 &&
+               (w->pevents & ~w->events) == 0 &&
+               (w->events & ~w->pevents & POLLOUT) == 0) {
+      /* The watcher lost read interest but gained nothing.  Leave the
+       * registration alone and squelch the events after epoll_wait(); a
+       * uv_read_stop() is often followed by a uv_read_start() before the
+       * fd becomes readable again.  POLLOUT is excluded because a socket
+       * is nearly always writable, so deferring would buy a wakeup.
+       */
+      uv__metrics_add(loop, ctl_deferred, 1);
+      continue;
+    }
+
     if (w->events == 0)
       op = UV__EPOLL_CTL_ADD;
     else
       op = UV__EPOLL_CTL_MOD;
 
-    /* XXX Future optimization: do EPOLL_CTL_MOD lazily if we stop watching
-     * events, skip the syscall and squelch the events after epoll_wait().
-     */
+    uv__metrics_add(loop, ctl_count, 1);
     if (uv__epoll_ctl(loop->backend_fd, op, w->fd, &e)) {
       if (errno != EEXIST)
         abort();
@@ -229,6 +250,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       assert(op == UV__EPOLL_CTL_ADD);
 
       /* We've reactivated a file descriptor that's been watched before. */
+      uv__metrics_add(loop, ctl_count, 1);
       if (uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_MOD, w->fd, &e))
         abort();
     }
@@ -248,6 +270,19 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   count = 48; /* Benchmarks suggest this gives the best throughput. */
   real_timeout = timeout;
 
+  /* Spin with non-blocking polls for up to busy_poll_timeout nanoseconds
+   * before going to sleep.  Trades CPU time for wakeup latency.
+   */
+  wait_start = 0;
+  busy_until = 0;
+  fields = uv__get_internal_fields(loop);
+  if (fields != NULL && fields->busy_poll_timeout != 0 && timeout != 0) {
+    busy_until = fields->busy_poll_timeout;
+    if (timeout > 0 && (uint64_t) timeout * 1000000 < busy_until)
+      busy_until = (uint64_t) timeout * 1000000;
+    busy_until += uv__hrtime(UV_CLOCK_PRECISE);
+  }
+
   for (;;) {
     /* See the comment for max_safe_timeout for an explanation of why
      * this is necessary.  Executive summary: kernel bug workaround.
@@ -255,15 +290,34 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     if (sizeof(int32_t) == sizeof(long) && timeout >= max_safe_timeout)
       timeout = max_safe_timeout;
 
+    poll_timeout = timeout;
+    if (busy_until != 0 && timeout != 0) {
+      if (uv__hrtime(UV_CLOCK_PRECISE) < busy_until) {
+        poll_timeout = 0;
+      } else {
+        /* Done spinning, block for whatever is left of the timeout. */
+        busy_until = 0;
+        if (timeout > 0) {
+          timeout = real_timeout - (int) (loop->time - base);
+          if (timeout <= 0)
+            return;
+          poll_timeout = timeout;
+        }
+      }
+    }
+
     if (sigmask != 0 && no_epoll_pwait != 0)
       if (pthread_sigmask(SIG_BLOCK, &sigset, NULL))
         abort();
 
+    if (loop->flags & UV_LOOP_TIMED)
+      wait_start = uv__hrtime(UV_CLOCK_PRECISE);
+
     if (no_epoll_wait != 0 || (sigmask != 0 && no_epoll_pwait == 0)) {
       nfds = uv__epoll_pwait(loop->backend_fd,
                              events,
                              ARRAY_SIZE(events),
-                             timeout,
+                             poll_timeout,
                              sigmask);
       if (nfds == -1 && errno == ENOSYS)
         no_epoll_pwait = 1;
@@ -271,11 +325,15 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       nfds = uv__epoll_wait(loop->backend_fd,
                             events,
                             ARRAY_SIZE(events),
-                            timeout);
+                            poll_timeout);
       if (nfds == -1 && errno == ENOSYS)
         no_epoll_wait = 1;
     }
 
+    if (loop->flags & UV_LOOP_TIMED)
+      SAVE_ERRNO(uv__get_internal_fields(loop)->metrics.poll_block_time +=
+                     uv__hrtime(UV_CLOCK_PRECISE) - wait_start);
+
     if (sigmask != 0 && no_epoll_pwait != 0)
       if (pthread_sigmask(SIG_UNBLOCK, &sigset, NULL))
         abort();
@@ -286,12 +344,17 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
      */
     SAVE_ERRNO(uv__update_time(loop));
 
-    if (nfds == 0) {
-      assert(timeout != -1);
+    uv__metrics_add(loop, poll_count, 1);
 
+    if (nfds == 0) {
       if (timeout == 0)
         return;
 
+      if (poll_timeout == 0)
+        continue;  /* Still busy polling. */
+
+      assert(timeout != -1);
+
       /* We may have been inside the system call for longer than |timeout|
        * milliseconds so we need to update the timestamp to avoid drift.
        */
@@ -343,10 +406,23 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
          * Ignore all errors because we may be racing with another thread
          * when the file descriptor is closed.
          */
+        uv__metrics_add(loop, ctl_count, 1);
         uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_DEL, fd, pe);
         continue;
       }
 
+      /* An event for interest that was dropped without an epoll_ctl(), see
+       * above.  Narrow the registration now that it has cost us a wakeup.
+       */
+      if (pe->events & (w->events & ~w->pevents)) {
+        e.events = w->pevents;
+        e.data = fd;
+        uv__metrics_add(loop, ctl_count, 1);
+        if (uv__epoll_ctl(loop->backend_fd, UV__EPOLL_CTL_MOD, fd, &e))
+          abort();
+        w->events = w->pevents;
+      }
+
       /* Give users only events they're interested in. Prevents spurious
        * callbacks when previous callback invocation in this loop has stopped
        * the current watcher. Also, filters out events that users has not
@@ -388,6 +464,9 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     if (have_signals != 0)
       loop->signal_io_watcher.cb(loop, &loop->signal_io_watcher, POLLIN);
 
+    uv__metrics_add(loop, poll_wakeups, 1);
+    uv__metrics_add(loop, events, nevents);
+
     loop->watchers[loop->nwatchers] = NULL;
     loop->watchers[loop->nwatchers + 1] = NULL;
 
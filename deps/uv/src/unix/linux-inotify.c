@@ -29,17 +29,50 @@
 #include <assert.h>
 #include <errno.h>
 
+#include <dirent.h>
+#include <limits.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#ifndef PATH_MAX
+# define PATH_MAX 4096
+#endif
+
 struct watcher_list {
   RB_ENTRY(watcher_list) entry;
   QUEUE watchers;
+  QUEUE nodes;
   int iterating;
   char* path;
   int wd;
 };
 
+/* UV_FS_EVENT_RECURSIVE handles keep a trie of the directories below the
+ * watched path, one node per directory.  A node sits in the watcher_list of
+ * its directory's watch descriptor, next to the plain handles, so a single
+ * inotify instance serves any mix of plain and recursive watchers.  Event
+ * file names are made relative to the watched path by walking up the trie.
+ */
+struct watcher_node {
+  QUEUE member;  /* In watcher_list.nodes. */
+  QUEUE children;
+  QUEUE sibling;
+  struct watcher_node* parent;
+  struct watcher_list* list;
+  uv_fs_event_t* handle;
+  char name[1];  /* Relative to the parent, "" for the root. */
+};
+
+#define UV__INOTIFY_EVENTS (UV__IN_ATTRIB                                     \
+                           | UV__IN_CREATE                                    \
+                           | UV__IN_MODIFY                                    \
+                           | UV__IN_DELETE                                    \
+                           | UV__IN_DELETE_SELF                               \
+                           | UV__IN_MOVE_SELF                                 \
+                           | UV__IN_MOVED_FROM                                \
+                           | UV__IN_MOVED_TO)
+
 struct watcher_root {
   struct watcher_list* rbh_root;
 };
@@ -114,9 +147,45 @@ static struct watcher_list* find_watcher(uv_loop_t* loop, int wd) {
   return RB_FIND(watcher_root, CAST(&loop->inotify_watchers), &w);
 }
 
+static struct watcher_list* add_watcher(uv_loop_t* loop,
+                                        const char* path,
+                                        uint32_t events,
+                                        int* wd_out) {
+  struct watcher_list* w;
+  int wd;
+
+  wd = uv__inotify_add_watch(loop->inotify_fd, path, events);
+  if (wd == -1) {
+    *wd_out = -errno;
+    return NULL;
+  }
+
+  *wd_out = wd;
+  w = find_watcher(loop, wd);
+  if (w != NULL)
+    return w;
+
+  w = uv__malloc(sizeof(*w) + strlen(path) + 1);
+  if (w == NULL) {
+    *wd_out = -ENOMEM;
+    return NULL;
+  }
+
+  w->wd = wd;
+  w->path = strcpy((char*)(w + 1), path);
+  QUEUE_INIT(&w->watchers);
+  QUEUE_INIT(&w->nodes);
+  w->iterating = 0;
+  RB_INSERT(watcher_root, CAST(&loop->inotify_watchers), w);
+
+  return w;
+}
+
 static void maybe_free_watcher_list(struct watcher_list* w, uv_loop_t* loop) {
   /* if the watcher_list->watchers is being iterated over, we can't free it. */
-  if ((!w->iterating) && QUEUE_EMPTY(&w->watchers)) {
+  if ((!w->iterating) &&
+      QUEUE_EMPTY(&w->watchers) &&
+      QUEUE_EMPTY(&w->nodes)) {
     /* No watchers left for this path. Clean up. */
     RB_REMOVE(watcher_root, CAST(&loop->inotify_watchers), w);
     uv__inotify_rm_watch(loop->inotify_fd, w->wd);
@@ -124,6 +193,326 @@ static void maybe_free_watcher_list(struct watcher_list* w, uv_loop_t* loop) {
   }
 }
 
+/* Writes the path of |node| relative to the watched path, followed by
+ * "/name" if |name| is not NULL, to |buf|.  Returns the length or -1 if it
+ * doesn't fit.
+ */
+static int node_path(const struct watcher_node* node,
+                     const char* name,
+                     char* buf,
+                     size_t size) {
+  size_t len;
+  size_t n;
+  int r;
+
+  len = 0;
+  if (node->parent != NULL) {
+    r = node_path(node->parent, node->name, buf, size);
+    if (r < 0)
+      return -1;
+    len = r;
+  }
+
+  if (name == NULL) {
+    if (len + 1 > size)
+      return -1;
+    buf[len] = '\0';
+    return len;
+  }
+
+  n = strlen(name);
+  if (len + (len != 0) + n + 1 > size)
+    return -1;
+
+  if (len != 0)
+    buf[len++] = '/';
+  memcpy(buf + len, name, n + 1);
+
+  return len + n;
+}
+
+
+static struct watcher_node* find_child(struct watcher_node* node,
+                                       const char* name) {
+  struct watcher_node* child;
+  QUEUE* q;
+
+  QUEUE_FOREACH(q, &node->children) {
+    child = QUEUE_DATA(q, struct watcher_node, sibling);
+    if (strcmp(child->name, name) == 0)
+      return child;
+  }
+
+  return NULL;
+}
+
+
+static void remove_node(uv_loop_t* loop, struct watcher_node* node) {
+  struct watcher_node* child;
+
+  while (!QUEUE_EMPTY(&node->children)) {
+    child = QUEUE_DATA(QUEUE_HEAD(&node->children),
+                       struct watcher_node,
+                       sibling);
+    remove_node(loop, child);
+  }
+
+  if (node->parent != NULL)
+    QUEUE_REMOVE(&node->sibling);
+  QUEUE_REMOVE(&node->member);
+  maybe_free_watcher_list(node->list, loop);
+  uv__free(node);
+}
+
+
+/* Watches the directory at |path| and hangs it off |parent| as |name|.
+ * Returns NULL with *err set to 0 when there is nothing to watch: it's gone
+ * already, isn't a directory or is part of the tree elsewhere (bind mounts).
+ */
+static struct watcher_node* add_node(uv_fs_event_t* handle,
+                                     struct watcher_node* parent,
+                                     const char* name,
+                                     const char* path,
+                                     int* err) {
+  struct watcher_node* node;
+  struct watcher_list* w;
+  uint32_t events;
+  QUEUE* q;
+  int wd;
+
+  events = UV__INOTIFY_EVENTS;
+  if (parent != NULL)
+    events |= UV__IN_ONLYDIR | UV__IN_DONT_FOLLOW;
+
+  *err = 0;
+  w = add_watcher(handle->loop, path, events, &wd);
+  if (w == NULL) {
+    if (parent != NULL && (wd == -ENOENT || wd == -ENOTDIR || wd == -EACCES))
+      return NULL;
+    *err = wd;
+    return NULL;
+  }
+
+  QUEUE_FOREACH(q, &w->nodes)
+    if (QUEUE_DATA(q, struct watcher_node, member)->handle == handle)
+      return NULL;
+
+  node = uv__malloc(sizeof(*node) + strlen(name));
+  if (node == NULL) {
+    maybe_free_watcher_list(w, handle->loop);
+    *err = -ENOMEM;
+    return NULL;
+  }
+
+  strcpy(node->name, name);
+  node->parent = parent;
+  node->list = w;
+  node->handle = handle;
+  QUEUE_INIT(&node->children);
+  QUEUE_INSERT_TAIL(&w->nodes, &node->member);
+  if (parent != NULL)
+    QUEUE_INSERT_TAIL(&parent->children, &node->sibling);
+
+  return node;
+}
+
+
+/* Adds the directories below |node| that aren't in the trie yet, which is
+ * all of them for a new node.  Directories that disappear halfway are
+ * skipped, the parent's event for that is still to come.
+ */
+static int scan_node(uv_fs_event_t* handle,
+                     struct watcher_node* node,
+                     char* path,
+                     size_t len) {
+  struct watcher_node* child;
+  struct dirent* d;
+  struct stat s;
+  size_t dlen;
+  DIR* dir;
+  int err;
+
+  dir = opendir(path);
+  if (dir == NULL)
+    return 0;
+
+  err = 0;
+  while (err == 0 && (d = readdir(dir)) != NULL) {
+    if (strcmp(d->d_name, ".") == 0 || strcmp(d->d_name, "..") == 0)
+      continue;
+
+    dlen = strlen(d->d_name);
+    if (len + 1 + dlen + 1 > PATH_MAX)
+      continue;
+    path[len] = '/';
+    memcpy(path + len + 1, d->d_name, dlen + 1);
+
+    if (d->d_type == DT_UNKNOWN) {
+      if (lstat(path, &s) || !S_ISDIR(s.st_mode))
+        continue;
+    } else if (d->d_type != DT_DIR) {
+      continue;
+    }
+
+    child = find_child(node, d->d_name);
+    if (child == NULL)
+      child = add_node(handle, node, d->d_name, path, &err);
+    if (child != NULL)
+      err = scan_node(handle, child, path, len + 1 + dlen);
+  }
+
+  path[len] = '\0';
+  closedir(dir);
+  return err;
+}
+
+
+/* Full path of |node| plus |name| in |buf|, which is PATH_MAX bytes. */
+static int node_full_path(const struct watcher_node* node,
+                          const char* name,
+                          char* buf) {
+  const char* root;
+  size_t len;
+  int n;
+
+  root = node->handle->path;
+  len = strlen(root);
+  if (len + 1 >= PATH_MAX)
+    return -1;
+
+  memcpy(buf, root, len);
+  buf[len++] = '/';
+  n = node_path(node, name, buf + len, PATH_MAX - len);
+  if (n < 0)
+    return -1;
+
+  return len + n;
+}
+
+
+static void add_subtree(uv_fs_event_t* handle,
+                        struct watcher_node* parent,
+                        const char* name) {
+  struct watcher_node* node;
+  char path[PATH_MAX];
+  int len;
+  int err;
+
+  len = node_full_path(parent, name, path);
+  if (len < 0)
+    return;
+
+  node = add_node(handle, parent, name, path, &err);
+  if (node != NULL)
+    err = scan_node(handle, node, path, len);
+
+  /* Out of watches, most likely. */
+  if (err != 0)
+    handle->cb(handle, NULL, UV_RENAME, err);
+}
+
+
+static void uv__inotify_overflow(uv_loop_t* loop) {
+  struct watcher_node* root;
+  uv_fs_event_t* h;
+  char path[PATH_MAX];
+  QUEUE queue;
+  QUEUE* q;
+  int err;
+
+  /* Events were lost.  Catch up on the directories that were created in the
+   * meantime, then tell every watcher to rescan whatever it cares about.
+   * Only recursive watchers get that as an error; for the others, which
+   * never heard of UV_ENOBUFS, it is a plain change without a file name.
+   * Handles closed by a callback stay in the queue until the close is done.
+   */
+  QUEUE_MOVE(&loop->handle_queue, &queue);
+  while (!QUEUE_EMPTY(&queue)) {
+    q = QUEUE_HEAD(&queue);
+    QUEUE_REMOVE(q);
+    QUEUE_INSERT_TAIL(&loop->handle_queue, q);
+
+    h = QUEUE_DATA(q, uv_fs_event_t, handle_queue);
+    if (h->type != UV_FS_EVENT || !uv__is_active(h))
+      continue;
+
+    root = h->tree;
+    if (root == NULL) {
+      h->cb(h, NULL, UV_RENAME | UV_CHANGE, 0);
+      continue;
+    }
+
+    err = 0;
+    if (strlen(h->path) < sizeof(path)) {
+      strcpy(path, h->path);
+      err = scan_node(h, root, path, strlen(path));
+    }
+
+    h->cb(h, NULL, UV_RENAME | UV_CHANGE, err ? err : -ENOBUFS);
+  }
+}
+
+
+static void uv__inotify_dispatch_nodes(uv_loop_t* loop,
+                                       struct watcher_list* w,
+                                       const struct uv__inotify_event* e,
+                                       int events) {
+  struct watcher_node* node;
+  struct watcher_node* child;
+  uv_fs_event_t* h;
+  const char* name;
+  char path[PATH_MAX];
+  QUEUE queue;
+  QUEUE* q;
+
+  name = e->len ? (const char*) (e + 1) : NULL;
+
+  /* Same dance as for the plain watchers.  A callback that stops its handle
+   * frees the handle's nodes, which takes them out of |queue| too.
+   */
+  QUEUE_MOVE(&w->nodes, &queue);
+  while (!QUEUE_EMPTY(&queue)) {
+    q = QUEUE_HEAD(&queue);
+    node = QUEUE_DATA(q, struct watcher_node, member);
+    h = node->handle;
+
+    QUEUE_REMOVE(q);
+    QUEUE_INSERT_TAIL(&w->nodes, q);
+
+    /* The kernel dropped the watch, the directory is gone.  Its parent
+     * reports that, the root reports it through IN_DELETE_SELF.
+     */
+    if (e->mask & UV__IN_IGNORED) {
+      if (node->parent != NULL)
+        remove_node(loop, node);
+      continue;
+    }
+
+    if (name != NULL && (e->mask & UV__IN_ISDIR)) {
+      if (e->mask & (UV__IN_DELETE | UV__IN_MOVED_FROM)) {
+        child = find_child(node, name);
+        if (child != NULL)
+          remove_node(loop, child);
+      } else if (e->mask & (UV__IN_CREATE | UV__IN_MOVED_TO)) {
+        add_subtree(h, node, name);
+        if (!uv__is_active(h))
+          continue;
+      }
+    }
+
+    /* Events on a subdirectory itself are reported by its parent already. */
+    if (name == NULL && node->parent != NULL)
+      continue;
+
+    if (name == NULL) {
+      h->cb(h, uv__basename_r(h->path), events, 0);
+    } else if (node_path(node, name, path, sizeof(path)) >= 0) {
+      h->cb(h, path, events, 0);
+    }
+  }
+}
+
+
 static void uv__inotify_read(uv_loop_t* loop,
                              uv__io_t* dummy,
                              unsigned int events) {
@@ -154,6 +543,11 @@ static void uv__inotify_read(uv_loop_t* loop,
     for (p = buf; p < buf + size; p += sizeof(*e) + e->len) {
       e = (const struct uv__inotify_event*)p;
 
+      if (e->mask & UV__IN_Q_OVERFLOW) {
+        uv__inotify_overflow(loop);
+        continue;
+      }
+
       events = 0;
       if (e->mask & (UV__IN_ATTRIB|UV__IN_MODIFY))
         events |= UV_CHANGE;
@@ -192,6 +586,7 @@ static void uv__inotify_read(uv_loop_t* loop,
 
         h->cb(h, path, events, 0);
       }
+      uv__inotify_dispatch_nodes(loop, w, e, events);
       /* done iterating, time to (maybe) free empty watcher_list */
       w->iterating = 0;
       maybe_free_watcher_list(w, loop);
@@ -206,12 +601,51 @@ int uv_fs_event_init(uv_loop_t* loop, uv_fs_event_t* handle) {
 }
 
 
+static int uv__fs_event_start_recursive(uv_fs_event_t* handle,
+                                        uv_fs_event_cb cb,
+                                        const char* path) {
+  struct watcher_node* root;
+  char buf[PATH_MAX];
+  size_t len;
+  int err;
+
+  len = strlen(path);
+  if (len >= sizeof(buf))
+    return -ENAMETOOLONG;
+
+  handle->cb = cb;
+  handle->path = NULL;
+  root = add_node(handle, NULL, "", path, &err);
+  if (root == NULL)
+    return err;
+
+  /* Point the handle at the watched path before scanning, node_full_path()
+   * starts from there.
+   */
+  handle->tree = root;
+  handle->path = root->list->path;
+  handle->wd = root->list->wd;
+
+  memcpy(buf, path, len + 1);
+  err = scan_node(handle, root, buf, len);
+  if (err) {
+    remove_node(handle->loop, root);
+    handle->tree = NULL;
+    handle->path = NULL;
+    handle->wd = -1;
+    return err;
+  }
+
+  uv__handle_start(handle);
+  return 0;
+}
+
+
 int uv_fs_event_start(uv_fs_event_t* handle,
                       uv_fs_event_cb cb,
                       const char* path,
                       unsigned int flags) {
   struct watcher_list* w;
-  int events;
   int err;
   int wd;
 
@@ -222,34 +656,14 @@ int uv_fs_event_start(uv_fs_event_t* handle,
   if (err)
     return err;
 
-  events = UV__IN_ATTRIB
-         | UV__IN_CREATE
-         | UV__IN_MODIFY
-         | UV__IN_DELETE
-         | UV__IN_DELETE_SELF
-         | UV__IN_MOVE_SELF
-         | UV__IN_MOVED_FROM
-         | UV__IN_MOVED_TO;
-
-  wd = uv__inotify_add_watch(handle->loop->inotify_fd, path, events);
-  if (wd == -1)
-    return -errno;
-
-  w = find_watcher(handle->loop, wd);
-  if (w)
-    goto no_insert;
+  handle->tree = NULL;
+  if (flags & UV_FS_EVENT_RECURSIVE)
+    return uv__fs_event_start_recursive(handle, cb, path);
 
-  w = uv__malloc(sizeof(*w) + strlen(path) + 1);
+  w = add_watcher(handle->loop, path, UV__INOTIFY_EVENTS, &wd);
   if (w == NULL)
-    return -ENOMEM;
+    return wd;
 
-  w->wd = wd;
-  w->path = strcpy((char*)(w + 1), path);
-  QUEUE_INIT(&w->watchers);
-  w->iterating = 0;
-  RB_INSERT(watcher_root, CAST(&handle->loop->inotify_watchers), w);
-
-no_insert:
   uv__handle_start(handle);
   QUEUE_INSERT_TAIL(&w->watchers, &handle->watchers);
   handle->path = w->path;
@@ -266,6 +680,15 @@ int uv_fs_event_stop(uv_fs_event_t* handle) {
   if (!uv__is_active(handle))
     return 0;
 
+  if (handle->tree != NULL) {
+    remove_node(handle->loop, handle->tree);
+    handle->tree = NULL;
+    handle->wd = -1;
+    handle->path = NULL;
+    uv__handle_stop(handle);
+    return 0;
+  }
+
   w = find_watcher(handle->loop, handle->wd);
   assert(w != NULL);
 
@@ -71,6 +71,7 @@
 #define UV__EPOLL_CTL_ADD     1
 #define UV__EPOLL_CTL_DEL     2
 #define UV__EPOLL_CTL_MOD     3
+#define UV__EPOLLET           (1u << 31)
 
 /* inotify flags */
 #define UV__IN_ACCESS         0x001
@@ -85,6 +86,11 @@
 #define UV__IN_DELETE         0x200
 #define UV__IN_DELETE_SELF    0x400
 #define UV__IN_MOVE_SELF      0x800
+#define UV__IN_Q_OVERFLOW     0x4000
+#define UV__IN_IGNORED        0x8000
+#define UV__IN_ONLYDIR        0x1000000
+#define UV__IN_DONT_FOLLOW    0x2000000
+#define UV__IN_ISDIR          0x40000000
 
 #if defined(__x86_64__)
 struct uv__epoll_event {
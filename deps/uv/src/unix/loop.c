@@ -144,16 +144,70 @@ void uv__loop_close(uv_loop_t* loop) {
   uv__free(loop->watchers);
   loop->watchers = NULL;
   loop->nwatchers = 0;
+
+  uv__timer_wheel_free(loop);
+
+  uv__free(loop->internal_fields);
+  loop->internal_fields = NULL;
+}
+
+
+uv__loop_internal_fields_t* uv__loop_alloc_internal_fields(uv_loop_t* loop) {
+  if (loop->internal_fields == NULL)
+    loop->internal_fields = uv__calloc(1, sizeof(uv__loop_internal_fields_t));
+
+  return uv__get_internal_fields(loop);
 }
 
 
 int uv__loop_configure(uv_loop_t* loop, uv_loop_option option, va_list ap) {
-  if (option != UV_LOOP_BLOCK_SIGNAL)
+  uv__loop_internal_fields_t* fields;
+  unsigned int usec;
+
+  switch (option) {
+  case UV_LOOP_BLOCK_SIGNAL:
+    if (va_arg(ap, int) != SIGPROF)
+      return UV_EINVAL;
+    loop->flags |= UV_LOOP_BLOCK_SIGPROF;
+    return 0;
+
+#if defined(__linux__)
+  case UV_LOOP_EDGE_TRIGGERED:
+    /* Streams that are already polled switch over the next time their
+     * epoll registration is modified.
+     */
+    loop->flags |= UV_LOOP_EPOLLET;
+    return 0;
+
+  case UV_LOOP_BUSY_POLL:
+    usec = va_arg(ap, unsigned int);
+    fields = uv__loop_alloc_internal_fields(loop);
+    if (fields == NULL)
+      return UV_ENOMEM;
+    fields->busy_poll_timeout = (uint64_t) usec * 1000;
+    return 0;
+#endif
+
+  case UV_LOOP_MEASURE_TIME:
+    if (uv__loop_alloc_internal_fields(loop) == NULL)
+      return UV_ENOMEM;
+    loop->flags |= UV_LOOP_TIMED;
+    return 0;
+
+  case UV_LOOP_TIMER_WHEEL:
+    return uv__timer_wheel_init(loop, va_arg(ap, unsigned int));
+
+  default:
     return UV_ENOSYS;
+  }
+}
+
 
-  if (va_arg(ap, int) != SIGPROF)
+int uv_loop_metrics(const uv_loop_t* loop, uv_loop_metrics_t* metrics) {
+  if (!(loop->flags & UV_LOOP_TIMED))
     return UV_EINVAL;
 
-  loop->flags |= UV_LOOP_BLOCK_SIGPROF;
+  *metrics = uv__get_internal_fields(loop)->metrics;
+  metrics->lag_histogram = uv__get_internal_fields(loop)->lag_histogram;
   return 0;
 }
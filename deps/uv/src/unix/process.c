@@ -44,6 +44,29 @@ extern char **environ;
 # include <grp.h>
 #endif
 
+#if defined(__linux__)
+# include <limits.h>
+# include <sched.h>
+# include <signal.h>
+# include <string.h>
+# include <sys/mman.h>
+
+/* Stack for the uv__process_spawn_vm() child. The mapping is only backed by
+ * memory as far as it is touched, the size just has to cover a PATH search.
+ * Anything that grows with the options is allocated by the parent.
+ */
+# define UV__SPAWN_STACK_SIZE (256 * 1024)
+
+struct uv__spawn_vm_args {
+  const uv_process_options_t* options;
+  int stdio_count;
+  int (*pipes)[2];
+  char** sh_argv;
+  int error_fd;
+  sigset_t sigmask;
+};
+#endif
+
 
 static void uv__chld(uv_signal_t* handle, int signum) {
   uv_process_t* process;
@@ -275,10 +298,107 @@ static void uv__write_int(int fd, int val) {
  * avoided. Since this isn't called on those targets, the function
  * doesn't even need to be defined for them.
  */
+#if defined(__linux__)
+/* execvp() with an explicit environment, for the uv__process_spawn_vm()
+ * child: it shares its memory with the parent, so it can neither replace
+ * `environ` nor allocate. Like execvp() after `environ = envp`, the PATH of
+ * the new environment is searched. `sh_argv` has room for argc + 3 entries,
+ * for the ENOEXEC fallback. Only returns on error.
+ */
+static int uv__execvpe(const char* file,
+                       char* const argv[],
+                       char** envp,
+                       char** sh_argv) {
+  char buf[PATH_MAX];
+  const char* path;
+  const char* dir;
+  const char* end;
+  size_t dirlen;
+  size_t filelen;
+  char** ep;
+  int eacces;
+  int argc;
+
+  if (strchr(file, '/') != NULL) {
+    execve(file, argv, envp);
+    goto enoexec;
+  }
+
+  path = "/bin:/usr/bin";  /* confstr(_CS_PATH), what execvp() uses. */
+  for (ep = envp; *ep != NULL; ep++) {
+    if (strncmp(*ep, "PATH=", 5) == 0) {
+      path = *ep + 5;
+      break;
+    }
+  }
+
+  filelen = strlen(file);
+  eacces = 0;
+
+  for (dir = path; ; dir = end + 1) {
+    end = strchr(dir, ':');
+    if (end == NULL)
+      end = dir + strlen(dir);
+
+    /* An empty entry means the current directory. */
+    dirlen = end - dir;
+    if (dirlen + filelen + 2 <= sizeof(buf)) {
+      memcpy(buf, dir, dirlen);
+      if (dirlen > 0)
+        buf[dirlen++] = '/';
+      memcpy(buf + dirlen, file, filelen + 1);
+
+      execve(buf, argv, envp);
+
+      switch (errno) {
+        case EACCES:
+          eacces = 1;
+          /* Fall through. */
+        case ENOENT:
+        case ENOTDIR:
+        case ESTALE:
+        case ENODEV:
+        case ETIMEDOUT:
+          break;
+        case ENOEXEC:
+          file = buf;
+          goto enoexec;
+        default:
+          return -errno;
+      }
+    }
+
+    if (*end == '\0')
+      break;
+  }
+
+  return eacces ? -EACCES : -ENOENT;
+
+enoexec:
+  if (errno != ENOEXEC)
+    return -errno;
+
+  /* Not an executable format the kernel knows, hand it to the shell like
+   * execvp() does.
+   */
+  for (argc = 0; argv[argc] != NULL; argc++);
+  sh_argv[0] = "sh";
+  sh_argv[1] = (char*) file;
+  memcpy(sh_argv + 2, argv + 1, argc * sizeof(argv[0]));
+  if (argc == 0)
+    sh_argv[2] = NULL;
+  execve("/bin/sh", sh_argv, envp);
+
+  return -errno;
+}
+#endif
+
+
 static void uv__process_child_init(const uv_process_options_t* options,
                                    int stdio_count,
                                    int (*pipes)[2],
-                                   int error_fd) {
+                                   int error_fd,
+                                   char** sh_argv) {
   int close_fd;
   int use_fd;
   int fd;
@@ -372,6 +492,18 @@ static void uv__process_child_init(const uv_process_options_t* options,
     _exit(127);
   }
 
+#if defined(__linux__)
+  /* Only the uv__process_spawn_vm() child gets a shell argv. */
+  if (sh_argv != NULL) {
+    uv__write_int(error_fd,
+                  uv__execvpe(options->file,
+                              options->args,
+                              options->env != NULL ? options->env : environ,
+                              sh_argv));
+    _exit(127);
+  }
+#endif
+
   if (options->env != NULL) {
     environ = options->env;
   }
@@ -383,6 +515,116 @@ static void uv__process_child_init(const uv_process_options_t* options,
 #endif
 
 
+#if defined(__linux__)
+static int uv__process_spawn_vm_child(void* arg) {
+  struct uv__spawn_vm_args* args;
+  struct sigaction sa;
+  struct sigaction old;
+  int signum;
+
+  args = arg;
+
+  /* The parent's signal handlers would run on the parent's memory; put back
+   * the default for everything that is caught before unblocking signals
+   * again. Ignored signals stay ignored, as across exec().
+   */
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = SIG_DFL;
+  for (signum = 1; signum < NSIG; signum++) {
+    if (sigaction(signum, NULL, &old))
+      continue;
+    if (old.sa_handler != SIG_DFL && old.sa_handler != SIG_IGN)
+      sigaction(signum, &sa, NULL);
+  }
+  pthread_sigmask(SIG_SETMASK, &args->sigmask, NULL);
+
+  uv__process_child_init(args->options,
+                         args->stdio_count,
+                         args->pipes,
+                         args->error_fd,
+                         args->sh_argv);
+  return 127;
+}
+
+
+/* Starts the child with clone(CLONE_VM | CLONE_VFORK) instead of fork(), so
+ * the kernel doesn't have to copy the page tables of the parent first; for a
+ * parent with a few GB mapped that is most of the cost of a spawn. The
+ * parent is suspended until the child has called execve() or exited.
+ *
+ * Returns -1 with errno set to ENOSYS when fork() has to be used instead:
+ * dropping privileges in a child that shares the parent's memory is not
+ * something to attempt.
+ */
+static pid_t uv__process_spawn_vm(const uv_process_options_t* options,
+                                  int stdio_count,
+                                  int (*pipes)[2],
+                                  int error_fd) {
+  struct uv__spawn_vm_args args;
+  sigset_t all;
+  void* stack;
+  pid_t pid;
+  int argc;
+  int err;
+
+  if (options->flags & (UV_PROCESS_SETUID | UV_PROCESS_SETGID)) {
+    errno = ENOSYS;
+    return -1;
+  }
+
+  /* The child rearranges the fds in its copy of `pipes`, the parent still
+   * needs the original. The child can't allocate, so the shell argv for the
+   * ENOEXEC fallback is set aside here too: "sh", the file, argv[1..argc-1]
+   * and the terminator, plus one so that an empty argv still fits.
+   */
+  for (argc = 0; options->args[argc] != NULL; argc++);
+  args.options = options;
+  args.stdio_count = stdio_count;
+  args.pipes = uv__malloc(stdio_count * sizeof(*pipes));
+  args.sh_argv = uv__malloc((argc + 3) * sizeof(*args.sh_argv));
+  args.error_fd = error_fd;
+  if (args.pipes == NULL || args.sh_argv == NULL) {
+    uv__free(args.pipes);
+    uv__free(args.sh_argv);
+    errno = ENOSYS;
+    return -1;
+  }
+  memcpy(args.pipes, pipes, stdio_count * sizeof(*pipes));
+
+  stack = mmap(NULL,
+               UV__SPAWN_STACK_SIZE,
+               PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK,
+               -1,
+               0);
+  if (stack == MAP_FAILED) {
+    uv__free(args.pipes);
+    uv__free(args.sh_argv);
+    errno = ENOSYS;
+    return -1;
+  }
+
+  /* No signal handler may run in the child before it has reset them. */
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &args.sigmask);
+
+  pid = clone(uv__process_spawn_vm_child,
+              (char*) stack + UV__SPAWN_STACK_SIZE,
+              CLONE_VM | CLONE_VFORK | SIGCHLD,
+              &args);
+  err = errno;
+
+  pthread_sigmask(SIG_SETMASK, &args.sigmask, NULL);
+  munmap(stack, UV__SPAWN_STACK_SIZE);
+  uv__free(args.pipes);
+  uv__free(args.sh_argv);
+
+  errno = err;
+  return pid;
+}
+#endif
+
+
 int uv_spawn(uv_loop_t* loop,
              uv_process_t* process,
              const uv_process_options_t* options) {
@@ -458,7 +700,13 @@ int uv_spawn(uv_loop_t* loop,
 
   /* Acquire write lock to prevent opening new fds in worker threads */
   uv_rwlock_wrlock(&loop->cloexec_lock);
+#if defined(__linux__)
+  pid = uv__process_spawn_vm(options, stdio_count, pipes, signal_pipe[1]);
+  if (pid == -1 && errno == ENOSYS)
+    pid = fork();
+#else
   pid = fork();
+#endif
 
   if (pid == -1) {
     err = -errno;
@@ -469,7 +717,7 @@ int uv_spawn(uv_loop_t* loop,
   }
 
   if (pid == 0) {
-    uv__process_child_init(options, stdio_count, pipes, signal_pipe[1]);
+    uv__process_child_init(options, stdio_count, pipes, signal_pipe[1], NULL);
     abort();
   }
 
@@ -20,33 +20,58 @@
 
 #include "uv.h"
 #include "internal.h"
+#include "atomic-ops.h"
 
 #include <assert.h>
 #include <errno.h>
 #include <signal.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
 
-typedef struct {
-  uv_signal_t* handle;
-  int signum;
-} uv__signal_msg_t;
-
 RB_HEAD(uv__signal_tree_s, uv_signal_s);
 
+/* Every loop with signal handles owns a slot. The signal handler finds the
+ * loops it has to wake by walking the list of slots, which it must be able to
+ * do without taking a lock: slots are prepended with uv__signal_lock held but
+ * they are never unlinked or freed, a loop that goes away just gives its slot
+ * up for reuse. The handler announces itself in `busy` before it looks at
+ * `wfd` so that uv__signal_loop_cleanup() can wait for it before the
+ * descriptor is closed.
+ */
+typedef struct uv__signal_slot_s uv__signal_slot_t;
+
+struct uv__signal_slot_s {
+  uv__signal_slot_t* next;
+  int wfd;            /* Wakeup descriptor, -1 while the slot is unused. */
+  int busy;           /* Number of signal handlers that are using wfd. */
+  int pending;        /* Set when a wakeup has been written but not read. */
+  int in_use;         /* Protected by uv__signal_lock. */
+  int watched[NSIG];  /* Started handles per signal, written by the loop. */
+  struct uv__signal_tree_s handles;  /* Only touched by the loop thread. */
+};
+
 
-static int uv__signal_unlock(void);
 static void uv__signal_event(uv_loop_t* loop, uv__io_t* w, unsigned int events);
 static int uv__signal_compare(uv_signal_t* w1, uv_signal_t* w2);
 static void uv__signal_stop(uv_signal_t* handle);
 
 
 static uv_once_t uv__signal_global_init_guard = UV_ONCE_INIT;
-static struct uv__signal_tree_s uv__signal_tree =
-    RB_INITIALIZER(uv__signal_tree);
-static int uv__signal_lock_pipefd[2];
+static uv_mutex_t uv__signal_lock;
+static uv__signal_slot_t* uv__signal_slots;
+
+/* How many times each signal has been caught. Only ever incremented, by the
+ * signal handler. A handle remembers the value it has dispatched up to.
+ */
+static int uv__signal_counts[NSIG];
+
+/* Started handles per signal in all loops, protected by uv__signal_lock. The
+ * process-wide handler is installed while this is nonzero.
+ */
+static unsigned int uv__signal_refs[NSIG];
 
 
 RB_GENERATE_STATIC(uv__signal_tree_s,
@@ -55,10 +80,7 @@ RB_GENERATE_STATIC(uv__signal_tree_s,
 
 
 static void uv__signal_global_init(void) {
-  if (uv__make_pipe(uv__signal_lock_pipefd, 0))
-    abort();
-
-  if (uv__signal_unlock())
+  if (uv_mutex_init(&uv__signal_lock))
     abort();
 }
 
@@ -68,108 +90,83 @@ void uv__signal_global_once_init(void) {
 }
 
 
-
-static int uv__signal_lock(void) {
-  int r;
-  char data;
-
-  do {
-    r = read(uv__signal_lock_pipefd[0], &data, sizeof data);
-  } while (r < 0 && errno == EINTR);
-
-  return (r < 0) ? -1 : 0;
+static int uv__signal_load(int* ptr) {
+  return *(volatile int*) ptr;
 }
 
 
-static int uv__signal_unlock(void) {
-  int r;
-  char data = 42;
+static void uv__signal_add(int* ptr, int delta) {
+  int oldval;
+  int newval;
 
   do {
-    r = write(uv__signal_lock_pipefd[1], &data, sizeof data);
-  } while (r < 0 && errno == EINTR);
-
-  return (r < 0) ? -1 : 0;
-}
-
-
-static void uv__signal_block_and_lock(sigset_t* saved_sigmask) {
-  sigset_t new_mask;
-
-  if (sigfillset(&new_mask))
-    abort();
-
-  if (pthread_sigmask(SIG_SETMASK, &new_mask, saved_sigmask))
-    abort();
-
-  if (uv__signal_lock())
-    abort();
+    oldval = uv__signal_load(ptr);
+    newval = (int) ((unsigned int) oldval + delta);
+  } while (cmpxchgi(ptr, oldval, newval) != oldval);
 }
 
 
-static void uv__signal_unlock_and_unblock(sigset_t* saved_sigmask) {
-  if (uv__signal_unlock())
-    abort();
+static void uv__signal_wakeup(int fd) {
+  /* Works for both the eventfd and the pipe. A full pipe already has a wakeup
+   * in it, so EAGAIN is fine.
+   */
+  static const uint64_t val = 1;
+  int r;
 
-  if (pthread_sigmask(SIG_SETMASK, saved_sigmask, NULL))
-    abort();
+  do
+    r = write(fd, &val, sizeof(val));
+  while (r == -1 && errno == EINTR);
 }
 
 
-static uv_signal_t* uv__signal_first_handle(int signum) {
-  /* This function must be called with the signal lock held. */
-  uv_signal_t lookup;
-  uv_signal_t* handle;
-
-  lookup.signum = signum;
-  lookup.loop = NULL;
+/* Find the slot of a loop by its wakeup descriptor, which no other slot can
+ * hold while the loop has it open. Keeps the slot out of uv_loop_t. Only
+ * called from the loop's own thread.
+ */
+static uv__signal_slot_t* uv__signal_loop_slot(const uv_loop_t* loop) {
+  uv__signal_slot_t* slot;
 
-  handle = RB_NFIND(uv__signal_tree_s, &uv__signal_tree, &lookup);
+  if (loop->signal_pipefd[1] == -1)
+    return NULL;
 
-  if (handle != NULL && handle->signum == signum)
-    return handle;
+  for (slot = *(uv__signal_slot_t* volatile*) &uv__signal_slots;
+       slot != NULL;
+       slot = slot->next) {
+    if (uv__signal_load(&slot->wfd) == loop->signal_pipefd[1])
+      return slot;
+  }
 
   return NULL;
 }
 
 
 static void uv__signal_handler(int signum) {
-  uv__signal_msg_t msg;
-  uv_signal_t* handle;
+  uv__signal_slot_t* slot;
   int saved_errno;
+  int fd;
 
   saved_errno = errno;
-  memset(&msg, 0, sizeof msg);
-
-  if (uv__signal_lock()) {
-    errno = saved_errno;
-    return;
-  }
-
-  for (handle = uv__signal_first_handle(signum);
-       handle != NULL && handle->signum == signum;
-       handle = RB_NEXT(uv__signal_tree_s, &uv__signal_tree, handle)) {
-    int r;
+  uv__signal_add(&uv__signal_counts[signum], 1);
 
-    msg.signum = signum;
-    msg.handle = handle;
+  for (slot = *(uv__signal_slot_t* volatile*) &uv__signal_slots;
+       slot != NULL;
+       slot = slot->next) {
+    if (uv__signal_load(&slot->watched[signum]) == 0)
+      continue;
 
-    /* write() should be atomic for small data chunks, so the entire message
-     * should be written at once. In theory the pipe could become full, in
-     * which case the user is out of luck.
+    /* The loop reads the counters after it clears `pending`, so only the
+     * first signal since then has to wake it up.
      */
-    do {
-      r = write(handle->loop->signal_pipefd[1], &msg, sizeof msg);
-    } while (r == -1 && errno == EINTR);
-
-    assert(r == sizeof msg ||
-           (r == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)));
+    if (cmpxchgi(&slot->pending, 0, 1) != 0)
+      continue;
 
-    if (r != -1)
-      handle->caught_signals++;
+    uv__signal_add(&slot->busy, 1);
+    fd = uv__signal_load(&slot->wfd);
+    if (fd != -1)
+      uv__signal_wakeup(fd);
+    uv__signal_add(&slot->busy, -1);
   }
 
-  uv__signal_unlock();
   errno = saved_errno;
 }
 
@@ -209,15 +206,57 @@ static void uv__signal_unregister_handler(int signum) {
 
 
 static int uv__signal_loop_once_init(uv_loop_t* loop) {
+  uv__signal_slot_t* slot;
+  int pipefd[2];
   int err;
 
   /* Return if already initialized. */
   if (loop->signal_pipefd[0] != -1)
     return 0;
 
-  err = uv__make_pipe(loop->signal_pipefd, UV__F_NONBLOCK);
-  if (err)
+  err = uv__async_eventfd();
+  if (err >= 0) {
+    pipefd[0] = err;
+    pipefd[1] = err;
+  } else if (err == -ENOSYS) {
+    err = uv__make_pipe(pipefd, UV__F_NONBLOCK);
+    if (err)
+      return err;
+  } else {
     return err;
+  }
+
+  uv_mutex_lock(&uv__signal_lock);
+
+  for (slot = uv__signal_slots; slot != NULL; slot = slot->next)
+    if (slot->in_use == 0)
+      break;
+
+  if (slot == NULL) {
+    slot = uv__calloc(1, sizeof(*slot));
+    if (slot == NULL) {
+      uv_mutex_unlock(&uv__signal_lock);
+      uv__close(pipefd[0]);
+      if (pipefd[1] != pipefd[0])
+        uv__close(pipefd[1]);
+      return -ENOMEM;
+    }
+
+    slot->wfd = -1;
+    slot->next = uv__signal_slots;
+    /* Publish the slot to the signal handler only once it's filled in. */
+    cmpxchgl((long*) &uv__signal_slots, (long) slot->next, (long) slot);
+  }
+
+  slot->in_use = 1;
+  uv_mutex_unlock(&uv__signal_lock);
+
+  RB_INIT(&slot->handles);
+  cmpxchgi(&slot->wfd, -1, pipefd[1]);
+  cmpxchgi(&slot->pending, 1, 0);
+
+  loop->signal_pipefd[0] = pipefd[0];
+  loop->signal_pipefd[1] = pipefd[1];
 
   uv__io_init(&loop->signal_io_watcher,
               uv__signal_event,
@@ -229,11 +268,12 @@ static int uv__signal_loop_once_init(uv_loop_t* loop) {
 
 
 void uv__signal_loop_cleanup(uv_loop_t* loop) {
+  uv__signal_slot_t* slot;
   QUEUE* q;
 
   /* Stop all the signal watchers that are still attached to this loop. This
-   * ensures that the (shared) signal tree doesn't contain any invalid entries
-   * entries, and that signal handlers are removed when appropriate.
+   * ensures that the (shared) signal handler refcounts stay correct, and that
+   * signal handlers are removed when appropriate.
    * It's safe to use QUEUE_FOREACH here because the handles and the handle
    * queue are not modified by uv__signal_stop().
    */
@@ -244,14 +284,29 @@ void uv__signal_loop_cleanup(uv_loop_t* loop) {
       uv__signal_stop((uv_signal_t*) handle);
   }
 
-  if (loop->signal_pipefd[0] != -1) {
-    uv__close(loop->signal_pipefd[0]);
-    loop->signal_pipefd[0] = -1;
+  slot = uv__signal_loop_slot(loop);
+  if (slot != NULL) {
+    /* A signal handler on another thread may still be about to write to the
+     * descriptor; wait for it before the descriptor can be closed and reused.
+     */
+    cmpxchgi(&slot->wfd, loop->signal_pipefd[1], -1);
+    while (uv__signal_load(&slot->busy) != 0)
+      cpu_relax();
+
+    uv_mutex_lock(&uv__signal_lock);
+    slot->in_use = 0;
+    uv_mutex_unlock(&uv__signal_lock);
   }
 
-  if (loop->signal_pipefd[1] != -1) {
+  if (loop->signal_pipefd[1] != -1 &&
+      loop->signal_pipefd[1] != loop->signal_pipefd[0]) {
     uv__close(loop->signal_pipefd[1]);
-    loop->signal_pipefd[1] = -1;
+  }
+  loop->signal_pipefd[1] = -1;
+
+  if (loop->signal_pipefd[0] != -1) {
+    uv__close(loop->signal_pipefd[0]);
+    loop->signal_pipefd[0] = -1;
   }
 }
 
@@ -273,30 +328,24 @@ int uv_signal_init(uv_loop_t* loop, uv_signal_t* handle) {
 
 
 void uv__signal_close(uv_signal_t* handle) {
-
-  uv__signal_stop(handle);
-
-  /* If there are any caught signals "trapped" in the signal pipe, we can't
-   * call the close callback yet. Otherwise, add the handle to the finish_close
-   * queue.
+  /* Signals are counted rather than queued per handle, so nothing can be in
+   * flight for a stopped handle and it can be closed right away.
    */
-  if (handle->caught_signals == handle->dispatched_signals) {
-    uv__make_close_pending((uv_handle_t*) handle);
-  }
+  uv__signal_stop(handle);
 }
 
 
 int uv_signal_start(uv_signal_t* handle, uv_signal_cb signal_cb, int signum) {
-  sigset_t saved_sigmask;
+  uv__signal_slot_t* slot;
   int err;
 
   assert(!uv__is_closing(handle));
 
-  /* If the user supplies signum == 0, then return an error already. If the
-   * signum is otherwise invalid then uv__signal_register will find out
-   * eventually.
+  /* If the user supplies signum == 0, then return an error already. Negative
+   * and out of range values are rejected here too because signum indexes the
+   * counters; anything else that is invalid makes sigaction() fail.
    */
-  if (signum == 0)
+  if (signum <= 0 || signum >= NSIG)
     return -EINVAL;
 
   /* Short circuit: if the signal watcher is already watching {signum} don't
@@ -314,24 +363,32 @@ int uv_signal_start(uv_signal_t* handle, uv_signal_cb signal_cb, int signum) {
     uv__signal_stop(handle);
   }
 
-  uv__signal_block_and_lock(&saved_sigmask);
+  uv_mutex_lock(&uv__signal_lock);
 
   /* If at this point there are no active signal watchers for this signum (in
    * any of the loops), it's time to try and register a handler for it here.
    */
-  if (uv__signal_first_handle(signum) == NULL) {
+  if (uv__signal_refs[signum] == 0) {
     err = uv__signal_register_handler(signum);
     if (err) {
       /* Registering the signal handler failed. Must be an invalid signal. */
-      uv__signal_unlock_and_unblock(&saved_sigmask);
+      uv_mutex_unlock(&uv__signal_lock);
       return err;
     }
   }
 
-  handle->signum = signum;
-  RB_INSERT(uv__signal_tree_s, &uv__signal_tree, handle);
+  uv__signal_refs[signum]++;
+  uv_mutex_unlock(&uv__signal_lock);
+
+  /* Make the loop visible to the signal handler before taking the baseline;
+   * a signal that is counted after this point is sure to wake the loop up.
+   */
+  slot = uv__signal_loop_slot(handle->loop);
+  uv__signal_add(&slot->watched[signum], 1);
 
-  uv__signal_unlock_and_unblock(&saved_sigmask);
+  handle->signum = signum;
+  handle->caught_signals = uv__signal_load(&uv__signal_counts[signum]);
+  RB_INSERT(uv__signal_tree_s, &slot->handles, handle);
 
   handle->signal_cb = signal_cb;
   uv__handle_start(handle);
@@ -340,76 +397,69 @@ int uv_signal_start(uv_signal_t* handle, uv_signal_cb signal_cb, int signum) {
 }
 
 
-static void uv__signal_event(uv_loop_t* loop,
-                             uv__io_t* w,
-                             unsigned int events) {
-  uv__signal_msg_t* msg;
+static void uv__signal_dispatch(uv__signal_slot_t* slot, int signum) {
+  uv_signal_t lookup;
   uv_signal_t* handle;
-  char buf[sizeof(uv__signal_msg_t) * 32];
-  size_t bytes, end, i;
-  int r;
-
-  bytes = 0;
-  end = 0;
+  unsigned int count;
+  unsigned int n;
 
-  do {
-    r = read(loop->signal_pipefd[0], buf + bytes, sizeof(buf) - bytes);
-
-    if (r == -1 && errno == EINTR)
-      continue;
+  lookup.signum = signum;
+  lookup.loop = NULL;
 
-    if (r == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-      /* If there are bytes in the buffer already (which really is extremely
-       * unlikely if possible at all) we can't exit the function here. We'll
-       * spin until more bytes are read instead.
-       */
-      if (bytes > 0)
-        continue;
+  /* The callbacks can start, stop or close any handle, including the one that
+   * is being dispatched, so look the next handle up from scratch every time.
+   */
+  for (;;) {
+    count = uv__signal_load(&uv__signal_counts[signum]);
+
+    handle = RB_NFIND(uv__signal_tree_s, &slot->handles, &lookup);
+    while (handle != NULL &&
+           handle->signum == signum &&
+           handle->caught_signals == count) {
+      handle = RB_NEXT(uv__signal_tree_s, &slot->handles, handle);
+    }
 
-      /* Otherwise, there was nothing there. */
+    if (handle == NULL || handle->signum != signum)
       return;
-    }
 
-    /* Other errors really should never happen. */
-    if (r == -1)
-      abort();
+    n = count - handle->caught_signals;
+    handle->caught_signals = count;
 
-    bytes += r;
+    while (n-- > 0 && handle->signum == signum) {
+      assert(!(handle->flags & UV_CLOSING));
+      handle->dispatched_signals++;
+      handle->signal_cb(handle, signum);
+    }
+  }
+}
 
-    /* `end` is rounded down to a multiple of sizeof(uv__signal_msg_t). */
-    end = (bytes / sizeof(uv__signal_msg_t)) * sizeof(uv__signal_msg_t);
 
-    for (i = 0; i < end; i += sizeof(uv__signal_msg_t)) {
-      msg = (uv__signal_msg_t*) (buf + i);
-      handle = msg->handle;
+static void uv__signal_event(uv_loop_t* loop,
+                             uv__io_t* w,
+                             unsigned int events) {
+  uv__signal_slot_t* slot;
+  char buf[64];
+  int signum;
+  int r;
 
-      if (msg->signum == handle->signum) {
-        assert(!(handle->flags & UV_CLOSING));
-        handle->signal_cb(handle, handle->signum);
-      }
+  slot = uv__signal_loop_slot(loop);
 
-      handle->dispatched_signals++;
+  /* Clear the flag before looking at the counters, a signal that comes in
+   * from here on writes a new wakeup.
+   */
+  cmpxchgi(&slot->pending, 1, 0);
 
-      /* If uv_close was called while there were caught signals that were not
-       * yet dispatched, the uv__finish_close was deferred. Make close pending
-       * now if this has happened.
-       */
-      if ((handle->flags & UV_CLOSING) &&
-          (handle->caught_signals == handle->dispatched_signals)) {
-        uv__make_close_pending((uv_handle_t*) handle);
-      }
-    }
+  do
+    r = read(w->fd, buf, sizeof(buf));
+  while (r == sizeof(buf) || (r == -1 && errno == EINTR));
 
-    bytes -= end;
+  /* Other errors really should never happen. */
+  if (r == -1 && errno != EAGAIN && errno != EWOULDBLOCK)
+    abort();
 
-    /* If there are any "partial" messages left, move them to the start of the
-     * the buffer, and spin. This should not happen.
-     */
-    if (bytes) {
-      memmove(buf, buf + end, bytes);
-      continue;
-    }
-  } while (end == sizeof buf);
+  for (signum = 1; signum < NSIG; signum++)
+    if (slot->watched[signum] != 0)
+      uv__signal_dispatch(slot, signum);
 }
 
 
@@ -441,26 +491,27 @@ int uv_signal_stop(uv_signal_t* handle) {
 
 
 static void uv__signal_stop(uv_signal_t* handle) {
+  uv__signal_slot_t* slot;
   uv_signal_t* removed_handle;
-  sigset_t saved_sigmask;
 
   /* If the watcher wasn't started, this is a no-op. */
   if (handle->signum == 0)
     return;
 
-  uv__signal_block_and_lock(&saved_sigmask);
-
-  removed_handle = RB_REMOVE(uv__signal_tree_s, &uv__signal_tree, handle);
+  slot = uv__signal_loop_slot(handle->loop);
+  removed_handle = RB_REMOVE(uv__signal_tree_s, &slot->handles, handle);
   assert(removed_handle == handle);
   (void) removed_handle;
 
+  uv__signal_add(&slot->watched[handle->signum], -1);
+
   /* Check if there are other active signal watchers observing this signal. If
    * not, unregister the signal handler.
    */
-  if (uv__signal_first_handle(handle->signum) == NULL)
+  uv_mutex_lock(&uv__signal_lock);
+  if (--uv__signal_refs[handle->signum] == 0)
     uv__signal_unregister_handler(handle->signum);
-
-  uv__signal_unlock_and_unblock(&saved_sigmask);
+  uv_mutex_unlock(&uv__signal_lock);
 
   handle->signum = 0;
   uv__handle_stop(handle);
@@ -60,10 +60,16 @@ struct uv__stream_select_s {
 };
 #endif /* defined(__APPLE__) */
 
+/* Upper bound on the number of buffers uv__write() gathers from queued
+ * requests; uv__getiovmax() lowers it further where needed.
+ */
+#define UV__WRITE_GATHER_MAX 1024
+
 static void uv__stream_connect(uv_stream_t*);
 static void uv__write(uv_stream_t* stream);
 static void uv__read(uv_stream_t* stream);
 static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events);
+static void uv__stream_rearm(uv_stream_t* stream);
 static void uv__write_callbacks(uv_stream_t* stream);
 static size_t uv__write_req_size(uv_write_t* req);
 
@@ -743,7 +749,39 @@ static int uv__handle_fd(uv_handle_t* handle) {
   }
 }
 
+/* Collect the unwritten buffers of consecutive queued requests, starting
+ * with the head, so that they go out with a single writev(). Stops at the
+ * first request that passes a handle, those need a sendmsg() of their own.
+ */
+static int uv__write_gather(uv_stream_t* stream,
+                            struct iovec* iov,
+                            int iovmax) {
+  QUEUE* q;
+  uv_write_t* req;
+  unsigned int i;
+  int iovcnt;
+
+  iovcnt = 0;
+  QUEUE_FOREACH(q, &stream->write_queue) {
+    req = QUEUE_DATA(q, uv_write_t, queue);
+    if (req->send_handle != NULL)
+      break;
+
+    for (i = req->write_index; i < req->nbufs; i++) {
+      if (iovcnt == iovmax)
+        return iovcnt;
+      iov[iovcnt].iov_base = req->bufs[i].base;
+      iov[iovcnt].iov_len = req->bufs[i].len;
+      iovcnt++;
+    }
+  }
+
+  return iovcnt;
+}
+
+
 static void uv__write(uv_stream_t* stream) {
+  struct iovec gather[UV__WRITE_GATHER_MAX];
   struct iovec* iov;
   QUEUE* q;
   uv_write_t* req;
@@ -762,19 +800,27 @@ start:
   req = QUEUE_DATA(q, uv_write_t, queue);
   assert(req->handle == stream);
 
-  /*
-   * Cast to iovec. We had to have our own uv_buf_t instead of iovec
-   * because Windows's WSABUF is not an iovec.
-   */
-  assert(sizeof(uv_buf_t) == sizeof(struct iovec));
-  iov = (struct iovec*) &(req->bufs[req->write_index]);
-  iovcnt = req->nbufs - req->write_index;
-
   iovmax = uv__getiovmax();
 
-  /* Limit iov count to avoid EINVALs from writev() */
-  if (iovcnt > iovmax)
-    iovcnt = iovmax;
+  if (req->send_handle == NULL && QUEUE_NEXT(q) != &stream->write_queue) {
+    /* More than one request is queued, write them all in one go. */
+    if (iovmax > (int) ARRAY_SIZE(gather))
+      iovmax = ARRAY_SIZE(gather);
+    iov = gather;
+    iovcnt = uv__write_gather(stream, gather, iovmax);
+  } else {
+    /*
+     * Cast to iovec. We had to have our own uv_buf_t instead of iovec
+     * because Windows's WSABUF is not an iovec.
+     */
+    assert(sizeof(uv_buf_t) == sizeof(struct iovec));
+    iov = (struct iovec*) &(req->bufs[req->write_index]);
+    iovcnt = req->nbufs - req->write_index;
+
+    /* Limit iov count to avoid EINVALs from writev() */
+    if (iovcnt > iovmax)
+      iovcnt = iovmax;
+  }
 
   /*
    * Now do the actual writev. Note that we've been updating the pointers
@@ -898,10 +944,27 @@ start:
 
         if (req->write_index == req->nbufs) {
           /* Then we're done! */
-          assert(n == 0);
           uv__write_req_finish(req);
-          /* TODO: start trying to write the next request. */
-          return;
+
+          if (QUEUE_EMPTY(&stream->write_queue)) {
+            assert(n == 0);
+            return;
+          }
+
+          /* The rest of the bytes belong to the next request(s), which were
+           * gathered into the same writev(). If nothing is left, the next
+           * request still needs to be written: the partial write branch
+           * above takes care of that on the next iteration.
+           */
+          req = QUEUE_DATA(QUEUE_HEAD(&stream->write_queue),
+                           uv_write_t,
+                           queue);
+          assert(n == 0 || req->send_handle == NULL);
+          if (n == 0 && req->send_handle != NULL) {
+            if (stream->flags & UV_STREAM_BLOCKING)
+              goto start;
+            break;
+          }
         }
       }
     }
@@ -916,6 +979,13 @@ start:
   /* We're not done. */
   uv__io_start(stream->loop, &stream->io_watcher, POLLOUT);
 
+  /* Stopped short of EAGAIN, e.g. because the gather list was full. The
+   * socket is still writable, so an edge-triggered watcher won't hear about
+   * it again unless it is rearmed.
+   */
+  if (n == 0)
+    uv__stream_rearm(stream);
+
   /* Notify select() thread about state change */
   uv__stream_osx_interrupt_select(stream);
 }
@@ -1100,23 +1170,60 @@ static int uv__stream_recv_cmsg(uv_stream_t* stream, struct msghdr* msg) {
 # pragma clang diagnostic ignored "-Wgnu-folding-constant"
 #endif
 
+/* Keeps reading into |base| until it is full or the kernel reports EAGAIN
+ * or EOF.  Returns the number of bytes read.  Errors other than EAGAIN are
+ * left for the next uv__read(), which the rearm makes happen.
+ */
+static ssize_t uv__stream_read_tail(uv_stream_t* stream,
+                                    char* base,
+                                    size_t len,
+                                    int* eof) {
+  ssize_t total;
+  ssize_t n;
+
+  total = 0;
+  while ((size_t) total < len) {
+    do
+      n = read(uv__stream_fd(stream), base + total, len - total);
+    while (n == -1 && errno == EINTR);
+
+    if (n > 0) {
+      total += n;
+      continue;
+    }
+
+    if (n == 0)
+      *eof = 1;
+    else if (errno != EAGAIN && errno != EWOULDBLOCK)
+      uv__stream_rearm(stream);
+    break;
+  }
+
+  return total;
+}
+
+
 static void uv__read(uv_stream_t* stream) {
   uv_buf_t buf;
   ssize_t nread;
   struct msghdr msg;
   char cmsg_space[CMSG_SPACE(UV__CMSG_FD_SIZE)];
   int count;
+  int edge;
+  int edge_eof;
   int err;
   int is_ipc;
 
   stream->flags &= ~UV_STREAM_READ_PARTIAL;
 
   /* Prevent loop starvation when the data comes in as fast as (or faster than)
-   * we can read it. XXX Need to rearm fd if we switch to edge-triggered I/O.
+   * we can read it.  Edge-triggered watchers are rearmed when we bail out
+   * with data possibly still pending.
    */
   count = 32;
 
   is_ipc = stream->type == UV_NAMED_PIPE && ((uv_pipe_t*) stream)->ipc;
+  edge = uv__stream_edge_triggered(&stream->io_watcher);
 
   /* XXX: Maybe instead of having UV_STREAM_READING we just test if
    * tcp->read_cb is NULL or not?
@@ -1131,6 +1238,8 @@ static void uv__read(uv_stream_t* stream) {
     if (buf.base == NULL || buf.len == 0) {
       /* User indicates it can't or won't handle the read. */
       stream->read_cb(stream, UV_ENOBUFS, &buf);
+      if (stream->flags & UV_STREAM_READING)
+        uv__stream_rearm(stream);
       return;
     }
 
@@ -1218,15 +1327,32 @@ static void uv__read(uv_stream_t* stream) {
         msg.msg_iov = old;
       }
 #endif
+      /* A short read doesn't prove that an edge-triggered watcher has been
+       * drained; a FIN queued behind the data, for one, won't raise another
+       * edge.  Top up the buffer until the kernel says EAGAIN.
+       */
+      edge_eof = 0;
+      if (edge && nread < buflen)
+        nread += uv__stream_read_tail(stream, buf.base + nread,
+                                      buflen - nread, &edge_eof);
+
       stream->read_cb(stream, nread, &buf);
 
       /* Return if we didn't fill the buffer, there is no more data to read. */
       if (nread < buflen) {
         stream->flags |= UV_STREAM_READ_PARTIAL;
+        if (edge_eof && uv__stream_fd(stream) != -1 &&
+            (stream->flags & UV_STREAM_READING)) {
+          buf = uv_buf_init(NULL, 0);
+          uv__stream_eof(stream, &buf);
+        }
         return;
       }
     }
   }
+
+  if (count < 0)
+    uv__stream_rearm(stream);
 }
 
 
@@ -1265,6 +1391,35 @@ int uv_shutdown(uv_shutdown_t* req, uv_stream_t* stream, uv_shutdown_cb cb) {
 }
 
 
+/* Whether the epoll backend may register |w| edge-triggered.  Only plain
+ * byte streams qualify: uv__read() on those either drains the fd to EAGAIN
+ * or rearms the watcher.  IPC pipes can stop at a message boundary with
+ * more data queued, and the accept and poll watchers are not stream
+ * watchers to begin with.
+ */
+int uv__stream_edge_triggered(uv__io_t* w) {
+  uv_stream_t* stream;
+
+  if (w->cb != uv__stream_io)
+    return 0;
+
+  stream = container_of(w, uv_stream_t, io_watcher);
+  if (!(stream->loop->flags & UV_LOOP_EPOLLET))
+    return 0;
+
+  if (stream->type == UV_TCP)
+    return 1;
+
+  return stream->type == UV_NAMED_PIPE && !((uv_pipe_t*) stream)->ipc;
+}
+
+
+static void uv__stream_rearm(uv_stream_t* stream) {
+  if (uv__stream_edge_triggered(&stream->io_watcher))
+    uv__io_rearm(stream->loop, &stream->io_watcher);
+}
+
+
 static void uv__stream_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
   uv_stream_t* stream;
 
@@ -1367,7 +1522,13 @@ static void uv__stream_connect(uv_stream_t* stream) {
   if (error < 0) {
     uv__stream_flush_write_queue(stream, -ECANCELED);
     uv__write_callbacks(stream);
+    return;
   }
+
+  /* The event that got us here may also have carried readability or room
+   * for the queued writes; an edge-triggered watcher won't see it again.
+   */
+  uv__stream_rearm(stream);
 }
 
 
@@ -1440,6 +1601,9 @@ int uv_write2(uv_write_t* req,
   if (stream->connect_req) {
     /* Still connecting, do nothing. */
   }
+  else if (stream->flags & UV_STREAM_CORKED) {
+    /* Held back until uv_stream_uncork(). */
+  }
   else if (empty_queue) {
     uv__write(stream);
   }
@@ -1659,3 +1823,36 @@ int uv_stream_set_blocking(uv_stream_t* handle, int blocking) {
    */
   return uv__nonblock(uv__stream_fd(handle), !blocking);
 }
+
+
+int uv_stream_cork(uv_stream_t* handle) {
+  if (uv__stream_fd(handle) < 0)
+    return -EBADF;
+
+  /* Blocking streams never queue, there is nothing to hold back. */
+  if (handle->flags & UV_STREAM_BLOCKING)
+    return -EINVAL;
+
+  handle->flags |= UV_STREAM_CORKED;
+  return 0;
+}
+
+
+int uv_stream_uncork(uv_stream_t* handle) {
+  if (!(handle->flags & UV_STREAM_CORKED))
+    return 0;
+
+  handle->flags &= ~UV_STREAM_CORKED;
+
+  /* If the write watcher is active, or the stream is still connecting, the
+   * queue gets flushed once the fd becomes writable anyway.
+   */
+  if (uv__stream_fd(handle) >= 0 &&
+      handle->connect_req == NULL &&
+      !QUEUE_EMPTY(&handle->write_queue) &&
+      !uv__io_active(&handle->io_watcher, POLLOUT)) {
+    uv__write(handle);
+  }
+
+  return 0;
+}
@@ -24,6 +24,256 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
+
+/* The optional timer wheel (UV_LOOP_TIMER_WHEEL) is the classic hierarchical
+ * one: 256 slots of one tick each, then four levels of 64 slots that each
+ * span 64 slots of the level below, 2^32 ticks in all.  A timer sits in the
+ * slot for its expiry tick on the lowest level that reaches it and moves
+ * down a level (cascades) when the wheel turns past the start of its slot.
+ * Start, stop and again are O(1).
+ *
+ * Timers on the wheel are linked through their heap_node, which the heap
+ * doesn't use then.  Within a tick they fire in start order, like the heap
+ * does for equal timeouts.
+ */
+#define UV__WHEEL_BITS0 8
+#define UV__WHEEL_BITS 6
+#define UV__WHEEL_LEVELS 5
+#define UV__WHEEL_SIZE0 (1 << UV__WHEEL_BITS0)
+#define UV__WHEEL_SIZE (1 << UV__WHEEL_BITS)
+#define UV__WHEEL_RANGE 0xFFFFFFFFu
+
+#define UV__TIMER_QUEUE(handle) ((QUEUE*) &(handle)->heap_node)
+
+struct uv__timer_wheel {
+  uint64_t granularity;  /* Milliseconds per tick. */
+  uint64_t tick;         /* Next tick to expire. */
+  uint64_t count;
+  QUEUE level0[UV__WHEEL_SIZE0];
+  QUEUE levels[UV__WHEEL_LEVELS - 1][UV__WHEEL_SIZE];
+};
+
+
+static struct uv__timer_wheel* uv__loop_wheel(const uv_loop_t* loop) {
+  uv__loop_internal_fields_t* fields;
+
+  fields = uv__get_internal_fields(loop);
+  return fields != NULL ? fields->timer_wheel : NULL;
+}
+
+
+static unsigned int uv__wheel_shift(unsigned int level) {
+  return UV__WHEEL_BITS0 + (level - 1) * UV__WHEEL_BITS;
+}
+
+
+/* First tick at or after |timeout|. */
+static uint64_t uv__wheel_tick(const struct uv__timer_wheel* wheel,
+                               uint64_t timeout) {
+  return timeout / wheel->granularity + (timeout % wheel->granularity != 0);
+}
+
+
+static void uv__wheel_insert(struct uv__timer_wheel* wheel,
+                             uv_timer_t* handle) {
+  unsigned int level;
+  uint64_t delta;
+  uint64_t tick;
+  QUEUE* slot;
+  QUEUE* q;
+
+  tick = uv__wheel_tick(wheel, handle->timeout);
+  if (tick < wheel->tick)
+    tick = wheel->tick;
+  delta = tick - wheel->tick;
+
+  if (delta < UV__WHEEL_SIZE0) {
+    /* A timer that was just started has the highest start_id there is and
+     * goes last.  Only cascaded timers need to search for their place.
+     */
+    slot = &wheel->level0[tick & (UV__WHEEL_SIZE0 - 1)];
+    q = QUEUE_PREV(slot);
+    while (q != slot &&
+           QUEUE_DATA(q, uv_timer_t, heap_node)->start_id > handle->start_id)
+      q = QUEUE_PREV(q);
+    QUEUE_INSERT_HEAD(q, UV__TIMER_QUEUE(handle));
+    return;
+  }
+
+  /* Park far-off timers at the edge of the wheel, they are put back in the
+   * right place every time they cascade.
+   */
+  if (delta > UV__WHEEL_RANGE) {
+    delta = UV__WHEEL_RANGE;
+    tick = wheel->tick + delta;
+  }
+
+  for (level = 1; level < UV__WHEEL_LEVELS - 1; level++)
+    if ((delta >> uv__wheel_shift(level + 1)) == 0)
+      break;
+
+  slot = &wheel->levels[level - 1][(tick >> uv__wheel_shift(level)) &
+                                   (UV__WHEEL_SIZE - 1)];
+  QUEUE_INSERT_TAIL(slot, UV__TIMER_QUEUE(handle));
+}
+
+
+static void uv__wheel_cascade(struct uv__timer_wheel* wheel,
+                              unsigned int level,
+                              unsigned int index) {
+  QUEUE queue;
+  QUEUE* q;
+
+  QUEUE_MOVE(&wheel->levels[level - 1][index], &queue);
+  while (!QUEUE_EMPTY(&queue)) {
+    q = QUEUE_HEAD(&queue);
+    QUEUE_REMOVE(q);
+    uv__wheel_insert(wheel, QUEUE_DATA(q, uv_timer_t, heap_node));
+  }
+}
+
+
+static void uv__wheel_run(uv_loop_t* loop, struct uv__timer_wheel* wheel) {
+  unsigned int level;
+  unsigned int index;
+  uv_timer_t* handle;
+  uint64_t target;
+  QUEUE* slot;
+
+  target = loop->time / wheel->granularity;
+
+  while (wheel->tick <= target) {
+    if (wheel->count == 0) {
+      wheel->tick = target + 1;
+      break;
+    }
+
+    if ((wheel->tick & (UV__WHEEL_SIZE0 - 1)) == 0) {
+      for (level = 1; level < UV__WHEEL_LEVELS; level++) {
+        index = (wheel->tick >> uv__wheel_shift(level)) & (UV__WHEEL_SIZE - 1);
+        uv__wheel_cascade(wheel, level, index);
+        if (index != 0)
+          break;
+      }
+    }
+
+    /* Timers that are (re)started with a zero timeout from a callback land
+     * in this same slot and run in this same pass, as with the heap.
+     */
+    slot = &wheel->level0[wheel->tick & (UV__WHEEL_SIZE0 - 1)];
+    while (!QUEUE_EMPTY(slot)) {
+      handle = QUEUE_DATA(QUEUE_HEAD(slot), uv_timer_t, heap_node);
+      uv_timer_stop(handle);
+      uv_timer_again(handle);
+      handle->timer_cb(handle);
+    }
+
+    wheel->tick++;
+  }
+}
+
+
+static int uv__wheel_next_timeout(const uv_loop_t* loop,
+                                  const struct uv__timer_wheel* wheel) {
+  unsigned int level;
+  unsigned int shift;
+  unsigned int first;
+  uint64_t block;
+  uint64_t start;
+  uint64_t next;
+  uint64_t diff;
+  unsigned int i;
+
+  if (wheel->count == 0)
+    return -1; /* block indefinitely */
+
+  next = (uint64_t) -1;
+  for (i = 0; i < UV__WHEEL_SIZE0; i++) {
+    if (!QUEUE_EMPTY(&wheel->level0[(wheel->tick + i) &
+                                    (UV__WHEEL_SIZE0 - 1)])) {
+      next = wheel->tick + i;
+      break;
+    }
+  }
+
+  /* Timers on the upper levels are due no sooner than the start of their
+   * slot.  Wake up then to cascade them and take another look.  The slot of
+   * the current block has been cascaded already, unless the wheel stopped
+   * right at its start: uv__wheel_run() only cascades when it runs a tick.
+   */
+  for (level = 1; level < UV__WHEEL_LEVELS; level++) {
+    shift = uv__wheel_shift(level);
+    block = wheel->tick >> shift;
+    first = (wheel->tick & (((uint64_t) 1 << shift) - 1)) != 0;
+    for (i = first; i < first + UV__WHEEL_SIZE; i++) {
+      start = (block + i) << shift;
+      if (start >= next)
+        break;
+      if (!QUEUE_EMPTY(&wheel->levels[level - 1][(block + i) &
+                                                 (UV__WHEEL_SIZE - 1)])) {
+        next = start;
+        break;
+      }
+    }
+  }
+
+  next *= wheel->granularity;
+  if (next <= loop->time)
+    return 0;
+
+  diff = next - loop->time;
+  if (diff > INT_MAX)
+    diff = INT_MAX;
+
+  return diff;
+}
+
+
+int uv__timer_wheel_init(uv_loop_t* loop, unsigned int granularity) {
+  uv__loop_internal_fields_t* fields;
+  struct uv__timer_wheel* wheel;
+  unsigned int level;
+  unsigned int i;
+
+  if (granularity == 0)
+    return -EINVAL;
+
+  if (uv__loop_wheel(loop) != NULL || loop->timer_heap.nelts != 0)
+    return -EBUSY;
+
+  fields = uv__loop_alloc_internal_fields(loop);
+  if (fields == NULL)
+    return -ENOMEM;
+
+  wheel = uv__malloc(sizeof(*wheel));
+  if (wheel == NULL)
+    return -ENOMEM;
+
+  wheel->granularity = granularity;
+  wheel->tick = loop->time / granularity;
+  wheel->count = 0;
+  for (i = 0; i < UV__WHEEL_SIZE0; i++)
+    QUEUE_INIT(&wheel->level0[i]);
+  for (level = 1; level < UV__WHEEL_LEVELS; level++)
+    for (i = 0; i < UV__WHEEL_SIZE; i++)
+      QUEUE_INIT(&wheel->levels[level - 1][i]);
+
+  fields->timer_wheel = wheel;
+  return 0;
+}
+
+
+void uv__timer_wheel_free(uv_loop_t* loop) {
+  uv__loop_internal_fields_t* fields;
+
+  fields = uv__get_internal_fields(loop);
+  if (fields != NULL) {
+    uv__free(fields->timer_wheel);
+    fields->timer_wheel = NULL;
+  }
+}
+
 
 
 static int timer_less_than(const struct heap_node* ha,
@@ -63,6 +313,7 @@ int uv_timer_start(uv_timer_t* handle,
                    uv_timer_cb cb,
                    uint64_t timeout,
                    uint64_t repeat) {
+  struct uv__timer_wheel* wheel;
   uint64_t clamped_timeout;
 
   if (cb == NULL)
@@ -81,9 +332,15 @@ int uv_timer_start(uv_timer_t* handle,
   /* start_id is the second index to be compared in uv__timer_cmp() */
   handle->start_id = handle->loop->timer_counter++;
 
-  heap_insert((struct heap*) &handle->loop->timer_heap,
-              (struct heap_node*) &handle->heap_node,
-              timer_less_than);
+  wheel = uv__loop_wheel(handle->loop);
+  if (wheel != NULL) {
+    uv__wheel_insert(wheel, handle);
+    wheel->count++;
+  } else {
+    heap_insert((struct heap*) &handle->loop->timer_heap,
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
+  }
   uv__handle_start(handle);
 
   return 0;
@@ -91,12 +348,20 @@ int uv_timer_start(uv_timer_t* handle,
 
 
 int uv_timer_stop(uv_timer_t* handle) {
+  struct uv__timer_wheel* wheel;
+
   if (!uv__is_active(handle))
     return 0;
 
-  heap_remove((struct heap*) &handle->loop->timer_heap,
-              (struct heap_node*) &handle->heap_node,
-              timer_less_than);
+  wheel = uv__loop_wheel(handle->loop);
+  if (wheel != NULL) {
+    QUEUE_REMOVE(UV__TIMER_QUEUE(handle));
+    wheel->count--;
+  } else {
+    heap_remove((struct heap*) &handle->loop->timer_heap,
+                (struct heap_node*) &handle->heap_node,
+                timer_less_than);
+  }
   uv__handle_stop(handle);
 
   return 0;
@@ -127,10 +392,15 @@ uint64_t uv_timer_get_repeat(const uv_timer_t* handle) {
 
 
 int uv__next_timeout(const uv_loop_t* loop) {
+  const struct uv__timer_wheel* wheel;
   const struct heap_node* heap_node;
   const uv_timer_t* handle;
   uint64_t diff;
 
+  wheel = uv__loop_wheel(loop);
+  if (wheel != NULL)
+    return uv__wheel_next_timeout(loop, wheel);
+
   heap_node = heap_min((const struct heap*) &loop->timer_heap);
   if (heap_node == NULL)
     return -1; /* block indefinitely */
@@ -148,9 +418,16 @@ int uv__next_timeout(const uv_loop_t* loop) {
 
 
 void uv__run_timers(uv_loop_t* loop) {
+  struct uv__timer_wheel* wheel;
   struct heap_node* heap_node;
   uv_timer_t* handle;
 
+  wheel = uv__loop_wheel(loop);
+  if (wheel != NULL) {
+    uv__wheel_run(loop, wheel);
+    return;
+  }
+
   for (;;) {
     heap_node = heap_min((struct heap*) &loop->timer_heap);
     if (heap_node == NULL)
@@ -327,6 +327,12 @@ int uv__loop_configure(uv_loop_t* loop, uv_loop_option option, va_list ap) {
 }
 
 
+int uv_loop_metrics(const uv_loop_t* loop, uv_loop_metrics_t* metrics) {
+  memset(metrics, 0, sizeof(*metrics));
+  return UV_ENOSYS;
+}
+
+
 int uv_backend_fd(const uv_loop_t* loop) {
   return -1;
 }
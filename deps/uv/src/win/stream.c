@@ -247,3 +247,16 @@ int uv_stream_set_blocking(uv_stream_t* handle, int blocking) {
 
   return 0;
 }
+
+
+int uv_stream_cork(uv_stream_t* handle) {
+  /* Writes are handed to the kernel as overlapped requests right away, there
+   * is no per-request syscall to save.
+   */
+  return 0;
+}
+
+
+int uv_stream_uncork(uv_stream_t* handle) {
+  return 0;
+}
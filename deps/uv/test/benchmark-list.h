@@ -75,6 +75,13 @@ BENCHMARK_DECLARE (spawn)
 BENCHMARK_DECLARE (thread_create)
 BENCHMARK_DECLARE (million_async)
 BENCHMARK_DECLARE (million_timers)
+BENCHMARK_DECLARE (timer_rearm_heap)
+BENCHMARK_DECLARE (timer_rearm_wheel)
+#ifndef _WIN32
+BENCHMARK_DECLARE (sigchld_storm_1)
+BENCHMARK_DECLARE (sigchld_storm_4)
+BENCHMARK_DECLARE (spawn_storm_4)
+#endif
 HELPER_DECLARE    (tcp4_blackhole_server)
 HELPER_DECLARE    (tcp_pump_server)
 HELPER_DECLARE    (pipe_pump_server)
@@ -160,4 +167,11 @@ TASK_LIST_START
   BENCHMARK_ENTRY  (thread_create)
   BENCHMARK_ENTRY  (million_async)
   BENCHMARK_ENTRY  (million_timers)
+  BENCHMARK_ENTRY  (timer_rearm_heap)
+  BENCHMARK_ENTRY  (timer_rearm_wheel)
+#ifndef _WIN32
+  BENCHMARK_ENTRY  (sigchld_storm_1)
+  BENCHMARK_ENTRY  (sigchld_storm_4)
+  BENCHMARK_ENTRY  (spawn_storm_4)
+#endif
 TASK_LIST_END
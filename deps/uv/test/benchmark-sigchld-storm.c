@@ -0,0 +1,246 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* SIGCHLD storms: raise SIGCHLD as fast as possible while several loops are
+ * watching it, and have several loops reap short-lived children at the same
+ * time.
+ */
+
+#ifndef _WIN32
+
+#include "task.h"
+#include "uv.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NUM_SIGNALS (100 * 1000)
+#define NUM_EXITS 250
+#define CONCURRENCY 16
+
+struct ctx {
+  uv_loop_t loop;
+  uv_thread_t thread;
+  uv_sem_t ready;
+  uv_async_t stop_async;
+  uv_signal_t signal;
+  unsigned int callbacks;
+  unsigned int spawned;
+  unsigned int exited;
+};
+
+static char exepath[1024];
+
+
+static void signal_cb(uv_signal_t* handle, int signum) {
+  struct ctx* ctx = container_of(handle, struct ctx, signal);
+  ASSERT(signum == SIGCHLD);
+  ctx->callbacks++;
+}
+
+
+static void stop_async_cb(uv_async_t* handle) {
+  struct ctx* ctx = container_of(handle, struct ctx, stop_async);
+  uv_close((uv_handle_t*) &ctx->stop_async, NULL);
+  uv_close((uv_handle_t*) &ctx->signal, NULL);
+}
+
+
+static void signal_worker(void* arg) {
+  struct ctx* ctx = arg;
+  uv_sem_post(&ctx->ready);
+  ASSERT(0 == uv_run(&ctx->loop, UV_RUN_DEFAULT));
+}
+
+
+static int test_sigchld_storm(int nloops) {
+  struct ctx* loops;
+  struct ctx* ctx;
+  uint64_t time;
+  pid_t pid;
+  int i;
+
+  loops = calloc(nloops, sizeof(loops[0]));
+  ASSERT(loops != NULL);
+
+  for (i = 0; i < nloops; i++) {
+    ctx = loops + i;
+    ASSERT(0 == uv_loop_init(&ctx->loop));
+    ASSERT(0 == uv_sem_init(&ctx->ready, 0));
+    ASSERT(0 == uv_async_init(&ctx->loop, &ctx->stop_async, stop_async_cb));
+    ASSERT(0 == uv_signal_init(&ctx->loop, &ctx->signal));
+    ASSERT(0 == uv_signal_start(&ctx->signal, signal_cb, SIGCHLD));
+    ASSERT(0 == uv_thread_create(&ctx->thread, signal_worker, ctx));
+    uv_sem_wait(&ctx->ready);
+  }
+
+  pid = getpid();
+  time = uv_hrtime();
+
+  for (i = 0; i < NUM_SIGNALS; i++)
+    ASSERT(0 == kill(pid, SIGCHLD));
+
+  time = uv_hrtime() - time;
+
+  for (i = 0; i < nloops; i++) {
+    ctx = loops + i;
+    ASSERT(0 == uv_async_send(&ctx->stop_async));
+    ASSERT(0 == uv_thread_join(&ctx->thread));
+    ASSERT(ctx->callbacks > 0);
+    ASSERT(0 == uv_loop_close(&ctx->loop));
+    uv_sem_destroy(&ctx->ready);
+  }
+
+  fprintf(stderr,
+          "sigchld_storm_%d: %.0f signals/s, %.0f ns/signal, "
+          "%u callbacks on the first loop\n",
+          nloops,
+          NUM_SIGNALS / (time / 1e9),
+          (double) time / NUM_SIGNALS,
+          loops[0].callbacks);
+  fflush(stderr);
+
+  free(loops);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+static void spawn_child(struct ctx* ctx);
+
+
+static void close_cb(uv_handle_t* handle) {
+  free(handle);
+}
+
+
+static void exit_cb(uv_process_t* process,
+                    int64_t exit_status,
+                    int term_signal) {
+  struct ctx* ctx = process->data;
+
+  ASSERT(exit_status == 42);
+  ASSERT(term_signal == 0);
+  uv_close((uv_handle_t*) process, close_cb);
+
+  ctx->exited++;
+  if (ctx->spawned < NUM_EXITS)
+    spawn_child(ctx);
+}
+
+
+static void spawn_child(struct ctx* ctx) {
+  uv_process_options_t options;
+  uv_process_t* process;
+  char* args[3];
+
+  args[0] = exepath;
+  args[1] = "spawn_helper";
+  args[2] = NULL;
+
+  memset(&options, 0, sizeof(options));
+  options.file = exepath;
+  options.args = args;
+  options.exit_cb = exit_cb;
+
+  process = malloc(sizeof(*process));
+  ASSERT(process != NULL);
+  process->data = ctx;
+
+  ASSERT(0 == uv_spawn(&ctx->loop, process, &options));
+  ctx->spawned++;
+}
+
+
+static void spawn_worker(void* arg) {
+  struct ctx* ctx = arg;
+  int i;
+
+  for (i = 0; i < CONCURRENCY; i++)
+    spawn_child(ctx);
+
+  ASSERT(0 == uv_run(&ctx->loop, UV_RUN_DEFAULT));
+  ASSERT(ctx->exited == NUM_EXITS);
+}
+
+
+static int test_spawn_storm(int nloops) {
+  struct ctx* loops;
+  struct ctx* ctx;
+  size_t exepath_size;
+  uint64_t time;
+  int i;
+
+  exepath_size = sizeof(exepath);
+  ASSERT(0 == uv_exepath(exepath, &exepath_size));
+  exepath[exepath_size] = '\0';
+
+  loops = calloc(nloops, sizeof(loops[0]));
+  ASSERT(loops != NULL);
+
+  time = uv_hrtime();
+
+  for (i = 0; i < nloops; i++) {
+    ctx = loops + i;
+    ASSERT(0 == uv_loop_init(&ctx->loop));
+    ASSERT(0 == uv_thread_create(&ctx->thread, spawn_worker, ctx));
+  }
+
+  for (i = 0; i < nloops; i++) {
+    ctx = loops + i;
+    ASSERT(0 == uv_thread_join(&ctx->thread));
+    ASSERT(0 == uv_loop_close(&ctx->loop));
+  }
+
+  time = uv_hrtime() - time;
+
+  fprintf(stderr,
+          "spawn_storm_%d: %.0f exits/s\n",
+          nloops,
+          (double) nloops * NUM_EXITS / (time / 1e9));
+  fflush(stderr);
+
+  free(loops);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+BENCHMARK_IMPL(sigchld_storm_1) {
+  return test_sigchld_storm(1);
+}
+
+
+BENCHMARK_IMPL(sigchld_storm_4) {
+  return test_sigchld_storm(4);
+}
+
+
+BENCHMARK_IMPL(spawn_storm_4) {
+  return test_spawn_storm(4);
+}
+
+#endif  /* !_WIN32 */
@@ -0,0 +1,128 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "task.h"
+#include "uv.h"
+
+/* A million idle connections, each with an inactivity timeout of a minute
+ * that is pushed back whenever the connection sees traffic: 10k re-arms a
+ * second, spread over random timers.
+ */
+#define NUM_TIMERS (1000 * 1000)
+#define IDLE_TIMEOUT (60 * 1000)
+#define REARMS_PER_MS 10
+#define RUN_TIME 2000
+
+static uv_timer_t* timers;
+static uv_timer_t driver;
+static uint64_t rearm_time;
+static uint64_t rearms;
+static uint64_t started;
+static unsigned int seed;
+
+
+static void idle_cb(uv_timer_t* handle) {
+  FATAL("idle_cb should not have been called");
+}
+
+
+static void driver_cb(uv_timer_t* handle) {
+  uint64_t elapsed;
+  uint64_t before;
+
+  /* Catch up when the loop falls behind so the rate stays at 10k/s. */
+  elapsed = uv_now(handle->loop) - started;
+  before = uv_hrtime();
+  for (; rearms < elapsed * REARMS_PER_MS; rearms++) {
+    seed = seed * 1103515245 + 12345;
+    ASSERT(0 == uv_timer_again(timers + (seed >> 8) % NUM_TIMERS));
+  }
+  rearm_time += uv_hrtime() - before;
+
+  if (elapsed >= RUN_TIME)
+    uv_stop(handle->loop);
+}
+
+
+static int timer_rearm(unsigned int granularity) {
+  uv_loop_t loop;
+  uint64_t before_all;
+  uint64_t before_run;
+  uint64_t after_run;
+  int i;
+
+  timers = malloc(NUM_TIMERS * sizeof(timers[0]));
+  ASSERT(timers != NULL);
+
+  ASSERT(0 == uv_loop_init(&loop));
+  if (granularity != 0)
+    ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL, granularity));
+
+  rearm_time = 0;
+  rearms = 0;
+  seed = 42;
+
+  before_all = uv_hrtime();
+  for (i = 0; i < NUM_TIMERS; i++) {
+    ASSERT(0 == uv_timer_init(&loop, timers + i));
+    ASSERT(0 == uv_timer_start(timers + i, idle_cb, IDLE_TIMEOUT, IDLE_TIMEOUT));
+  }
+
+  ASSERT(0 == uv_timer_init(&loop, &driver));
+  ASSERT(0 == uv_timer_start(&driver, driver_cb, 1, 1));
+
+  uv_update_time(&loop);
+  started = uv_now(&loop);
+  before_run = uv_hrtime();
+  uv_run(&loop, UV_RUN_DEFAULT);
+  after_run = uv_hrtime();
+
+  for (i = 0; i < NUM_TIMERS; i++)
+    uv_close((uv_handle_t*) (timers + i), NULL);
+  uv_close((uv_handle_t*) &driver, NULL);
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(0 == uv_loop_close(&loop));
+  free(timers);
+
+  fprintf(stderr, "%s: %.2f seconds init, %.0f re-arms/s, %.0f ns/re-arm\n",
+          granularity != 0 ? "wheel" : "heap",
+          (before_run - before_all) / 1e9,
+          rearms / ((after_run - before_run) / 1e9),
+          (double) rearm_time / rearms);
+  fflush(stderr);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+BENCHMARK_IMPL(timer_rearm_heap) {
+  return timer_rearm(0);
+}
+
+
+BENCHMARK_IMPL(timer_rearm_wheel) {
+#ifdef _WIN32
+  RETURN_SKIP("UV_LOOP_TIMER_WHEEL is not supported on Windows");
+#else
+  return timer_rearm(1);
+#endif
+}
@@ -45,7 +45,7 @@
 static uv_fs_event_t fs_event;
 static const char file_prefix[] = "fsevent-";
 static const int fs_event_file_count = 16;
-#if defined(__APPLE__) || defined(_WIN32)
+#if defined(__APPLE__) || defined(_WIN32) || defined(__linux__)
 static const char file_prefix_in_subdir[] = "subdir";
 #endif
 static uv_timer_t timer;
@@ -217,7 +217,7 @@ static void fs_event_cb_dir_multi_file(uv_fs_event_t* handle,
   }
 }
 
-#if defined(__APPLE__) || defined(_WIN32)
+#if defined(__APPLE__) || defined(_WIN32) || defined(__linux__)
 static const char* fs_event_get_filename_in_subdir(int i) {
   snprintf(fs_event_filename,
            sizeof(fs_event_filename),
@@ -433,7 +433,7 @@ TEST_IMPL(fs_event_watch_dir) {
 }
 
 TEST_IMPL(fs_event_watch_dir_recursive) {
-#if defined(__APPLE__) || defined(_WIN32)
+#if defined(__APPLE__) || defined(_WIN32) || defined(__linux__)
   uv_loop_t* loop;
   int r;
 
@@ -476,6 +476,183 @@ TEST_IMPL(fs_event_watch_dir_recursive) {
 }
 
 
+#if defined(__linux__)
+static const char* recursive_expected[] = {
+  "a", "a/b", "a/b/file", "a", "c", "c/b/file2"
+};
+static int recursive_seen;
+
+
+static void fs_event_cb_recursive_new_subdir(uv_fs_event_t* handle,
+                                             const char* filename,
+                                             int events,
+                                             int status) {
+  uv_fs_t req;
+
+  ASSERT(handle == &fs_event);
+  ASSERT(status == 0);
+  ASSERT(filename != NULL);
+
+  /* Creating a file can report more than once, skip the repeats. */
+  if (recursive_seen > 0 &&
+      strcmp(filename, recursive_expected[recursive_seen - 1]) == 0) {
+    return;
+  }
+
+  ASSERT(recursive_seen < (int) ARRAY_SIZE(recursive_expected));
+  ASSERT(0 == strcmp(filename, recursive_expected[recursive_seen]));
+
+  /* Each step waits for the event of the previous one, so every new
+   * directory is watched by the time something happens in it.
+   */
+  switch (recursive_seen++) {
+  case 0:
+    create_dir("watch_dir/a/b");
+    break;
+  case 1:
+    create_file("watch_dir/a/b/file");
+    break;
+  case 2:
+    ASSERT(0 == uv_fs_rename(NULL, &req, "watch_dir/a", "watch_dir/c", NULL));
+    uv_fs_req_cleanup(&req);
+    break;
+  case 4:
+    create_file("watch_dir/c/b/file2");
+    break;
+  case 5:
+    uv_close((uv_handle_t*) handle, close_cb);
+    break;
+  }
+}
+#endif
+
+TEST_IMPL(fs_event_watch_dir_recursive_new_subdir) {
+#if defined(__linux__)
+  uv_loop_t* loop;
+
+  loop = uv_default_loop();
+  remove("watch_dir/c/b/file2");
+  remove("watch_dir/c/b/file");
+  remove("watch_dir/c/b");
+  remove("watch_dir/c");
+  remove("watch_dir/");
+  create_dir("watch_dir");
+
+  ASSERT(0 == uv_fs_event_init(loop, &fs_event));
+  ASSERT(0 == uv_fs_event_start(&fs_event,
+                                fs_event_cb_recursive_new_subdir,
+                                "watch_dir",
+                                UV_FS_EVENT_RECURSIVE));
+  create_dir("watch_dir/a");
+
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(recursive_seen == ARRAY_SIZE(recursive_expected));
+  ASSERT(close_cb_called == 1);
+
+  remove("watch_dir/c/b/file2");
+  remove("watch_dir/c/b/file");
+  remove("watch_dir/c/b");
+  remove("watch_dir/c");
+  remove("watch_dir/");
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#else
+  RETURN_SKIP("Only tests the inotify backend.");
+#endif
+}
+
+
+#if defined(__linux__)
+static uv_fs_event_t fs_event_recursive;
+static int overflow_plain_seen;
+static int overflow_recursive_seen;
+
+
+static void fs_event_cb_overflow(uv_fs_event_t* handle,
+                                 const char* filename,
+                                 int events,
+                                 int status) {
+  if (filename != NULL) {
+    ASSERT(status == 0);
+    return;
+  }
+
+  /* Only the recursive watcher hears about the overflow as an error. */
+  ASSERT(events == (UV_RENAME | UV_CHANGE));
+  if (handle == &fs_event) {
+    ASSERT(status == 0);
+    overflow_plain_seen++;
+  } else {
+    ASSERT(handle == &fs_event_recursive);
+    ASSERT(status == UV_ENOBUFS);
+    overflow_recursive_seen++;
+  }
+
+  if (overflow_plain_seen > 0 && overflow_recursive_seen > 0) {
+    uv_close((uv_handle_t*) &fs_event, close_cb);
+    uv_close((uv_handle_t*) &fs_event_recursive, close_cb);
+  }
+}
+#endif
+
+TEST_IMPL(fs_event_watch_dir_overflow) {
+#if defined(__linux__)
+  uv_loop_t* loop;
+  FILE* f;
+  int max_events;
+  int i;
+
+  f = fopen("/proc/sys/fs/inotify/max_queued_events", "r");
+  if (f == NULL)
+    RETURN_SKIP("Can't read the inotify queue size.");
+  ASSERT(1 == fscanf(f, "%d", &max_events));
+  fclose(f);
+  if (max_events > 65536)
+    RETURN_SKIP("The inotify queue is too large to overflow quickly.");
+
+  loop = uv_default_loop();
+  remove("watch_dir/file1");
+  remove("watch_dir/file2");
+  remove("watch_dir/");
+  create_dir("watch_dir");
+  create_file("watch_dir/file1");
+  create_file("watch_dir/file2");
+
+  ASSERT(0 == uv_fs_event_init(loop, &fs_event));
+  ASSERT(0 == uv_fs_event_start(&fs_event,
+                                fs_event_cb_overflow,
+                                "watch_dir",
+                                0));
+  ASSERT(0 == uv_fs_event_init(loop, &fs_event_recursive));
+  ASSERT(0 == uv_fs_event_start(&fs_event_recursive,
+                                fs_event_cb_overflow,
+                                "watch_dir",
+                                UV_FS_EVENT_RECURSIVE));
+
+  /* Alternate between two files, the kernel merges identical events that
+   * follow each other.
+   */
+  for (i = 0; i < max_events + 1024; i++)
+    touch_file(i & 1 ? "watch_dir/file1" : "watch_dir/file2");
+
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(overflow_plain_seen == 1);
+  ASSERT(overflow_recursive_seen == 1);
+  ASSERT(close_cb_called == 2);
+
+  remove("watch_dir/file1");
+  remove("watch_dir/file2");
+  remove("watch_dir/");
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#else
+  RETURN_SKIP("Only tests the inotify backend.");
+#endif
+}
+
+
 TEST_IMPL(fs_event_watch_file) {
 #if defined(__MVS__)
   RETURN_SKIP("Filesystem watching not supported on this platform.");
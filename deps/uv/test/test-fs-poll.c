@@ -24,6 +24,10 @@
 
 #include <string.h>
 
+#ifdef __linux__
+# include <sys/stat.h>
+#endif
+
 #define FIXTURE "testfile"
 
 static void timer_cb(uv_timer_t* handle);
@@ -185,3 +189,193 @@ TEST_IMPL(fs_poll_getpath) {
   MAKE_VALGRIND_HAPPY();
   return 0;
 }
+
+
+static int watch_cb_called;
+static uint64_t watch_ino;
+
+
+static void write_file(const char* path, const char* data) {
+  FILE* fp;
+
+  ASSERT((fp = fopen(path, "w")));
+  fputs(data, fp);
+  fclose(fp);
+}
+
+
+static void link_write_cb(uv_timer_t* handle) {
+  FILE* fp;
+
+  /* Append, truncating first could be seen as a change of its own. */
+  ASSERT((fp = fopen(FIXTURE ".lnk", "a")));
+  fputs(" and appended to", fp);
+  fclose(fp);
+}
+
+
+static void poll_cb_watch(uv_fs_poll_t* handle,
+                          int status,
+                          const uv_stat_t* prev,
+                          const uv_stat_t* curr) {
+  uv_fs_t req;
+
+  ASSERT(handle == &poll_handle);
+
+  switch (watch_cb_called++) {
+  case 0:
+    ASSERT(status == UV_ENOENT);
+    break;
+
+  case 1:
+    ASSERT(status == 0);
+    watch_ino = curr->st_ino;
+    /* Replace the file the way editors and config management do, and keep
+     * a second name for the new one.
+     */
+    write_file(FIXTURE ".tmp", "replaced");
+    ASSERT(0 == uv_fs_link(NULL, &req, FIXTURE ".tmp", FIXTURE ".lnk", NULL));
+    uv_fs_req_cleanup(&req);
+    ASSERT(0 == uv_fs_rename(NULL, &req, FIXTURE ".tmp", FIXTURE, NULL));
+    uv_fs_req_cleanup(&req);
+    break;
+
+  case 2:
+    ASSERT(status == 0);
+    ASSERT(prev->st_ino == watch_ino);
+    ASSERT(curr->st_ino != watch_ino);
+    watch_ino = curr->st_ino;
+    /* A write through the other name has to be seen as well, which means
+     * the new file is watched now.
+     */
+    ASSERT(0 == uv_timer_start(&timer_handle, link_write_cb, 50, 0));
+    break;
+
+  case 3:
+    ASSERT(status == 0);
+    ASSERT(curr->st_ino == watch_ino);
+    ASSERT(curr->st_size == (int64_t) strlen("replaced and appended to"));
+    remove(FIXTURE ".lnk");
+    remove(FIXTURE);
+    break;
+
+  case 4:
+    ASSERT(status == UV_ENOENT);
+    uv_close((uv_handle_t*) handle, close_cb);
+    uv_close((uv_handle_t*) &timer_handle, close_cb);
+    break;
+
+  default:
+    ASSERT(0);
+  }
+}
+
+
+TEST_IMPL(fs_poll_watch) {
+  loop = uv_default_loop();
+
+  remove(FIXTURE);
+  remove(FIXTURE ".tmp");
+  remove(FIXTURE ".lnk");
+
+  ASSERT(0 == uv_timer_init(loop, &timer_handle));
+  ASSERT(0 == uv_fs_poll_init(loop, &poll_handle));
+  ASSERT(0 == uv_fs_poll_start(&poll_handle, poll_cb_watch, FIXTURE, 10));
+
+  while (watch_cb_called == 0)
+    ASSERT(0 != uv_run(loop, UV_RUN_ONCE));
+
+#ifdef __linux__
+  /* Nothing left to do until inotify reports a change. */
+  ASSERT(-1 == uv_backend_timeout(loop));
+#endif
+
+  write_file(FIXTURE, "created");
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT(watch_cb_called == 5);
+  ASSERT(close_cb_called == 2);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+#ifdef __linux__
+#define OVERFLOW_DIR "fs_poll_overflow"
+
+static int overflow_cb_called;
+static int overflow_events;
+
+
+static void poll_cb_overflow(uv_fs_poll_t* handle,
+                             int status,
+                             const uv_stat_t* prev,
+                             const uv_stat_t* curr) {
+  int i;
+
+  switch (overflow_cb_called++) {
+  case 0:
+    ASSERT(status == UV_ENOENT);
+    /* Fill the inotify queue, then create the file.  Its event is dropped,
+     * only the overflow says that something happened.
+     */
+    for (i = 0; i < overflow_events + 1024; i++)
+      write_file(i & 1 ? OVERFLOW_DIR "/a" : OVERFLOW_DIR "/b", "x");
+    write_file(OVERFLOW_DIR "/file", "created");
+    break;
+
+  case 1:
+    ASSERT(status == 0);
+    ASSERT(curr->st_size == (int64_t) strlen("created"));
+    uv_close((uv_handle_t*) handle, close_cb);
+    break;
+
+  default:
+    ASSERT(0);
+  }
+}
+#endif
+
+
+TEST_IMPL(fs_poll_watch_overflow) {
+#ifdef __linux__
+  FILE* fp;
+
+  fp = fopen("/proc/sys/fs/inotify/max_queued_events", "r");
+  if (fp == NULL)
+    RETURN_SKIP("Can't read the inotify queue size.");
+  ASSERT(1 == fscanf(fp, "%d", &overflow_events));
+  fclose(fp);
+  if (overflow_events > 65536)
+    RETURN_SKIP("The inotify queue is too large to overflow quickly.");
+
+  loop = uv_default_loop();
+
+  remove(OVERFLOW_DIR "/a");
+  remove(OVERFLOW_DIR "/b");
+  remove(OVERFLOW_DIR "/file");
+  remove(OVERFLOW_DIR);
+  ASSERT(0 == mkdir(OVERFLOW_DIR, 0755));
+
+  ASSERT(0 == uv_fs_poll_init(loop, &poll_handle));
+  ASSERT(0 == uv_fs_poll_start(&poll_handle,
+                               poll_cb_overflow,
+                               OVERFLOW_DIR "/file",
+                               10));
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+
+  ASSERT(overflow_cb_called == 2);
+  ASSERT(close_cb_called == 1);
+
+  remove(OVERFLOW_DIR "/a");
+  remove(OVERFLOW_DIR "/b");
+  remove(OVERFLOW_DIR "/file");
+  remove(OVERFLOW_DIR);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#else
+  RETURN_SKIP("Only tests the inotify backend.");
+#endif
+}
@@ -32,6 +32,11 @@ TEST_DECLARE   (loop_stop)
 TEST_DECLARE   (loop_update_time)
 TEST_DECLARE   (loop_backend_timeout)
 TEST_DECLARE   (loop_configure)
+TEST_DECLARE   (loop_measure_time)
+TEST_DECLARE   (loop_metrics)
+TEST_DECLARE   (loop_edge_triggered)
+TEST_DECLARE   (loop_edge_triggered_write_queue)
+TEST_DECLARE   (loop_busy_poll)
 TEST_DECLARE   (default_loop_close)
 TEST_DECLARE   (barrier_1)
 TEST_DECLARE   (barrier_2)
@@ -76,6 +81,7 @@ TEST_DECLARE   (tcp_writealot)
 TEST_DECLARE   (tcp_write_fail)
 TEST_DECLARE   (tcp_try_write)
 TEST_DECLARE   (tcp_write_queue_order)
+TEST_DECLARE   (tcp_write_cork)
 TEST_DECLARE   (tcp_open)
 TEST_DECLARE   (tcp_open_twice)
 TEST_DECLARE   (tcp_connect_error_after_write)
@@ -166,6 +172,13 @@ TEST_DECLARE   (timer_run_once)
 TEST_DECLARE   (timer_from_check)
 TEST_DECLARE   (timer_null_callback)
 TEST_DECLARE   (timer_early_check)
+#ifndef _WIN32
+TEST_DECLARE   (timer_wheel_configure)
+TEST_DECLARE   (timer_wheel_order)
+TEST_DECLARE   (timer_wheel_granularity)
+TEST_DECLARE   (timer_wheel_again)
+TEST_DECLARE   (timer_wheel_boundary)
+#endif
 TEST_DECLARE   (idle_starvation)
 TEST_DECLARE   (loop_handles)
 TEST_DECLARE   (get_loadavg)
@@ -249,9 +262,13 @@ TEST_DECLARE   (spawn_stdout_and_stderr_to_file_swap)
 TEST_DECLARE   (spawn_auto_unref)
 TEST_DECLARE   (spawn_closed_process_io)
 TEST_DECLARE   (spawn_reads_child_path)
+TEST_DECLARE   (spawn_script_without_argv)
+TEST_DECLARE   (spawn_script_many_args)
 TEST_DECLARE   (spawn_inherit_streams)
 TEST_DECLARE   (fs_poll)
 TEST_DECLARE   (fs_poll_getpath)
+TEST_DECLARE   (fs_poll_watch)
+TEST_DECLARE   (fs_poll_watch_overflow)
 TEST_DECLARE   (kill)
 TEST_DECLARE   (fs_file_noent)
 TEST_DECLARE   (fs_file_nametoolong)
@@ -279,6 +296,8 @@ TEST_DECLARE   (fs_stat_missing_path)
 TEST_DECLARE   (fs_read_file_eof)
 TEST_DECLARE   (fs_event_watch_dir)
 TEST_DECLARE   (fs_event_watch_dir_recursive)
+TEST_DECLARE   (fs_event_watch_dir_recursive_new_subdir)
+TEST_DECLARE   (fs_event_watch_dir_overflow)
 TEST_DECLARE   (fs_event_watch_file)
 TEST_DECLARE   (fs_event_watch_file_exact_path)
 TEST_DECLARE   (fs_event_watch_file_twice)
@@ -383,6 +402,11 @@ TASK_LIST_START
   TEST_ENTRY  (loop_update_time)
   TEST_ENTRY  (loop_backend_timeout)
   TEST_ENTRY  (loop_configure)
+  TEST_ENTRY  (loop_measure_time)
+  TEST_ENTRY  (loop_metrics)
+  TEST_ENTRY  (loop_edge_triggered)
+  TEST_ENTRY  (loop_edge_triggered_write_queue)
+  TEST_ENTRY  (loop_busy_poll)
   TEST_ENTRY  (default_loop_close)
   TEST_ENTRY  (barrier_1)
   TEST_ENTRY  (barrier_2)
@@ -452,6 +476,7 @@ TASK_LIST_START
   TEST_ENTRY  (tcp_try_write)
 
   TEST_ENTRY  (tcp_write_queue_order)
+  TEST_ENTRY  (tcp_write_cork)
 
   TEST_ENTRY  (tcp_open)
   TEST_HELPER (tcp_open, tcp4_echo_server)
@@ -562,6 +587,13 @@ TASK_LIST_START
   TEST_ENTRY  (timer_from_check)
   TEST_ENTRY  (timer_null_callback)
   TEST_ENTRY  (timer_early_check)
+#ifndef _WIN32
+  TEST_ENTRY  (timer_wheel_configure)
+  TEST_ENTRY  (timer_wheel_order)
+  TEST_ENTRY  (timer_wheel_granularity)
+  TEST_ENTRY  (timer_wheel_again)
+  TEST_ENTRY  (timer_wheel_boundary)
+#endif
 
   TEST_ENTRY  (idle_starvation)
 
@@ -678,9 +710,13 @@ TASK_LIST_START
   TEST_ENTRY  (spawn_auto_unref)
   TEST_ENTRY  (spawn_closed_process_io)
   TEST_ENTRY  (spawn_reads_child_path)
+  TEST_ENTRY  (spawn_script_without_argv)
+  TEST_ENTRY  (spawn_script_many_args)
   TEST_ENTRY  (spawn_inherit_streams)
   TEST_ENTRY  (fs_poll)
   TEST_ENTRY  (fs_poll_getpath)
+  TEST_ENTRY  (fs_poll_watch)
+  TEST_ENTRY  (fs_poll_watch_overflow)
   TEST_ENTRY  (kill)
 
   TEST_ENTRY  (poll_close_doesnt_corrupt_stack)
@@ -738,6 +774,8 @@ TASK_LIST_START
   TEST_ENTRY  (fs_file_open_append)
   TEST_ENTRY  (fs_event_watch_dir)
   TEST_ENTRY  (fs_event_watch_dir_recursive)
+  TEST_ENTRY  (fs_event_watch_dir_recursive_new_subdir)
+  TEST_ENTRY  (fs_event_watch_dir_overflow)
   TEST_ENTRY  (fs_event_watch_file)
   TEST_ENTRY  (fs_event_watch_file_exact_path)
   TEST_ENTRY  (fs_event_watch_file_twice)
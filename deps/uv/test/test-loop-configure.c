@@ -36,3 +36,59 @@ TEST_IMPL(loop_configure) {
   ASSERT(0 == uv_loop_close(&loop));
   return 0;
 }
+
+
+static void busy_timer_cb(uv_timer_t* handle) {
+  uint64_t start;
+
+  /* Keep the loop busy for 5ms so that the iteration lands in the lag
+   * histogram well above the noise.
+   */
+  start = uv_hrtime();
+  while (uv_hrtime() - start < 5 * 1000 * 1000);
+  uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+TEST_IMPL(loop_measure_time) {
+  uv_loop_metrics_t metrics;
+  uv_timer_t timer_handle;
+  uv_loop_t loop;
+  uint64_t total;
+  uint64_t slow;
+  int i;
+
+  ASSERT(0 == uv_loop_init(&loop));
+#ifdef _WIN32
+  ASSERT(UV_ENOSYS == uv_loop_configure(&loop, UV_LOOP_MEASURE_TIME));
+  ASSERT(UV_ENOSYS == uv_loop_metrics(&loop, &metrics));
+#else
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_MEASURE_TIME));
+#endif
+  ASSERT(0 == uv_timer_init(&loop, &timer_handle));
+  ASSERT(0 == uv_timer_start(&timer_handle, busy_timer_cb, 20, 0));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+
+#ifndef _WIN32
+  ASSERT(0 == uv_loop_metrics(&loop, &metrics));
+  ASSERT(metrics.iterations > 0);
+  ASSERT(metrics.timers_time >= 5 * 1000 * 1000);
+#if defined(__linux__)
+  ASSERT(metrics.poll_block_time >= 10 * 1000 * 1000);
+#endif
+
+  /* Every iteration is counted once; the busy one is at least 4096us. */
+  total = 0;
+  slow = 0;
+  for (i = 0; i < UV_LOOP_LAG_BUCKETS; i++) {
+    total += metrics.lag_histogram[i];
+    if (i >= 4 * (12 - 1))
+      slow += metrics.lag_histogram[i];
+  }
+  ASSERT(total == metrics.iterations);
+  ASSERT(slow == 1);
+#endif
+
+  ASSERT(0 == uv_loop_close(&loop));
+  return 0;
+}
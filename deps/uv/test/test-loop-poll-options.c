@@ -0,0 +1,388 @@
+/* Copyright libuv project contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#ifndef __linux__
+
+TEST_IMPL(loop_metrics) {
+  RETURN_SKIP("Poller metrics are only kept on Linux.");
+}
+
+TEST_IMPL(loop_edge_triggered) {
+  RETURN_SKIP("Edge-triggered streams are only supported on Linux.");
+}
+
+TEST_IMPL(loop_busy_poll) {
+  RETURN_SKIP("Busy polling is only supported on Linux.");
+}
+
+TEST_IMPL(loop_edge_triggered_write_queue) {
+  RETURN_SKIP("Edge-triggered streams are only supported on Linux.");
+}
+
+#else  /* __linux__ */
+
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define TRANSFER_SIZE (1024 * 1024)
+#define PAUSE_EVERY (64 * 1024)
+
+static uv_loop_t loop;
+static uv_tcp_t server;
+static uv_tcp_t client;
+static uv_tcp_t incoming;
+static uv_connect_t connect_req;
+static uv_shutdown_t shutdown_req;
+static uv_write_t write_req;
+static uv_timer_t resume_timer;
+static char* send_data;
+static size_t received_len;
+static size_t pause_len;
+static int pause_count;
+static int read_cb_called;
+static int eof_cb_called;
+static int close_cb_called;
+static int write_cb_called;
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void small_alloc_cb(uv_handle_t* handle,
+                           size_t suggested_size,
+                           uv_buf_t* buf) {
+  /* Small buffers make uv__read() give up before it sees EAGAIN. */
+  static char slab[1024];
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void et_read_cb(uv_stream_t* stream,
+                       ssize_t nread,
+                       const uv_buf_t* buf);
+
+
+static void resume_cb(uv_timer_t* handle) {
+  ASSERT(0 == uv_read_start((uv_stream_t*) &incoming,
+                            small_alloc_cb,
+                            et_read_cb));
+}
+
+
+static void et_read_cb(uv_stream_t* stream,
+                       ssize_t nread,
+                       const uv_buf_t* buf) {
+  if (nread == UV_EOF) {
+    eof_cb_called++;
+    uv_close((uv_handle_t*) &incoming, close_cb);
+    uv_close((uv_handle_t*) &client, close_cb);
+    uv_close((uv_handle_t*) &server, close_cb);
+    uv_close((uv_handle_t*) &resume_timer, close_cb);
+    return;
+  }
+
+  ASSERT(nread >= 0);
+  received_len += nread;
+  pause_len += nread;
+
+  /* Stop reading with data still queued in the socket.  Nothing new
+   * arrives while paused once the sender is done, so resuming only works
+   * if uv_read_start() rearms the watcher.
+   */
+  if (pause_len >= PAUSE_EVERY) {
+    pause_len = 0;
+    pause_count++;
+    ASSERT(0 == uv_read_stop(stream));
+    ASSERT(0 == uv_timer_start(&resume_timer, resume_cb, 0, 0));
+  }
+}
+
+
+static void et_connection_cb(uv_stream_t* tcp, int status) {
+  ASSERT(status == 0);
+  ASSERT(0 == uv_tcp_init(tcp->loop, &incoming));
+  ASSERT(0 == uv_accept(tcp, (uv_stream_t*) &incoming));
+  ASSERT(0 == uv_read_start((uv_stream_t*) &incoming,
+                            small_alloc_cb,
+                            et_read_cb));
+}
+
+
+static void et_write_cb(uv_write_t* req, int status) {
+  ASSERT(status == 0);
+  write_cb_called++;
+}
+
+
+static void et_shutdown_cb(uv_shutdown_t* req, int status) {
+  ASSERT(status == 0);
+}
+
+
+static void et_connect_cb(uv_connect_t* req, int status) {
+  uv_buf_t buf;
+
+  ASSERT(status == 0);
+  buf = uv_buf_init(send_data, TRANSFER_SIZE);
+  ASSERT(0 == uv_write(&write_req, req->handle, &buf, 1, et_write_cb));
+  ASSERT(0 == uv_shutdown(&shutdown_req, req->handle, et_shutdown_cb));
+}
+
+
+TEST_IMPL(loop_edge_triggered) {
+  struct sockaddr_in addr;
+  uv_loop_metrics_t metrics;
+
+  send_data = malloc(TRANSFER_SIZE);
+  ASSERT(send_data != NULL);
+  memset(send_data, 'x', TRANSFER_SIZE);
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_EDGE_TRIGGERED));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_MEASURE_TIME));
+  ASSERT(0 == uv_timer_init(&loop, &resume_timer));
+
+  ASSERT(0 == uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+  ASSERT(0 == uv_tcp_init(&loop, &server));
+  ASSERT(0 == uv_tcp_bind(&server, (struct sockaddr*) &addr, 0));
+  ASSERT(0 == uv_listen((uv_stream_t*) &server, 128, et_connection_cb));
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT(0 == uv_tcp_init(&loop, &client));
+  ASSERT(0 == uv_tcp_connect(&connect_req,
+                             &client,
+                             (struct sockaddr*) &addr,
+                             et_connect_cb));
+
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+
+  ASSERT(write_cb_called == 1);
+  ASSERT(eof_cb_called == 1);
+  ASSERT(close_cb_called == 4);
+  ASSERT(received_len == TRANSFER_SIZE);
+  ASSERT(pause_count > 1);
+
+  ASSERT(0 == uv_loop_metrics(&loop, &metrics));
+  ASSERT(metrics.events > 0);
+  ASSERT(metrics.ctl_count > 0);
+
+  ASSERT(0 == uv_loop_close(&loop));
+  free(send_data);
+  return 0;
+}
+
+
+/* More buffers than uv__write() hands to a single writev(). */
+#define WRITE_BUFS 3000
+
+static uv_buf_t write_bufs[WRITE_BUFS];
+
+
+TEST_IMPL(loop_edge_triggered_write_queue) {
+  struct sockaddr_in addr;
+  int i;
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_EDGE_TRIGGERED));
+  ASSERT(0 == uv_timer_init(&loop, &resume_timer));
+
+  ASSERT(0 == uv_ip4_addr("0.0.0.0", TEST_PORT, &addr));
+  ASSERT(0 == uv_tcp_init(&loop, &server));
+  ASSERT(0 == uv_tcp_bind(&server, (struct sockaddr*) &addr, 0));
+  ASSERT(0 == uv_listen((uv_stream_t*) &server, 128, et_connection_cb));
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+  ASSERT(0 == uv_tcp_init(&loop, &client));
+  ASSERT(0 == uv_tcp_connect(&connect_req,
+                             &client,
+                             (struct sockaddr*) &addr,
+                             NULL));
+
+  /* Each writev() fits in the socket buffer and returns without EAGAIN,
+   * so the rest of the request only goes out if the watcher is rearmed.
+   */
+  for (i = 0; i < WRITE_BUFS; i++)
+    write_bufs[i] = uv_buf_init("x", 1);
+  ASSERT(0 == uv_write(&write_req,
+                       (uv_stream_t*) &client,
+                       write_bufs,
+                       WRITE_BUFS,
+                       et_write_cb));
+  ASSERT(0 == uv_shutdown(&shutdown_req,
+                          (uv_stream_t*) &client,
+                          et_shutdown_cb));
+
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+
+  ASSERT(write_cb_called == 1);
+  ASSERT(eof_cb_called == 1);
+  ASSERT(close_cb_called == 4);
+  ASSERT(received_len == WRITE_BUFS);
+
+  ASSERT(0 == uv_loop_close(&loop));
+  return 0;
+}
+
+
+static void count_read_cb(uv_stream_t* stream,
+                          ssize_t nread,
+                          const uv_buf_t* buf) {
+  ASSERT(nread > 0);
+  read_cb_called++;
+}
+
+
+static void metrics_alloc_cb(uv_handle_t* handle,
+                             size_t suggested_size,
+                             uv_buf_t* buf) {
+  static char slab[64 * 1024];
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void cancelled_write_cb(uv_write_t* req, int status) {
+  ASSERT(status == UV_ECANCELED);
+  write_cb_called++;
+}
+
+
+TEST_IMPL(loop_metrics) {
+  uv_loop_metrics_t before;
+  uv_loop_metrics_t after;
+  uv_pipe_t pipe_handle;
+  uv_buf_t buf;
+  char* data;
+  size_t size;
+  int fds[2];
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(UV_EINVAL == uv_loop_metrics(&loop, &before));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_MEASURE_TIME));
+  ASSERT(0 == uv_loop_metrics(&loop, &before));
+  ASSERT(before.poll_count == 0);
+
+  ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  ASSERT(0 == uv_pipe_init(&loop, &pipe_handle, 0));
+  ASSERT(0 == uv_pipe_open(&pipe_handle, fds[0]));
+  ASSERT(0 == uv_read_start((uv_stream_t*) &pipe_handle,
+                            metrics_alloc_cb,
+                            count_read_cb));
+
+  /* Nobody reads the other end, so this leaves POLLOUT enabled. */
+  size = 8 * 1024 * 1024;
+  data = calloc(1, size);
+  ASSERT(data != NULL);
+  buf = uv_buf_init(data, size);
+  ASSERT(0 == uv_write(&write_req,
+                       (uv_stream_t*) &pipe_handle,
+                       &buf,
+                       1,
+                       cancelled_write_cb));
+  ASSERT(pipe_handle.write_queue_size > 0);
+
+  ASSERT(0 != uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT(0 == uv_loop_metrics(&loop, &before));
+  ASSERT(before.poll_count > 0);
+  ASSERT(before.ctl_count > 0);
+
+  /* Dropping read interest while still writing costs no epoll_ctl(). */
+  ASSERT(0 == uv_read_stop((uv_stream_t*) &pipe_handle));
+  ASSERT(0 != uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT(0 == uv_loop_metrics(&loop, &after));
+  ASSERT(after.ctl_deferred == before.ctl_deferred + 1);
+  ASSERT(after.ctl_count == before.ctl_count);
+
+  /* Nor does taking it back before anything arrived. */
+  ASSERT(0 == uv_read_start((uv_stream_t*) &pipe_handle,
+                            metrics_alloc_cb,
+                            count_read_cb));
+  ASSERT(1 == write(fds[1], "x", 1));
+  ASSERT(0 != uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT(read_cb_called == 1);
+  ASSERT(0 == uv_loop_metrics(&loop, &before));
+  ASSERT(before.ctl_count == after.ctl_count);
+  ASSERT(before.events > after.events);
+
+  /* Input that shows up after a deferred stop is squelched and the
+   * registration narrowed on the spot.
+   */
+  ASSERT(0 == uv_read_stop((uv_stream_t*) &pipe_handle));
+  ASSERT(0 != uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT(1 == write(fds[1], "x", 1));
+  ASSERT(0 != uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT(read_cb_called == 1);
+  ASSERT(0 == uv_loop_metrics(&loop, &after));
+  ASSERT(after.ctl_count == before.ctl_count + 1);
+
+  uv_close((uv_handle_t*) &pipe_handle, close_cb);
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(write_cb_called == 1);
+  ASSERT(close_cb_called == 1);
+
+  ASSERT(0 == close(fds[1]));
+  ASSERT(0 == uv_loop_close(&loop));
+  free(data);
+  return 0;
+}
+
+
+static void busy_timer_cb(uv_timer_t* handle) {
+  uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+TEST_IMPL(loop_busy_poll) {
+  uv_loop_metrics_t metrics;
+  uv_timer_t timer;
+  uv_async_t async;
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_BUSY_POLL, 2000u));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_MEASURE_TIME));
+
+  /* Gives the poller a file descriptor to spin on. */
+  ASSERT(0 == uv_async_init(&loop, &async, NULL));
+  uv_unref((uv_handle_t*) &async);
+
+  ASSERT(0 == uv_timer_init(&loop, &timer));
+  ASSERT(0 == uv_timer_start(&timer, busy_timer_cb, 10, 0));
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(close_cb_called == 1);
+
+  ASSERT(0 == uv_loop_metrics(&loop, &metrics));
+  ASSERT(metrics.poll_count > 1);
+  ASSERT(metrics.poll_wakeups == 0);
+
+  uv_close((uv_handle_t*) &async, NULL);
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(0 == uv_loop_close(&loop));
+  return 0;
+}
+
+#endif  /* __linux__ */
@@ -1556,6 +1556,91 @@ TEST_IMPL(spawn_reads_child_path) {
   return 0;
 }
 
+TEST_IMPL(spawn_script_without_argv) {
+#ifdef _WIN32
+  RETURN_SKIP("Unix only test");
+#else
+  static const char script[] = "exit 1\n";
+  char* no_args[1];
+  int fd;
+  int r;
+
+  /* Without a #! line the kernel refuses to run the script, and it is
+   * handed to /bin/sh instead, the same as execvp() does.  An empty argv
+   * has to come out of that NULL-terminated too.
+   */
+  unlink("spawn_script");
+  fd = open("spawn_script", O_WRONLY | O_CREAT | O_TRUNC, 0755);
+  ASSERT(fd >= 0);
+  r = write(fd, script, sizeof(script) - 1);
+  ASSERT(r == sizeof(script) - 1);
+  close(fd);
+
+  init_process_options("", exit_cb);
+  no_args[0] = NULL;
+  options.file = "./spawn_script";
+  options.args = no_args;
+
+  r = uv_spawn(uv_default_loop(), &process, &options);
+  ASSERT(r == 0);
+
+  r = uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+  ASSERT(r == 0);
+
+  ASSERT(exit_cb_called == 1);
+  ASSERT(close_cb_called == 1);
+
+  unlink("spawn_script");
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#endif
+}
+
+TEST_IMPL(spawn_script_many_args) {
+#ifdef _WIN32
+  RETURN_SKIP("Unix only test");
+#else
+  static const char script[] = "exit 1\n";
+  static char* many_args[5000 + 1];
+  static uv_stdio_container_t stdio[4096];
+  int fd;
+  int i;
+  int r;
+
+  /* More arguments and stdio entries than fit on the child's stack. */
+  unlink("spawn_script");
+  fd = open("spawn_script", O_WRONLY | O_CREAT | O_TRUNC, 0755);
+  ASSERT(fd >= 0);
+  r = write(fd, script, sizeof(script) - 1);
+  ASSERT(r == sizeof(script) - 1);
+  close(fd);
+
+  init_process_options("", exit_cb);
+  for (i = 0; i < (int) ARRAY_SIZE(many_args) - 1; i++)
+    many_args[i] = "x";
+  many_args[i] = NULL;
+  for (i = 0; i < (int) ARRAY_SIZE(stdio); i++)
+    stdio[i].flags = UV_IGNORE;
+  options.file = "./spawn_script";
+  options.args = many_args;
+  options.stdio = stdio;
+  options.stdio_count = ARRAY_SIZE(stdio);
+
+  r = uv_spawn(uv_default_loop(), &process, &options);
+  ASSERT(r == 0);
+
+  r = uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+  ASSERT(r == 0);
+
+  ASSERT(exit_cb_called == 1);
+  ASSERT(close_cb_called == 1);
+
+  unlink("spawn_script");
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#endif
+}
+
 #ifndef _WIN32
 static int mpipe(int *fds) {
   if (pipe(fds) == -1)
@@ -0,0 +1,213 @@
+/* Copyright (c) 2017, Ben Noordhuis <info@bnoordhuis.nl>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <limits.h>
+#include <string.h>
+
+#ifndef _WIN32
+
+struct wheel_timer {
+  uv_timer_t handle;
+  uint64_t due;
+  int id;
+};
+
+static int fired[8];
+static int fired_count;
+static int repeat_cb_called;
+
+
+static void order_cb(uv_timer_t* handle) {
+  struct wheel_timer* t;
+
+  t = container_of(handle, struct wheel_timer, handle);
+  /* Never early, and not later than one tick plus some scheduling slack. */
+  ASSERT(uv_now(handle->loop) >= t->due);
+  ASSERT(fired_count < (int) ARRAY_SIZE(fired));
+  fired[fired_count++] = t->id;
+}
+
+
+TEST_IMPL(timer_wheel_configure) {
+  uv_timer_t handle;
+  uv_loop_t loop;
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(UV_EINVAL == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL, 0));
+
+  ASSERT(0 == uv_timer_init(&loop, &handle));
+  ASSERT(0 == uv_timer_start(&handle, order_cb, 1000, 0));
+  ASSERT(UV_EBUSY == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL, 1));
+  ASSERT(0 == uv_timer_stop(&handle));
+
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL, 1));
+  ASSERT(UV_EBUSY == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL, 1));
+
+  uv_close((uv_handle_t*) &handle, NULL);
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(0 == uv_loop_close(&loop));
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+static void run_order(unsigned int granularity) {
+  /* 300 and 260 start out on the second level and have to cascade. */
+  static const uint64_t timeouts[] = { 300, 20, 0, 20, 260, 10, 0, 300 };
+  static const int expected[] = { 2, 6, 5, 1, 3, 4, 0, 7 };
+  struct wheel_timer timers[ARRAY_SIZE(timeouts)];
+  uv_loop_t loop;
+  unsigned int i;
+
+  fired_count = 0;
+  memset(fired, 0, sizeof(fired));
+
+  ASSERT(0 == uv_loop_init(&loop));
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL, granularity));
+
+  for (i = 0; i < ARRAY_SIZE(timers); i++) {
+    timers[i].id = i;
+    timers[i].due = uv_now(&loop) + timeouts[i];
+    ASSERT(0 == uv_timer_init(&loop, &timers[i].handle));
+    ASSERT(0 == uv_timer_start(&timers[i].handle, order_cb, timeouts[i], 0));
+  }
+
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(fired_count == ARRAY_SIZE(expected));
+  for (i = 0; i < ARRAY_SIZE(expected); i++)
+    ASSERT(fired[i] == expected[i]);
+
+  for (i = 0; i < ARRAY_SIZE(timers); i++)
+    uv_close((uv_handle_t*) &timers[i].handle, NULL);
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(0 == uv_loop_close(&loop));
+}
+
+
+TEST_IMPL(timer_wheel_order) {
+  run_order(1);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(timer_wheel_granularity) {
+  /* Timeouts that fall between ticks round up, never down. */
+  run_order(7);
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+static uv_timer_t repeat_handle;
+static uv_timer_t stopped_handle;
+static uv_timer_t again_handle;
+
+
+static void never_cb(uv_timer_t* handle) {
+  FATAL("never_cb should not have been called");
+}
+
+
+TEST_IMPL(timer_wheel_boundary) {
+  uv_timer_t handle;
+  uv_loop_t loop;
+  uint64_t granularity;
+  int timeout;
+
+  ASSERT(0 == uv_loop_init(&loop));
+
+  /* Make tick 255, the last of the first level 1 block, span the current
+   * time with a few seconds to spare.
+   */
+  granularity = uv_now(&loop) / 255;
+  if (granularity < 2000 || granularity > UINT_MAX) {
+    ASSERT(0 == uv_loop_close(&loop));
+    RETURN_SKIP("Monotonic clock too young or too old for this test");
+  }
+
+  /* Start the wheel at tick 56, so that a timer due at tick 356, 100 ticks
+   * into the second block, goes on level 1.
+   */
+  loop.time = 56 * granularity;
+  ASSERT(0 == uv_loop_configure(&loop, UV_LOOP_TIMER_WHEEL,
+                                (unsigned int) granularity));
+  ASSERT(0 == uv_timer_init(&loop, &handle));
+  ASSERT(0 == uv_timer_start(&handle, never_cb, 300 * granularity, 0));
+
+  /* This runs ticks 56 to 255.  The wheel stops at tick 256, on the block
+   * boundary, and the timer's slot cascades only when that tick runs.  The
+   * loop has to wake up for it then, not one full turn of level 1 later.
+   */
+  ASSERT(0 != uv_run(&loop, UV_RUN_NOWAIT));
+  ASSERT(uv_now(&loop) / granularity == 255);
+  timeout = uv_backend_timeout(&loop);
+  ASSERT(timeout >= 0);
+  ASSERT((uint64_t) timeout <= granularity);
+
+  uv_close((uv_handle_t*) &handle, NULL);
+  ASSERT(0 == uv_run(&loop, UV_RUN_DEFAULT));
+  ASSERT(0 == uv_loop_close(&loop));
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+static void repeat_cb(uv_timer_t* handle) {
+  ASSERT(handle == &repeat_handle);
+  repeat_cb_called++;
+
+  /* Keep pushing the other timer back, it should never get to run. */
+  ASSERT(0 == uv_timer_again(&again_handle));
+
+  if (repeat_cb_called == 5) {
+    uv_close((uv_handle_t*) &repeat_handle, NULL);
+    uv_close((uv_handle_t*) &again_handle, NULL);
+  }
+}
+
+
+TEST_IMPL(timer_wheel_again) {
+  uv_loop_t* loop;
+  uint64_t start;
+
+  loop = uv_default_loop();
+  ASSERT(0 == uv_loop_configure(loop, UV_LOOP_TIMER_WHEEL, 1));
+
+  ASSERT(0 == uv_timer_init(loop, &stopped_handle));
+  ASSERT(0 == uv_timer_start(&stopped_handle, never_cb, 10, 0));
+  ASSERT(0 == uv_timer_stop(&stopped_handle));
+
+  ASSERT(0 == uv_timer_init(loop, &again_handle));
+  ASSERT(0 == uv_timer_start(&again_handle, never_cb, 100, 100));
+
+  ASSERT(0 == uv_timer_init(loop, &repeat_handle));
+  ASSERT(0 == uv_timer_start(&repeat_handle, repeat_cb, 0, 30));
+
+  start = uv_now(loop);
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(repeat_cb_called == 5);
+  ASSERT(uv_now(loop) - start >= 4 * 30);
+
+  uv_close((uv_handle_t*) &stopped_handle, NULL);
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+#endif  /* !_WIN32 */
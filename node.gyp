@@ -183,6 +183,7 @@
         'src/node_v8.cc',
         'src/node_stat_watcher.cc',
         'src/node_watchdog.cc',
+        'src/node_worker.cc',
         'src/node_zlib.cc',
         'src/node_i18n.cc',
         'src/pipe_wrap.cc',
@@ -227,6 +228,7 @@
         'src/node_root_certs.h',
         'src/node_version.h',
         'src/node_watchdog.h',
+        'src/node_worker.h',
         'src/node_wrap.h',
         'src/node_revert.h',
         'src/node_i18n.h',
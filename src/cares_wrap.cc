@@ -36,6 +36,7 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 
 #if defined(__ANDROID__) || \
     defined(__MINGW32__) || \
@@ -275,29 +276,27 @@ static void ares_sockstate_cb(void* data,
 
 static Local<Array> HostentToAddresses(Environment* env, struct hostent* host) {
   EscapableHandleScope scope(env->isolate());
-  Local<Array> addresses = Array::New(env->isolate());
+  std::vector<Local<Value>> addresses;
 
   char ip[INET6_ADDRSTRLEN];
   for (uint32_t i = 0; host->h_addr_list[i] != nullptr; ++i) {
     uv_inet_ntop(host->h_addrtype, host->h_addr_list[i], ip, sizeof(ip));
-    Local<String> address = OneByteString(env->isolate(), ip);
-    addresses->Set(i, address);
+    addresses.push_back(OneByteString(env->isolate(), ip));
   }
 
-  return scope.Escape(addresses);
+  return scope.Escape(env->NewArray(addresses.data(), addresses.size()));
 }
 
 
 static Local<Array> HostentToNames(Environment* env, struct hostent* host) {
   EscapableHandleScope scope(env->isolate());
-  Local<Array> names = Array::New(env->isolate());
+  std::vector<Local<Value>> names;
 
   for (uint32_t i = 0; host->h_aliases[i] != nullptr; ++i) {
-    Local<String> address = OneByteString(env->isolate(), host->h_aliases[i]);
-    names->Set(i, address);
+    names.push_back(OneByteString(env->isolate(), host->h_aliases[i]));
   }
 
-  return scope.Escape(names);
+  return scope.Escape(env->NewArray(names.data(), names.size()));
 }
 
 
@@ -996,8 +995,8 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
     struct addrinfo *address;
     int n = 0;
 
-    // Create the response array.
-    Local<Array> results = Array::New(env->isolate());
+    // Collect the response array elements.
+    std::vector<Local<Value>> results;
 
     char ip[INET6_ADDRSTRLEN];
     const char *addr;
@@ -1021,8 +1020,7 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
           continue;
 
         // Create JavaScript string
-        Local<String> s = OneByteString(env->isolate(), ip);
-        results->Set(n, s);
+        results.push_back(OneByteString(env->isolate(), ip));
         n++;
       }
 
@@ -1048,8 +1046,7 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
           continue;
 
         // Create JavaScript string
-        Local<String> s = OneByteString(env->isolate(), ip);
-        results->Set(n, s);
+        results.push_back(OneByteString(env->isolate(), ip));
         n++;
       }
 
@@ -1062,7 +1059,7 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
       argv[0] = Integer::New(env->isolate(), UV_EAI_NODATA);
     }
 
-    argv[1] = results;
+    argv[1] = env->NewArray(results.data(), results.size());
   }
 
   uv_freeaddrinfo(res);
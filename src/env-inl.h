@@ -26,6 +26,7 @@
 
 #include "env.h"
 #include "node.h"
+#include "node_i18n.h"
 #include "util.h"
 #include "util-inl.h"
 #include "uv.h"
@@ -223,6 +224,24 @@ inline Environment::Environment(IsolateData* isolate_data,
 inline Environment::~Environment() {
   v8::HandleScope handle_scope(isolate());
 
+  CleanupHandles();
+
+  context()->SetAlignedPointerInEmbedderData(kContextEmbedderDataIndex,
+                                             nullptr);
+#define V(PropertyName, TypeName) PropertyName ## _.Reset();
+  ENVIRONMENT_STRONG_PERSISTENT_PROPERTIES(V)
+#undef V
+
+  delete[] heap_statistics_buffer_;
+  delete[] heap_space_statistics_buffer_;
+  delete[] loop_metrics_buffer_;
+  delete[] http_parser_buffer_;
+#if defined(NODE_HAVE_I18N_SUPPORT)
+  i18n::FreeConverterCache(icu_converter_cache_);
+#endif
+}
+
+inline void Environment::CleanupHandles() {
   while (HandleCleanup* hc = handle_cleanup_queue_.PopFront()) {
     handle_cleanup_waiting_++;
     hc->cb_(this, hc->handle_, hc->arg_);
@@ -236,6 +255,8 @@ inline Environment::~Environment() {
   // prevents the async wrap destroy hook from being called.
   uv_handle_t* handle =
     reinterpret_cast<uv_handle_t*>(&destroy_ids_idle_handle_);
+  if (uv_is_closing(handle))
+    return;  // Already cleaned up.
   handle->data = this;
   handle_cleanup_waiting_ = 1;
   uv_close(handle, [](uv_handle_t* handle) {
@@ -244,16 +265,6 @@ inline Environment::~Environment() {
 
   while (handle_cleanup_waiting_ != 0)
     uv_run(event_loop(), UV_RUN_ONCE);
-
-  context()->SetAlignedPointerInEmbedderData(kContextEmbedderDataIndex,
-                                             nullptr);
-#define V(PropertyName, TypeName) PropertyName ## _.Reset();
-  ENVIRONMENT_STRONG_PERSISTENT_PROPERTIES(V)
-#undef V
-
-  delete[] heap_statistics_buffer_;
-  delete[] heap_space_statistics_buffer_;
-  delete[] http_parser_buffer_;
 }
 
 inline v8::Isolate* Environment::isolate() const {
@@ -371,6 +382,11 @@ inline void Environment::set_heap_space_statistics_buffer(double* pointer) {
   heap_space_statistics_buffer_ = pointer;
 }
 
+inline double* Environment::loop_metrics_buffer() const {
+  CHECK_NE(loop_metrics_buffer_, nullptr);
+  return loop_metrics_buffer_;
+}
+
 
 inline char* Environment::http_parser_buffer() const {
   return http_parser_buffer_;
@@ -390,6 +406,18 @@ inline void Environment::set_fs_stats_field_array(double* fields) {
   fs_stats_field_array_ = fields;
 }
 
+#if defined(NODE_HAVE_I18N_SUPPORT)
+inline i18n::ConverterCache* Environment::icu_converter_cache() const {
+  return icu_converter_cache_;
+}
+
+inline void Environment::set_icu_converter_cache(
+    i18n::ConverterCache* cache) {
+  CHECK_EQ(icu_converter_cache_, nullptr);  // Should be set only once.
+  icu_converter_cache_ = cache;
+}
+#endif
+
 inline Environment* Environment::from_cares_timer_handle(uv_timer_t* handle) {
   return ContainerOf(&Environment::cares_timer_handle_, handle);
 }
@@ -502,6 +530,23 @@ inline v8::Local<v8::Object> Environment::NewInternalFieldObject() {
   return m_obj.ToLocalChecked();
 }
 
+inline v8::Local<v8::Array> Environment::NewArray(
+    v8::Local<v8::Value>* values, size_t length) {
+#ifdef NODE_ENGINE_SPIDERMONKEY
+  return v8::Array::New(isolate(), values, length);
+#else
+  v8::Local<v8::Array> array = v8::Array::New(isolate());
+  v8::Local<v8::Function> fn = push_values_to_array_function();
+  for (size_t i = 0; i < length; i += NODE_PUSH_VAL_TO_ARRAY_MAX) {
+    size_t count = length - i;
+    if (count > NODE_PUSH_VAL_TO_ARRAY_MAX)
+      count = NODE_PUSH_VAL_TO_ARRAY_MAX;
+    fn->Call(context(), array, count, values + i).ToLocalChecked();
+  }
+  return array;
+#endif
+}
+
 #define VP(PropertyName, StringValue) V(v8::Private, PropertyName)
 #define VS(PropertyName, StringValue) V(v8::String, PropertyName)
 #define V(TypeName, PropertyName)                                             \
@@ -49,6 +49,12 @@ void Environment::Start(int argc,
   uv_unref(reinterpret_cast<uv_handle_t*>(&idle_prepare_handle_));
   uv_unref(reinterpret_cast<uv_handle_t*>(&idle_check_handle_));
 
+  uv_prepare_init(event_loop(), &loop_metrics_prepare_handle_);
+  uv_unref(reinterpret_cast<uv_handle_t*>(&loop_metrics_prepare_handle_));
+
+  uv_check_init(event_loop(), &native_immediate_check_handle_);
+  uv_unref(reinterpret_cast<uv_handle_t*>(&native_immediate_check_handle_));
+
   uv_idle_init(event_loop(), destroy_ids_idle_handle());
   uv_unref(reinterpret_cast<uv_handle_t*>(destroy_ids_idle_handle()));
 
@@ -76,6 +82,14 @@ void Environment::Start(int argc,
       reinterpret_cast<uv_handle_t*>(&idle_check_handle_),
       close_and_finish,
       nullptr);
+  RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(&loop_metrics_prepare_handle_),
+      close_and_finish,
+      nullptr);
+  RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(&native_immediate_check_handle_),
+      close_and_finish,
+      nullptr);
 
   if (start_profiler_idle_notifier) {
     StartProfilerIdleNotifier();
@@ -109,6 +123,73 @@ void Environment::StopProfilerIdleNotifier() {
   uv_check_stop(&idle_check_handle_);
 }
 
+void Environment::StartLoopMetrics() {
+  if (loop_metrics_buffer_ != nullptr)
+    return;
+
+  loop_metrics_buffer_ = new double[kLoopMetricsFieldsCount]();
+
+  // Not implemented on Windows; the array then stays all zeroes.
+  if (uv_loop_configure(event_loop(), UV_LOOP_MEASURE_TIME) != 0)
+    return;
+
+  // The prepare phase runs right before the loop goes to sleep, so the
+  // numbers are at most one iteration old when JS gets to look at them.
+  uv_prepare_start(&loop_metrics_prepare_handle_, [](uv_prepare_t* handle) {
+    Environment* env =
+        ContainerOf(&Environment::loop_metrics_prepare_handle_, handle);
+    env->UpdateLoopMetrics();
+  });
+}
+
+void Environment::UpdateLoopMetrics() {
+  uv_loop_metrics_t m;
+  if (uv_loop_metrics(event_loop(), &m) != 0)
+    return;
+
+  double* const fields = loop_metrics_buffer();
+  const double ms = 1e6;
+  fields[kLoopIterations] = static_cast<double>(m.iterations);
+  fields[kLoopTimersTime] = m.timers_time / ms;
+  fields[kLoopPendingTime] = m.pending_time / ms;
+  fields[kLoopIdlePrepareTime] = m.idle_prepare_time / ms;
+  fields[kLoopIdleTime] = m.poll_block_time / ms;
+  fields[kLoopPollTime] = m.poll_time / ms;
+  fields[kLoopCheckCloseTime] = m.check_close_time / ms;
+  fields[kLoopPollCount] = static_cast<double>(m.poll_count);
+  fields[kLoopPollWakeups] = static_cast<double>(m.poll_wakeups);
+  fields[kLoopEvents] = static_cast<double>(m.events);
+  for (int i = 0; i < UV_LOOP_LAG_BUCKETS; i++)
+    fields[kLoopLagHistogram + i] = static_cast<double>(m.lag_histogram[i]);
+}
+
+void Environment::SetNativeImmediate(NativeImmediateCallback cb,
+                                     void* data) {
+  if (native_immediates_.empty()) {
+    uv_check_start(&native_immediate_check_handle_, [](uv_check_t* handle) {
+      Environment* env =
+          ContainerOf(&Environment::native_immediate_check_handle_, handle);
+      // Callbacks can queue or cancel more, hence the index.
+      for (size_t i = 0; i < env->native_immediates_.size(); i++) {
+        auto entry = env->native_immediates_[i];
+        if (entry.first != nullptr)
+          entry.first(env, entry.second);
+      }
+      env->native_immediates_.clear();
+      uv_check_stop(handle);
+    });
+  }
+  native_immediates_.emplace_back(cb, data);
+}
+
+void Environment::CancelNativeImmediate(NativeImmediateCallback cb,
+                                        void* data) {
+  for (auto& entry : native_immediates_) {
+    if (entry.first == cb && entry.second == data)
+      entry.first = nullptr;
+  }
+}
+
 void Environment::PrintSyncTrace() const {
   if (!trace_sync_io_)
     return;
@@ -38,6 +38,7 @@
 
 #include <stdint.h>
 #include <vector>
+#include <utility>
 
 // Caveat emptor: we're going slightly crazy with macros here but the end
 // hopefully justifies the means. We have a lot of per-context properties
@@ -156,6 +157,7 @@ namespace node {
   V(nsname_string, "nsname")                                                  \
   V(ocsp_request_string, "OCSPRequest")                                       \
   V(onchange_string, "onchange")                                              \
+  V(onchanges_string, "onchanges")                                            \
   V(onclienthello_string, "onclienthello")                                    \
   V(oncomplete_string, "oncomplete")                                          \
   V(onconnection_string, "onconnection")                                      \
@@ -176,7 +178,9 @@ namespace node {
   V(onsignal_string, "onsignal")                                              \
   V(onstop_string, "onstop")                                                  \
   V(onwrite_string, "onwrite")                                                \
+  V(onwritebatch_string, "onwritebatch")                                      \
   V(output_string, "output")                                                  \
+  V(output_fd_string, "outputFd")                                             \
   V(order_string, "order")                                                    \
   V(owner_string, "owner")                                                    \
   V(parse_error_string, "Parse Error")                                        \
@@ -273,6 +277,12 @@ namespace node {
 
 class Environment;
 
+#if defined(NODE_HAVE_I18N_SUPPORT)
+namespace i18n {
+class ConverterCache;
+}  // namespace i18n
+#endif
+
 struct node_ares_task {
   Environment* env;
   ares_socket_t sock;
@@ -438,6 +448,36 @@ class Environment {
   void StartProfilerIdleNotifier();
   void StopProfilerIdleNotifier();
 
+  // Layout of the array returned by process._getLoopMetrics().  Times are
+  // cumulative milliseconds, see uv_loop_metrics_t for what they cover.
+  enum LoopMetricsFields {
+    kLoopIterations,
+    kLoopTimersTime,
+    kLoopPendingTime,
+    kLoopIdlePrepareTime,
+    kLoopIdleTime,
+    kLoopPollTime,
+    kLoopCheckCloseTime,
+    kLoopPollCount,
+    kLoopPollWakeups,
+    kLoopEvents,
+    kLoopLagHistogram,
+    kLoopMetricsFieldsCount = kLoopLagHistogram + UV_LOOP_LAG_BUCKETS
+  };
+
+  // Turns on libuv's phase timing and starts copying the numbers into
+  // loop_metrics_buffer() once per loop iteration.
+  void StartLoopMetrics();
+  void UpdateLoopMetrics();
+  inline double* loop_metrics_buffer() const;
+
+  // Runs |cb| in the check phase of the current loop iteration, after the
+  // I/O callbacks that queued it.  Used to hand JS a whole iteration's worth
+  // of events at once.  Whoever owns |data| cancels before freeing it.
+  typedef void (*NativeImmediateCallback)(Environment* env, void* data);
+  void SetNativeImmediate(NativeImmediateCallback cb, void* data);
+  void CancelNativeImmediate(NativeImmediateCallback cb, void* data);
+
   inline v8::Isolate* isolate() const;
   inline uv_loop_t* event_loop() const;
   inline bool async_wrap_callbacks_enabled() const;
@@ -455,6 +495,9 @@ class Environment {
                                     HandleCleanupCb cb,
                                     void *arg);
   inline void FinishHandleCleanup(uv_handle_t* handle);
+  // Closes the handles registered above and waits for them.  Run by the
+  // destructor; embedders that tear down the loop early may call it first.
+  inline void CleanupHandles();
 
   inline AsyncHooks* async_hooks();
   inline DomainFlag* domain_flag();
@@ -494,6 +537,11 @@ class Environment {
   inline double* fs_stats_field_array() const;
   inline void set_fs_stats_field_array(double* fields);
 
+#if defined(NODE_HAVE_I18N_SUPPORT)
+  inline i18n::ConverterCache* icu_converter_cache() const;
+  inline void set_icu_converter_cache(i18n::ConverterCache* cache);
+#endif
+
   inline void ThrowError(const char* errmsg);
   inline void ThrowTypeError(const char* errmsg);
   inline void ThrowRangeError(const char* errmsg);
@@ -525,6 +573,12 @@ class Environment {
 
   inline v8::Local<v8::Object> NewInternalFieldObject();
 
+  // Creates an array holding |length| values.  Engines with a bulk array
+  // constructor build it in one step, the others push the values through
+  // push_values_to_array_function() in NODE_PUSH_VAL_TO_ARRAY_MAX chunks.
+  inline v8::Local<v8::Array> NewArray(v8::Local<v8::Value>* values,
+                                       size_t length);
+
   // Strings and private symbols are shared across shared contexts
   // The getters simply proxy to the per-isolate primitive.
 #define VP(PropertyName, StringValue) V(v8::Private, PropertyName)
@@ -573,6 +627,9 @@ class Environment {
   uv_idle_t destroy_ids_idle_handle_;
   uv_prepare_t idle_prepare_handle_;
   uv_check_t idle_check_handle_;
+  uv_prepare_t loop_metrics_prepare_handle_;
+  uv_check_t native_immediate_check_handle_;
+  std::vector<std::pair<NativeImmediateCallback, void*>> native_immediates_;
   AsyncHooks async_hooks_;
   DomainFlag domain_flag_;
   TickInfo tick_info_;
@@ -599,11 +656,16 @@ class Environment {
 
   double* heap_statistics_buffer_ = nullptr;
   double* heap_space_statistics_buffer_ = nullptr;
+  double* loop_metrics_buffer_ = nullptr;
 
   char* http_parser_buffer_;
 
   double* fs_stats_field_array_;
 
+#if defined(NODE_HAVE_I18N_SUPPORT)
+  i18n::ConverterCache* icu_converter_cache_ = nullptr;
+#endif
+
 #define V(PropertyName, TypeName)                                             \
   v8::Persistent<TypeName> PropertyName ## _;
   ENVIRONMENT_STRONG_PERSISTENT_PROPERTIES(V)
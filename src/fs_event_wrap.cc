@@ -30,9 +30,12 @@
 #include "string_bytes.h"
 
 #include <stdlib.h>
+#include <string>
+#include <vector>
 
 namespace node {
 
+using v8::Array;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -52,6 +55,8 @@ class FSEventWrap: public HandleWrap {
   static void Start(const FunctionCallbackInfo<Value>& args);
   static void Close(const FunctionCallbackInfo<Value>& args);
 
+  void Close(Local<Value> close_callback = Local<Value>()) override;
+
   size_t self_size() const override { return sizeof(*this); }
 
  private:
@@ -63,8 +68,22 @@ class FSEventWrap: public HandleWrap {
   static void OnEvent(uv_fs_event_t* handle, const char* filename, int events,
     int status);
 
+  // In batch mode, events are collected and handed to onchanges() once per
+  // loop iteration as a flat [event, filename, event, filename, ...] array.
+  // Errors still go to onchange(), after the events that came before them.
+  struct Event {
+    Local<String> (Environment::*type)() const;
+    bool has_filename;
+    std::string filename;
+  };
+  static void FlushEvents(Environment* env, void* data);
+  void FlushEvents();
+  void DropEvents();
+
   uv_fs_event_t handle_;
   bool initialized_ = false;
+  bool batch_ = false;
+  std::vector<Event> events_;
   enum encoding encoding_ = kDefaultEncoding;
 };
 
@@ -78,6 +97,7 @@ FSEventWrap::FSEventWrap(Environment* env, Local<Object> object)
 
 FSEventWrap::~FSEventWrap() {
   CHECK_EQ(initialized_, false);
+  DropEvents();
 }
 
 
@@ -125,6 +145,7 @@ void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
     flags |= UV_FS_EVENT_RECURSIVE;
 
   wrap->encoding_ = ParseEncoding(env->isolate(), args[3], kDefaultEncoding);
+  wrap->batch_ = args[4]->IsTrue();
 
   int err = uv_fs_event_init(wrap->env()->event_loop(), &wrap->handle_);
   if (err == 0) {
@@ -156,6 +177,25 @@ void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
 
   CHECK_EQ(wrap->persistent().IsEmpty(), false);
 
+  if (wrap->batch_ && status == 0) {
+    if (wrap->events_.empty())
+      env->SetNativeImmediate(FlushEvents, wrap);
+    wrap->events_.push_back(Event {
+      (events & UV_RENAME) ? &Environment::rename_string
+                           : &Environment::change_string,
+      filename != nullptr,
+      filename != nullptr ? filename : ""
+    });
+    return;
+  }
+
+  if (!wrap->events_.empty()) {
+    env->CancelNativeImmediate(FlushEvents, wrap);
+    wrap->FlushEvents();
+    if (!wrap->initialized_)
+      return;  // Closed by the callback.
+  }
+
   // We're in a bind here. libuv can set both UV_RENAME and UV_CHANGE but
   // the Node API only lets us pass a single event to JS land.
   //
@@ -203,15 +243,69 @@ void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
 }
 
 
+void FSEventWrap::FlushEvents(Environment* env, void* data) {
+  static_cast<FSEventWrap*>(data)->FlushEvents();
+}
+
+
+void FSEventWrap::FlushEvents() {
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  std::vector<Event> events;
+  events.swap(events_);
+
+  Local<Array> list = Array::New(env->isolate(), 2 * events.size());
+  for (size_t i = 0; i < events.size(); i++) {
+    const Event& event = events[i];
+    Local<Value> fn = Null(env->isolate());
+    if (event.has_filename) {
+      fn = StringBytes::Encode(env->isolate(),
+                               event.filename.c_str(),
+                               encoding_);
+      // Not valid in the requested encoding, pass the raw bytes instead.
+      if (fn.IsEmpty()) {
+        fn = StringBytes::Encode(env->isolate(),
+                                 event.filename.data(),
+                                 event.filename.size(),
+                                 BUFFER);
+      }
+    }
+    list->Set(2 * i, (env->*event.type)());
+    list->Set(2 * i + 1, fn);
+  }
+
+  Local<Value> arg = list;
+  MakeCallback(env->onchanges_string(), 1, &arg);
+}
+
+
+void FSEventWrap::DropEvents() {
+  if (events_.empty())
+    return;
+  env()->CancelNativeImmediate(FlushEvents, this);
+  events_.clear();
+}
+
+
 void FSEventWrap::Close(const FunctionCallbackInfo<Value>& args) {
   FSEventWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
 
-  if (wrap == nullptr || wrap->initialized_ == false)
+  if (wrap == nullptr)
+    return;
+  wrap->Close(args[0]);
+}
+
+
+void FSEventWrap::Close(Local<Value> close_callback) {
+  if (initialized_ == false)
     return;
-  wrap->initialized_ = false;
+  initialized_ = false;
+  DropEvents();
 
-  HandleWrap::Close(args);
+  HandleWrap::Close(close_callback);
 }
 
 }  // namespace node
@@ -6,8 +6,12 @@
 #include "node_buffer.h"
 #include "stream_base.h"
 #include "stream_base-inl.h"
+#include "util.h"
+#include "util-inl.h"
 #include "v8.h"
 
+#include <string.h>
+
 namespace node {
 
 using v8::Array;
@@ -23,13 +27,19 @@ using v8::Value;
 
 JSStream::JSStream(Environment* env, Local<Object> obj, AsyncWrap* parent)
     : AsyncWrap(env, obj, AsyncWrap::PROVIDER_JSSTREAM, parent),
-      StreamBase(env) {
+      StreamBase(env),
+      batching_(false),
+      flush_scheduled_(false),
+      batched_data_(nullptr),
+      batched_length_(0),
+      batched_capacity_(0) {
   node::Wrap(obj, this);
   MakeWeak<JSStream>(this);
 }
 
 
 JSStream::~JSStream() {
+  free(batched_data_);
 }
 
 
@@ -87,6 +97,38 @@ int JSStream::DoWrite(WriteWrap* w,
                       uv_stream_t* send_handle) {
   CHECK_EQ(send_handle, nullptr);
 
+  if (batching_) {
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++)
+      size += bufs[i].len;
+
+    if (batched_length_ + size > batched_capacity_) {
+      size_t capacity = batched_capacity_ * 2;
+      if (capacity < batched_length_ + size)
+        capacity = batched_length_ + size;
+      if (capacity < 16384)
+        capacity = 16384;
+      batched_data_ = Realloc(batched_data_, capacity);
+      batched_capacity_ = capacity;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      memcpy(batched_data_ + batched_length_, bufs[i].base, bufs[i].len);
+      batched_length_ += bufs[i].len;
+    }
+
+    batched_writes_.push_back(w);
+    w->Dispatched();
+
+    if (!flush_scheduled_) {
+      // Stay alive until the batch has been handed over.
+      flush_scheduled_ = true;
+      ClearWeak();
+      env()->isolate()->EnqueueMicrotask(FlushWrites, this);
+    }
+    return 0;
+  }
+
   HandleScope scope(env()->isolate());
 
   Local<Array> bufs_arr = Array::New(env()->isolate(), count);
@@ -109,6 +151,51 @@ int JSStream::DoWrite(WriteWrap* w,
 }
 
 
+void JSStream::FlushWrites(void* data) {
+  static_cast<JSStream*>(data)->FlushWrites();
+}
+
+
+void JSStream::FlushWrites() {
+  flush_scheduled_ = false;
+  MakeWeak<JSStream>(this);
+
+  if (batched_writes_.empty())
+    return;
+
+  HandleScope scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+
+  std::vector<WriteWrap*> writes;
+  writes.swap(batched_writes_);
+
+  Local<Array> reqs = Array::New(env()->isolate(), writes.size());
+  for (size_t i = 0; i < writes.size(); i++)
+    reqs->Set(i, writes[i]->object());
+
+  // The buffer takes over the batch's memory.
+  Local<Object> data =
+      Buffer::New(env(), batched_data_, batched_length_).ToLocalChecked();
+  batched_data_ = nullptr;
+  batched_length_ = 0;
+  batched_capacity_ = 0;
+
+  Local<Value> argv[] = {
+    reqs,
+    data
+  };
+
+  Local<Value> res =
+      MakeCallback(env()->onwritebatch_string(), arraysize(argv), argv);
+
+  int err = res.IsEmpty() ? UV_EPROTO : res->Int32Value();
+  if (err != 0) {
+    for (WriteWrap* w : writes)
+      w->Done(err);
+  }
+}
+
+
 void JSStream::New(const FunctionCallbackInfo<Value>& args) {
   // This constructor should not be exposed to public javascript.
   // Therefore we assert that we are not trying to call this as a
@@ -181,26 +268,65 @@ void JSStream::Finish(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Takes a Buffer or an array of Buffers.  The chunks of an array are packed
+// into as few allocations as the consumer hands out, so that it sees one
+// read (and one EmitData()) rather than one per chunk.
 void JSStream::ReadBuffer(const FunctionCallbackInfo<Value>& args) {
   JSStream* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
 
-  CHECK(Buffer::HasInstance(args[0]));
-  char* data = Buffer::Data(args[0]);
-  int len = Buffer::Length(args[0]);
+  Local<Array> chunks;
+  uint32_t count = 1;
+  size_t total = 0;
+  if (args[0]->IsArray()) {
+    chunks = args[0].As<Array>();
+    count = chunks->Length();
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> chunk = chunks->Get(i);
+      CHECK(Buffer::HasInstance(chunk));
+      total += Buffer::Length(chunk);
+    }
+  } else {
+    CHECK(Buffer::HasInstance(args[0]));
+    total = Buffer::Length(args[0]);
+  }
 
-  do {
-    uv_buf_t buf;
-    ssize_t avail = len;
-    wrap->OnAlloc(len, &buf);
-    if (static_cast<ssize_t>(buf.len) < avail)
-      avail = buf.len;
+  uv_buf_t buf;
+  size_t filled = 0;
+  bool allocated = false;
+
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> chunk = chunks.IsEmpty() ? args[0] : chunks->Get(i);
+    const char* data = Buffer::Data(chunk);
+    size_t len = Buffer::Length(chunk);
+
+    while (len != 0) {
+      if (!allocated) {
+        wrap->OnAlloc(total, &buf);
+        CHECK_GT(buf.len, 0);
+        filled = 0;
+        allocated = true;
+      }
+
+      size_t avail = buf.len - filled;
+      if (len < avail)
+        avail = len;
+
+      memcpy(buf.base + filled, data, avail);
+      filled += avail;
+      data += avail;
+      len -= avail;
+      total -= avail;
+
+      if (filled == buf.len) {
+        wrap->OnRead(filled, &buf);
+        allocated = false;
+      }
+    }
+  }
 
-    memcpy(buf.base, data, avail);
-    data += avail;
-    len -= avail;
-    wrap->OnRead(avail, &buf);
-  } while (len != 0);
+  if (allocated)
+    wrap->OnRead(filled, &buf);
 }
 
 
@@ -212,6 +338,41 @@ void JSStream::EmitEOF(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void JSStream::SetBatching(const FunctionCallbackInfo<Value>& args) {
+  JSStream* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  wrap->batching_ = args[0]->IsTrue();
+}
+
+
+// doAfterWrite() plus finishWrite() for every request of a batch.
+void JSStream::FinishWriteBatch(const FunctionCallbackInfo<Value>& args) {
+  JSStream* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  CHECK(args[0]->IsArray());
+  Local<Array> reqs = args[0].As<Array>();
+  int status = args[1]->Int32Value();
+
+  for (uint32_t i = 0; i < reqs->Length(); i++) {
+    Local<Value> req = reqs->Get(i);
+    CHECK(req->IsObject());
+    // A request that is already gone can't be finished, but the ones after
+    // it still have to be, so fail them rather than leave them pending.
+    WriteWrap* w = Unwrap<WriteWrap>(req.As<Object>());
+    if (w == nullptr) {
+      if (status == 0)
+        status = UV_EPROTO;
+      continue;
+    }
+
+    wrap->OnAfterWrite(w);
+    w->Done(status);
+  }
+}
+
+
 void JSStream::Initialize(Local<Object> target,
                           Local<Value> unused,
                           Local<Context> context) {
@@ -228,6 +389,8 @@ void JSStream::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "finishShutdown", Finish<ShutdownWrap>);
   env->SetProtoMethod(t, "readBuffer", ReadBuffer);
   env->SetProtoMethod(t, "emitEOF", EmitEOF);
+  env->SetProtoMethod(t, "setBatching", SetBatching);
+  env->SetProtoMethod(t, "finishWriteBatch", FinishWriteBatch);
 
   StreamBase::AddMethods<JSStream>(env, t, StreamBase::kFlagHasWritev);
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "JSStream"),
@@ -8,6 +8,8 @@
 #include "stream_base.h"
 #include "v8.h"
 
+#include <vector>
+
 namespace node {
 
 class JSStream : public AsyncWrap, public StreamBase {
@@ -43,9 +45,26 @@ class JSStream : public AsyncWrap, public StreamBase {
   static void DoAfterWrite(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void ReadBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EmitEOF(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetBatching(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void FinishWriteBatch(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
   template <class Wrap>
   static void Finish(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+ private:
+  static void FlushWrites(void* data);
+  void FlushWrites();
+
+  // With batching on, DoWrite() only appends to a single buffer, and all
+  // writes of one tick reach JS together through
+  // `onwritebatch(reqs, data)`, from a microtask.
+  bool batching_;
+  bool flush_scheduled_;
+  std::vector<WriteWrap*> batched_writes_;
+  char* batched_data_;
+  size_t batched_length_;
+  size_t batched_capacity_;
 };
 
 }  // namespace node
@@ -165,6 +165,7 @@ static unsigned int preload_module_count = 0;
 static const char** preload_modules = nullptr;
 static const int v8_default_thread_pool_size = 4;
 static int v8_thread_pool_size = v8_default_thread_pool_size;
+static bool v8_thread_pool_size_set = false;
 static bool prof_process = false;
 static bool v8_is_profiling = false;
 static bool node_is_initialized = false;
@@ -1755,27 +1756,15 @@ static Local<Value> ExecuteString(Environment* env,
 static void GetActiveRequests(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
-  Local<Array> ary = Array::New(args.GetIsolate());
-  Local<Context> ctx = env->context();
-  Local<Function> fn = env->push_values_to_array_function();
-  Local<Value> argv[NODE_PUSH_VAL_TO_ARRAY_MAX];
-  size_t idx = 0;
+  std::vector<Local<Value>> requests;
 
   for (auto w : *env->req_wrap_queue()) {
     if (w->persistent().IsEmpty())
       continue;
-    argv[idx] = w->object();
-    if (++idx >= arraysize(argv)) {
-      fn->Call(ctx, ary, idx, argv).ToLocalChecked();
-      idx = 0;
-    }
+    requests.push_back(w->object());
   }
 
-  if (idx > 0) {
-    fn->Call(ctx, ary, idx, argv).ToLocalChecked();
-  }
-
-  args.GetReturnValue().Set(ary);
+  args.GetReturnValue().Set(env->NewArray(requests.data(), requests.size()));
 }
 
 
@@ -1784,11 +1773,7 @@ static void GetActiveRequests(const FunctionCallbackInfo<Value>& args) {
 void GetActiveHandles(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
-  Local<Array> ary = Array::New(env->isolate());
-  Local<Context> ctx = env->context();
-  Local<Function> fn = env->push_values_to_array_function();
-  Local<Value> argv[NODE_PUSH_VAL_TO_ARRAY_MAX];
-  size_t idx = 0;
+  std::vector<Local<Value>> handles;
 
   Local<String> owner_sym = env->owner_string();
 
@@ -1799,17 +1784,10 @@ void GetActiveHandles(const FunctionCallbackInfo<Value>& args) {
     Local<Value> owner = object->Get(owner_sym);
     if (owner->IsUndefined())
       owner = object;
-    argv[idx] = owner;
-    if (++idx >= arraysize(argv)) {
-      fn->Call(ctx, ary, idx, argv).ToLocalChecked();
-      idx = 0;
-    }
-  }
-  if (idx > 0) {
-    fn->Call(ctx, ary, idx, argv).ToLocalChecked();
+    handles.push_back(owner);
   }
 
-  args.GetReturnValue().Set(ary);
+  args.GetReturnValue().Set(env->NewArray(handles.data(), handles.size()));
 }
 
 
@@ -2377,6 +2355,24 @@ void CPUUsage(const FunctionCallbackInfo<Value>& args) {
   fields[1] = MICROS_PER_SEC * rusage.ru_stime.tv_sec + rusage.ru_stime.tv_usec;
 }
 
+// GetLoopMetrics turns on event loop timing and returns a Float64Array over
+// the environment's metrics buffer, laid out as Environment::LoopMetricsFields.
+// The buffer is refreshed in place once per loop iteration, so callers can
+// hold on to the array and sample it without calling back into C++.
+void GetLoopMetrics(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  env->StartLoopMetrics();
+  env->UpdateLoopMetrics();
+
+  const size_t count = Environment::kLoopMetricsFieldsCount;
+  Local<ArrayBuffer> ab =
+      ArrayBuffer::New(env->isolate(),
+                       env->loop_metrics_buffer(),
+                       sizeof(*env->loop_metrics_buffer()) * count);
+  args.GetReturnValue().Set(Float64Array::New(ab, 0, count));
+}
+
 extern "C" void node_module_register(void* m) {
   struct node_module* mp = reinterpret_cast<struct node_module*>(m);
 
@@ -3400,6 +3396,8 @@ void SetupProcessObject(Environment* env,
 
   env->SetMethod(process, "cpuUsage", CPUUsage);
 
+  env->SetMethod(process, "_getLoopMetrics", GetLoopMetrics);
+
   env->SetMethod(process, "dlopen", DLOpen);
 
   env->SetMethod(process, "uptime", Uptime);
@@ -3751,6 +3749,7 @@ static void ParseArgs(int* argc,
       new_v8_argc += 1;
     } else if (strncmp(arg, "--v8-pool-size=", 15) == 0) {
       v8_thread_pool_size = atoi(arg + 15);
+      v8_thread_pool_size_set = true;
 #if HAVE_OPENSSL
     } else if (strncmp(arg, "--tls-cipher-list=", 18) == 0) {
       default_cipher_list = arg + 18;
@@ -4594,6 +4593,13 @@ int Start(int argc, char** argv) {
 #endif  // HAVE_OPENSSL
 
   v8_platform.Initialize(v8_thread_pool_size);
+#ifdef NODE_ENGINE_SPIDERMONKEY
+  // There is no platform thread pool to size; let the flag size
+  // SpiderMonkey's helper threads instead.  Without it, SpiderMonkey sizes
+  // them for the number of CPUs the system reports.
+  if (v8_thread_pool_size_set && v8_thread_pool_size > 0)
+    V8::SetHelperThreadCPUCount(v8_thread_pool_size);
+#endif
   // Enable tracing when argv has --trace-events-enabled.
   if (trace_enabled) {
     fprintf(stderr, "Warning: Trace event is an experimental feature "
@@ -207,16 +207,26 @@ bool HasInstance(Local<Object> obj) {
 char* Data(Local<Value> val) {
   CHECK(val->IsUint8Array());
   Local<Uint8Array> ui = val.As<Uint8Array>();
+#ifdef NODE_ENGINE_SPIDERMONKEY
+  size_t length;
+  return static_cast<char*>(ui->GetData(&length));
+#else
   ArrayBuffer::Contents ab_c = ui->Buffer()->GetContents();
   return static_cast<char*>(ab_c.Data()) + ui->ByteOffset();
+#endif
 }
 
 
 char* Data(Local<Object> obj) {
   CHECK(obj->IsUint8Array());
   Local<Uint8Array> ui = obj.As<Uint8Array>();
+#ifdef NODE_ENGINE_SPIDERMONKEY
+  size_t length;
+  return static_cast<char*>(ui->GetData(&length));
+#else
   ArrayBuffer::Contents ab_c = ui->Buffer()->GetContents();
   return static_cast<char*>(ab_c.Data()) + ui->ByteOffset();
+#endif
 }
 
 
@@ -807,11 +817,17 @@ void WriteFloatGeneric(const FunctionCallbackInfo<Value>& args) {
   }
 
   Local<Uint8Array> ts_obj = args[0].As<Uint8Array>();
+#ifdef NODE_ENGINE_SPIDERMONKEY
+  size_t ts_obj_length;
+  char* const ts_obj_data =
+      static_cast<char*>(ts_obj->GetData(&ts_obj_length));
+#else
   ArrayBuffer::Contents ts_obj_c = ts_obj->Buffer()->GetContents();
   const size_t ts_obj_offset = ts_obj->ByteOffset();
   const size_t ts_obj_length = ts_obj->ByteLength();
   char* const ts_obj_data =
       static_cast<char*>(ts_obj_c.Data()) + ts_obj_offset;
+#endif
   if (ts_obj_length > 0)
     CHECK_NE(ts_obj_data, nullptr);
 
@@ -112,6 +112,7 @@ class ContextifyContext {
     return Local<Object>::Cast(context()->GetEmbedderData(kSandboxObjectIndex));
   }
 
+#ifndef NODE_ENGINE_SPIDERMONKEY
   // XXX(isaacs): This function only exists because of a shortcoming of
   // the V8 SetNamedPropertyHandler function.
   //
@@ -197,6 +198,7 @@ class ContextifyContext {
     }
   }
 }
+#endif  // !NODE_ENGINE_SPIDERMONKEY
 
 
   // This is an object that just keeps an internal pointer to this
@@ -234,6 +236,9 @@ class ContextifyContext {
                                              GlobalPropertyDeleterCallback,
                                              GlobalPropertyEnumeratorCallback,
                                              CreateDataWrapper(env));
+#ifdef NODE_ENGINE_SPIDERMONKEY
+    config.definer = GlobalPropertyDefinerCallback;
+#endif
     object_template->SetHandler(config);
 
     Local<Context> ctx = Context::New(env->isolate(), nullptr, object_template);
@@ -487,6 +492,70 @@ class ContextifyContext {
   }
 
 
+#ifdef NODE_ENGINE_SPIDERMONKEY
+  // SpiderMonkey sends every definition on the global through here: var and
+  // function declarations, Object.defineProperty(), and assignments to
+  // undeclared names.  Defining them on the sandbox instead of the global
+  // keeps the two in sync, which is what CopyProperties() does for V8 after
+  // each run.
+  static void GlobalPropertyDefinerCallback(
+      Local<Name> property,
+      const PropertyDescriptor& desc,
+      const PropertyCallbackInfo<Value>& args) {
+    ContextifyContext* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Data().As<Object>());
+
+    // Still initializing
+    if (ctx->context_.IsEmpty())
+      return;
+
+    Local<Context> context = ctx->context();
+    auto attributes = PropertyAttribute::None;
+    bool is_declared =
+        ctx->global_proxy()->GetRealNamedPropertyAttributes(context, property)
+        .To(&attributes);
+    bool read_only =
+        static_cast<int>(attributes) &
+        static_cast<int>(PropertyAttribute::ReadOnly);
+
+    // Read-only globals such as undefined are left to the global.
+    if (is_declared && read_only)
+      return;
+
+    Local<Object> sandbox = ctx->sandbox();
+    auto define_property_on_sandbox = [&] (PropertyDescriptor* sandbox_desc) {
+      if (desc.has_enumerable())
+        sandbox_desc->set_enumerable(desc.enumerable());
+      if (desc.has_configurable())
+        sandbox_desc->set_configurable(desc.configurable());
+      if (sandbox->DefineProperty(context, property, *sandbox_desc).IsJust()) {
+        args.GetReturnValue().Set(true);
+      }
+    };
+
+    if (desc.has_get() || desc.has_set()) {
+      PropertyDescriptor desc_for_sandbox(
+          desc.has_get() ? desc.get() : Local<Value>(),
+          desc.has_set() ? desc.set() : Local<Value>());
+      define_property_on_sandbox(&desc_for_sandbox);
+    } else if (desc.has_value() || desc.has_writable()) {
+      Local<Value> value = desc.has_value() ?
+          desc.value() : Undefined(ctx->env()->isolate()).As<Value>();
+      if (desc.has_writable()) {
+        PropertyDescriptor desc_for_sandbox(value, desc.writable());
+        define_property_on_sandbox(&desc_for_sandbox);
+      } else {
+        PropertyDescriptor desc_for_sandbox(value);
+        define_property_on_sandbox(&desc_for_sandbox);
+      }
+    } else {
+      PropertyDescriptor desc_for_sandbox;
+      define_property_on_sandbox(&desc_for_sandbox);
+    }
+  }
+#endif  // NODE_ENGINE_SPIDERMONKEY
+
+
   static void GlobalPropertyEnumeratorCallback(
       const PropertyCallbackInfo<Array>& args) {
     ContextifyContext* ctx;
@@ -518,6 +587,9 @@ class ContextifyScript : public BaseObject {
 
     target->Set(class_name, script_tmpl->GetFunction());
     env->set_script_context_constructor_template(script_tmpl);
+#ifdef NODE_ENGINE_SPIDERMONKEY
+    env->SetMethod(target, "compileScriptAsync", CompileAsync);
+#endif
   }
 
 
@@ -602,6 +674,135 @@ class ContextifyScript : public BaseObject {
   }
 
 
+#ifdef NODE_ENGINE_SPIDERMONKEY
+  // Compiles a script on one of SpiderMonkey's helper threads and hands the
+  // resulting ContextifyScript to a callback on the event loop, so that
+  // parsing large sources doesn't block the loop.
+  class AsyncCompile {
+   public:
+    AsyncCompile(Environment* env,
+                 Local<Function> callback,
+                 bool display_errors)
+        : env_(env),
+          callback_(env->isolate(), callback),
+          display_errors_(display_errors),
+          task_(nullptr) {
+      CHECK_EQ(0, uv_async_init(env->event_loop(), &async_, AfterCompile));
+    }
+
+    ~AsyncCompile() {
+      callback_.Reset();
+    }
+
+    bool Start(ScriptCompiler::Source* source) {
+      return ScriptCompiler::StartOffThreadCompile(env_->isolate(),
+                                                   source,
+                                                   OnCompiled,
+                                                   this) != nullptr;
+    }
+
+    void Close() {
+      uv_close(reinterpret_cast<uv_handle_t*>(&async_), OnClose);
+    }
+
+   private:
+    // May run on a helper thread, so it must not touch the isolate.
+    static void OnCompiled(ScriptCompiler::OffThreadCompileTask* task,
+                           void* data) {
+      AsyncCompile* req = static_cast<AsyncCompile*>(data);
+      req->task_ = task;
+      CHECK_EQ(0, uv_async_send(&req->async_));
+    }
+
+    static void AfterCompile(uv_async_t* handle) {
+      AsyncCompile* req = ContainerOf(&AsyncCompile::async_, handle);
+      Environment* env = req->env_;
+      HandleScope handle_scope(env->isolate());
+      Context::Scope context_scope(env->context());
+
+      Local<Value> argv[] = {
+        Null(env->isolate()),
+        Undefined(env->isolate())
+      };
+      {
+        TryCatch try_catch(env->isolate());
+        MaybeLocal<UnboundScript> v8_script =
+            ScriptCompiler::FinishOffThreadCompile(env->isolate(), req->task_);
+        if (v8_script.IsEmpty()) {
+          if (req->display_errors_) {
+            DecorateErrorStack(env, try_catch);
+          }
+          argv[0] = try_catch.Exception();
+        } else {
+          Local<Object> object =
+              env->script_context_constructor_template()->InstanceTemplate()
+                  ->NewInstance(env->context()).ToLocalChecked();
+          ContextifyScript* contextify_script =
+              new ContextifyScript(env, object);
+          contextify_script->script_.Reset(env->isolate(),
+                                           v8_script.ToLocalChecked());
+          argv[1] = object;
+        }
+      }
+
+      Local<Function> callback =
+          PersistentToLocal(env->isolate(), req->callback_);
+      req->Close();
+      MakeCallback(env, Undefined(env->isolate()), callback,
+                   arraysize(argv), argv);
+    }
+
+    static void OnClose(uv_handle_t* handle) {
+      AsyncCompile* req = ContainerOf(&AsyncCompile::async_,
+                                      reinterpret_cast<uv_async_t*>(handle));
+      delete req;
+    }
+
+    Environment* const env_;
+    Persistent<Function> callback_;
+    const bool display_errors_;
+    ScriptCompiler::OffThreadCompileTask* task_;
+    uv_async_t async_;
+  };
+
+
+  // args: code, [options], callback
+  static void CompileAsync(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+
+    if (!args[2]->IsFunction()) {
+      return env->ThrowTypeError("callback must be a function");
+    }
+
+    TryCatch try_catch(env->isolate());
+    Local<String> code = args[0]->ToString(env->isolate());
+
+    Local<Value> options = args[1];
+    Local<String> filename = GetFilenameArg(env, options);
+    Local<Integer> lineOffset = GetLineOffsetArg(env, options);
+    Local<Integer> columnOffset = GetColumnOffsetArg(env, options);
+    bool display_errors = GetDisplayErrorsArg(env, options);
+    if (try_catch.HasCaught()) {
+      try_catch.ReThrow();
+      return;
+    }
+
+    ScriptOrigin origin(filename, lineOffset, columnOffset);
+    ScriptCompiler::Source source(code, origin);
+    AsyncCompile* req =
+        new AsyncCompile(env, args[2].As<Function>(), display_errors);
+    if (!req->Start(&source)) {
+      req->Close();
+      // Thrown inside |try_catch| so that it is rethrown along with any
+      // exception the engine left pending.
+      if (!try_catch.HasCaught())
+        env->ThrowError("Failed to start compiling script.");
+      try_catch.ReThrow();
+    }
+  }
+#endif
+
+
   static bool InstanceOf(Environment* env, const Local<Value>& value) {
     return !value.IsEmpty() &&
            env->script_context_constructor_template()->HasInstance(value);
@@ -668,6 +869,15 @@ class ContextifyScript : public BaseObject {
       TryCatch try_catch(env->isolate());
       // Do the eval within the context
       Context::Scope context_scope(contextify_context->context());
+#ifdef NODE_ENGINE_SPIDERMONKEY
+      // The definer has already put any new globals on the sandbox.
+      EvalMachine(contextify_context->env(),
+                  timeout,
+                  display_errors,
+                  break_on_sigint,
+                  args,
+                  &try_catch);
+#else
       if (EvalMachine(contextify_context->env(),
                       timeout,
                       display_errors,
@@ -676,6 +886,7 @@ class ContextifyScript : public BaseObject {
                       &try_catch)) {
         contextify_context->CopyProperties();
       }
+#endif
 
       if (try_catch.HasCaught()) {
         try_catch.ReThrow();
@@ -287,10 +287,8 @@ static void After(uv_fs_t *req) {
       case UV_FS_SCANDIR:
         {
           int r;
-          Local<Array> names = Array::New(env->isolate(), 0);
-          Local<Function> fn = env->push_values_to_array_function();
-          Local<Value> name_argv[NODE_PUSH_VAL_TO_ARRAY_MAX];
-          size_t name_idx = 0;
+          std::vector<Local<Value>> names;
+          names.reserve(req->result);
 
           for (int i = 0; ; i++) {
             uv_dirent_t ent;
@@ -318,21 +316,10 @@ static void After(uv_fs_t *req) {
                                     req_wrap->data());
               break;
             }
-            name_argv[name_idx++] = filename;
-
-            if (name_idx >= arraysize(name_argv)) {
-              fn->Call(env->context(), names, name_idx, name_argv)
-                  .ToLocalChecked();
-              name_idx = 0;
-            }
-          }
-
-          if (name_idx > 0) {
-            fn->Call(env->context(), names, name_idx, name_argv)
-                .ToLocalChecked();
+            names.push_back(filename);
           }
 
-          argv[1] = names;
+          argv[1] = env->NewArray(names.data(), names.size());
         }
         break;
 
@@ -888,10 +875,8 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
 
     CHECK_GE(SYNC_REQ.result, 0);
     int r;
-    Local<Array> names = Array::New(env->isolate(), 0);
-    Local<Function> fn = env->push_values_to_array_function();
-    Local<Value> name_v[NODE_PUSH_VAL_TO_ARRAY_MAX];
-    size_t name_idx = 0;
+    std::vector<Local<Value>> names;
+    names.reserve(SYNC_REQ.result);
 
     for (int i = 0; ; i++) {
       uv_dirent_t ent;
@@ -912,20 +897,10 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
                                      *path);
       }
 
-      name_v[name_idx++] = filename;
-
-      if (name_idx >= arraysize(name_v)) {
-        fn->Call(env->context(), names, name_idx, name_v)
-            .ToLocalChecked();
-        name_idx = 0;
-      }
-    }
-
-    if (name_idx > 0) {
-      fn->Call(env->context(), names, name_idx, name_v).ToLocalChecked();
+      names.push_back(filename);
     }
 
-    args.GetReturnValue().Set(names);
+    args.GetReturnValue().Set(env->NewArray(names.data(), names.size()));
   }
 }
 
@@ -660,25 +660,12 @@ class Parser : public AsyncWrap {
   }
 
   Local<Array> CreateHeaders() {
-    Local<Array> headers = Array::New(env()->isolate());
-    Local<Function> fn = env()->push_values_to_array_function();
-    Local<Value> argv[NODE_PUSH_VAL_TO_ARRAY_MAX * 2];
-    size_t i = 0;
-
-    do {
-      size_t j = 0;
-      while (i < num_values_ && j < arraysize(argv) / 2) {
-        argv[j * 2] = fields_[i].ToString(env());
-        argv[j * 2 + 1] = values_[i].ToString(env());
-        i++;
-        j++;
-      }
-      if (j > 0) {
-        fn->Call(env()->context(), headers, j * 2, argv).ToLocalChecked();
-      }
-    } while (i < num_values_);
-
-    return headers;
+    Local<Value> headers[arraysize(fields_) * 2];
+    for (size_t i = 0; i < num_values_; i++) {
+      headers[i * 2] = fields_[i].ToString(env());
+      headers[i * 2 + 1] = values_[i].ToString(env());
+    }
+    return env()->NewArray(headers, num_values_ * 2);
   }
 
 
@@ -46,6 +46,9 @@
 
 #include "node.h"
 #include "node_buffer.h"
+#include "node_internals.h"
+#include "base-object.h"
+#include "base-object-inl.h"
 #include "env.h"
 #include "env-inl.h"
 #include "util.h"
@@ -85,6 +88,7 @@ namespace node {
 
 using v8::Context;
 using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
 using v8::Isolate;
 using v8::Local;
 using v8::MaybeLocal;
@@ -110,6 +114,26 @@ MaybeLocal<Object> ToBufferEndian(Environment* env, MaybeStackBuffer<T>* buf) {
   return ret;
 }
 
+const char* EncodingName(const enum encoding encoding) {
+  switch (encoding) {
+    case ASCII: return "us-ascii";
+    case LATIN1: return "iso8859-1";
+    case UCS2: return "utf16le";
+    case UTF8: return "utf-8";
+    default: return NULL;
+  }
+}
+
+bool SupportedEncoding(const enum encoding encoding) {
+  switch (encoding) {
+    case ASCII:
+    case LATIN1:
+    case UCS2:
+    case UTF8: return true;
+    default: return false;
+  }
+}
+
 struct Converter {
   explicit Converter(const char* name, const char* sub = NULL)
       : conv(nullptr) {
@@ -128,6 +152,58 @@ struct Converter {
   UConverter* conv;
 };
 
+class ConverterCache {
+ public:
+  ~ConverterCache() {
+    for (UConverter* conv : sources_) {
+      if (conv != nullptr)
+        ucnv_close(conv);
+    }
+    for (UConverter* conv : targets_) {
+      if (conv != nullptr)
+        ucnv_close(conv);
+    }
+  }
+
+  // Converters are reset by every one-shot conversion function, so the same
+  // one can be handed out again and again.  Targets substitute '?' for
+  // characters they can't represent.
+  UConverter* Source(const enum encoding encoding) {
+    return Get(&sources_[encoding], encoding, nullptr);
+  }
+
+  UConverter* Target(const enum encoding encoding) {
+    return Get(&targets_[encoding], encoding, "?");
+  }
+
+ private:
+  static UConverter* Get(UConverter** slot,
+                         const enum encoding encoding,
+                         const char* sub) {
+    if (*slot == nullptr) {
+      UErrorCode status = U_ZERO_ERROR;
+      *slot = ucnv_open(EncodingName(encoding), &status);
+      CHECK(U_SUCCESS(status));
+      if (sub != nullptr)
+        ucnv_setSubstChars(*slot, sub, strlen(sub), &status);
+    }
+    return *slot;
+  }
+
+  UConverter* sources_[BUFFER + 1] = {};
+  UConverter* targets_[BUFFER + 1] = {};
+};
+
+void FreeConverterCache(ConverterCache* cache) {
+  delete cache;
+}
+
+ConverterCache* GetConverterCache(Environment* env) {
+  if (env->icu_converter_cache() == nullptr)
+    env->set_icu_converter_cache(new ConverterCache());
+  return env->icu_converter_cache();
+}
+
 // One-Shot Converters
 
 void CopySourceBuffer(MaybeStackBuffer<UChar>* dest,
@@ -143,27 +219,28 @@ void CopySourceBuffer(MaybeStackBuffer<UChar>* dest,
 }
 
 typedef MaybeLocal<Object> (*TranscodeFunc)(Environment* env,
-                                            const char* fromEncoding,
-                                            const char* toEncoding,
+                                            const enum encoding fromEncoding,
+                                            const enum encoding toEncoding,
                                             const char* source,
                                             const size_t source_length,
                                             UErrorCode* status);
 
 MaybeLocal<Object> Transcode(Environment* env,
-                             const char* fromEncoding,
-                             const char* toEncoding,
+                             const enum encoding fromEncoding,
+                             const enum encoding toEncoding,
                              const char* source,
                              const size_t source_length,
                              UErrorCode* status) {
   *status = U_ZERO_ERROR;
   MaybeLocal<Object> ret;
   MaybeStackBuffer<char> result;
-  Converter to(toEncoding, "?");
-  Converter from(fromEncoding);
-  const uint32_t limit = source_length * ucnv_getMaxCharSize(to.conv);
+  ConverterCache* cache = GetConverterCache(env);
+  UConverter* to = cache->Target(toEncoding);
+  UConverter* from = cache->Source(fromEncoding);
+  const uint32_t limit = source_length * ucnv_getMaxCharSize(to);
   result.AllocateSufficientStorage(limit);
   char* target = *result;
-  ucnv_convertEx(to.conv, from.conv, &target, target + limit,
+  ucnv_convertEx(to, from, &target, target + limit,
                  &source, source + source_length, nullptr, nullptr,
                  nullptr, nullptr, true, true, status);
   if (U_SUCCESS(*status)) {
@@ -174,17 +251,17 @@ MaybeLocal<Object> Transcode(Environment* env,
 }
 
 MaybeLocal<Object> TranscodeToUcs2(Environment* env,
-                                   const char* fromEncoding,
-                                   const char* toEncoding,
+                                   const enum encoding fromEncoding,
+                                   const enum encoding toEncoding,
                                    const char* source,
                                    const size_t source_length,
                                    UErrorCode* status) {
   *status = U_ZERO_ERROR;
   MaybeLocal<Object> ret;
   MaybeStackBuffer<UChar> destbuf(source_length);
-  Converter from(fromEncoding);
+  UConverter* from = GetConverterCache(env)->Source(fromEncoding);
   const size_t length_in_chars = source_length * sizeof(UChar);
-  ucnv_toUChars(from.conv, *destbuf, length_in_chars,
+  ucnv_toUChars(from, *destbuf, length_in_chars,
                 source, source_length, status);
   if (U_SUCCESS(*status))
     ret = ToBufferEndian(env, &destbuf);
@@ -192,19 +269,19 @@ MaybeLocal<Object> TranscodeToUcs2(Environment* env,
 }
 
 MaybeLocal<Object> TranscodeFromUcs2(Environment* env,
-                                     const char* fromEncoding,
-                                     const char* toEncoding,
+                                     const enum encoding fromEncoding,
+                                     const enum encoding toEncoding,
                                      const char* source,
                                      const size_t source_length,
                                      UErrorCode* status) {
   *status = U_ZERO_ERROR;
   MaybeStackBuffer<UChar> sourcebuf;
   MaybeLocal<Object> ret;
-  Converter to(toEncoding, "?");
+  UConverter* to = GetConverterCache(env)->Target(toEncoding);
   const size_t length_in_chars = source_length / sizeof(UChar);
   CopySourceBuffer(&sourcebuf, source, source_length, length_in_chars);
   MaybeStackBuffer<char> destbuf(length_in_chars);
-  const uint32_t len = ucnv_fromUChars(to.conv, *destbuf, length_in_chars,
+  const uint32_t len = ucnv_fromUChars(to, *destbuf, length_in_chars,
                                        *sourcebuf, length_in_chars, status);
   if (U_SUCCESS(*status)) {
     destbuf.SetLength(len);
@@ -214,8 +291,8 @@ MaybeLocal<Object> TranscodeFromUcs2(Environment* env,
 }
 
 MaybeLocal<Object> TranscodeUcs2FromUtf8(Environment* env,
-                                         const char* fromEncoding,
-                                         const char* toEncoding,
+                                         const enum encoding fromEncoding,
+                                         const enum encoding toEncoding,
                                          const char* source,
                                          const size_t source_length,
                                          UErrorCode* status) {
@@ -242,8 +319,8 @@ MaybeLocal<Object> TranscodeUcs2FromUtf8(Environment* env,
 }
 
 MaybeLocal<Object> TranscodeUtf8FromUcs2(Environment* env,
-                                         const char* fromEncoding,
-                                         const char* toEncoding,
+                                         const enum encoding fromEncoding,
+                                         const enum encoding toEncoding,
                                          const char* source,
                                          const size_t source_length,
                                          UErrorCode* status) {
@@ -272,24 +349,120 @@ MaybeLocal<Object> TranscodeUtf8FromUcs2(Environment* env,
   return ret;
 }
 
-const char* EncodingName(const enum encoding encoding) {
-  switch (encoding) {
-    case ASCII: return "us-ascii";
-    case LATIN1: return "iso8859-1";
-    case UCS2: return "utf16le";
-    case UTF8: return "utf-8";
-    default: return NULL;
+// Latin-1 maps one to one onto the first 256 code points, so conversions
+// between it, plain ASCII, UCS-2 and UTF-8 are simple enough to do without
+// going through ICU.
+
+// Returns the length of the ASCII-only prefix of |data|.  Checks eight bytes
+// at a time, which compilers can also turn into vector instructions.
+size_t AsciiPrefixLength(const char* data, const size_t length) {
+  const uint64_t kHighBits = 0x8080808080808080ull;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    if (word & kHighBits)
+      break;
   }
+  while (i < length && !(data[i] & 0x80))
+    i++;
+  return i;
 }
 
-bool SupportedEncoding(const enum encoding encoding) {
-  switch (encoding) {
-    case ASCII:
-    case LATIN1:
-    case UCS2:
-    case UTF8: return true;
-    default: return false;
+// Writes |length| Latin-1 characters as little-endian UCS-2.
+void WidenLatin1(char* dest, const char* source, const size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    dest[2 * i] = source[i];
+    dest[2 * i + 1] = 0;
+  }
+}
+
+MaybeLocal<Object> TranscodeLatin1ToUtf8(Environment* env,
+                                         const char* source,
+                                         const size_t source_length,
+                                         const size_t ascii_length) {
+  size_t length = source_length;
+  for (size_t i = ascii_length; i < source_length; i++)
+    length += (source[i] & 0x80) != 0;
+
+  MaybeStackBuffer<char> destbuf(length);
+  char* dest = *destbuf;
+  memcpy(dest, source, ascii_length);
+  dest += ascii_length;
+  for (size_t i = ascii_length; i < source_length; i++) {
+    const uint8_t c = source[i];
+    if (c < 0x80) {
+      *dest++ = c;
+    } else {
+      *dest++ = 0xc0 | (c >> 6);
+      *dest++ = 0x80 | (c & 0x3f);
+    }
+  }
+  return ToBufferEndian(env, &destbuf);
+}
+
+// Narrows little-endian UCS-2 to |max| (0x7f or 0xff), substituting '?' for
+// anything else the way the ICU converters would: once per code point, so
+// a surrogate pair only gets one.
+MaybeLocal<Object> TranscodeUcs2ToSingleByte(Environment* env,
+                                             const char* source,
+                                             const size_t source_length,
+                                             const uint16_t max) {
+  const uint8_t* units = reinterpret_cast<const uint8_t*>(source);
+  const size_t length_in_chars = source_length / sizeof(UChar);
+  MaybeStackBuffer<char> destbuf(length_in_chars);
+  char* dest = *destbuf;
+  for (size_t i = 0; i < length_in_chars; i++) {
+    const uint16_t c = units[2 * i] | (units[2 * i + 1] << 8);
+    if (c <= max) {
+      *dest++ = c;
+      continue;
+    }
+    *dest++ = '?';
+    if (U16_IS_LEAD(c) && i + 1 < length_in_chars) {
+      const uint16_t next = units[2 * i + 2] | (units[2 * i + 3] << 8);
+      if (U16_IS_TRAIL(next))
+        i++;
+    }
+  }
+  destbuf.SetLength(dest - *destbuf);
+  return ToBufferEndian(env, &destbuf);
+}
+
+// Returns false, without touching |result|, if ICU needs to do the work.
+bool TranscodeFast(Environment* env,
+                   const enum encoding fromEncoding,
+                   const enum encoding toEncoding,
+                   const char* source,
+                   const size_t source_length,
+                   MaybeLocal<Object>* result) {
+  if (fromEncoding == UCS2) {
+    if (toEncoding != ASCII && toEncoding != LATIN1)
+      return false;
+    *result = TranscodeUcs2ToSingleByte(env, source, source_length,
+                                        toEncoding == ASCII ? 0x7f : 0xff);
+    return true;
+  }
+
+  const size_t ascii_length = AsciiPrefixLength(source, source_length);
+  if (ascii_length < source_length && fromEncoding != LATIN1)
+    return false;
+
+  if (toEncoding == UCS2) {
+    MaybeStackBuffer<char> destbuf(source_length * sizeof(UChar));
+    WidenLatin1(*destbuf, source, source_length);
+    *result = ToBufferEndian(env, &destbuf);
+  } else if (ascii_length == source_length || toEncoding == LATIN1) {
+    *result = Buffer::Copy(env, source, source_length);
+  } else if (toEncoding == UTF8) {
+    *result = TranscodeLatin1ToUtf8(env, source, source_length, ascii_length);
+  } else {
+    MaybeStackBuffer<char> destbuf(source_length);
+    for (size_t i = 0; i < source_length; i++)
+      destbuf[i] = (source[i] & 0x80) ? '?' : source[i];
+    *result = ToBufferEndian(env, &destbuf);
   }
+  return true;
 }
 
 void Transcode(const FunctionCallbackInfo<Value>&args) {
@@ -304,36 +477,42 @@ void Transcode(const FunctionCallbackInfo<Value>&args) {
   const enum encoding toEncoding = ParseEncoding(isolate, args[2], BUFFER);
 
   if (SupportedEncoding(fromEncoding) && SupportedEncoding(toEncoding)) {
-    TranscodeFunc tfn = &Transcode;
-    switch (fromEncoding) {
-      case ASCII:
-      case LATIN1:
-        if (toEncoding == UCS2)
-          tfn = &TranscodeToUcs2;
-        break;
-      case UTF8:
-        if (toEncoding == UCS2)
-          tfn = &TranscodeUcs2FromUtf8;
-        break;
-      case UCS2:
-        switch (toEncoding) {
-          case UCS2:
-            tfn = &Transcode;
-            break;
-          case UTF8:
-            tfn = &TranscodeUtf8FromUcs2;
-            break;
-          default:
-            tfn = TranscodeFromUcs2;
-        }
-        break;
-      default:
-        // This should not happen because of the SupportedEncoding checks
-        ABORT();
-    }
+    if (TranscodeFast(env, fromEncoding, toEncoding,
+                      ts_obj_data, ts_obj_length, &result)) {
+      if (result.IsEmpty())
+        status = U_MEMORY_ALLOCATION_ERROR;
+    } else {
+      TranscodeFunc tfn = &Transcode;
+      switch (fromEncoding) {
+        case ASCII:
+        case LATIN1:
+          if (toEncoding == UCS2)
+            tfn = &TranscodeToUcs2;
+          break;
+        case UTF8:
+          if (toEncoding == UCS2)
+            tfn = &TranscodeUcs2FromUtf8;
+          break;
+        case UCS2:
+          switch (toEncoding) {
+            case UCS2:
+              tfn = &Transcode;
+              break;
+            case UTF8:
+              tfn = &TranscodeUtf8FromUcs2;
+              break;
+            default:
+              tfn = TranscodeFromUcs2;
+          }
+          break;
+        default:
+          // This should not happen because of the SupportedEncoding checks
+          ABORT();
+      }
 
-    result = tfn(env, EncodingName(fromEncoding), EncodingName(toEncoding),
-                 ts_obj_data, ts_obj_length, &status);
+      result = tfn(env, fromEncoding, toEncoding,
+                   ts_obj_data, ts_obj_length, &status);
+    }
   } else {
     status = U_ILLEGAL_ARGUMENT_ERROR;
   }
@@ -344,6 +523,100 @@ void Transcode(const FunctionCallbackInfo<Value>&args) {
   return args.GetReturnValue().Set(result.ToLocalChecked());
 }
 
+// Streaming conversion: unlike the one-shot converters above, a Transcoder
+// keeps the converter state and any partial characters between chunks, so
+// input can be split anywhere.
+class Transcoder : public BaseObject {
+ public:
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args.IsConstructCall());
+    const enum encoding fromEncoding =
+        ParseEncoding(env->isolate(), args[0], BUFFER);
+    const enum encoding toEncoding =
+        ParseEncoding(env->isolate(), args[1], BUFFER);
+    if (!SupportedEncoding(fromEncoding) || !SupportedEncoding(toEncoding))
+      return env->ThrowRangeError("Unsupported encoding");
+    new Transcoder(env, args.This(), fromEncoding, toEncoding);
+  }
+
+  // transcode(buffer, flush) returns the converted output so far, or an ICU
+  // error code.  Input that ends in the middle of a character is held back
+  // until the next call; passing flush=true ends the stream.
+  static void Transcode(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    Transcoder* transcoder;
+    ASSIGN_OR_RETURN_UNWRAP(&transcoder, args.Holder());
+    THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+    SPREAD_BUFFER_ARG(args[0], ts_obj);
+    const bool flush = args[1]->IsTrue();
+
+    UErrorCode status = U_ZERO_ERROR;
+    MaybeStackBuffer<char> result;
+    // Leave room for whatever is still waiting in the pivot buffer.
+    size_t capacity = (ts_obj_length + kPivotSize) *
+                      ucnv_getMaxCharSize(transcoder->to_.conv);
+    result.AllocateSufficientStorage(capacity);
+    char* target = *result;
+    const char* source = ts_obj_data;
+    const char* source_limit = ts_obj_data + ts_obj_length;
+    for (;;) {
+      ucnv_convertEx(transcoder->to_.conv, transcoder->from_.conv,
+                     &target, *result + capacity,
+                     &source, source_limit,
+                     transcoder->pivot_,
+                     &transcoder->pivot_source_,
+                     &transcoder->pivot_target_,
+                     transcoder->pivot_ + kPivotSize,
+                     false, flush, &status);
+      if (status != U_BUFFER_OVERFLOW_ERROR)
+        break;
+      status = U_ZERO_ERROR;
+      const size_t written = target - *result;
+      capacity *= 2;
+      result.AllocateSufficientStorage(capacity);
+      target = *result + written;
+    }
+
+    if (flush || U_FAILURE(status))
+      transcoder->Reset();
+    if (U_FAILURE(status))
+      return args.GetReturnValue().Set(status);
+
+    result.SetLength(target - *result);
+    Local<Object> buffer;
+    if (!ToBufferEndian(env, &result).ToLocal(&buffer))
+      return args.GetReturnValue().Set(U_MEMORY_ALLOCATION_ERROR);
+    args.GetReturnValue().Set(buffer);
+  }
+
+ private:
+  static const size_t kPivotSize = 1024;
+
+  Transcoder(Environment* env,
+             Local<Object> wrap,
+             const enum encoding fromEncoding,
+             const enum encoding toEncoding)
+      : BaseObject(env, wrap),
+        from_(EncodingName(fromEncoding)),
+        to_(EncodingName(toEncoding), "?") {
+    MakeWeak<Transcoder>(this);
+    Reset();
+  }
+
+  void Reset() {
+    ucnv_reset(from_.conv);
+    ucnv_reset(to_.conv);
+    pivot_source_ = pivot_target_ = pivot_;
+  }
+
+  Converter from_;
+  Converter to_;
+  UChar pivot_[kPivotSize];
+  UChar* pivot_source_;
+  UChar* pivot_target_;
+};
+
 static void ICUErrorName(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   UErrorCode status = static_cast<UErrorCode>(args[0]->Int32Value());
@@ -655,6 +928,13 @@ void Init(Local<Object> target,
   // One-shot converters
   env->SetMethod(target, "icuErrName", ICUErrorName);
   env->SetMethod(target, "transcode", Transcode);
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(Transcoder::New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Transcoder"));
+  env->SetProtoMethod(t, "transcode", Transcoder::Transcode);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Transcoder"),
+              t->GetFunction());
 }
 
 }  // namespace i18n
@@ -46,6 +46,11 @@ int32_t ToUnicode(MaybeStackBuffer<char>* buf,
                   size_t length,
                   bool lenient = false);
 
+// ICU converters opened by Transcode(), kept for the lifetime of an
+// Environment so that they aren't opened and closed on every call.
+class ConverterCache;
+void FreeConverterCache(ConverterCache* cache);
+
 }  // namespace i18n
 }  // namespace node
 
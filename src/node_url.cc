@@ -15,6 +15,12 @@
 #include <stdio.h>
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NODE_URL_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
 #define UNICODE_REPLACEMENT_CHARACTER 0xFFFD
 
 namespace node {
@@ -30,6 +36,7 @@ using v8::Local;
 using v8::Null;
 using v8::Object;
 using v8::String;
+using v8::Uint32Array;
 using v8::Undefined;
 using v8::Value;
 
@@ -37,20 +44,6 @@ using v8::Value;
   obj->Get(env->context(),                                                    \
            OneByteString(env->isolate(), name)).ToLocalChecked()
 
-#define GET_AND_SET(env, obj, name, data, flag)                               \
-  {                                                                           \
-    Local<Value> val = GET(env, obj, #name);                                  \
-    if (val->IsString()) {                                                    \
-      Utf8Value value(env->isolate(), val.As<String>());                      \
-      data->name = *value;                                                    \
-      data->flags |= flag;                                                    \
-    }                                                                         \
-  }
-
-#define UTF8STRING(isolate, str)                                              \
-  String::NewFromUtf8(isolate, str.c_str(), v8::NewStringType::kNormal)       \
-    .ToLocalChecked()
-
 namespace url {
 
 #if defined(NODE_HAVE_I18N_SUPPORT)
@@ -270,8 +263,9 @@ namespace url {
       if (ch == '.' || ch == kEOL) {
         if (++parts > 4)
           goto end;
+        // An empty part means this is not an IPv4 address.
         if (pointer - mark == 0)
-          break;
+          goto end;
         int64_t n = ParseNumber(mark, pointer);
         if (n < 0)
           goto end;
@@ -446,44 +440,257 @@ namespace url {
     return host->type;
   }
 
-  static bool ParseHost(std::string* input,
-                        std::string* output,
-                        bool unicode = false) {
-    if (input->length() == 0)
+  // Whether ToASCII() would return a host unchanged and without errors: one
+  // or more lower case LDH labels, none of them empty (except for a trailing
+  // root label), longer than 63 characters, starting or ending with a hyphen,
+  // or with the "--" at positions 3-4 that A-labels have.  Those are the vast
+  // majority of hosts, and they can skip the percent-decoding and ICU.
+  static inline bool IsCanonicalDomain(const char* input, size_t length) {
+    if (length > 253)
+      return false;
+    size_t label = 0;
+    for (size_t n = 0; n < length; n++) {
+      const char ch = input[n];
+      if (ch == '.') {
+        if (label == 0 || input[n - 1] == '-')
+          return false;
+        label = 0;
+        continue;
+      }
+      if (ch == '-') {
+        if (label == 0 || (label == 3 && input[n - 1] == '-'))
+          return false;
+      } else if (!ASCII_DIGIT(ch) && (ch < 'a' || ch > 'z')) {
+        return false;
+      }
+      if (++label > 63)
+        return false;
+    }
+    return label == 0 || input[length - 1] != '-';
+  }
+
+  // Replaces the host that starts at `start` and runs to the end of `href`
+  // with its serialization.
+  static bool ParseHost(std::string* href, size_t start) {
+    const char* input = href->data() + start;
+    const size_t length = href->size() - start;
+    if (length == 0)
       return true;
     url_host host{{""}, HOST_TYPE_DOMAIN};
-    ParseHost(&host, input->c_str(), input->length(), unicode);
+    if (IsCanonicalDomain(input, length)) {
+      if (ParseIPv4Host(&host, input, length) == HOST_TYPE_DOMAIN)
+        return true;
+    } else {
+      ParseHost(&host, input, length);
+    }
     if (host.type == HOST_TYPE_FAILED)
       return false;
-    WriteHost(&host, output);
+    std::string out;
+    WriteHost(&host, &out);
+    href->resize(start);
+    href->append(out);
     return true;
   }
 
-  static inline void Copy(Environment* env,
-                          Local<Array> ary,
-                          std::vector<std::string>* vec) {
-    const int32_t len = ary->Length();
-    if (len == 0)
-      return;  // nothing to copy
-    vec->reserve(len);
-    for (int32_t n = 0; n < len; n++) {
-      Local<Value> val = ary->Get(env->context(), n).ToLocalChecked();
-      if (val->IsString()) {
-        Utf8Value value(env->isolate(), val.As<String>());
-        vec->push_back(std::string(*value, value.length()));
-      }
+  // Characters that the path, query, fragment and cannot-be-base path states
+  // copy through unchanged: everything in [lo, 0x7e] except for the stops,
+  // which are either percent-encoded or end the state.
+  static const char kPathStops[] = "\"#<>?`{}/\\";
+  static const char kQueryStops[] = "\"#<>";
+  static const char kFragmentStops[] = "";
+  static const char kCannotBeBaseStops[] = "?#";
+
+  template <size_t N>
+  static inline bool IsRunChar(const unsigned char ch,
+                               const unsigned char lo,
+                               const char (&stops)[N]) {
+    if (ch < lo || ch > 0x7e)
+      return false;
+    for (size_t n = 0; n < N - 1; n++) {
+      if (ch == static_cast<unsigned char>(stops[n]))
+        return false;
+    }
+    return true;
+  }
+
+  // Returns the end of the run of characters at `p` that can be appended to
+  // the output as they are.  With SSE2 it checks 16 bytes at a time.
+  template <size_t N>
+  static inline const char* FindRunEnd(const char* p,
+                                       const char* end,
+                                       const unsigned char lo,
+                                       const char (&stops)[N]) {
+#if defined(NODE_URL_HAVE_SSE2)
+    // The comparisons are signed, so bytes >= 0x80 are below `lo`.
+    const __m128i below = _mm_set1_epi8(static_cast<char>(lo - 1));
+    const __m128i del = _mm_set1_epi8(0x7f);
+    while (end - p >= 16) {
+      const __m128i chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(chunk, below),
+                                 _mm_cmplt_epi8(chunk, del));
+      for (size_t n = 0; n < N - 1; n++)
+        ok = _mm_andnot_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(stops[n])),
+                              ok);
+      if (_mm_movemask_epi8(ok) != 0xffff)
+        break;
+      p += 16;
+    }
+#endif
+    while (p < end && IsRunChar(*p, lo, stops))
+      p++;
+    return p;
+  }
+
+  static inline bool IsFileScheme(const struct url_data* url) {
+    return url->end[URL_COMPONENT_SCHEME] == 5 &&
+           memcmp(url->href.data(), "file:", 5) == 0;
+  }
+
+  static inline bool IsSameScheme(const struct url_data* url,
+                                  const struct url_data* other) {
+    const uint32_t length = url->end[URL_COMPONENT_SCHEME];
+    return length == other->end[URL_COMPONENT_SCHEME] &&
+           memcmp(url->href.data(), other->href.data(), length) == 0;
+  }
+
+  // Ends the component that is being written and starts `c` after `delim`.
+  // The components in between are left empty.
+  static inline void Begin(struct url_data* url,
+                           enum url_component c,
+                           const char* delim = "") {
+    CHECK_GT(c, url->cur);
+    const uint32_t pos = url->href.size();
+    url->end[url->cur] = pos;
+    for (int n = url->cur + 1; n < c; n++)
+      url->start[n] = url->end[n] = pos;
+    url->href += delim;
+    url->start[c] = url->href.size();
+    url->cur = c;
+  }
+
+  // Starts the host, after the '@' that ends the credentials if there are
+  // any.  An empty password is not serialized, and neither is its ':'.
+  static inline void BeginHost(struct url_data* url) {
+    if (url->cur == URL_COMPONENT_PASSWORD &&
+        url->href.size() == url->start[URL_COMPONENT_PASSWORD]) {
+      url->href.pop_back();
+      url->start[URL_COMPONENT_PASSWORD] = url->href.size();
+    }
+    const bool has_credentials =
+        url->cur >= URL_COMPONENT_USERNAME &&
+        url->href.size() > url->start[URL_COMPONENT_USERNAME];
+    Begin(url, URL_COMPONENT_HOST, has_credentials ? "@" : "");
+  }
+
+  static inline void Finish(struct url_data* url) {
+    const uint32_t pos = url->href.size();
+    url->end[url->cur] = pos;
+    for (int n = url->cur + 1; n < URL_COMPONENT_COUNT; n++)
+      url->start[n] = url->end[n] = pos;
+  }
+
+  // Replaces everything written so far with the components of `base` up to
+  // and including `last`, and takes over those of its `flags` that are set.
+  static inline void CopyBase(struct url_data* url,
+                              const struct url_data* base,
+                              enum url_component last,
+                              int32_t flags) {
+    url->href.assign(base->href, 0, base->end[last]);
+    for (int n = 0; n <= last; n++) {
+      url->start[n] = base->start[n];
+      url->end[n] = base->end[n];
+    }
+    url->cur = last;
+    url->flags |= URL_FLAGS_HAS_SCHEME | (base->flags & flags);
+    if (IsSpecial(url->href.data(), url->end[URL_COMPONENT_SCHEME]))
+      url->flags |= URL_FLAGS_SPECIAL;
+    else
+      url->flags &= ~URL_FLAGS_SPECIAL;
+    if (last >= URL_COMPONENT_PORT)
+      url->port = base->port;
+  }
+
+  // Removes the host of a file URL whose path turned out to start with a
+  // drive letter.  Returns the number of bytes removed.
+  static inline size_t EraseHost(struct url_data* url) {
+    const uint32_t start = url->start[URL_COMPONENT_HOST];
+    const uint32_t length = url->end[URL_COMPONENT_HOST] - start;
+    url->href.erase(start, length);
+    url->end[URL_COMPONENT_HOST] = start;
+    for (int n = URL_COMPONENT_HOST + 1; n <= url->cur; n++) {
+      url->start[n] -= length;
+      if (n < url->cur)
+        url->end[n] -= length;
     }
+    return length;
   }
 
-  static inline Local<Array> Copy(Environment* env,
-                                  std::vector<std::string> vec) {
+  static inline const char* ComponentData(const struct url_data* url,
+                                          enum url_component c) {
+    return url->href.data() + url->start[c];
+  }
+
+  static inline size_t ComponentLength(const struct url_data* url,
+                                       enum url_component c) {
+    return url->end[c] - url->start[c];
+  }
+
+  static inline Local<String> ComponentString(Isolate* isolate,
+                                              const struct url_data* url,
+                                              enum url_component c) {
+    return String::NewFromUtf8(isolate,
+                               ComponentData(url, c),
+                               v8::NewStringType::kNormal,
+                               ComponentLength(url, c)).ToLocalChecked();
+  }
+
+  // The path split into its segments, or the whole path of a cannot-be-base
+  // URL.
+  static inline Local<Array> PathToArray(Environment* env,
+                                         const struct url_data* url) {
     Isolate* isolate = env->isolate();
-    Local<Array> ary = Array::New(isolate, vec.size());
-    for (size_t n = 0; n < vec.size(); n++)
-      ary->Set(env->context(), n, UTF8STRING(isolate, vec[n])).FromJust();
+    Local<Array> ary = Array::New(isolate);
+    if (url->flags & URL_FLAGS_CANNOT_BE_BASE) {
+      ary->Set(env->context(), 0,
+               ComponentString(isolate, url, URL_COMPONENT_PATH)).FromJust();
+      return ary;
+    }
+    const char* path = ComponentData(url, URL_COMPONENT_PATH);
+    const size_t length = ComponentLength(url, URL_COMPONENT_PATH);
+    uint32_t index = 0;
+    size_t n = 0;
+    while (n < length) {
+      size_t next = n + 1;
+      while (next < length && path[next] != '/')
+        next++;
+      Local<String> segment =
+          String::NewFromUtf8(isolate,
+                              path + n + 1,
+                              v8::NewStringType::kNormal,
+                              next - n - 1).ToLocalChecked();
+      ary->Set(env->context(), index++, segment).FromJust();
+      n = next;
+    }
     return ary;
   }
 
+  // Appends the value of `name` on `obj` to the component that is being
+  // written, if it is a string.
+  static inline bool AppendString(Environment* env,
+                                  struct url_data* url,
+                                  Local<Object> obj,
+                                  const char* name,
+                                  int32_t flag) {
+    Local<Value> val = GET(env, obj, name);
+    if (!val->IsString())
+      return false;
+    Utf8Value value(env->isolate(), val.As<String>());
+    url->href.append(*value, value.length());
+    url->flags |= flag;
+    return true;
+  }
+
   static inline void HarvestBase(Environment* env,
                                  struct url_data* base,
                                  Local<Object> base_obj) {
@@ -491,21 +698,51 @@ namespace url {
     Local<Value> flags = GET(env, base_obj, "flags");
     if (flags->IsInt32())
       base->flags = flags->Int32Value(context).FromJust();
-
-    GET_AND_SET(env, base_obj, scheme, base, URL_FLAGS_HAS_SCHEME);
-    GET_AND_SET(env, base_obj, username, base, URL_FLAGS_HAS_USERNAME);
-    GET_AND_SET(env, base_obj, password, base, URL_FLAGS_HAS_PASSWORD);
-    GET_AND_SET(env, base_obj, host, base, URL_FLAGS_HAS_HOST);
-    GET_AND_SET(env, base_obj, query, base, URL_FLAGS_HAS_QUERY);
-    GET_AND_SET(env, base_obj, fragment, base, URL_FLAGS_HAS_FRAGMENT);
     Local<Value> port = GET(env, base_obj, "port");
     if (port->IsInt32())
       base->port = port->Int32Value(context).FromJust();
+
+    AppendString(env, base, base_obj, "scheme", URL_FLAGS_HAS_SCHEME);
+    base->end[URL_COMPONENT_SCHEME] = base->href.size();
+    const bool has_authority =
+        GET(env, base_obj, "host")->IsString() || IsFileScheme(base);
+    Begin(base, URL_COMPONENT_USERNAME, has_authority ? "//" : "");
+    AppendString(env, base, base_obj, "username", URL_FLAGS_HAS_USERNAME);
+    Begin(base, URL_COMPONENT_PASSWORD, ":");
+    AppendString(env, base, base_obj, "password", URL_FLAGS_HAS_PASSWORD);
+    BeginHost(base);
+    AppendString(env, base, base_obj, "host", URL_FLAGS_HAS_HOST);
+    if (base->port > -1) {
+      Begin(base, URL_COMPONENT_PORT, ":");
+      base->href += std::to_string(base->port);
+    }
+
+    Begin(base, URL_COMPONENT_PATH);
     Local<Value> path = GET(env, base_obj, "path");
     if (path->IsArray()) {
       base->flags |= URL_FLAGS_HAS_PATH;
-      Copy(env, path.As<Array>(), &(base->path));
+      Local<Array> ary = path.As<Array>();
+      const uint32_t len = ary->Length();
+      for (uint32_t n = 0; n < len; n++) {
+        Local<Value> val = ary->Get(context, n).ToLocalChecked();
+        if (!val->IsString())
+          continue;
+        Utf8Value value(env->isolate(), val.As<String>());
+        if (!(base->flags & URL_FLAGS_CANNOT_BE_BASE))
+          base->href += '/';
+        base->href.append(*value, value.length());
+      }
+    }
+
+    if (GET(env, base_obj, "query")->IsString()) {
+      Begin(base, URL_COMPONENT_QUERY, "?");
+      AppendString(env, base, base_obj, "query", URL_FLAGS_HAS_QUERY);
     }
+    if (GET(env, base_obj, "fragment")->IsString()) {
+      Begin(base, URL_COMPONENT_FRAGMENT, "#");
+      AppendString(env, base, base_obj, "fragment", URL_FLAGS_HAS_FRAGMENT);
+    }
+    Finish(base);
   }
 
   static inline void HarvestContext(Environment* env,
@@ -522,7 +759,8 @@ namespace url {
     Local<Value> scheme = GET(env, context_obj, "scheme");
     if (scheme->IsString()) {
       Utf8Value value(env->isolate(), scheme);
-      context->scheme.assign(*value, value.length());
+      context->href.assign(*value, value.length());
+      context->end[URL_COMPONENT_SCHEME] = context->href.size();
     }
     Local<Value> port = GET(env, context_obj, "port");
     if (port->IsInt32())
@@ -530,10 +768,10 @@ namespace url {
   }
 
   // Single dot segment can be ".", "%2e", or "%2E"
-  static inline bool IsSingleDotSegment(std::string str) {
-    switch (str.size()) {
+  static inline bool IsSingleDotSegment(const char* str, size_t len) {
+    switch (len) {
       case 1:
-        return str == ".";
+        return str[0] == '.';
       case 3:
         return str[0] == '%' &&
                str[1] == '2' &&
@@ -546,10 +784,10 @@ namespace url {
   // Double dot segment can be:
   //   "..", ".%2e", ".%2E", "%2e.", "%2E.",
   //   "%2e%2e", "%2E%2E", "%2e%2E", or "%2E%2e"
-  static inline bool IsDoubleDotSegment(std::string str) {
-    switch (str.size()) {
+  static inline bool IsDoubleDotSegment(const char* str, size_t len) {
+    switch (len) {
       case 2:
-        return str == "..";
+        return str[0] == '.' && str[1] == '.';
       case 4:
         if (str[0] != '.' && str[0] != '%')
           return false;
@@ -573,34 +811,45 @@ namespace url {
     }
   }
 
+  // Drops the last segment of the path, which is being written.
   static inline void ShortenUrlPath(struct url_data* url) {
-    if (url->path.empty()) return;
-    if (url->path.size() == 1 && url->scheme == "file:" &&
-        NORMALIZED_WINDOWS_DRIVE_LETTER(url->path[0])) return;
-    url->path.pop_back();
+    const size_t start = url->start[URL_COMPONENT_PATH];
+    const size_t length = url->href.size() - start;
+    if (length == 0) return;
+    const char* path = url->href.data() + start;
+    if (length == 3 && IsFileScheme(url) &&
+        NORMALIZED_WINDOWS_DRIVE_LETTER((path + 1), 2)) return;
+    url->href.resize(url->href.rfind('/'));
   }
 
-  void URL::Parse(const char* input,
-                  const size_t len,
-                  enum url_parse_state state_override,
-                  struct url_data* url,
-                  const struct url_data* base,
-                  bool has_base) {
+  // Whether the path of a file URL starts with a drive letter segment.
+  static inline bool HasDriveLetter(const struct url_data* url) {
+    const char* path = ComponentData(url, URL_COMPONENT_PATH);
+    const size_t length = ComponentLength(url, URL_COMPONENT_PATH);
+    return length >= 3 &&
+           NORMALIZED_WINDOWS_DRIVE_LETTER((path + 1), 2) &&
+           (length == 3 || path[3] == '/');
+  }
+
+  // The parser proper.  The components are written straight into url->href
+  // in order, so the only copies are of the base URL.
+  static void RunStateMachine(const char* input,
+                              const size_t len,
+                              enum url_parse_state state_override,
+                              struct url_data* url,
+                              const struct url_data* base,
+                              bool has_base) {
     bool atflag = false;
     bool sbflag = false;
     bool uflag = false;
     bool base_is_file = false;
-    int wskip = 0;
-
-    std::string buffer;
-    url->scheme.reserve(len);
-    url->username.reserve(len);
-    url->password.reserve(len);
-    url->host.reserve(len);
-    url->path.reserve(len);
-    url->query.reserve(len);
-    url->fragment.reserve(len);
-    buffer.reserve(len);
+    // Start of the userinfo or host that kAuthority has not consumed yet.
+    const char* mark = input;
+    // Start of the path segment that is being written, if any.
+    size_t segment = std::string::npos;
+    int port = -1;
+
+    url->href.reserve(url->href.size() + len);
 
     // Set the initial parse state.
     const bool has_state_override = state_override != kUnknownState;
@@ -619,13 +868,6 @@ namespace url {
       const char ch = p < end ? p[0] : kEOL;
 
       if (TAB_AND_NEWLINE(ch)) {
-        if (state == kAuthority) {
-          // It's necessary to keep track of how much whitespace
-          // is being ignored when in kAuthority state because of
-          // how the buffer is managed. TODO: See if there's a better
-          // way
-          wskip++;
-        }
         p++;
         continue;
       }
@@ -636,7 +878,9 @@ namespace url {
       switch (state) {
         case kSchemeStart:
           if (ASCII_ALPHA(ch)) {
-            buffer += TO_LOWER(ch);
+            url->href.clear();
+            url->cur = URL_COMPONENT_SCHEME;
+            url->href += TO_LOWER(ch);
             state = kScheme;
           } else if (!has_state_override) {
             state = kNoScheme;
@@ -648,16 +892,14 @@ namespace url {
           break;
         case kScheme:
           if (SCHEME_CHAR(ch)) {
-            buffer += TO_LOWER(ch);
+            url->href += TO_LOWER(ch);
             p++;
             continue;
           } else if (ch == ':' || (has_state_override && ch == kEOL)) {
-            buffer += ':';
-            if (buffer.size() > 0) {
-              url->flags |= URL_FLAGS_HAS_SCHEME;
-              url->scheme = buffer;
-            }
-            if (IsSpecial(url->scheme)) {
+            url->href += ':';
+            url->end[URL_COMPONENT_SCHEME] = url->href.size();
+            url->flags |= URL_FLAGS_HAS_SCHEME;
+            if (IsSpecial(url->href.data(), url->href.size())) {
               url->flags |= URL_FLAGS_SPECIAL;
               special = true;
             } else {
@@ -665,13 +907,12 @@ namespace url {
             }
             if (has_state_override)
               return;
-            buffer.clear();
-            if (url->scheme == "file:") {
+            if (IsFileScheme(url)) {
               state = kFile;
             } else if (special &&
                        has_base &&
                        base->flags & URL_FLAGS_HAS_SCHEME &&
-                       url->scheme == base->scheme) {
+                       IsSameScheme(url, base)) {
               state = kSpecialRelativeOrAuthority;
             } else if (special) {
               state = kSpecialAuthoritySlashes;
@@ -681,11 +922,11 @@ namespace url {
             } else {
               url->flags |= URL_FLAGS_CANNOT_BE_BASE;
               url->flags |= URL_FLAGS_HAS_PATH;
-              url->path.push_back("");
+              Begin(url, URL_COMPONENT_PATH);
               state = kCannotBeBase;
             }
           } else if (!has_state_override) {
-            buffer.clear();
+            url->href.clear();
             state = kNoScheme;
             p = input;
             continue;
@@ -695,41 +936,25 @@ namespace url {
           }
           break;
         case kNoScheme:
-          cannot_be_base = base->flags & URL_FLAGS_CANNOT_BE_BASE;
+          cannot_be_base =
+              has_base && (base->flags & URL_FLAGS_CANNOT_BE_BASE);
           if (!has_base || (cannot_be_base && ch != '#')) {
             url->flags |= URL_FLAGS_FAILED;
             return;
           } else if (cannot_be_base && ch == '#') {
-            url->flags |= URL_FLAGS_HAS_SCHEME;
-            url->scheme = base->scheme;
-            if (IsSpecial(url->scheme)) {
-              url->flags |= URL_FLAGS_SPECIAL;
-              special = true;
-            } else {
-              url->flags &= ~URL_FLAGS_SPECIAL;
-            }
-            if (base->flags & URL_FLAGS_HAS_PATH) {
-              url->flags |= URL_FLAGS_HAS_PATH;
-              url->path = base->path;
-            }
-            if (base->flags & URL_FLAGS_HAS_QUERY) {
-              url->flags |= URL_FLAGS_HAS_QUERY;
-              url->query = base->query;
-            }
-            if (base->flags & URL_FLAGS_HAS_FRAGMENT) {
-              url->flags |= URL_FLAGS_HAS_FRAGMENT;
-              url->fragment = base->fragment;
-            }
+            CopyBase(url, base, URL_COMPONENT_QUERY,
+                     URL_FLAGS_HAS_PATH | URL_FLAGS_HAS_QUERY);
             url->flags |= URL_FLAGS_CANNOT_BE_BASE;
             state = kFragment;
-          } else if (has_base &&
-                     base->flags & URL_FLAGS_HAS_SCHEME &&
-                     base->scheme != "file:") {
+          } else if (base->flags & URL_FLAGS_HAS_SCHEME &&
+                     !IsFileScheme(base)) {
             state = kRelative;
             continue;
           } else {
+            url->href.assign("file:");
+            url->cur = URL_COMPONENT_SCHEME;
+            url->end[URL_COMPONENT_SCHEME] = url->href.size();
             url->flags |= URL_FLAGS_HAS_SCHEME;
-            url->scheme = "file:";
             url->flags |= URL_FLAGS_SPECIAL;
             special = true;
             state = kFile;
@@ -754,107 +979,40 @@ namespace url {
           }
           break;
         case kRelative:
-          url->flags |= URL_FLAGS_HAS_SCHEME;
-          url->scheme = base->scheme;
-          if (IsSpecial(url->scheme)) {
-            url->flags |= URL_FLAGS_SPECIAL;
-            special = true;
-          } else {
-            url->flags &= ~URL_FLAGS_SPECIAL;
-          }
+          CopyBase(url, base, URL_COMPONENT_SCHEME, URL_FLAGS_NONE);
+          special = (url->flags & URL_FLAGS_SPECIAL);
           switch (ch) {
             case kEOL:
-              if (base->flags & URL_FLAGS_HAS_USERNAME) {
-                url->flags |= URL_FLAGS_HAS_USERNAME;
-                url->username = base->username;
-              }
-              if (base->flags & URL_FLAGS_HAS_PASSWORD) {
-                url->flags |= URL_FLAGS_HAS_PASSWORD;
-                url->password = base->password;
-              }
-              if (base->flags & URL_FLAGS_HAS_HOST) {
-                url->flags |= URL_FLAGS_HAS_HOST;
-                url->host = base->host;
-              }
-              if (base->flags & URL_FLAGS_HAS_QUERY) {
-                url->flags |= URL_FLAGS_HAS_QUERY;
-                url->query = base->query;
-              }
-              if (base->flags & URL_FLAGS_HAS_PATH) {
-                url->flags |= URL_FLAGS_HAS_PATH;
-                url->path = base->path;
-              }
-              url->port = base->port;
+              CopyBase(url, base, URL_COMPONENT_QUERY,
+                       URL_FLAGS_HAS_USERNAME | URL_FLAGS_HAS_PASSWORD |
+                       URL_FLAGS_HAS_HOST | URL_FLAGS_HAS_PATH |
+                       URL_FLAGS_HAS_QUERY);
               break;
             case '/':
               state = kRelativeSlash;
               break;
             case '?':
-              if (base->flags & URL_FLAGS_HAS_USERNAME) {
-                url->flags |= URL_FLAGS_HAS_USERNAME;
-                url->username = base->username;
-              }
-              if (base->flags & URL_FLAGS_HAS_PASSWORD) {
-                url->flags |= URL_FLAGS_HAS_PASSWORD;
-                url->password = base->password;
-              }
-              if (base->flags & URL_FLAGS_HAS_HOST) {
-                url->flags |= URL_FLAGS_HAS_HOST;
-                url->host = base->host;
-              }
-              if (base->flags & URL_FLAGS_HAS_PATH) {
-                url->flags |= URL_FLAGS_HAS_PATH;
-                url->path = base->path;
-              }
-              url->port = base->port;
+              CopyBase(url, base, URL_COMPONENT_PATH,
+                       URL_FLAGS_HAS_USERNAME | URL_FLAGS_HAS_PASSWORD |
+                       URL_FLAGS_HAS_HOST | URL_FLAGS_HAS_PATH);
               state = kQuery;
               break;
             case '#':
-              if (base->flags & URL_FLAGS_HAS_USERNAME) {
-                url->flags |= URL_FLAGS_HAS_USERNAME;
-                url->username = base->username;
-              }
-              if (base->flags & URL_FLAGS_HAS_PASSWORD) {
-                url->flags |= URL_FLAGS_HAS_PASSWORD;
-                url->password = base->password;
-              }
-              if (base->flags & URL_FLAGS_HAS_HOST) {
-                url->flags |= URL_FLAGS_HAS_HOST;
-                url->host = base->host;
-              }
-              if (base->flags & URL_FLAGS_HAS_QUERY) {
-                url->flags |= URL_FLAGS_HAS_QUERY;
-                url->query = base->query;
-              }
-              if (base->flags & URL_FLAGS_HAS_PATH) {
-                url->flags |= URL_FLAGS_HAS_PATH;
-                url->path = base->path;
-              }
-              url->port = base->port;
+              CopyBase(url, base, URL_COMPONENT_QUERY,
+                       URL_FLAGS_HAS_USERNAME | URL_FLAGS_HAS_PASSWORD |
+                       URL_FLAGS_HAS_HOST | URL_FLAGS_HAS_PATH |
+                       URL_FLAGS_HAS_QUERY);
               state = kFragment;
               break;
             default:
               if (special_back_slash) {
                 state = kRelativeSlash;
               } else {
-                if (base->flags & URL_FLAGS_HAS_USERNAME) {
-                  url->flags |= URL_FLAGS_HAS_USERNAME;
-                  url->username = base->username;
-                }
-                if (base->flags & URL_FLAGS_HAS_PASSWORD) {
-                  url->flags |= URL_FLAGS_HAS_PASSWORD;
-                  url->password = base->password;
-                }
-                if (base->flags & URL_FLAGS_HAS_HOST) {
-                  url->flags |= URL_FLAGS_HAS_HOST;
-                  url->host = base->host;
-                }
-                if (base->flags & URL_FLAGS_HAS_PATH) {
-                  url->flags |= URL_FLAGS_HAS_PATH;
-                  url->path = base->path;
+                CopyBase(url, base, URL_COMPONENT_PATH,
+                         URL_FLAGS_HAS_USERNAME | URL_FLAGS_HAS_PASSWORD |
+                         URL_FLAGS_HAS_HOST | URL_FLAGS_HAS_PATH);
+                if (base->flags & URL_FLAGS_HAS_PATH)
                   ShortenUrlPath(url);
-                }
-                url->port = base->port;
                 state = kPath;
                 continue;
               }
@@ -864,19 +1022,9 @@ namespace url {
           if (ch == '/' || special_back_slash) {
             state = kSpecialAuthorityIgnoreSlashes;
           } else {
-            if (base->flags & URL_FLAGS_HAS_USERNAME) {
-              url->flags |= URL_FLAGS_HAS_USERNAME;
-              url->username = base->username;
-            }
-            if (base->flags & URL_FLAGS_HAS_PASSWORD) {
-              url->flags |= URL_FLAGS_HAS_PASSWORD;
-              url->password = base->password;
-            }
-            if (base->flags & URL_FLAGS_HAS_HOST) {
-              url->flags |= URL_FLAGS_HAS_HOST;
-              url->host = base->host;
-            }
-            url->port = base->port;
+            CopyBase(url, base, URL_COMPONENT_PORT,
+                     URL_FLAGS_HAS_USERNAME | URL_FLAGS_HAS_PASSWORD |
+                     URL_FLAGS_HAS_HOST);
             state = kPath;
             continue;
           }
@@ -896,57 +1044,61 @@ namespace url {
           }
           break;
         case kAuthority:
+          if (url->cur < URL_COMPONENT_USERNAME) {
+            Begin(url, URL_COMPONENT_USERNAME, "//");
+            mark = p;
+          }
           if (ch == '@') {
+            // Everything up to the last '@' is userinfo, any earlier '@'s
+            // end up percent-encoded in it.
             if (atflag) {
-              buffer.reserve(buffer.size() + 3);
-              buffer.insert(0, "%40");
-            }
-            atflag = true;
-            const size_t blen = buffer.size();
-            if (blen > 0 && buffer[0] != ':') {
               url->flags |= URL_FLAGS_HAS_USERNAME;
+              url->href += "%40";
             }
-            for (size_t n = 0; n < blen; n++) {
-              const char bch = buffer[n];
+            atflag = true;
+            bool first = true;
+            for (const char* q = mark; q < p; q++) {
+              const char bch = *q;
+              if (TAB_AND_NEWLINE(bch))
+                continue;
+              if (first && bch != ':')
+                url->flags |= URL_FLAGS_HAS_USERNAME;
+              first = false;
               if (bch == ':') {
                 url->flags |= URL_FLAGS_HAS_PASSWORD;
                 if (!uflag) {
                   uflag = true;
+                  Begin(url, URL_COMPONENT_PASSWORD, ":");
                   continue;
                 }
               }
-              if (uflag) {
-                AppendOrEscape(&url->password, bch, UserinfoEncodeSet);
-              } else {
-                AppendOrEscape(&url->username, bch, UserinfoEncodeSet);
-              }
+              AppendOrEscape(&url->href, bch, UserinfoEncodeSet);
             }
-            buffer.clear();
+            mark = p + 1;
           } else if (ch == kEOL ||
                      ch == '/' ||
                      ch == '?' ||
                      ch == '#' ||
                      special_back_slash) {
-            p -= buffer.size() + 1 + wskip;
-            buffer.clear();
+            p = mark;
             state = kHost;
-          } else {
-            buffer += ch;
+            continue;
           }
           break;
         case kHost:
         case kHostname:
+          if (url->cur < URL_COMPONENT_HOST)
+            BeginHost(url);
           if (ch == ':' && !sbflag) {
-            if (special && buffer.size() == 0) {
+            if (special && url->href.size() == url->start[URL_COMPONENT_HOST]) {
               url->flags |= URL_FLAGS_FAILED;
               return;
             }
             url->flags |= URL_FLAGS_HAS_HOST;
-            if (!ParseHost(&buffer, &url->host)) {
+            if (!ParseHost(&url->href, url->start[URL_COMPONENT_HOST])) {
               url->flags |= URL_FLAGS_FAILED;
               return;
             }
-            buffer.clear();
             state = kPort;
             if (state_override == kHostname) {
               url->flags |= URL_FLAGS_TERMINATED;
@@ -958,16 +1110,15 @@ namespace url {
                      ch == '#' ||
                      special_back_slash) {
             p--;
-            if (special && buffer.size() == 0) {
+            if (special && url->href.size() == url->start[URL_COMPONENT_HOST]) {
               url->flags |= URL_FLAGS_FAILED;
               return;
             }
             url->flags |= URL_FLAGS_HAS_HOST;
-            if (!ParseHost(&buffer, &url->host)) {
+            if (!ParseHost(&url->href, url->start[URL_COMPONENT_HOST])) {
               url->flags |= URL_FLAGS_FAILED;
               return;
             }
-            buffer.clear();
             state = kPathStart;
             if (has_state_override) {
               url->flags |= URL_FLAGS_TERMINATED;
@@ -978,29 +1129,35 @@ namespace url {
               sbflag = true;
             if (ch == ']')
               sbflag = false;
-            buffer += TO_LOWER(ch);
+            url->href += TO_LOWER(ch);
           }
           break;
         case kPort:
           if (ASCII_DIGIT(ch)) {
-            buffer += ch;
+            // Saturate rather than overflow, anything above 0xffff fails.
+            port = port < 0 ? ch - '0' : port * 10 + (ch - '0');
+            if (port > 0xffff)
+              port = 0x10000;
           } else if (has_state_override ||
                      ch == kEOL ||
                      ch == '/' ||
                      ch == '?' ||
                      ch == '#' ||
                      special_back_slash) {
-            if (buffer.size() > 0) {
-              int port = 0;
-              for (size_t i = 0; i < buffer.size(); i++)
-                port = port * 10 + buffer[i] - '0';
-              if (port >= 0 && port <= 0xffff) {
-                url->port = NormalizePort(url->scheme, port);
+            if (port >= 0) {
+              if (port <= 0xffff) {
+                url->port = NormalizePort(url->href.data(),
+                                          url->end[URL_COMPONENT_SCHEME],
+                                          port);
               } else if (!has_state_override) {
                 url->flags |= URL_FLAGS_FAILED;
                 return;
               }
-              buffer.clear();
+              port = -1;
+            }
+            if (url->port > -1 && url->cur < URL_COMPONENT_PORT) {
+              Begin(url, URL_COMPONENT_PORT, ":");
+              url->href += std::to_string(url->port);
             }
             state = kPathStart;
             continue;
@@ -1010,25 +1167,18 @@ namespace url {
           }
           break;
         case kFile:
+          if (url->cur < URL_COMPONENT_HOST)
+            Begin(url, URL_COMPONENT_HOST, "//");
           base_is_file = (
               has_base &&
               base->flags & URL_FLAGS_HAS_SCHEME &&
-              base->scheme == "file:");
+              IsFileScheme(base));
           switch (ch) {
             case kEOL:
               if (base_is_file) {
-                if (base->flags & URL_FLAGS_HAS_HOST) {
-                  url->flags |= URL_FLAGS_HAS_HOST;
-                  url->host = base->host;
-                }
-                if (base->flags & URL_FLAGS_HAS_PATH) {
-                  url->flags |= URL_FLAGS_HAS_PATH;
-                  url->path = base->path;
-                }
-                if (base->flags & URL_FLAGS_HAS_QUERY) {
-                  url->flags |= URL_FLAGS_HAS_QUERY;
-                  url->query = base->query;
-                }
+                CopyBase(url, base, URL_COMPONENT_QUERY,
+                         URL_FLAGS_HAS_HOST | URL_FLAGS_HAS_PATH |
+                         URL_FLAGS_HAS_QUERY);
                 break;
               }
               state = kPath;
@@ -1039,32 +1189,17 @@ namespace url {
               break;
             case '?':
               if (base_is_file) {
-                if (base->flags & URL_FLAGS_HAS_HOST) {
-                  url->flags |= URL_FLAGS_HAS_HOST;
-                  url->host = base->host;
-                }
-                if (base->flags & URL_FLAGS_HAS_PATH) {
-                  url->flags |= URL_FLAGS_HAS_PATH;
-                  url->path = base->path;
-                }
+                CopyBase(url, base, URL_COMPONENT_PATH,
+                         URL_FLAGS_HAS_HOST | URL_FLAGS_HAS_PATH);
                 url->flags |= URL_FLAGS_HAS_QUERY;
                 state = kQuery;
                 break;
               }
             case '#':
               if (base_is_file) {
-                if (base->flags & URL_FLAGS_HAS_HOST) {
-                  url->flags |= URL_FLAGS_HAS_HOST;
-                  url->host = base->host;
-                }
-                if (base->flags & URL_FLAGS_HAS_PATH) {
-                  url->flags |= URL_FLAGS_HAS_PATH;
-                  url->path = base->path;
-                }
-                if (base->flags & URL_FLAGS_HAS_QUERY) {
-                  url->flags |= URL_FLAGS_HAS_QUERY;
-                  url->query = base->query;
-                }
+                CopyBase(url, base, URL_COMPONENT_QUERY,
+                         URL_FLAGS_HAS_HOST | URL_FLAGS_HAS_PATH |
+                         URL_FLAGS_HAS_QUERY);
                 state = kFragment;
                 break;
               }
@@ -1076,14 +1211,8 @@ namespace url {
                     p[2] != '\\' &&
                     p[2] != '?' &&
                     p[2] != '#'))) {
-                if (base->flags & URL_FLAGS_HAS_HOST) {
-                  url->flags |= URL_FLAGS_HAS_HOST;
-                  url->host = base->host;
-                }
-                if (base->flags & URL_FLAGS_HAS_PATH) {
-                  url->flags |= URL_FLAGS_HAS_PATH;
-                  url->path = base->path;
-                }
+                CopyBase(url, base, URL_COMPONENT_PATH,
+                         URL_FLAGS_HAS_HOST | URL_FLAGS_HAS_PATH);
                 ShortenUrlPath(url);
               }
               state = kPath;
@@ -1096,12 +1225,12 @@ namespace url {
           } else {
             if (has_base &&
                 base->flags & URL_FLAGS_HAS_SCHEME &&
-                base->scheme == "file:" &&
+                IsFileScheme(base) &&
                 base->flags & URL_FLAGS_HAS_PATH &&
-                base->path.size() > 0 &&
-                NORMALIZED_WINDOWS_DRIVE_LETTER(base->path[0])) {
+                HasDriveLetter(base)) {
               url->flags |= URL_FLAGS_HAS_PATH;
-              url->path.push_back(base->path[0]);
+              Begin(url, URL_COMPONENT_PATH);
+              url->href.append(ComponentData(base, URL_COMPONENT_PATH), 3);
             }
             state = kPath;
             continue;
@@ -1113,25 +1242,35 @@ namespace url {
               ch == '\\' ||
               ch == '?' ||
               ch == '#') {
-            if (buffer.size() == 2 &&
-                WINDOWS_DRIVE_LETTER(buffer[0], buffer[1])) {
+            const size_t start = url->start[URL_COMPONENT_HOST];
+            const char* host = url->href.data() + start;
+            const size_t length = url->href.size() - start;
+            if (length == 2 && WINDOWS_DRIVE_LETTER(host[0], host[1])) {
+              // Not a host after all, but the first segment of the path.
+              const char drive[2] = { host[0], host[1] };
+              url->href.resize(start);
+              Begin(url, URL_COMPONENT_PATH);
+              url->href += '/';
+              segment = url->href.size();
+              url->href.append(drive, 2);
               state = kPath;
-            } else if (buffer.size() == 0) {
+            } else if (length == 0) {
               state = kPathStart;
             } else {
-              if (buffer != "localhost") {
+              if (length == 9 && memcmp(host, "localhost", 9) == 0) {
+                url->href.resize(start);
+              } else {
                 url->flags |= URL_FLAGS_HAS_HOST;
-                if (!ParseHost(&buffer, &url->host)) {
+                if (!ParseHost(&url->href, start)) {
                   url->flags |= URL_FLAGS_FAILED;
                   return;
                 }
               }
-              buffer.clear();
               state = kPathStart;
             }
             continue;
           } else {
-            buffer += ch;
+            url->href += ch;
           }
           break;
         case kPathStart:
@@ -1140,35 +1279,44 @@ namespace url {
             continue;
           break;
         case kPath:
+          if (segment == std::string::npos) {
+            if (url->cur < URL_COMPONENT_PATH)
+              Begin(url, URL_COMPONENT_PATH);
+            url->href += '/';
+            segment = url->href.size();
+          }
           if (ch == kEOL ||
               ch == '/' ||
               special_back_slash ||
               (!has_state_override && (ch == '?' || ch == '#'))) {
-            if (IsDoubleDotSegment(buffer)) {
+            const char* str = url->href.data() + segment;
+            const size_t length = url->href.size() - segment;
+            if (IsDoubleDotSegment(str, length)) {
+              url->href.resize(segment - 1);
               ShortenUrlPath(url);
               if (ch != '/' && !special_back_slash) {
                 url->flags |= URL_FLAGS_HAS_PATH;
-                url->path.push_back("");
+                url->href += '/';
               }
-            } else if (IsSingleDotSegment(buffer)) {
+            } else if (IsSingleDotSegment(str, length)) {
+              url->href.resize(segment - 1);
               if (ch != '/' && !special_back_slash) {
                 url->flags |= URL_FLAGS_HAS_PATH;
-                url->path.push_back("");
+                url->href += '/';
               }
             } else {
               if (url->flags & URL_FLAGS_HAS_SCHEME &&
-                  url->scheme == "file:" &&
-                  url->path.empty() &&
-                  buffer.size() == 2 &&
-                  WINDOWS_DRIVE_LETTER(buffer[0], buffer[1])) {
+                  IsFileScheme(url) &&
+                  segment - 1 == url->start[URL_COMPONENT_PATH] &&
+                  length == 2 &&
+                  WINDOWS_DRIVE_LETTER(str[0], str[1])) {
                 url->flags &= ~URL_FLAGS_HAS_HOST;
-                buffer[1] = ':';
+                segment -= EraseHost(url);
+                url->href[segment + 1] = ':';
               }
               url->flags |= URL_FLAGS_HAS_PATH;
-              std::string segment(buffer.c_str(), buffer.size());
-              url->path.push_back(segment);
             }
-            buffer.clear();
+            segment = std::string::npos;
             if (ch == '?') {
               url->flags |= URL_FLAGS_HAS_QUERY;
               state = kQuery;
@@ -1176,7 +1324,10 @@ namespace url {
               state = kFragment;
             }
           } else {
-            AppendOrEscape(&buffer, ch, DefaultEncodeSet);
+            AppendOrEscape(&url->href, ch, DefaultEncodeSet);
+            const char* run = FindRunEnd(p + 1, end, 0x21, kPathStops);
+            url->href.append(p + 1, run - p - 1);
+            p = run - 1;
           }
           break;
         case kCannotBeBase:
@@ -1188,33 +1339,46 @@ namespace url {
               state = kFragment;
               break;
             default:
-              if (url->path.size() == 0)
-                url->path.push_back("");
-              if (url->path.size() > 0 && ch != kEOL)
-                AppendOrEscape(&url->path[0], ch, SimpleEncodeSet);
+              if (url->cur < URL_COMPONENT_PATH)
+                Begin(url, URL_COMPONENT_PATH);
+              if (ch != kEOL) {
+                AppendOrEscape(&url->href, ch, SimpleEncodeSet);
+                const char* run =
+                    FindRunEnd(p + 1, end, 0x20, kCannotBeBaseStops);
+                url->href.append(p + 1, run - p - 1);
+                p = run - 1;
+              }
           }
           break;
         case kQuery:
+          if (url->cur < URL_COMPONENT_QUERY)
+            Begin(url, URL_COMPONENT_QUERY, "?");
           if (ch == kEOL || (!has_state_override && ch == '#')) {
             url->flags |= URL_FLAGS_HAS_QUERY;
-            url->query = buffer;
-            buffer.clear();
             if (ch == '#')
               state = kFragment;
           } else {
-            AppendOrEscape(&buffer, ch, QueryEncodeSet);
+            AppendOrEscape(&url->href, ch, QueryEncodeSet);
+            const char* run = FindRunEnd(p + 1, end, 0x21, kQueryStops);
+            url->href.append(p + 1, run - p - 1);
+            p = run - 1;
           }
           break;
         case kFragment:
+          if (url->cur < URL_COMPONENT_FRAGMENT)
+            Begin(url, URL_COMPONENT_FRAGMENT, "#");
           switch (ch) {
             case kEOL:
               url->flags |= URL_FLAGS_HAS_FRAGMENT;
-              url->fragment = buffer;
               break;
             case 0:
               break;
             default:
-              AppendOrEscape(&buffer, ch, SimpleEncodeSet);
+              AppendOrEscape(&url->href, ch, SimpleEncodeSet);
+              const char* run =
+                  FindRunEnd(p + 1, end, 0x20, kFragmentStops);
+              url->href.append(p + 1, run - p - 1);
+              p = run - 1;
           }
           break;
         default:
@@ -1226,6 +1390,16 @@ namespace url {
     }
   }
 
+  void URL::Parse(const char* input,
+                  const size_t len,
+                  enum url_parse_state state_override,
+                  struct url_data* url,
+                  const struct url_data* base,
+                  bool has_base) {
+    RunStateMachine(input, len, state_override, url, base, has_base);
+    Finish(url);
+  }
+
   static void Parse(Environment* env,
                     Local<Value> recv,
                     const char* input,
@@ -1269,21 +1443,25 @@ namespace url {
       };
       argv[ARG_FLAGS] = Integer::NewFromUnsigned(isolate, url.flags);
       if (url.flags & URL_FLAGS_HAS_SCHEME)
-        argv[ARG_PROTOCOL] = OneByteString(isolate, url.scheme.c_str());
+        argv[ARG_PROTOCOL] =
+            ComponentString(isolate, &url, URL_COMPONENT_SCHEME);
       if (url.flags & URL_FLAGS_HAS_USERNAME)
-        argv[ARG_USERNAME] = UTF8STRING(isolate, url.username);
+        argv[ARG_USERNAME] =
+            ComponentString(isolate, &url, URL_COMPONENT_USERNAME);
       if (url.flags & URL_FLAGS_HAS_PASSWORD)
-        argv[ARG_PASSWORD] = UTF8STRING(isolate, url.password);
+        argv[ARG_PASSWORD] =
+            ComponentString(isolate, &url, URL_COMPONENT_PASSWORD);
       if (url.flags & URL_FLAGS_HAS_HOST)
-        argv[ARG_HOST] = UTF8STRING(isolate, url.host);
+        argv[ARG_HOST] = ComponentString(isolate, &url, URL_COMPONENT_HOST);
       if (url.flags & URL_FLAGS_HAS_QUERY)
-        argv[ARG_QUERY] = UTF8STRING(isolate, url.query);
+        argv[ARG_QUERY] = ComponentString(isolate, &url, URL_COMPONENT_QUERY);
       if (url.flags & URL_FLAGS_HAS_FRAGMENT)
-        argv[ARG_FRAGMENT] = UTF8STRING(isolate, url.fragment);
+        argv[ARG_FRAGMENT] =
+            ComponentString(isolate, &url, URL_COMPONENT_FRAGMENT);
       if (url.port > -1)
         argv[ARG_PORT] = Integer::New(isolate, url.port);
       if (url.flags & URL_FLAGS_HAS_PATH)
-        argv[ARG_PATH] = Copy(env, url.path);
+        argv[ARG_PATH] = PathToArray(env, &url);
       (void)cb->Call(context, recv, arraysize(argv), argv);
     } else if (error_cb->IsFunction()) {
       Local<Value> argv[2] = { undef, undef };
@@ -1325,6 +1503,105 @@ namespace url {
           args[5]);
   }
 
+  // The href is ASCII unless a host could not go through ToASCII (builds
+  // without ICU).  JS indexes strings by UTF-16 code units, so the offsets
+  // into such an href have to be translated.
+  static inline uint32_t ToUTF16Offset(const std::string& href,
+                                       uint32_t offset) {
+    uint32_t units = 0;
+    for (uint32_t n = 0; n < offset; n++) {
+      const unsigned char ch = href[n];
+      if ((ch & 0xc0) != 0x80)
+        units += ch >= 0xf0 ? 2 : 1;
+    }
+    return units;
+  }
+
+  // parseHref(input, baseHref, baseOffsets, offsets) parses `input` against
+  // the base URL that an earlier call returned, if any, without parsing that
+  // again.  It fills `offsets` as laid out by url_offsets and returns the
+  // serialized URL, or undefined if `input` could not be parsed.
+  static void ParseHref(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    Isolate* isolate = env->isolate();
+    CHECK_GE(args.Length(), 4);
+    CHECK(args[0]->IsString());  // input
+    CHECK(args[1]->IsUndefined() || args[1]->IsString());  // base href
+    CHECK(args[2]->IsUndefined() || args[2]->IsUint32Array());  // base offsets
+    CHECK(args[3]->IsUint32Array());  // offsets
+
+    Local<Uint32Array> array = args[3].As<Uint32Array>();
+    CHECK_EQ(array->Length(), URL_OFFSETS_LENGTH);
+    uint32_t* offsets = reinterpret_cast<uint32_t*>(
+        static_cast<char*>(array->Buffer()->GetContents().Data()) +
+        array->ByteOffset());
+
+    struct url_data base;
+    const bool has_base = args[1]->IsString();
+    if (has_base) {
+      Utf8Value href(isolate, args[1]);
+      if (args[2]->IsUint32Array() &&
+          href.length() ==
+              static_cast<size_t>(args[1].As<String>()->Length())) {
+        Local<Uint32Array> base_array = args[2].As<Uint32Array>();
+        CHECK_EQ(base_array->Length(), URL_OFFSETS_LENGTH);
+        const uint32_t* base_offsets = reinterpret_cast<const uint32_t*>(
+            static_cast<const char*>(
+                base_array->Buffer()->GetContents().Data()) +
+            base_array->ByteOffset());
+        base.href.assign(*href, href.length());
+        base.flags = base_offsets[URL_OFFSETS_FLAGS];
+        base.port = static_cast<int32_t>(base_offsets[URL_OFFSETS_PORT]);
+        for (int n = 0; n < URL_COMPONENT_COUNT; n++) {
+          base.start[n] = base_offsets[URL_OFFSETS_COMPONENTS + 2 * n];
+          base.end[n] = base_offsets[URL_OFFSETS_COMPONENTS + 2 * n + 1];
+          CHECK_LE(base.start[n], base.end[n]);
+          CHECK_LE(base.end[n], href.length());
+        }
+        base.cur = URL_COMPONENT_FRAGMENT;
+      } else {
+        URL::Parse(*href, href.length(), kUnknownState, &base, nullptr, false);
+      }
+    }
+
+    struct url_data url;
+    if (!(base.flags & URL_FLAGS_FAILED)) {
+      Utf8Value input(isolate, args[0]);
+      URL::Parse(*input, input.length(), kUnknownState, &url, &base, has_base);
+    } else {
+      url.flags |= URL_FLAGS_FAILED;
+    }
+
+    offsets[URL_OFFSETS_FLAGS] = url.flags;
+    offsets[URL_OFFSETS_PORT] = static_cast<uint32_t>(url.port);
+    if (url.flags & URL_FLAGS_FAILED)
+      return;
+
+    bool is_ascii = true;
+    for (const char ch : url.href) {
+      if (ch & 0x80) {
+        is_ascii = false;
+        break;
+      }
+    }
+    for (int n = 0; n < URL_COMPONENT_COUNT; n++) {
+      uint32_t* pair = offsets + URL_OFFSETS_COMPONENTS + 2 * n;
+      pair[0] = is_ascii ? url.start[n] : ToUTF16Offset(url.href, url.start[n]);
+      pair[1] = is_ascii ? url.end[n] : ToUTF16Offset(url.href, url.end[n]);
+    }
+
+    Local<String> href;
+    if (is_ascii) {
+      href = OneByteString(isolate, url.href.data(), url.href.size());
+    } else {
+      href = String::NewFromUtf8(isolate,
+                                 url.href.data(),
+                                 v8::NewStringType::kNormal,
+                                 url.href.size()).ToLocalChecked();
+    }
+    args.GetReturnValue().Set(href);
+  }
+
   static void EncodeAuthSet(const FunctionCallbackInfo<Value>& args) {
     Environment* env = Environment::GetCurrent(args);
     CHECK_GE(args.Length(), 1);
@@ -1424,6 +1701,7 @@ namespace url {
                    void* priv) {
     Environment* env = Environment::GetCurrent(context);
     env->SetMethod(target, "parse", Parse);
+    env->SetMethod(target, "parseHref", ParseHref);
     env->SetMethod(target, "encodeAuth", EncodeAuthSet);
     env->SetMethod(target, "toUSVString", ToUSVString);
     env->SetMethod(target, "domainToASCII", DomainToASCII);
@@ -1436,7 +1714,12 @@ namespace url {
 #define XX(name) NODE_DEFINE_CONSTANT(target, name);
     ARGS(XX)
     PARSESTATES(XX)
+    COMPONENTS(XX)
 #undef XX
+    NODE_DEFINE_CONSTANT(target, URL_OFFSETS_FLAGS);
+    NODE_DEFINE_CONSTANT(target, URL_OFFSETS_PORT);
+    NODE_DEFINE_CONSTANT(target, URL_OFFSETS_COMPONENTS);
+    NODE_DEFINE_CONSTANT(target, URL_OFFSETS_LENGTH);
   }
 }  // namespace url
 }  // namespace node
@@ -4,6 +4,7 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include "node.h"
+#include <string.h>
 #include <string>
 
 namespace node {
@@ -28,8 +29,8 @@ namespace url {
   (ASCII_ALPHANUMERIC(ch) || ch == '+' || ch == '-' || ch == '.')
 #define WINDOWS_DRIVE_LETTER(ch, next)                                        \
   (ASCII_ALPHA(ch) && (next == ':' || next == '|'))
-#define NORMALIZED_WINDOWS_DRIVE_LETTER(str)                                  \
-  (str.length() == 2 &&                                                       \
+#define NORMALIZED_WINDOWS_DRIVE_LETTER(str, len)                             \
+  (len == 2 &&                                                                \
   ASCII_ALPHA(str[0]) &&                                                      \
   str[1] == ':')
 
@@ -467,6 +468,18 @@ static inline void PercentDecode(const char* input,
   XX(ERR_ARG_FLAGS)                                                           \
   XX(ERR_ARG_INPUT)                                                           \
 
+// The components of a parsed URL, in the order in which they appear in its
+// serialization.
+#define COMPONENTS(XX)                                                        \
+  XX(URL_COMPONENT_SCHEME)                                                    \
+  XX(URL_COMPONENT_USERNAME)                                                  \
+  XX(URL_COMPONENT_PASSWORD)                                                  \
+  XX(URL_COMPONENT_HOST)                                                      \
+  XX(URL_COMPONENT_PORT)                                                      \
+  XX(URL_COMPONENT_PATH)                                                      \
+  XX(URL_COMPONENT_QUERY)                                                     \
+  XX(URL_COMPONENT_FRAGMENT)
+
 static const char kEOL = -1;
 
 enum url_parse_state {
@@ -494,30 +507,52 @@ enum url_error_cb_args {
 #undef XX
 };
 
-static inline bool IsSpecial(std::string scheme) {
-#define XX(name, _) if (scheme == name) return true;
+enum url_component {
+#define XX(name) name,
+  COMPONENTS(XX)
+#undef XX
+  URL_COMPONENT_COUNT
+};
+
+// Layout of the Uint32Array that parseHref() fills in: the flags, the port
+// (-1 reads back as 0xffffffff), then a start/end pair for every component.
+enum url_offsets {
+  URL_OFFSETS_FLAGS = 0,
+  URL_OFFSETS_PORT = 1,
+  URL_OFFSETS_COMPONENTS = 2,
+  URL_OFFSETS_LENGTH = URL_OFFSETS_COMPONENTS + 2 * URL_COMPONENT_COUNT
+};
+
+static inline bool IsSpecial(const char* scheme, size_t len) {
+#define XX(name, _)                                                           \
+  if (len == sizeof(name) - 1 && memcmp(scheme, name, len) == 0) return true;
   SPECIALS(XX);
 #undef XX
   return false;
 }
 
-static inline int NormalizePort(std::string scheme, int p) {
-#define XX(name, port) if (scheme == name && p == port) return -1;
+static inline int NormalizePort(const char* scheme, size_t len, int p) {
+#define XX(name, port)                                                        \
+  if (len == sizeof(name) - 1 && memcmp(scheme, name, len) == 0 &&            \
+      p == port)                                                              \
+    return -1;
   SPECIALS(XX);
 #undef XX
   return p;
 }
 
+// A parsed URL is kept as its serialization plus the offsets of each
+// component in it.  The ranges exclude the delimiters, except that the
+// scheme includes its trailing ':'; a component that is not present is an
+// empty range where it would have started.  `cur` is the component that is
+// still being written, its end is only valid once the parser is done.
 struct url_data {
   int32_t flags = URL_FLAGS_NONE;
   int port = -1;
-  std::string scheme;
-  std::string username;
-  std::string password;
-  std::string host;
-  std::string query;
-  std::string fragment;
-  std::vector<std::string> path;
+  std::string href;
+  uint32_t start[URL_COMPONENT_COUNT] {};
+  uint32_t end[URL_COMPONENT_COUNT] {};
+  enum url_component cur = URL_COMPONENT_SCHEME;
 };
 
 union url_host_value {
@@ -586,40 +621,44 @@ class URL {
     return context_.port;
   }
 
-  const std::string& protocol() const {
-    return context_.scheme;
+  const std::string& href() const {
+    return context_.href;
   }
 
-  const std::string& username() const {
-    return context_.username;
+  std::string protocol() const {
+    return component(URL_COMPONENT_SCHEME);
   }
 
-  const std::string& password() const {
-    return context_.password;
+  std::string username() const {
+    return component(URL_COMPONENT_USERNAME);
   }
 
-  const std::string& host() const {
-    return context_.host;
+  std::string password() const {
+    return component(URL_COMPONENT_PASSWORD);
   }
 
-  const std::string& query() const {
-    return context_.query;
+  std::string host() const {
+    return component(URL_COMPONENT_HOST);
   }
 
-  const std::string& fragment() const {
-    return context_.fragment;
+  std::string query() const {
+    return component(URL_COMPONENT_QUERY);
   }
 
-  std::string path() {
-    std::string ret;
-    for (auto i = context_.path.begin(); i != context_.path.end(); i++) {
-      ret += '/';
-      ret += *i;
-    }
-    return ret;
+  std::string fragment() const {
+    return component(URL_COMPONENT_FRAGMENT);
+  }
+
+  std::string path() const {
+    return component(URL_COMPONENT_PATH);
   }
 
  private:
+  std::string component(enum url_component c) const {
+    return context_.href.substr(context_.start[c],
+                                context_.end[c] - context_.start[c]);
+  }
+
   struct url_data context_;
 };
 
@@ -34,10 +34,14 @@ using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::HeapSpaceStatistics;
 using v8::HeapStatistics;
+#ifdef NODE_ENGINE_SPIDERMONKEY
+using v8::HelperThreadStatistics;
+#endif
 using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::NewStringType;
+using v8::Number;
 using v8::Object;
 using v8::ScriptCompiler;
 using v8::String;
@@ -113,6 +117,34 @@ void UpdateHeapSpaceStatisticsBuffer(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+#ifdef NODE_ENGINE_SPIDERMONKEY
+#define HELPER_THREAD_STATISTICS_PROPERTIES(V)                                \
+  V(cpu_count, "cpuCount")                                                    \
+  V(thread_count, "threadCount")                                              \
+  V(ion_pending, "ionPending")                                                \
+  V(ion_finished, "ionFinished")                                              \
+  V(wasm_pending, "wasmPending")                                              \
+  V(parse_pending, "parsePending")                                            \
+  V(parse_finished, "parseFinished")                                          \
+  V(compression_pending, "compressionPending")                                \
+  V(gc_pending, "gcPending")                                                  \
+  V(promise_tasks_pending, "promiseTasksPending")
+
+void GetHelperThreadStatistics(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  HelperThreadStatistics s;
+  V8::GetHelperThreadStatistics(&s);
+  Local<Object> result = Object::New(env->isolate());
+#define V(name, key)                                                          \
+  result->Set(FIXED_ONE_BYTE_STRING(env->isolate(), key),                     \
+              Number::New(env->isolate(), static_cast<double>(s.name())));
+  HELPER_THREAD_STATISTICS_PROPERTIES(V)
+#undef V
+  args.GetReturnValue().Set(result);
+}
+#endif  // NODE_ENGINE_SPIDERMONKEY
+
+
 void SetFlagsFromString(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -133,6 +165,12 @@ void InitializeV8Bindings(Local<Object> target,
 
   env->SetMethod(target, "cachedDataVersionTag", CachedDataVersionTag);
 
+#ifdef NODE_ENGINE_SPIDERMONKEY
+  env->SetMethod(target,
+                 "getHelperThreadStatistics",
+                 GetHelperThreadStatistics);
+#endif
+
   env->SetMethod(target,
                  "updateHeapStatisticsArrayBuffer",
                  UpdateHeapStatisticsArrayBuffer);
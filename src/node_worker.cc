@@ -0,0 +1,417 @@
+#include "node_worker.h"
+#include "node.h"
+#include "node_internals.h"
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "handle_wrap.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+namespace node {
+namespace worker {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::Boolean;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Locker;
+using v8::Object;
+using v8::SealHandleScope;
+using v8::Value;
+using v8::ValueDeserializer;
+using v8::ValueSerializer;
+
+namespace {
+
+// The Worker whose script runs on the current thread, if any.
+uv_key_t current_worker_key;
+uv_once_t current_worker_key_once = UV_ONCE_INIT;
+
+void InitCurrentWorkerKey() {
+  CHECK_EQ(0, uv_key_create(&current_worker_key));
+}
+
+}  // anonymous namespace
+
+
+Worker::Message::~Message() {
+#ifdef NODE_ENGINE_SPIDERMONKEY
+  // Let a deserializer that never reads the value free the contents of the
+  // transferred buffers.  It doesn't look at the isolate for that.
+  if (!data_.empty())
+    ValueDeserializer unread(nullptr, data_.data(), data_.size());
+#endif
+}
+
+
+Worker::Worker(Environment* env,
+               Local<Object> object,
+               const std::string& filename)
+    : BaseObject(env, object),
+      filename_(filename),
+      worker_env_(nullptr),
+      stopped_(false),
+      isolate_(nullptr),
+      stop_requested_(false),
+      worker_async_open_(true),
+      exited_(false),
+      exit_code_(0) {
+  Wrap(object, this);
+
+  // Both handles are set up here, before the thread exists, so that either
+  // side can uv_async_send() as soon as the constructor returns.
+  CHECK_EQ(0, uv_loop_init(&loop_));
+  CHECK_EQ(0, uv_async_init(&loop_, &worker_async_, OnWorkerAsync));
+  CHECK_EQ(0, uv_async_init(env->event_loop(), &parent_async_, OnParentAsync));
+
+  CHECK_EQ(0, uv_thread_create(&thread_, Run, this));
+}
+
+
+Worker::~Worker() {
+  CHECK(exited_);
+  CHECK_EQ(0, uv_loop_close(&loop_));
+  persistent().Reset();
+}
+
+
+void Worker::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+
+  if (!args[0]->IsString())
+    return env->ThrowTypeError("filename must be a string");
+
+  node::Utf8Value filename(env->isolate(), args[0]);
+  new Worker(env, args.This(), *filename);
+}
+
+
+bool Worker::Serialize(Environment* env,
+                       Local<Value> value,
+                       Local<Value> transfer_list,
+                       Message* message) {
+  ValueSerializer serializer(env->isolate());
+  serializer.WriteHeader();
+
+#ifdef NODE_ENGINE_SPIDERMONKEY
+  // SpiderMonkey moves the contents of transferred buffers into the message
+  // itself, so the receiving side has nothing to hook up.  V8 would need the
+  // contents handed over out of band; there the buffers are just copied.
+  if (transfer_list->IsArray()) {
+    Local<Array> list = transfer_list.As<Array>();
+    for (uint32_t i = 0; i < list->Length(); i++) {
+      Local<Value> entry = list->Get(i);
+      if (entry->IsArrayBuffer())
+        serializer.TransferArrayBuffer(i, entry.As<ArrayBuffer>());
+    }
+  }
+#endif
+
+  if (serializer.WriteValue(env->context(), value).IsNothing())
+    return false;
+  message->data_ = serializer.ReleaseBuffer();
+  return true;
+}
+
+
+void Worker::Deliver(Environment* env,
+                     Local<Object> recv,
+                     Message* message) {
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  ValueDeserializer deserializer(env->isolate(),
+                                 message->data_.data(),
+                                 message->data_.size());
+  // The deserializer owns the transferred buffers from here on.
+  message->data_.clear();
+  Local<Value> value;
+  if (deserializer.ReadHeader(env->context()).IsNothing() ||
+      !deserializer.ReadValue(env->context()).ToLocal(&value)) {
+    return;
+  }
+  MakeCallback(env, recv, "onmessage", 1, &value);
+}
+
+
+void Worker::PostMessageToWorker(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Worker* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.Holder());
+
+  Message message;
+  if (!Serialize(env, args[0], args[1], &message))
+    return;  // Exception pending.
+
+  Mutex::ScopedLock lock(w->mutex_);
+  if (!w->worker_async_open_)
+    return;  // The worker is gone, drop the message.
+  w->to_worker_.push_back(std::move(message));
+  uv_async_send(&w->worker_async_);
+}
+
+
+void Worker::Terminate(const FunctionCallbackInfo<Value>& args) {
+  Worker* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.Holder());
+
+  Mutex::ScopedLock lock(w->mutex_);
+  w->stop_requested_ = true;
+  // Interrupt any script that is still running, then wake the loop so that
+  // it notices the request.
+  if (w->isolate_ != nullptr)
+    w->isolate_->TerminateExecution();
+  if (w->worker_async_open_)
+    uv_async_send(&w->worker_async_);
+}
+
+
+void Worker::PostMessageToParent(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Worker* w = static_cast<Worker*>(uv_key_get(&current_worker_key));
+  CHECK_NE(w, nullptr);
+
+  Message message;
+  if (!Serialize(env, args[0], args[1], &message))
+    return;  // Exception pending.
+
+  Mutex::ScopedLock lock(w->mutex_);
+  w->to_parent_.push_back(std::move(message));
+  uv_async_send(&w->parent_async_);
+}
+
+
+void Worker::Close(const FunctionCallbackInfo<Value>& args) {
+  Worker* w = static_cast<Worker*>(uv_key_get(&current_worker_key));
+  CHECK_NE(w, nullptr);
+  w->Stop();
+}
+
+
+void Worker::Stop() {
+  stopped_ = true;
+  uv_stop(&loop_);
+}
+
+
+void Worker::Run(void* arg) {
+  Worker* w = static_cast<Worker*>(arg);
+  uv_key_set(&current_worker_key, w);
+
+  w->RunEnvironment();
+
+  {
+    Mutex::ScopedLock lock(w->mutex_);
+    w->worker_async_open_ = false;
+  }
+  // Already closed by CloseHandles() unless the isolate failed to start.
+  uv_handle_t* async = reinterpret_cast<uv_handle_t*>(&w->worker_async_);
+  if (!uv_is_closing(async))
+    uv_close(async, nullptr);
+  uv_run(&w->loop_, UV_RUN_DEFAULT);
+
+  uv_key_set(&current_worker_key, nullptr);
+
+  Mutex::ScopedLock lock(w->mutex_);
+  w->exited_ = true;
+  uv_async_send(&w->parent_async_);
+}
+
+
+void Worker::RunEnvironment() {
+  ArrayBufferAllocator allocator;
+  Isolate::CreateParams params;
+  params.array_buffer_allocator = &allocator;
+
+  Isolate* isolate = Isolate::New(params);
+  if (isolate == nullptr) {
+    exit_code_ = 12;  // Same as a failed start of the main instance.
+    return;
+  }
+  isolate->SetAutorunMicrotasks(false);
+
+  {
+    Mutex::ScopedLock lock(mutex_);
+    isolate_ = isolate;
+    stopped_ = stop_requested_;
+  }
+
+  {
+    Locker locker(isolate);
+    Isolate::Scope isolate_scope(isolate);
+    HandleScope handle_scope(isolate);
+    IsolateData* isolate_data = CreateIsolateData(isolate, &loop_);
+    Local<Context> context = Context::New(isolate);
+    Context::Scope context_scope(context);
+
+    char exec_path[4096];
+    size_t exec_path_len = sizeof(exec_path);
+    if (uv_exepath(exec_path, &exec_path_len) != 0)
+      snprintf(exec_path, sizeof(exec_path), "node");
+    const char* argv[] = { exec_path, filename_.c_str() };
+    Environment* env = CreateEnvironment(isolate_data, context,
+                                         arraysize(argv), argv, 0, nullptr);
+    worker_env_ = env;
+
+    if (!stopped_) {
+      Environment::AsyncCallbackScope callback_scope(env);
+      LoadEnvironment(env);
+    }
+
+    {
+      SealHandleScope seal(isolate);
+      bool more = !stopped_;
+      while (more && !stopped_) {
+        more = uv_run(&loop_, UV_RUN_DEFAULT);
+        if (!more && !stopped_) {
+          EmitBeforeExit(env);
+          more = uv_loop_alive(&loop_);
+        }
+      }
+    }
+
+    // A terminate() may have interrupted a script; let the exit handlers run.
+    isolate->CancelTerminateExecution();
+    exit_code_ = EmitExit(env);
+    RunAtExit(env);
+    CloseHandles(env);
+
+    worker_binding_.Reset();
+    worker_env_ = nullptr;
+    FreeEnvironment(env);
+    FreeIsolateData(isolate_data);
+  }
+
+  {
+    Mutex::ScopedLock lock(mutex_);
+    isolate_ = nullptr;
+  }
+  isolate->Dispose();
+}
+
+
+// Timers, sockets and watchers that the script left open still point at
+// |env|, so they are closed, and their close callbacks run, before it goes
+// away.  Wraps are closed the way close() would close them, then the
+// environment's own handles, then whatever is left on the loop.
+void Worker::CloseHandles(Environment* env) {
+  {
+    Mutex::ScopedLock lock(mutex_);
+    worker_async_open_ = false;
+  }
+
+  for (auto w : *env->handle_wrap_queue())
+    w->Close();
+  env->CleanupHandles();
+
+  uv_walk(&loop_, [](uv_handle_t* handle, void* arg) {
+    if (!uv_is_closing(handle))
+      uv_close(handle, nullptr);
+  }, nullptr);
+  uv_run(&loop_, UV_RUN_DEFAULT);
+}
+
+
+void Worker::OnWorkerAsync(uv_async_t* handle) {
+  Worker* w = ContainerOf(&Worker::worker_async_, handle);
+
+  std::deque<Message> messages;
+  bool stop;
+  {
+    Mutex::ScopedLock lock(w->mutex_);
+    messages.swap(w->to_worker_);
+    stop = w->stop_requested_;
+  }
+
+  if (stop)
+    return w->Stop();
+
+  Environment* env = w->worker_env_;
+  if (env == nullptr || w->worker_binding_.IsEmpty())
+    return;
+  HandleScope handle_scope(env->isolate());
+  Local<Object> binding = PersistentToLocal(env->isolate(), w->worker_binding_);
+  for (Message& message : messages) {
+    if (w->stopped_)
+      break;
+    Deliver(env, binding, &message);
+  }
+}
+
+
+void Worker::OnParentAsync(uv_async_t* handle) {
+  Worker* w = ContainerOf(&Worker::parent_async_, handle);
+  Environment* env = w->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  std::deque<Message> messages;
+  bool exited;
+  {
+    Mutex::ScopedLock lock(w->mutex_);
+    messages.swap(w->to_parent_);
+    exited = w->exited_;
+  }
+
+  for (Message& message : messages)
+    Deliver(env, w->object(), &message);
+
+  if (!exited)
+    return;
+
+  CHECK_EQ(0, uv_thread_join(&w->thread_));
+  uv_close(reinterpret_cast<uv_handle_t*>(&w->parent_async_),
+           OnParentAsyncClose);
+
+  Local<Value> code = Integer::New(env->isolate(), w->exit_code_);
+  MakeCallback(env, w->object(), "onexit", 1, &code);
+}
+
+
+void Worker::OnParentAsyncClose(uv_handle_t* handle) {
+  Worker* w = ContainerOf(&Worker::parent_async_,
+                          reinterpret_cast<uv_async_t*>(handle));
+  // Nothing refers to the thread anymore, let the wrapper be collected.
+  w->MakeWeak<Worker>(w);
+}
+
+
+void Worker::Initialize(Local<Object> target,
+                        Local<Value> unused,
+                        Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  uv_once(&current_worker_key_once, InitCurrentWorkerKey);
+  Worker* current = static_cast<Worker*>(uv_key_get(&current_worker_key));
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Worker"));
+  env->SetProtoMethod(t, "postMessage", PostMessageToWorker);
+  env->SetProtoMethod(t, "terminate", Terminate);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Worker"),
+              t->GetFunction());
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "isMainThread"),
+              Boolean::New(env->isolate(), current == nullptr));
+
+  if (current != nullptr) {
+    env->SetMethod(target, "postMessage", PostMessageToParent);
+    env->SetMethod(target, "close", Close);
+    current->worker_binding_.Reset(env->isolate(), target);
+  }
+}
+
+}  // namespace worker
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(worker, node::worker::Worker::Initialize)
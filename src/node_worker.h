@@ -0,0 +1,118 @@
+#ifndef SRC_NODE_WORKER_H_
+#define SRC_NODE_WORKER_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "base-object.h"
+#include "env.h"
+#include "node_mutex.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace node {
+namespace worker {
+
+// A script running in its own isolate and event loop on a separate thread.
+// Values are passed between the two sides with ValueSerializer, so each
+// message is copied (or, for the ArrayBuffers in a transfer list, moved)
+// into the receiving isolate; the isolates never share any JS objects.
+//
+// The parent talks to the worker through the object returned by
+// `new binding.Worker(filename)`, which gets `onmessage(value)` and
+// `onexit(code)` callbacks.  Inside the worker the same binding exposes
+// `postMessage()` and `close()`, and its `onmessage` is called for messages
+// from the parent.  The worker keeps running until it calls close() or the
+// parent calls terminate().
+class Worker : public BaseObject {
+ public:
+  static void Initialize(v8::Local<v8::Object> target,
+                         v8::Local<v8::Value> unused,
+                         v8::Local<v8::Context> context);
+
+  ~Worker() override;
+
+ private:
+  // A serialized value.  With SpiderMonkey it also owns the contents of the
+  // ArrayBuffers it transfers until it is delivered, and frees them if it is
+  // dropped instead.
+  class Message {
+   public:
+    Message() {}
+    Message(Message&& other) : data_(std::move(other.data_)) {
+      other.data_.clear();
+    }
+    ~Message();
+
+   private:
+    friend class Worker;
+    std::vector<uint8_t> data_;
+
+    Message(const Message&) = delete;
+    void operator=(const Message&) = delete;
+  };
+
+  Worker(Environment* env,
+         v8::Local<v8::Object> object,
+         const std::string& filename);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void PostMessageToWorker(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Terminate(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void PostMessageToParent(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static bool Serialize(Environment* env,
+                        v8::Local<v8::Value> value,
+                        v8::Local<v8::Value> transfer_list,
+                        Message* message);
+  static void Deliver(Environment* env,
+                      v8::Local<v8::Object> recv,
+                      Message* message);
+
+  // Runs on the worker thread.
+  static void Run(void* arg);
+  void RunEnvironment();
+  void CloseHandles(Environment* env);
+  static void OnWorkerAsync(uv_async_t* handle);
+
+  // Run on the parent thread.
+  static void OnParentAsync(uv_async_t* handle);
+  static void OnParentAsyncClose(uv_handle_t* handle);
+
+  void Stop();
+
+  const std::string filename_;
+  uv_thread_t thread_;
+  uv_loop_t loop_;
+  uv_async_t worker_async_;  // Wakes the worker loop.
+  uv_async_t parent_async_;  // Wakes the parent loop.
+
+  // Only touched on the worker thread.
+  Environment* worker_env_;
+  v8::Persistent<v8::Object> worker_binding_;
+  bool stopped_;
+
+  // Shared between the two threads.
+  Mutex mutex_;
+  std::deque<Message> to_worker_;
+  std::deque<Message> to_parent_;
+  v8::Isolate* isolate_;
+  bool stop_requested_;
+  bool worker_async_open_;
+  bool exited_;
+  int exit_code_;
+};
+
+}  // namespace worker
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_WORKER_H_
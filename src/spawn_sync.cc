@@ -45,65 +45,20 @@ using v8::String;
 using v8::Value;
 
 
-SyncProcessOutputBuffer::SyncProcessOutputBuffer()
-    : used_(0),
-      next_(nullptr) {
-}
-
-
-void SyncProcessOutputBuffer::OnAlloc(size_t suggested_size,
-                                      uv_buf_t* buf) const {
-  if (used() == kBufferSize)
-    *buf = uv_buf_init(nullptr, 0);
-  else
-    *buf = uv_buf_init(data_ + used(), available());
-}
-
-
-void SyncProcessOutputBuffer::OnRead(const uv_buf_t* buf, size_t nread) {
-  // If we hand out the same chunk twice, this should catch it.
-  CHECK_EQ(buf->base, data_ + used());
-  used_ += static_cast<unsigned int>(nread);
-}
-
-
-size_t SyncProcessOutputBuffer::Copy(char* dest) const {
-  memcpy(dest, data_, used());
-  return used();
-}
-
-
-unsigned int SyncProcessOutputBuffer::available() const {
-  return sizeof data_ - used();
-}
-
-
-unsigned int SyncProcessOutputBuffer::used() const {
-  return used_;
-}
-
-
-SyncProcessOutputBuffer* SyncProcessOutputBuffer::next() const {
-  return next_;
-}
-
-
-void SyncProcessOutputBuffer::set_next(SyncProcessOutputBuffer* next) {
-  next_ = next;
-}
-
-
 SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
                                            bool readable,
                                            bool writable,
-                                           uv_buf_t input_buffer)
+                                           uv_buf_t input_buffer,
+                                           int output_fd)
     : process_handler_(process_handler),
       readable_(readable),
       writable_(writable),
       input_buffer_(input_buffer),
 
-      first_output_buffer_(nullptr),
-      last_output_buffer_(nullptr),
+      output_(nullptr),
+      output_length_(0),
+      output_capacity_(0),
+      output_fd_(output_fd),
 
       uv_pipe_(),
       write_req_(),
@@ -116,14 +71,7 @@ SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
 
 SyncProcessStdioPipe::~SyncProcessStdioPipe() {
   CHECK(lifecycle_ == kUninitialized || lifecycle_ == kClosed);
-
-  SyncProcessOutputBuffer* buf;
-  SyncProcessOutputBuffer* next;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = next) {
-    next = buf->next();
-    delete buf;
-  }
+  free(output_);
 }
 
 
@@ -185,11 +133,25 @@ void SyncProcessStdioPipe::Close() {
 }
 
 
-Local<Object> SyncProcessStdioPipe::GetOutputAsBuffer(Environment* env) const {
-  size_t length = OutputLength();
-  Local<Object> js_buffer = Buffer::New(env, length).ToLocalChecked();
-  CopyOutput(Buffer::Data(js_buffer));
-  return js_buffer;
+Local<Object> SyncProcessStdioPipe::GetOutputAsBuffer(Environment* env) {
+  CHECK(captures_output());
+
+  char* data = output_;
+  size_t length = output_length_;
+
+  // Hand back the slack from the last growth step.  For large blocks
+  // realloc() does that in place, so this doesn't copy either.
+  if (length < output_capacity_) {
+    char* shrunk = UncheckedRealloc(data, length);
+    if (shrunk != nullptr || length == 0)
+      data = shrunk;
+  }
+
+  output_ = nullptr;
+  output_length_ = 0;
+  output_capacity_ = 0;
+
+  return Buffer::New(env, data, length).ToLocalChecked();
 }
 
 
@@ -203,6 +165,11 @@ bool SyncProcessStdioPipe::writable() const {
 }
 
 
+bool SyncProcessStdioPipe::captures_output() const {
+  return writable() && output_fd_ < 0;
+}
+
+
 uv_stdio_flags SyncProcessStdioPipe::uv_flags() const {
   unsigned int flags;
 
@@ -232,45 +199,74 @@ uv_handle_t* SyncProcessStdioPipe::uv_handle() const {
 }
 
 
-size_t SyncProcessStdioPipe::OutputLength() const {
-  SyncProcessOutputBuffer* buf;
-  size_t size = 0;
+void SyncProcessStdioPipe::WriteOutput(const uv_buf_t* buf, size_t nread) {
+  uv_buf_t rest = uv_buf_init(buf->base, static_cast<unsigned int>(nread));
 
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    size += buf->used();
-
-  return size;
-}
+  while (rest.len > 0) {
+    uv_fs_t req;
+    int r = uv_fs_write(process_handler_->uv_loop_,
+                        &req,
+                        output_fd_,
+                        &rest,
+                        1,
+                        -1,
+                        nullptr);
+    uv_fs_req_cleanup(&req);
 
+    if (r < 0) {
+      SetError(r);
+      uv_read_stop(uv_stream());
+      return;
+    }
 
-void SyncProcessStdioPipe::CopyOutput(char* dest) const {
-  SyncProcessOutputBuffer* buf;
-  size_t offset = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    offset += buf->Copy(dest + offset);
+    rest.base += r;
+    rest.len -= r;
+  }
 }
 
 
 void SyncProcessStdioPipe::OnAlloc(size_t suggested_size, uv_buf_t* buf) {
   // This function assumes that libuv will never allocate two buffers for the
-  // same stream at the same time. There's an assert in
-  // SyncProcessOutputBuffer::OnRead that would fail if this assumption was
-  // ever violated.
-
-  if (last_output_buffer_ == nullptr) {
-    // Allocate the first capture buffer.
-    first_output_buffer_ = new SyncProcessOutputBuffer();
-    last_output_buffer_ = first_output_buffer_;
-
-  } else if (last_output_buffer_->available() == 0) {
-    // The current capture buffer is full so get us a new one.
-    SyncProcessOutputBuffer* buf = new SyncProcessOutputBuffer();
-    last_output_buffer_->set_next(buf);
-    last_output_buffer_ = buf;
+  // same stream at the same time. There's a check in OnRead that would fail
+  // if this assumption was ever violated.
+
+  // How much to read this time.  Captured output is read in steps the size
+  // of what has been read so far (up to kMaxOutputGrowth), so the block
+  // doubles while it's small.  Only as much as maxBuffer still allows is
+  // read, plus the one byte that tells the runner it was exceeded; past
+  // that the pipe is just drained until the child is gone.
+  size_t want;
+  if (output_fd_ >= 0) {
+    output_length_ = 0;  // The previous chunk has been written out.
+    want = kOutputChunkSize;
+  } else {
+    size_t budget = process_handler_->OutputBudget();
+    if (output_length_ < kOutputChunkSize)
+      want = kOutputChunkSize;
+    else if (output_length_ < kMaxOutputGrowth)
+      want = output_length_;
+    else
+      want = kMaxOutputGrowth;
+    if (budget > 0 && budget < want)
+      want = budget;
   }
 
-  last_output_buffer_->OnAlloc(suggested_size, buf);
+  if (output_capacity_ == output_length_) {
+    char* output = UncheckedRealloc(output_, output_length_ + want);
+    if (output == nullptr) {
+      // libuv reports this as UV_ENOBUFS to OnRead.
+      *buf = uv_buf_init(nullptr, 0);
+      return;
+    }
+    output_ = output;
+    output_capacity_ = output_length_ + want;
+  }
+
+  size_t available = output_capacity_ - output_length_;
+  if (available > want)
+    available = want;
+  *buf = uv_buf_init(output_ + output_length_,
+                     static_cast<unsigned int>(available));
 }
 
 
@@ -284,8 +280,17 @@ void SyncProcessStdioPipe::OnRead(const uv_buf_t* buf, ssize_t nread) {
     uv_read_stop(uv_stream());
 
   } else {
-    last_output_buffer_->OnRead(buf, nread);
-    process_handler_->IncrementBufferSizeAndCheckOverflow(nread);
+    // If we hand out the same chunk twice, this should catch it.
+    CHECK_EQ(buf->base, output_ + output_length_);
+
+    if (output_fd_ >= 0) {
+      WriteOutput(buf, nread);
+    } else if (process_handler_->OutputBudget() > 0) {
+      output_length_ += nread;
+      process_handler_->IncrementBufferSizeAndCheckOverflow(nread);
+    }
+    // Otherwise maxBuffer has been exceeded; the child is being killed and
+    // whatever it still writes is dropped.
   }
 }
 
@@ -616,6 +621,21 @@ void SyncProcessRunner::Kill() {
 }
 
 
+// The number of bytes of output that may still be kept before maxBuffer is
+// exceeded, counting the one byte that exceeds it.  Zero once that happened.
+size_t SyncProcessRunner::OutputBudget() const {
+  if (max_buffer_ <= 0)
+    return SIZE_MAX;
+  if (buffered_output_size_ > max_buffer_)
+    return 0;
+  double budget = max_buffer_ - buffered_output_size_;
+  // Infinity, or anything a size_t can't count, is as good as no limit.
+  if (!(budget < static_cast<double>(SIZE_MAX)))
+    return SIZE_MAX;
+  return static_cast<size_t>(budget) + 1;
+}
+
+
 void SyncProcessRunner::IncrementBufferSizeAndCheckOverflow(ssize_t length) {
   buffered_output_size_ += length;
 
@@ -710,7 +730,7 @@ Local<Array> SyncProcessRunner::BuildOutputArray() {
 
   for (uint32_t i = 0; i < stdio_count_; i++) {
     SyncProcessStdioPipe* h = stdio_pipes_[i];
-    if (h != nullptr && h->writable())
+    if (h != nullptr && h->captures_output())
       js_output->Set(i, h->GetOutputAsBuffer(env()));
     else
       js_output->Set(i, Null(env()->isolate()));
@@ -872,7 +892,21 @@ int SyncProcessRunner::ParseStdioOption(int child_fd,
       }
     }
 
-    return AddStdioPipe(child_fd, readable, writable, buf);
+    // Output that is passed on to a file descriptor as it arrives instead of
+    // being collected.  The fd is written synchronously, so it should be in
+    // blocking mode.
+    int output_fd = -1;
+    if (writable) {
+      Local<Value> js_output_fd =
+          js_stdio_option->Get(env()->output_fd_string());
+      if (IsSet(js_output_fd)) {
+        if (!js_output_fd->IsInt32() || js_output_fd->Int32Value() < 0)
+          return UV_EINVAL;
+        output_fd = js_output_fd->Int32Value();
+      }
+    }
+
+    return AddStdioPipe(child_fd, readable, writable, buf, output_fd);
 
   } else if (js_type->StrictEquals(env()->inherit_string()) ||
              js_type->StrictEquals(env()->fd_string())) {
@@ -899,14 +933,16 @@ int SyncProcessRunner::AddStdioIgnore(uint32_t child_fd) {
 int SyncProcessRunner::AddStdioPipe(uint32_t child_fd,
                                     bool readable,
                                     bool writable,
-                                    uv_buf_t input_buffer) {
+                                    uv_buf_t input_buffer,
+                                    int output_fd) {
   CHECK_LT(child_fd, stdio_count_);
   CHECK_EQ(stdio_pipes_[child_fd], nullptr);
 
   SyncProcessStdioPipe* h = new SyncProcessStdioPipe(this,
                                                      readable,
                                                      writable,
-                                                     input_buffer);
+                                                     input_buffer,
+                                                     output_fd);
 
   int r = h->Initialize(uv_loop_);
   if (r < 0) {
@@ -43,37 +43,10 @@ using v8::String;
 using v8::Value;
 
 
-class SyncProcessOutputBuffer;
 class SyncProcessStdioPipe;
 class SyncProcessRunner;
 
 
-class SyncProcessOutputBuffer {
-  static const unsigned int kBufferSize = 65536;
-
- public:
-  inline SyncProcessOutputBuffer();
-
-  inline void OnAlloc(size_t suggested_size, uv_buf_t* buf) const;
-  inline void OnRead(const uv_buf_t* buf, size_t nread);
-
-  inline size_t Copy(char* dest) const;
-
-  inline unsigned int available() const;
-  inline unsigned int used() const;
-
-  inline SyncProcessOutputBuffer* next() const;
-  inline void set_next(SyncProcessOutputBuffer* next);
-
- private:
-  // Use unsigned int because that's what `uv_buf_init` takes.
-  mutable char data_[kBufferSize];
-  unsigned int used_;
-
-  SyncProcessOutputBuffer* next_;
-};
-
-
 class SyncProcessStdioPipe {
   enum Lifecycle {
     kUninitialized = 0,
@@ -83,21 +56,26 @@ class SyncProcessStdioPipe {
     kClosed
   };
 
+  static const size_t kOutputChunkSize = 65536;
+  static const size_t kMaxOutputGrowth = 64 * 1024 * 1024;
+
  public:
   SyncProcessStdioPipe(SyncProcessRunner* process_handler,
                        bool readable,
                        bool writable,
-                       uv_buf_t input_buffer);
+                       uv_buf_t input_buffer,
+                       int output_fd);
   ~SyncProcessStdioPipe();
 
   int Initialize(uv_loop_t* loop);
   int Start();
   void Close();
 
-  Local<Object> GetOutputAsBuffer(Environment* env) const;
+  Local<Object> GetOutputAsBuffer(Environment* env);
 
   inline bool readable() const;
   inline bool writable() const;
+  inline bool captures_output() const;
   inline uv_stdio_flags uv_flags() const;
 
   inline uv_pipe_t* uv_pipe() const;
@@ -105,8 +83,7 @@ class SyncProcessStdioPipe {
   inline uv_handle_t* uv_handle() const;
 
  private:
-  inline size_t OutputLength() const;
-  inline void CopyOutput(char* dest) const;
+  inline void WriteOutput(const uv_buf_t* buf, size_t nread);
 
   inline void OnAlloc(size_t suggested_size, uv_buf_t* buf);
   inline void OnRead(const uv_buf_t* buf, ssize_t nread);
@@ -132,8 +109,15 @@ class SyncProcessStdioPipe {
   bool writable_;
   uv_buf_t input_buffer_;
 
-  SyncProcessOutputBuffer* first_output_buffer_;
-  SyncProcessOutputBuffer* last_output_buffer_;
+  // Output is read straight into a single malloc()ed block that grows with
+  // realloc() (which moves big blocks with mremap() on Linux instead of
+  // copying them) and becomes the Buffer's backing store as is.  When the
+  // output goes to `output_fd_` instead, the block is a fixed size scratch
+  // area that is written out after every read.
+  char* output_;
+  size_t output_length_;
+  size_t output_capacity_;
+  int output_fd_;
 
   mutable uv_pipe_t uv_pipe_;
   uv_write_t write_req_;
@@ -172,6 +156,7 @@ class SyncProcessRunner {
   void CloseKillTimer();
 
   void Kill();
+  size_t OutputBudget() const;
   void IncrementBufferSizeAndCheckOverflow(ssize_t length);
 
   void OnExit(int64_t exit_status, int term_signal);
@@ -192,7 +177,8 @@ class SyncProcessRunner {
   inline int AddStdioPipe(uint32_t child_fd,
                           bool readable,
                           bool writable,
-                          uv_buf_t input_buffer);
+                          uv_buf_t input_buffer,
+                          int output_fd);
   inline int AddStdioInheritFD(uint32_t child_fd, int inherit_fd);
 
   static bool IsSet(Local<Value> value);
@@ -98,6 +98,8 @@ void StreamWrap::AddMethods(Environment* env,
                             v8::Local<v8::FunctionTemplate> target,
                             int flags) {
   env->SetProtoMethod(target, "setBlocking", SetBlocking);
+  env->SetProtoMethod(target, "cork", Cork);
+  env->SetProtoMethod(target, "uncork", Uncork);
   StreamBase::AddMethods<StreamWrap>(env, target, flags);
 }
 
@@ -289,6 +291,28 @@ void StreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void StreamWrap::Cork(const FunctionCallbackInfo<Value>& args) {
+  StreamWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  if (!wrap->IsAlive())
+    return args.GetReturnValue().Set(UV_EINVAL);
+
+  args.GetReturnValue().Set(uv_stream_cork(wrap->stream()));
+}
+
+
+void StreamWrap::Uncork(const FunctionCallbackInfo<Value>& args) {
+  StreamWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+
+  if (!wrap->IsAlive())
+    return args.GetReturnValue().Set(UV_EINVAL);
+
+  args.GetReturnValue().Set(uv_stream_uncork(wrap->stream()));
+}
+
+
 int StreamWrap::DoShutdown(ShutdownWrap* req_wrap) {
   int err;
   err = uv_shutdown(req_wrap->req(), stream(), AfterShutdown);
@@ -96,6 +96,9 @@ class StreamWrap : public HandleWrap, public StreamBase {
 
  private:
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // Hold back writes until uncork(), then send them with one writev().
+  static void Cork(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Uncork(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // Callbacks for libuv
   static void OnAlloc(uv_handle_t* handle,
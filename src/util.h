@@ -438,6 +438,18 @@ class BufferValue : public MaybeStackBuffer<char> {
       return env->ThrowTypeError("argument should be a Buffer");            \
   } while (0)
 
+#ifdef NODE_ENGINE_SPIDERMONKEY
+// Buffer() has to create a handle for the ArrayBuffer on every call, while
+// GetData() reads the pointer and length straight off the view.
+#define SPREAD_BUFFER_ARG(val, name)                                          \
+  CHECK((val)->IsUint8Array());                                               \
+  v8::Local<v8::Uint8Array> name = (val).As<v8::Uint8Array>();                \
+  size_t name##_length;                                                       \
+  char* const name##_data =                                                   \
+      static_cast<char*>(name->GetData(&name##_length));                      \
+  if (name##_length > 0)                                                      \
+    CHECK_NE(name##_data, nullptr);
+#else
 #define SPREAD_BUFFER_ARG(val, name)                                          \
   CHECK((val)->IsUint8Array());                                               \
   v8::Local<v8::Uint8Array> name = (val).As<v8::Uint8Array>();                \
@@ -448,6 +460,7 @@ class BufferValue : public MaybeStackBuffer<char> {
       static_cast<char*>(name##_c.Data()) + name##_offset;                    \
   if (name##_length > 0)                                                      \
     CHECK_NE(name##_data, nullptr);
+#endif  // NODE_ENGINE_SPIDERMONKEY
 
 
 }  // namespace node